@@ -3,6 +3,7 @@
 #include "Application.h"
 #include "ModuleEditor.h"
 #include "SceneGraph.h"
+#include "CollisionSystem.h"
 
 namespace Phoenix {
 
@@ -11,6 +12,30 @@ static SceneGraph* getScene(){
     return app->getEditor()->getActiveModuleScene();
 }
 
+static CollisionSystem* getCollision(){
+    if (!app || !app->getEditor()) return nullptr;
+    return app->getEditor()->getCollisionSystem();
+}
+
+static RayQuery toQuery(const Scene::Ray& ray, uint32_t layerMask){
+    RayQuery q;
+    q.origin = ray.origin;
+    q.direction = ray.direction;
+    q.maxDistance = ray.maxDistance;
+    q.layerMask = layerMask;
+    return q;
+}
+
+static Scene::RaycastHit toHit(const ::RaycastHit& hit){
+    Scene::RaycastHit out;
+    if (!hit.hit()) return out;
+    out.object = hit.go;
+    out.point = hit.point;
+    out.normal = hit.normal;
+    out.distance = hit.distance;
+    return out;
+}
+
 GameObject* Scene::Find(const std::string& name){
     if (SceneGraph* sg = getScene())
         return sg->findGameObjectByName(name);
@@ -29,4 +54,61 @@ void Scene::Destroy(GameObject* go){
         sg->destroyGameObject(go);
 }
 
+bool Scene::Raycast(const Ray& ray, RaycastHit& outHit, uint32_t layerMask){
+    outHit = {};
+    CollisionSystem* cs = getCollision();
+    ::RaycastHit hit;
+    if (!cs || !cs->raycast(toQuery(ray, layerMask), hit)) return false;
+    outHit = toHit(hit);
+    return true;
+}
+
+bool Scene::SphereCast(const Ray& ray, float radius, RaycastHit& outHit, uint32_t layerMask){
+    outHit = {};
+    CollisionSystem* cs = getCollision();
+    ::RaycastHit hit;
+    if (!cs || !cs->sphereCast(toQuery(ray, layerMask), radius, hit)) return false;
+    outHit = toHit(hit);
+    return true;
+}
+
+int Scene::OverlapSphere(const Vec3& center, float radius, std::vector<GameObject*>& outObjects,
+                         uint32_t layerMask){
+    if (CollisionSystem* cs = getCollision())
+        return static_cast<int>(cs->sphereOverlap(center, radius, outObjects, layerMask));
+    return 0;
+}
+
+int Scene::OverlapBox(const Vec3& center, const Vec3& halfExtents, const Quat& rotation,
+                      std::vector<GameObject*>& outObjects, uint32_t layerMask){
+    if (CollisionSystem* cs = getCollision())
+        return static_cast<int>(cs->boxOverlap(center, halfExtents, rotation, outObjects, layerMask));
+    return 0;
+}
+
+void Scene::RaycastBatch(const std::vector<Ray>& rays, std::vector<RaycastHit>& outHits, uint32_t layerMask){
+    outHits.assign(rays.size(), RaycastHit{});
+    CollisionSystem* cs = getCollision();
+    if (!cs || rays.empty()) return;
+
+    std::vector<RayQuery> queries(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i) queries[i] = toQuery(rays[i], layerMask);
+    std::vector<::RaycastHit> hits(rays.size());
+    cs->raycastBatch(queries.data(), static_cast<uint32_t>(queries.size()), hits.data());
+    for (size_t i = 0; i < hits.size(); ++i) outHits[i] = toHit(hits[i]);
+}
+
+void Scene::SphereCastBatch(const std::vector<Ray>& rays, float radius, std::vector<RaycastHit>& outHits,
+                            uint32_t layerMask){
+    outHits.assign(rays.size(), RaycastHit{});
+    CollisionSystem* cs = getCollision();
+    if (!cs || rays.empty()) return;
+
+    std::vector<RayQuery> queries(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i) queries[i] = toQuery(rays[i], layerMask);
+    std::vector<::RaycastHit> hits(rays.size());
+    cs->sphereCastBatch(queries.data(), static_cast<uint32_t>(queries.size()), radius, hits.data());
+    for (size_t i = 0; i < hits.size(); ++i) outHits[i] = toHit(hits[i]);
+}
+
 } // namespace Phoenix
@@ -1,16 +1,52 @@
 #pragma once
+#include "API/Phoenix_Types.h"
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <cfloat>
 
 class GameObject;
 
 namespace Phoenix {
 
 struct Scene {
+    struct Ray {
+        Vec3 origin;
+        Vec3 direction;
+        float maxDistance = FLT_MAX;
+    };
+
+    struct RaycastHit {
+        GameObject* object = nullptr;
+        Vec3 point;
+        Vec3 normal;
+        float distance = 0.f;
+    };
+
     static GameObject* Find(const std::string& name);
 
     static GameObject* Spawn(const std::string& name);
 
     static void Destroy(GameObject* go);
+
+    // Queries see the bodies from the last physics step. layerMask selects
+    // which collision layers can be hit (bit i = layer i).
+    static bool Raycast(const Ray& ray, RaycastHit& outHit, uint32_t layerMask = 0xFFFFFFFF);
+
+    static bool SphereCast(const Ray& ray, float radius, RaycastHit& outHit, uint32_t layerMask = 0xFFFFFFFF);
+
+    static int OverlapSphere(const Vec3& center, float radius, std::vector<GameObject*>& outObjects,
+                             uint32_t layerMask = 0xFFFFFFFF);
+
+    static int OverlapBox(const Vec3& center, const Vec3& halfExtents, const Quat& rotation,
+                          std::vector<GameObject*>& outObjects, uint32_t layerMask = 0xFFFFFFFF);
+
+    // outHits is resized to rays.size(); misses have a null object.
+    static void RaycastBatch(const std::vector<Ray>& rays, std::vector<RaycastHit>& outHits,
+                             uint32_t layerMask = 0xFFFFFFFF);
+
+    static void SphereCastBatch(const std::vector<Ray>& rays, float radius, std::vector<RaycastHit>& outHits,
+                                uint32_t layerMask = 0xFFFFFFFF);
 };
 
 } // namespace Phoenix
@@ -0,0 +1,438 @@
+#include "Globals.h"
+#include "AnimationBenchmark.h"
+#include "AnimationBinding.h"
+#include "ResourceAnimation.h"
+#include "AnimationCompression.h"
+#include <unordered_map>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+namespace AnimationBenchmark {
+
+namespace {
+
+constexpr uint32_t kClipCount = 8;
+constexpr float kClipDuration = 2.f;
+constexpr float kKeyRate = 30.f;
+constexpr float kMaxAngleErrDeg = 1e-3f;
+constexpr float kMaxPosErr = 1e-5f;
+
+// The per-name layout clips used before they were compiled.
+struct NamedChannel {
+    std::unique_ptr<Vector3[]> positions;
+    std::unique_ptr<float[]> posTimeStamps;
+    uint32_t posCount = 0;
+
+    std::unique_ptr<Quaternion[]> rotations;
+    std::unique_ptr<float[]> rotTimeStamps;
+    uint32_t rotCount = 0;
+
+    std::unique_ptr<Vector3[]> scales;
+    std::unique_ptr<float[]> scaleTimeStamps;
+    uint32_t scaleCount = 0;
+};
+
+using NamedClip = std::unordered_map<std::string, NamedChannel>;
+
+Vector3 sampleNamedVector(const float* tf, const Vector3* values, uint32_t count, float timeSec){
+    const float* tl = tf + count;
+    const float* up = std::upper_bound(tf, tl, timeSec);
+    if (up == tf) return values[0];
+    if (up == tl) return values[count - 1];
+    const int i = (int)(up - tf) - 1;
+    const float d = tf[i + 1] - tf[i];
+    return Vector3::Lerp(values[i], values[i + 1], d > 0.f ? (timeSec - tf[i]) / d : 0.f);
+}
+
+bool sampleNamed(const NamedClip& clip, const char* name, float timeSec, BonePose& pose){
+    const auto it = clip.find(name);
+    if (it == clip.end()) return false;
+    const NamedChannel& ch = it->second;
+
+    if (ch.posCount > 0)
+        pose.position = sampleNamedVector(ch.posTimeStamps.get(), ch.positions.get(), ch.posCount, timeSec);
+
+    if (ch.rotCount > 0){
+        const float* tf = ch.rotTimeStamps.get();
+        const float* tl = tf + ch.rotCount;
+        const float* up = std::upper_bound(tf, tl, timeSec);
+        if (up == tf) pose.rotation = ch.rotations[0];
+        else if (up == tl) pose.rotation = ch.rotations[ch.rotCount - 1];
+        else {
+            const int i = (int)(up - tf) - 1;
+            const float d = tf[i + 1] - tf[i];
+            pose.rotation = Quaternion::Lerp(ch.rotations[i], ch.rotations[i + 1], d > 0.f ? (timeSec - tf[i]) / d : 0.f);
+        }
+    }
+
+    if (ch.scaleCount > 0)
+        pose.scale = sampleNamedVector(ch.scaleTimeStamps.get(), ch.scales.get(), ch.scaleCount, timeSec);
+    return true;
+}
+
+// Every tenth bone is left unanimated, every fourth squashes and stretches
+// on a scale track, and channels are stored in a shuffled order so binding
+// has real work to do.
+void buildClips(uint32_t bones, const std::vector<std::string>& names,
+                std::vector<std::unique_ptr<ResourceAnimation>>& compiled, std::vector<NamedClip>& named){
+    std::mt19937 rng(4242u);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f), phase(0.f, XM_2PI), amp(0.1f, 1.2f);
+    const uint32_t keys = (uint32_t)(kClipDuration * kKeyRate) + 1;
+
+    std::vector<uint32_t> order(bones);
+    for (uint32_t c = 0; c < kClipCount; ++c){
+        auto clip = std::make_unique<ResourceAnimation>(0);
+        clip->setDuration(kClipDuration);
+        NamedClip byName;
+
+        for (uint32_t b = 0; b < bones; ++b) order[b] = b;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        std::vector<float> times(keys);
+        std::vector<Vector3> positions(keys);
+        std::vector<Quaternion> rotations(keys);
+        std::vector<Vector3> scales(keys);
+        for (uint32_t b : order){
+            if (b % 10 == 9) continue;
+
+            Vector3 axis(unit(rng), unit(rng), unit(rng));
+            if (axis.LengthSquared() < 1e-4f) axis = Vector3::UnitY;
+            axis.Normalize();
+            const Vector3 base(unit(rng), unit(rng) + 1.f, unit(rng));
+            const float a = amp(rng), p = phase(rng);
+            for (uint32_t k = 0; k < keys; ++k){
+                times[k] = k / kKeyRate;
+                const float w = std::sin(times[k] * XM_2PI / kClipDuration + p);
+                positions[k] = base + Vector3(0.f, 0.05f * w, 0.f);
+                rotations[k] = Quaternion::CreateFromAxisAngle(axis, a * w);
+                scales[k] = Vector3(1.f - 0.1f * w, 1.f + 0.2f * w, 1.f - 0.1f * w);
+            }
+
+            const uint32_t scaleKeys = b % 4 == 1 ? keys : 0;
+            clip->addChannel(names[b], times.data(), positions.data(), keys,
+                             times.data(), rotations.data(), keys,
+                             times.data(), scales.data(), scaleKeys);
+
+            NamedChannel ch;
+            ch.posCount = ch.rotCount = keys;
+            ch.posTimeStamps = std::make_unique<float[]>(keys);
+            ch.rotTimeStamps = std::make_unique<float[]>(keys);
+            ch.positions = std::make_unique<Vector3[]>(keys);
+            ch.rotations = std::make_unique<Quaternion[]>(keys);
+            std::copy(times.begin(), times.end(), ch.posTimeStamps.get());
+            std::copy(times.begin(), times.end(), ch.rotTimeStamps.get());
+            std::copy(positions.begin(), positions.end(), ch.positions.get());
+            std::copy(rotations.begin(), rotations.end(), ch.rotations.get());
+            if (scaleKeys > 0){
+                ch.scaleCount = scaleKeys;
+                ch.scaleTimeStamps = std::make_unique<float[]>(keys);
+                ch.scales = std::make_unique<Vector3[]>(keys);
+                std::copy(times.begin(), times.end(), ch.scaleTimeStamps.get());
+                std::copy(scales.begin(), scales.end(), ch.scales.get());
+            }
+            byName.emplace(names[b], std::move(ch));
+        }
+
+        compiled.push_back(std::move(clip));
+        named.push_back(std::move(byName));
+    }
+}
+
+// Angle of the rotation taking a to b, from the vector part of conj(a) * b
+// so small angles keep their precision.
+float angleDeg(const Quaternion& a, const Quaternion& b){
+    Quaternion ia = a;
+    ia.Conjugate();
+    const Quaternion d = ia * b;
+    const float s = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+    return 2.f * std::atan2(s, std::fabs(d.w)) * 180.f / XM_PI;
+}
+
+// Channel by channel, the way the importer writes a version 4 file. A clip
+// with a track too wide to pack within tolerance stays float, as the
+// importer's version 5 file does.
+std::unique_ptr<ResourceAnimation> packClip(const ResourceAnimation& src){
+    using Track = ResourceAnimation::Track;
+    struct PackedChannel {
+        AnimationCompression::PackedVectors pos;
+        AnimationCompression::PackedRotations rot;
+        AnimationCompression::PackedVectors scl;
+    };
+    const auto& channels = src.getChannels();
+    std::vector<PackedChannel> packedChannels(channels.size());
+    bool withinTolerance = true;
+    for (uint32_t c = 0; c < (uint32_t)channels.size(); ++c){
+        const ResourceAnimation::TrackRange* tracks = channels[c].tracks;
+        const ResourceAnimation::TrackRange& pos = tracks[Track::Translation];
+        const ResourceAnimation::TrackRange& rot = tracks[Track::Rotation];
+        const ResourceAnimation::TrackRange& scl = tracks[Track::Scale];
+        PackedChannel& pc = packedChannels[c];
+        pc.pos = AnimationCompression::compressPositions(src.getTimes(Track::Translation) + pos.first,
+                                                         src.getVectors(Track::Translation) + pos.first, pos.count);
+        pc.rot = AnimationCompression::compressRotations(src.getTimes(Track::Rotation) + rot.first,
+                                                         src.getRotations() + rot.first, rot.count);
+        pc.scl = AnimationCompression::compressScales(src.getTimes(Track::Scale) + scl.first,
+                                                      src.getVectors(Track::Scale) + scl.first, scl.count);
+        withinTolerance = withinTolerance && pc.pos.withinTolerance && pc.rot.withinTolerance && pc.scl.withinTolerance;
+    }
+
+    auto packed = std::make_unique<ResourceAnimation>(0);
+    packed->setDuration(src.getDuration());
+    for (uint32_t c = 0; c < (uint32_t)channels.size(); ++c){
+        if (withinTolerance){
+            const PackedChannel& pc = packedChannels[c];
+            packed->addPackedChannel(src.getChannelName(c), pc.pos, pc.rot, pc.scl);
+            continue;
+        }
+        const ResourceAnimation::TrackRange* tracks = channels[c].tracks;
+        const ResourceAnimation::TrackRange& pos = tracks[Track::Translation];
+        const ResourceAnimation::TrackRange& rot = tracks[Track::Rotation];
+        const ResourceAnimation::TrackRange& scl = tracks[Track::Scale];
+        packed->addChannel(src.getChannelName(c),
+            src.getTimes(Track::Translation) + pos.first, src.getVectors(Track::Translation) + pos.first, pos.count,
+            src.getTimes(Track::Rotation) + rot.first, src.getRotations() + rot.first, rot.count,
+            src.getTimes(Track::Scale) + scl.first, src.getVectors(Track::Scale) + scl.first, scl.count);
+    }
+    return packed;
+}
+
+uint32_t keyCount(const ResourceAnimation& clip){
+    uint32_t keys = 0;
+    for (const ResourceAnimation::Channel& ch : clip.getChannels())
+        for (const ResourceAnimation::TrackRange& track : ch.tracks) keys += track.count;
+    return keys;
+}
+
+// Larger of the translation and scale distances.
+float vectorErr(const BonePose& a, const BonePose& b){
+    return std::max((a.position - b.position).Length(), (a.scale - b.scale).Length());
+}
+
+bool samePose(const BonePose& a, const BonePose& b){
+    return (a.position - b.position).LengthSquared() <= 1e-10f
+        && (a.scale - b.scale).LengthSquared() <= 1e-10f
+        && std::fabs(a.rotation.Dot(b.rotation)) >= 1.f - 1e-6f;
+}
+
+}
+
+std::vector<PoseSampleResult> RunPoseSampling(uint32_t characters, uint32_t bones, int frames){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<PoseSampleResult> results;
+    if (characters == 0 || bones == 0) return results;
+    if (frames < 1) frames = 1;
+
+    std::vector<std::string> names(bones);
+    for (uint32_t b = 0; b < bones; ++b) names[b] = "mixamorig:Bone_" + std::to_string(b);
+
+    std::vector<std::unique_ptr<ResourceAnimation>> compiled;
+    std::vector<NamedClip> named;
+    buildClips(bones, names, compiled, named);
+
+    std::vector<float> phase(characters);
+    for (uint32_t i = 0; i < characters; ++i) phase[i] = std::fmod(i * 0.137f, kClipDuration);
+    auto timeAt = [&](uint32_t character, int frame){
+        return std::fmod(phase[character] + frame / 60.f, kClipDuration);
+    };
+
+    const size_t poseSize = (size_t)characters * bones;
+    std::vector<BonePose> reference(poseSize), pose(poseSize);
+    const BonePose rest{ Vector3::Zero, Quaternion::Identity };
+
+    {
+        PoseSampleResult r;
+        r.path = "Name lookup";
+        r.characters = characters;
+        r.bones = bones;
+
+        std::fill(reference.begin(), reference.end(), rest);
+        const auto t0 = Clock::now();
+        for (int f = 0; f < frames; ++f){
+            for (uint32_t i = 0; i < characters; ++i){
+                const NamedClip& clip = named[i % kClipCount];
+                BonePose* out = reference.data() + (size_t)i * bones;
+                const float t = timeAt(i, f);
+                for (uint32_t b = 0; b < bones; ++b)
+                    sampleNamed(clip, names[b].c_str(), t, out[b]);
+            }
+        }
+        r.sampleMs = std::chrono::duration<float, std::milli>(Clock::now() - t0).count() / frames;
+        r.bonesPerUs = poseSize / (r.sampleMs * 1000.f);
+        results.push_back(r);
+    }
+
+    std::vector<AnimationBinding> bindings(characters);
+    float bindMs = 0.f;
+    {
+        const auto b0 = Clock::now();
+        for (uint32_t i = 0; i < characters; ++i)
+            bindings[i].bind(compiled[i % kClipCount].get(), names);
+        bindMs = std::chrono::duration<float, std::milli>(Clock::now() - b0).count();
+    }
+
+    // Search, then cursors on each sampling path. The lane paths are held
+    // to the scalar cursor pose within kMaxAngleErrDeg and kMaxPosErr.
+    struct BoundPath { const char* name; bool cursors; AnimationBinding::Path path; };
+    const BoundPath paths[] = {
+        { "Bound, search", false, AnimationBinding::Path::Scalar },
+        { "Cursors, scalar", true, AnimationBinding::Path::Scalar },
+        { "Cursors, SSE x4", true, AnimationBinding::Path::SSE },
+        { "Cursors, AVX2 x8", true, AnimationBinding::Path::AVX2 },
+    };
+
+    for (const BoundPath& bp : paths){
+        if (bp.path == AnimationBinding::Path::AVX2 && AnimationBinding::bestPath() != AnimationBinding::Path::AVX2)
+            continue;
+        for (AnimationBinding& binding : bindings) binding.setPath(bp.path);
+
+        PoseSampleResult r;
+        r.path = bp.name;
+        r.characters = characters;
+        r.bones = bones;
+        r.bindMs = bindMs;
+
+        std::fill(pose.begin(), pose.end(), rest);
+        const auto t0 = Clock::now();
+        for (int f = 0; f < frames; ++f){
+            for (uint32_t i = 0; i < characters; ++i){
+                BonePose* out = pose.data() + (size_t)i * bones;
+                const float t = timeAt(i, f);
+                if (bp.cursors){
+                    bindings[i].sample(t, out);
+                    continue;
+                }
+                const ResourceAnimation& clip = *compiled[i % kClipCount];
+                for (uint32_t b = 0; b < bones; ++b){
+                    const int32_t channel = bindings[i].channelOf(b);
+                    if (channel >= 0)
+                        AnimationBinding::sampleChannel(clip, (uint32_t)channel, t, out[b]);
+                }
+            }
+        }
+        r.sampleMs = std::chrono::duration<float, std::milli>(Clock::now() - t0).count() / frames;
+        r.bonesPerUs = poseSize / (r.sampleMs * 1000.f);
+
+        if (bp.cursors && bp.path != AnimationBinding::Path::Scalar){
+            // Every frame again, untimed, against a scalar binding stepped in
+            // lockstep; a mismatch is one bone on one frame past the bound.
+            std::vector<BonePose> lane(bones, rest), scalar(bones, rest);
+            for (uint32_t i = 0; i < characters; ++i){
+                AnimationBinding fl, fs;
+                fl.bind(compiled[i % kClipCount].get(), names);
+                fs.bind(compiled[i % kClipCount].get(), names);
+                fl.setPath(bp.path);
+                fs.setPath(AnimationBinding::Path::Scalar);
+                for (int f = 0; f < frames; ++f){
+                    fl.sample(timeAt(i, f), lane.data());
+                    fs.sample(timeAt(i, f), scalar.data());
+                    for (uint32_t k = 0; k < bones; ++k){
+                        const float angle = angleDeg(lane[k].rotation, scalar[k].rotation);
+                        const float dist = vectorErr(lane[k], scalar[k]);
+                        r.maxAngleErrDeg = std::max(r.maxAngleErrDeg, angle);
+                        r.maxPosErr = std::max(r.maxPosErr, dist);
+                        if (angle > kMaxAngleErrDeg || dist > kMaxPosErr) ++r.mismatches;
+                    }
+                }
+            }
+        } else {
+            for (size_t k = 0; k < poseSize; ++k)
+                if (!samePose(pose[k], reference[k])) ++r.mismatches;
+        }
+        results.push_back(r);
+    }
+
+    for (const PoseSampleResult& r : results)
+        LOG("AnimationBenchmark: %-16s %u x %u bones  bind %7.3f ms  sample %7.3f ms/frame  %7.2f bones/us  max err %.2e deg, %.2e pos  %u mismatch(es)",
+            r.path, r.characters, r.bones, r.bindMs, r.sampleMs, r.bonesPerUs, r.maxAngleErrDeg, r.maxPosErr, r.mismatches);
+    return results;
+}
+
+std::vector<CompressionResult> RunCompression(uint32_t characters, uint32_t bones, int frames){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<CompressionResult> results;
+    if (characters == 0 || bones == 0) return results;
+    if (frames < 1) frames = 1;
+
+    std::vector<std::string> names(bones);
+    for (uint32_t b = 0; b < bones; ++b) names[b] = "mixamorig:Bone_" + std::to_string(b);
+
+    std::vector<std::unique_ptr<ResourceAnimation>> compiled;
+    std::vector<NamedClip> named;
+    buildClips(bones, names, compiled, named);
+
+    std::vector<std::unique_ptr<ResourceAnimation>> packed;
+    const auto c0 = Clock::now();
+    for (const auto& clip : compiled) packed.push_back(packClip(*clip));
+    const float compressMs = std::chrono::duration<float, std::milli>(Clock::now() - c0).count() / kClipCount;
+
+    std::vector<float> phase(characters);
+    for (uint32_t i = 0; i < characters; ++i) phase[i] = std::fmod(i * 0.137f, kClipDuration);
+    auto timeAt = [&](uint32_t character, int frame){
+        return std::fmod(phase[character] + frame / 60.f, kClipDuration);
+    };
+
+    const size_t poseSize = (size_t)characters * bones;
+    const BonePose rest{ Vector3::Zero, Quaternion::Identity };
+
+    auto run = [&](const char* path, const std::vector<std::unique_ptr<ResourceAnimation>>& clips){
+        CompressionResult r;
+        r.path = path;
+        size_t bytes = 0, keys = 0;
+        for (const auto& clip : clips){
+            bytes += clip->getKeyBytes();
+            keys += keyCount(*clip);
+        }
+        r.bytesPerClip = (uint32_t)(bytes / clips.size());
+        r.keysPerClip = (uint32_t)(keys / clips.size());
+
+        std::vector<AnimationBinding> bindings(characters);
+        for (uint32_t i = 0; i < characters; ++i)
+            bindings[i].bind(clips[i % kClipCount].get(), names);
+
+        std::vector<BonePose> pose(poseSize, rest);
+        const auto t0 = Clock::now();
+        for (int f = 0; f < frames; ++f)
+            for (uint32_t i = 0; i < characters; ++i)
+                bindings[i].sample(timeAt(i, f), pose.data() + (size_t)i * bones);
+        r.sampleMs = std::chrono::duration<float, std::milli>(Clock::now() - t0).count() / frames;
+        r.bonesPerUs = poseSize / (r.sampleMs * 1000.f);
+        return r;
+    };
+
+    results.push_back(run("Float keys", compiled));
+    results.push_back(run("Packed keys", packed));
+    results.back().compressMs = compressMs;
+
+    // Error over every frame for the first characters, which cover every clip.
+    std::vector<BonePose> a(bones, rest), b(bones, rest);
+    CompressionResult& r = results.back();
+    for (uint32_t i = 0; i < std::min(characters, 64u); ++i){
+        AnimationBinding fa, fb;
+        fa.bind(compiled[i % kClipCount].get(), names);
+        fb.bind(packed[i % kClipCount].get(), names);
+        for (int f = 0; f < frames; ++f){
+            fa.sample(timeAt(i, f), a.data());
+            fb.sample(timeAt(i, f), b.data());
+            for (uint32_t k = 0; k < bones; ++k){
+                r.maxAngleErrDeg = std::max(r.maxAngleErrDeg, angleDeg(a[k].rotation, b[k].rotation));
+                r.maxPosErr = std::max(r.maxPosErr, vectorErr(a[k], b[k]));
+            }
+        }
+    }
+
+    const AnimationCompression::Tolerance tolerance;
+    r.withinTolerance = r.maxAngleErrDeg <= tolerance.angleDeg
+                     && r.maxPosErr <= std::max(tolerance.position, tolerance.scale);
+
+    for (const CompressionResult& c : results)
+        LOG("AnimationBenchmark: %-12s %u keys %u bytes per clip  compress %7.3f ms/clip  sample %7.3f ms/frame  %7.2f bones/us  max err %.2e deg, %.2e pos  %s",
+            c.path, c.keysPerClip, c.bytesPerClip, c.compressMs, c.sampleMs, c.bonesPerUs, c.maxAngleErrDeg, c.maxPosErr,
+            c.withinTolerance ? "within tolerance" : "OVER TOLERANCE");
+    return results;
+}
+
+}
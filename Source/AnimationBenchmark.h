@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+namespace AnimationBenchmark {
+
+    struct PoseSampleResult {
+        const char* path = "";
+        uint32_t characters = 0;
+        uint32_t bones = 0;
+        float bindMs = 0.f;
+        float sampleMs = 0.f;
+        float bonesPerUs = 0.f;
+        float maxAngleErrDeg = 0.f;
+        float maxPosErr = 0.f;
+        uint32_t mismatches = 0;
+    };
+
+    // Headless: a crowd of characters sharing a few looping clips, each
+    // character at its own phase, sampled over consecutive 60 Hz frames.
+    // "Name lookup" hashes every bone name into a per-clip channel map, the
+    // way clips were stored before; the other paths bind each character once
+    // and then either binary-search every track or step each bone's cursor.
+    // Phases wrap during the run, so the cursor paths also cover loops.
+    // sampleMs is per frame for the whole crowd; mismatches are bones whose
+    // last-frame pose differs from the name-lookup path. The SSE and AVX2
+    // paths are checked against the scalar cursor pose on every frame
+    // instead: the max errors are the worst rotation angle and translation
+    // or scale distance, and a mismatch is a bone on a frame past the bound.
+    std::vector<PoseSampleResult> RunPoseSampling(uint32_t characters = 1000,
+                                                  uint32_t bones = 60,
+                                                  int frames = 60);
+
+    struct CompressionResult {
+        const char* path = "";
+        uint32_t keysPerClip = 0;
+        uint32_t bytesPerClip = 0;
+        float compressMs = 0.f;
+        float sampleMs = 0.f;
+        float bonesPerUs = 0.f;
+        float maxAngleErrDeg = 0.f;
+        float maxPosErr = 0.f;
+        bool withinTolerance = true;
+    };
+
+    // Headless: the same crowd and clips as RunPoseSampling, sampled with
+    // float keys and again after AnimationCompression packs each clip at the
+    // importer's tolerances. Bytes and keys are averaged over the clips,
+    // compressMs is per clip, and the max errors are the worst rotation
+    // angle and translation or scale distance from the float pose over every
+    // frame. The packed row is within tolerance when both errors stay under
+    // the importer's tolerances.
+    std::vector<CompressionResult> RunCompression(uint32_t characters = 1000,
+                                                  uint32_t bones = 60,
+                                                  int frames = 60);
+}
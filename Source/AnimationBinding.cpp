@@ -0,0 +1,379 @@
+#include "Globals.h"
+#include "AnimationBinding.h"
+#include "ResourceAnimation.h"
+#include "AnimationCompression.h"
+#include "SimdOps.h"
+#include <algorithm>
+
+namespace {
+
+// Forward playback rarely crosses more than a key per frame; past this many
+// steps the rest of the track is searched instead.
+constexpr uint32_t kMaxKeySteps = 4;
+
+// Last key at or before timeSec in [first, count), or `first` if none is.
+uint32_t searchKey(const float* times, uint32_t first, uint32_t count, float timeSec){
+    const float* upper = std::upper_bound(times + first, times + count, timeSec);
+    return upper == times + first ? first : (uint32_t)(upper - times) - 1;
+}
+
+// Last key at or before timeSec, clamped to the first. `cursor` is the key
+// found last time; one past the end forces a search.
+uint32_t stepKey(const float* times, uint32_t count, float timeSec, uint32_t& cursor){
+    uint32_t i = cursor;
+    if (i >= count || (i > 0 && timeSec < times[i]))
+        i = searchKey(times, 0, count, timeSec);
+    else {
+        uint32_t steps = 0;
+        while (i + 1 < count && times[i + 1] <= timeSec){
+            if (++steps > kMaxKeySteps){
+                i = searchKey(times, i + 1, count, timeSec);
+                break;
+            }
+            ++i;
+        }
+    }
+    cursor = i;
+    return i;
+}
+
+// Whether key i blends towards the next one at timeSec; before the first
+// key and from the last key on, it holds.
+bool blends(const float* times, uint32_t count, uint32_t i, float timeSec){
+    return i + 1 < count && timeSec >= times[i];
+}
+
+// Key before timeSec and the blend towards the next one.
+uint32_t findKey(const float* times, uint32_t count, float timeSec, uint32_t& cursor, float& lambda){
+    const uint32_t i = stepKey(times, count, timeSec, cursor);
+    lambda = 0.f;
+    if (!blends(times, count, i, timeSec)) return i;
+    const float denom = times[i + 1] - times[i];
+    lambda = denom > 0.f ? (timeSec - times[i]) / denom : 0.f;
+    return i;
+}
+
+// Tracks are gathered this many at a time: a whole number of AVX vectors
+// that stays on the stack.
+constexpr uint32_t kChunk = 16;
+
+// Key pairs of up to kChunk tracks as SoA, with the times they sit at; the
+// result is written back over `a`. A key that holds is paired with itself
+// over an empty span. Components past the track's own (w for positions)
+// are unused.
+struct KeyLanes {
+    alignas(32) float a[4][kChunk];
+    alignas(32) float b[4][kChunk];
+    alignas(32) float t0[kChunk];
+    alignas(32) float t1[kChunk];
+    uint32_t bone[kChunk];
+    uint32_t count = 0;
+
+    // Fills the rest of the last vector with identity keys.
+    void pad(uint32_t width){
+        const uint32_t end = (count + width - 1) / width * width;
+        for (uint32_t n = count; n < end; ++n){
+            for (int c = 0; c < 4; ++c) a[c][n] = b[c][n] = c == 3 ? 1.f : 0.f;
+            t0[n] = t1[n] = 0.f;
+        }
+    }
+};
+
+// The same blend as findKey: zero over an empty span.
+template<class Ops>
+typename Ops::V laneBlend(const KeyLanes& l, uint32_t base, typename Ops::V timeSec){
+    using V = typename Ops::V;
+    const V zero = Ops::set1(0.f);
+    const V t0 = Ops::load(l.t0 + base);
+    const V span = Ops::sub(Ops::load(l.t1 + base), t0);
+    const V valid = Ops::lt(zero, span);
+    const V lambda = Ops::div(Ops::sub(timeSec, t0), Ops::select(Ops::set1(1.f), span, valid));
+    return Ops::and_(lambda, valid);
+}
+
+template<class Ops>
+void lerpLanes(KeyLanes& l, float timeSec){
+    using V = typename Ops::V;
+    const V time = Ops::set1(timeSec);
+    for (uint32_t base = 0; base < l.count; base += Ops::kWidth){
+        const V t = laneBlend<Ops>(l, base, time);
+        for (int c = 0; c < 3; ++c){
+            const V a = Ops::load(l.a[c] + base);
+            Ops::store(l.a[c] + base, Ops::add(a, Ops::mul(t, Ops::sub(Ops::load(l.b[c] + base), a))));
+        }
+    }
+}
+
+template<class Ops>
+void nlerpLanes(KeyLanes& l, float timeSec){
+    using V = typename Ops::V;
+    const V zero = Ops::set1(0.f), time = Ops::set1(timeSec);
+    for (uint32_t base = 0; base < l.count; base += Ops::kWidth){
+        const V t = laneBlend<Ops>(l, base, time);
+        V a[4], b[4];
+        for (int c = 0; c < 4; ++c){
+            a[c] = Ops::load(l.a[c] + base);
+            b[c] = Ops::load(l.b[c] + base);
+        }
+
+        const V dot = Ops::add(Ops::add(Ops::mul(a[0], b[0]), Ops::mul(a[1], b[1])),
+                               Ops::add(Ops::mul(a[2], b[2]), Ops::mul(a[3], b[3])));
+        const V flip = Ops::lt(dot, zero);
+
+        V r[4];
+        for (int c = 0; c < 4; ++c){
+            const V bc = Ops::select(b[c], Ops::sub(zero, b[c]), flip);
+            r[c] = Ops::add(a[c], Ops::mul(t, Ops::sub(bc, a[c])));
+        }
+
+        const V len = Ops::sqrt(Ops::add(Ops::add(Ops::mul(r[0], r[0]), Ops::mul(r[1], r[1])),
+                                         Ops::add(Ops::mul(r[2], r[2]), Ops::mul(r[3], r[3]))));
+        for (int c = 0; c < 4; ++c)
+            Ops::store(l.a[c] + base, Ops::div(r[c], len));
+    }
+}
+
+using Track = ResourceAnimation::Track;
+using TrackRange = ResourceAnimation::TrackRange;
+
+// Key readers for float and packed clips. The sampler is instantiated for
+// each, so the layout is chosen once per clip rather than per key. The
+// gathers fill lane n with keys i and j of a track.
+struct FloatKeys {
+    const Vector3* vectors[ResourceAnimation::TrackCount];
+    const Quaternion* rotations;
+
+    explicit FloatKeys(const ResourceAnimation& clip)
+        : vectors{ clip.getVectors(Track::Translation), nullptr, clip.getVectors(Track::Scale) },
+          rotations(clip.getRotations()){}
+    Vector3 vector(Track t, const TrackRange& track, uint32_t i) const { return vectors[t][track.first + i]; }
+    Quaternion rotation(const TrackRange& track, uint32_t i) const { return rotations[track.first + i]; }
+
+    void gatherVector(KeyLanes& l, uint32_t n, Track t, const TrackRange& track, uint32_t i, uint32_t j) const {
+        const Vector3* keys = vectors[t] + track.first;
+        l.a[0][n] = keys[i].x; l.a[1][n] = keys[i].y; l.a[2][n] = keys[i].z;
+        l.b[0][n] = keys[j].x; l.b[1][n] = keys[j].y; l.b[2][n] = keys[j].z;
+    }
+
+    void gatherRotation(KeyLanes& l, uint32_t n, const TrackRange& track, uint32_t i, uint32_t j) const {
+        const Quaternion* keys = rotations + track.first;
+        l.a[0][n] = keys[i].x; l.a[1][n] = keys[i].y; l.a[2][n] = keys[i].z; l.a[3][n] = keys[i].w;
+        l.b[0][n] = keys[j].x; l.b[1][n] = keys[j].y; l.b[2][n] = keys[j].z; l.b[3][n] = keys[j].w;
+    }
+
+    template<class Ops> static void decodeRotations(KeyLanes&){}
+};
+
+// Rotations are gathered as their three smallest components plus the
+// largest one's index, and the lanes rebuild the largest together.
+struct PackedKeys {
+    const uint16_t* keys[ResourceAnimation::TrackCount];
+
+    explicit PackedKeys(const ResourceAnimation& clip)
+        : keys{ clip.getPackedKeys(Track::Translation), clip.getPackedKeys(Track::Rotation), clip.getPackedKeys(Track::Scale) }{}
+    Vector3 vector(Track t, const TrackRange& track, uint32_t i) const {
+        return AnimationCompression::unpackVector(keys[t] + (size_t)(track.first + i) * 3, track.origin, track.step);
+    }
+    Quaternion rotation(const TrackRange& track, uint32_t i) const {
+        return AnimationCompression::unpackRotation(keys[Track::Rotation] + (size_t)(track.first + i) * 3);
+    }
+
+    void gatherVector(KeyLanes& l, uint32_t n, Track t, const TrackRange& track, uint32_t i, uint32_t j) const {
+        const Vector3 k0 = vector(t, track, i);
+        const Vector3 k1 = vector(t, track, j);
+        l.a[0][n] = k0.x; l.a[1][n] = k0.y; l.a[2][n] = k0.z;
+        l.b[0][n] = k1.x; l.b[1][n] = k1.y; l.b[2][n] = k1.z;
+    }
+
+    void gatherRotation(KeyLanes& l, uint32_t n, const TrackRange& track, uint32_t i, uint32_t j) const {
+        const uint16_t* rot = keys[Track::Rotation] + (size_t)track.first * 3;
+        l.a[3][n] = (float)AnimationCompression::unpackSmallestThree(rot + (size_t)i * 3, l.a[0][n], l.a[1][n], l.a[2][n]);
+        l.b[3][n] = (float)AnimationCompression::unpackSmallestThree(rot + (size_t)j * 3, l.b[0][n], l.b[1][n], l.b[2][n]);
+    }
+
+    template<class Ops>
+    static void rebuildLargest(float (*q)[kChunk], uint32_t base){
+        using V = typename Ops::V;
+        const V a = Ops::load(q[0] + base), b = Ops::load(q[1] + base), c = Ops::load(q[2] + base);
+        const V largest = Ops::load(q[3] + base);
+        const V d = Ops::sqrt(Ops::max_(Ops::set1(0.f),
+            Ops::sub(Ops::set1(1.f), Ops::add(Ops::add(Ops::mul(a, a), Ops::mul(b, b)), Ops::mul(c, c)))));
+        const V is0 = Ops::lt(largest, Ops::set1(0.5f));
+        const V upTo1 = Ops::lt(largest, Ops::set1(1.5f));
+        const V upTo2 = Ops::lt(largest, Ops::set1(2.5f));
+        Ops::store(q[0] + base, Ops::select(a, d, is0));
+        Ops::store(q[1] + base, Ops::select(Ops::select(b, d, upTo1), a, is0));
+        Ops::store(q[2] + base, Ops::select(Ops::select(c, d, upTo2), b, upTo1));
+        Ops::store(q[3] + base, Ops::select(d, c, upTo2));
+    }
+
+    template<class Ops>
+    static void decodeRotations(KeyLanes& l){
+        for (uint32_t base = 0; base < l.count; base += Ops::kWidth){
+            rebuildLargest<Ops>(l.a, base);
+            rebuildLargest<Ops>(l.b, base);
+        }
+    }
+};
+
+// Translation or scale lanes, written to that part of each bone's pose.
+template<class Ops>
+void flushVectors(KeyLanes& l, float timeSec, BonePose* pose, Vector3 BonePose::* field){
+    if (l.count == 0) return;
+    l.pad(Ops::kWidth);
+    lerpLanes<Ops>(l, timeSec);
+    for (uint32_t n = 0; n < l.count; ++n)
+        pose[l.bone[n]].*field = Vector3(l.a[0][n], l.a[1][n], l.a[2][n]);
+    l.count = 0;
+}
+
+// Packed pad lanes read as index 1 over zeros, which still decodes to a
+// unit quaternion.
+template<class Ops, class Keys>
+void flushRotations(KeyLanes& l, float timeSec, BonePose* pose){
+    if (l.count == 0) return;
+    l.pad(Ops::kWidth);
+    Keys::template decodeRotations<Ops>(l);
+    nlerpLanes<Ops>(l, timeSec);
+    for (uint32_t n = 0; n < l.count; ++n)
+        pose[l.bone[n]].rotation = Quaternion(l.a[0][n], l.a[1][n], l.a[2][n], l.a[3][n]);
+    l.count = 0;
+}
+
+// `cursors` holds one key cursor per track.
+template<class Keys>
+void sampleKeys(const ResourceAnimation& clip, const Keys& keys, uint32_t channel, float timeSec,
+                uint32_t* cursors, BonePose& pose){
+    const ResourceAnimation::Channel& ch = clip.getChannels()[channel];
+
+    for (Track t : { Track::Translation, Track::Scale }){
+        const TrackRange& track = ch.tracks[t];
+        if (track.count == 0) continue;
+        float lambda;
+        const uint32_t i = findKey(clip.getTimes(t) + track.first, track.count, timeSec, cursors[t], lambda);
+        Vector3& out = t == Track::Scale ? pose.scale : pose.position;
+        out = lambda > 0.f ? Vector3::Lerp(keys.vector(t, track, i), keys.vector(t, track, i + 1), lambda)
+                           : keys.vector(t, track, i);
+    }
+
+    const TrackRange& track = ch.tracks[Track::Rotation];
+    if (track.count > 0){
+        float lambda;
+        const uint32_t i = findKey(clip.getTimes(Track::Rotation) + track.first, track.count, timeSec,
+                                   cursors[Track::Rotation], lambda);
+        pose.rotation = lambda > 0.f ? Quaternion::Lerp(keys.rotation(track, i), keys.rotation(track, i + 1), lambda)
+                                     : keys.rotation(track, i);
+    }
+}
+
+}
+
+void AnimationBinding::bind(const ResourceAnimation* clip, const std::vector<std::string>& boneNames){
+    m_clip = clip;
+    m_channelOfBone.assign(boneNames.size(), -1);
+    m_cursors.assign(boneNames.size() * ResourceAnimation::TrackCount, 0);
+    if (!clip) return;
+    for (size_t b = 0; b < boneNames.size(); ++b)
+        m_channelOfBone[b] = clip->findChannel(boneNames[b]);
+}
+
+void AnimationBinding::reset(){
+    m_clip = nullptr;
+    m_channelOfBone.clear();
+    m_cursors.clear();
+}
+
+void AnimationBinding::sampleChannel(const ResourceAnimation& clip, uint32_t channel, float timeSec, BonePose& pose){
+    uint32_t cursors[ResourceAnimation::TrackCount] = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+    if (clip.isPacked()) sampleKeys(clip, PackedKeys(clip), channel, timeSec, cursors, pose);
+    else sampleKeys(clip, FloatKeys(clip), channel, timeSec, cursors, pose);
+}
+
+AnimationBinding::Path AnimationBinding::bestPath(){
+    static const Path best = CpuHasAVX2() ? Path::AVX2 : Path::SSE;
+    return best;
+}
+
+const char* AnimationBinding::pathName(Path path){
+    switch (path){
+        case Path::AVX2: return "AVX2 x8";
+        case Path::SSE: return "SSE x4";
+        default: return "Scalar";
+    }
+}
+
+void AnimationBinding::setPath(Path path){
+    if (path == Path::AVX2 && bestPath() != Path::AVX2) path = Path::SSE;
+    m_path = path;
+}
+
+void AnimationBinding::sample(float timeSec, BonePose* pose){
+    if (!m_clip) return;
+    if (m_clip->isPacked()) sampleWith(PackedKeys(*m_clip), timeSec, pose);
+    else sampleWith(FloatKeys(*m_clip), timeSec, pose);
+}
+
+template<class Keys>
+void AnimationBinding::sampleWith(const Keys& keys, float timeSec, BonePose* pose){
+    switch (m_path){
+        case Path::AVX2: sampleLanes<AvxOps>(keys, timeSec, pose); break;
+        case Path::SSE: sampleLanes<SseOps>(keys, timeSec, pose); break;
+        default: sampleScalar(keys, timeSec, pose); break;
+    }
+}
+
+template<class Keys>
+void AnimationBinding::sampleScalar(const Keys& keys, float timeSec, BonePose* pose){
+    const uint32_t boneCount = (uint32_t)m_channelOfBone.size();
+    for (uint32_t b = 0; b < boneCount; ++b){
+        const int32_t channel = m_channelOfBone[b];
+        if (channel >= 0)
+            sampleKeys(*m_clip, keys, (uint32_t)channel, timeSec,
+                       m_cursors.data() + (size_t)b * ResourceAnimation::TrackCount, pose[b]);
+    }
+}
+
+// Keys are found per track as on the scalar path; a key with no blend is
+// paired with itself so every lane runs the same arithmetic. Each track
+// kind fills its own lanes.
+template<class Ops, class Keys>
+void AnimationBinding::sampleLanes(const Keys& keys, float timeSec, BonePose* pose){
+    const ResourceAnimation::Channel* channels = m_clip->getChannels().data();
+    const uint32_t boneCount = (uint32_t)m_channelOfBone.size();
+    KeyLanes lanes[ResourceAnimation::TrackCount];
+    Vector3 BonePose::* const vectorOf[ResourceAnimation::TrackCount] = { &BonePose::position, nullptr, &BonePose::scale };
+
+    const float* times[ResourceAnimation::TrackCount];
+    for (uint32_t t = 0; t < ResourceAnimation::TrackCount; ++t) times[t] = m_clip->getTimes((Track)t);
+
+    for (uint32_t b = 0; b < boneCount; ++b){
+        const int32_t channel = m_channelOfBone[b];
+        if (channel < 0) continue;
+        const ResourceAnimation::Channel& ch = channels[channel];
+        uint32_t* cursors = m_cursors.data() + (size_t)b * ResourceAnimation::TrackCount;
+
+        for (uint32_t t = 0; t < ResourceAnimation::TrackCount; ++t){
+            const TrackRange& track = ch.tracks[t];
+            if (track.count == 0) continue;
+            const float* trackTimes = times[t] + track.first;
+            const uint32_t i = stepKey(trackTimes, track.count, timeSec, cursors[t]);
+            const uint32_t j = blends(trackTimes, track.count, i, timeSec) ? i + 1 : i;
+
+            KeyLanes& l = lanes[t];
+            const uint32_t n = l.count++;
+            if (t == Track::Rotation) keys.gatherRotation(l, n, track, i, j);
+            else keys.gatherVector(l, n, (Track)t, track, i, j);
+            l.t0[n] = trackTimes[i];
+            l.t1[n] = trackTimes[j];
+            l.bone[n] = b;
+            if (l.count < kChunk) continue;
+            if (t == Track::Rotation) flushRotations<Ops, Keys>(l, timeSec, pose);
+            else flushVectors<Ops>(l, timeSec, pose, vectorOf[t]);
+        }
+    }
+    flushVectors<Ops>(lanes[Track::Translation], timeSec, pose, &BonePose::position);
+    flushRotations<Ops, Keys>(lanes[Track::Rotation], timeSec, pose);
+    flushVectors<Ops>(lanes[Track::Scale], timeSec, pose, &BonePose::scale);
+
+    Ops::end();
+}
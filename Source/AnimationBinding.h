@@ -0,0 +1,63 @@
+#pragma once
+#include "Globals.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class ResourceAnimation;
+
+// A bone's local TRS, in the order ResourceAnimation stores its tracks.
+struct BonePose {
+    Vector3 position;
+    Quaternion rotation;
+    Vector3 scale = Vector3::One;
+};
+
+// A clip's channels resolved to a skeleton's bones by name, once. Sampling
+// is then a linear pass over the bones that indexes the clip's flat key
+// arrays directly, with no string hashing. Each bone keeps a cursor on the
+// keys it used last, so forward playback steps to the next key instead of
+// searching; a loop, a seek or time going backward falls back to a binary
+// search. The SIMD paths gather each chunk of bones' key pairs into SoA
+// lanes and blend them 4 or 8 at a time: translations and scales by lerp,
+// rotations by normalized lerp with a shortest-path sign fix, as
+// Quaternion::Lerp does. Packed translations and scales are decoded as they
+// are gathered; packed rotations are gathered as smallest-three and rebuilt
+// in the lanes.
+class AnimationBinding {
+public:
+    enum class Path { Scalar, SSE, AVX2 };
+
+    static Path bestPath();
+    static const char* pathName(Path path);
+    void setPath(Path path);
+    Path getPath() const { return m_path; }
+
+    // `boneNames` is the skeleton in bone-index order.
+    void bind(const ResourceAnimation* clip, const std::vector<std::string>& boneNames);
+    void reset();
+
+    const ResourceAnimation* getClip() const { return m_clip; }
+    bool isBound() const { return m_clip != nullptr; }
+    uint32_t getBoneCount() const { return (uint32_t)m_channelOfBone.size(); }
+    bool animates(uint32_t bone) const { return m_channelOfBone[bone] >= 0; }
+    int32_t channelOf(uint32_t bone) const { return m_channelOfBone[bone]; }
+
+    // Writes the pose at timeSec into `pose`, one entry per bone. Bones the
+    // clip does not animate, and tracks with no keys, are left as they are.
+    void sample(float timeSec, BonePose* pose);
+
+    // One channel by binary search, without cursors. Tracks with no keys
+    // leave their part of `pose` as it is.
+    static void sampleChannel(const ResourceAnimation& clip, uint32_t channel, float timeSec, BonePose& pose);
+
+private:
+    template<class Keys> void sampleWith(const Keys& keys, float timeSec, BonePose* pose);
+    template<class Keys> void sampleScalar(const Keys& keys, float timeSec, BonePose* pose);
+    template<class Ops, class Keys> void sampleLanes(const Keys& keys, float timeSec, BonePose* pose);
+
+    Path m_path = bestPath();
+    const ResourceAnimation* m_clip = nullptr;
+    std::vector<int32_t> m_channelOfBone;
+    std::vector<uint32_t> m_cursors;     // one per track, per bone
+};
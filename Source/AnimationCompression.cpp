@@ -0,0 +1,175 @@
+#include "Globals.h"
+#include "AnimationCompression.h"
+
+namespace AnimationCompression {
+
+namespace {
+
+// Longest run of keys one span may replace; bounds the reduction to
+// O(keys * kMaxSpan) on long clips.
+constexpr uint32_t kMaxSpan = 64;
+
+constexpr float kRotScale = 1.41421356f / 32767.f;
+constexpr float kRotBias = -0.70710678f;
+
+float spanLambda(const float* times, uint32_t a, uint32_t b, uint32_t k){
+    const float span = times[b] - times[a];
+    return span > 0.f ? (times[k] - times[a]) / span : 0.f;
+}
+
+// Indices of the keys to keep. `fits(a, b, k, lambda)` says whether blending
+// kept keys a and b by lambda rebuilds key k; a == b asks whether key a
+// alone holds it. A track that key 0 holds throughout keeps only key 0.
+template<class Fits>
+std::vector<uint32_t> reduceKeys(const float* times, uint32_t count, Fits fits){
+    std::vector<uint32_t> kept;
+    if (count == 0) return kept;
+    kept.push_back(0);
+
+    bool constant = true;
+    for (uint32_t k = 1; k < count && constant; ++k) constant = fits(0, 0, k, 0.f);
+    if (constant) return kept;
+
+    uint32_t anchor = 0;
+    for (uint32_t end = 2; end < count; ++end){
+        bool ok = end - anchor <= kMaxSpan;
+        for (uint32_t k = anchor + 1; k < end && ok; ++k)
+            ok = fits(anchor, end, k, spanLambda(times, anchor, end, k));
+        if (!ok){
+            anchor = end - 1;
+            kept.push_back(anchor);
+        }
+    }
+    kept.push_back(count - 1);
+    return kept;
+}
+
+uint16_t quantize(float v, float origin, float step){
+    if (step <= 0.f) return 0;
+    return (uint16_t)std::min(65535.f, std::max(0.f, std::round((v - origin) / step)));
+}
+
+// Same blend as the sampler: normalized lerp along the shorter arc.
+Quaternion nlerp(const Quaternion& a, Quaternion b, float t){
+    if (a.Dot(b) < 0.f) b = Quaternion(-b.x, -b.y, -b.z, -b.w);
+    Quaternion r(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y), a.z + t * (b.z - a.z), a.w + t * (b.w - a.w));
+    r.Normalize();
+    return r;
+}
+
+// In double, from the vector part of conj(a) * b, so tolerances of a
+// hundredth of a degree are still resolved.
+double angleBetween(const Quaternion& a, const Quaternion& b){
+    const double x = (double)a.w * b.x - (double)a.x * b.w - (double)a.y * b.z + (double)a.z * b.y;
+    const double y = (double)a.w * b.y + (double)a.x * b.z - (double)a.y * b.w - (double)a.z * b.x;
+    const double z = (double)a.w * b.z - (double)a.x * b.y + (double)a.y * b.x - (double)a.z * b.w;
+    const double w = (double)a.w * b.w + (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z;
+    return 2.0 * std::atan2(std::sqrt(x * x + y * y + z * z), std::fabs(w));
+}
+
+// The 16-bit keys span the track's range, so a step is the finest the range
+// allows; the track is within tolerance when every kept key's quantization
+// error is.
+PackedVectors compressVectors(const float* times, const Vector3* values, uint32_t count, float tolerance){
+    PackedVectors out;
+    if (count == 0) return out;
+
+    Vector3 mn = values[0], mx = values[0];
+    for (uint32_t k = 1; k < count; ++k){
+        mn = Vector3::Min(mn, values[k]);
+        mx = Vector3::Max(mx, values[k]);
+    }
+    out.origin = mn;
+    out.step = (mx - mn) / 65535.f;
+
+    std::vector<uint16_t> quantized(count * 3);
+    std::vector<Vector3> decoded(count);
+    for (uint32_t k = 0; k < count; ++k){
+        uint16_t* q = quantized.data() + k * 3;
+        q[0] = quantize(values[k].x, mn.x, out.step.x);
+        q[1] = quantize(values[k].y, mn.y, out.step.y);
+        q[2] = quantize(values[k].z, mn.z, out.step.z);
+        decoded[k] = unpackVector(q, out.origin, out.step);
+    }
+
+    const std::vector<uint32_t> kept = reduceKeys(times, count,
+        [&](uint32_t a, uint32_t b, uint32_t k, float lambda){
+            const Vector3 p = decoded[a] + (decoded[b] - decoded[a]) * lambda;
+            return (p - values[k]).Length() <= tolerance;
+        });
+
+    out.times.reserve(kept.size());
+    out.keys.reserve(kept.size() * 3);
+    for (uint32_t k : kept){
+        if ((decoded[k] - values[k]).Length() > tolerance) out.withinTolerance = false;
+        out.times.push_back(times[k]);
+        out.keys.insert(out.keys.end(), quantized.begin() + k * 3, quantized.begin() + k * 3 + 3);
+    }
+    return out;
+}
+
+}
+
+void packRotation(const Quaternion& q, uint16_t out[3]){
+    Quaternion n = q;
+    n.Normalize();
+    float c[4] = { n.x, n.y, n.z, n.w };
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i)
+        if (std::fabs(c[i]) > std::fabs(c[largest])) largest = i;
+    if (c[largest] < 0.f)
+        for (float& v : c) v = -v;
+
+    uint16_t rest[3];
+    for (uint32_t i = 0, j = 0; i < 4; ++i){
+        if (i == largest) continue;
+        const float v = std::min(std::max(c[i], kRotBias), -kRotBias);
+        rest[j++] = (uint16_t)std::min(32767.f, std::round((v - kRotBias) / kRotScale));
+    }
+    out[0] = rest[0] | (uint16_t)((largest >> 1) << 15);
+    out[1] = rest[1] | (uint16_t)((largest & 1) << 15);
+    out[2] = rest[2];
+}
+
+PackedVectors compressPositions(const float* times, const Vector3* values, uint32_t count,
+                                const Tolerance& tolerance){
+    return compressVectors(times, values, count, tolerance.position);
+}
+
+PackedVectors compressScales(const float* times, const Vector3* values, uint32_t count,
+                             const Tolerance& tolerance){
+    return compressVectors(times, values, count, tolerance.scale);
+}
+
+PackedRotations compressRotations(const float* times, const Quaternion* values, uint32_t count,
+                                  const Tolerance& tolerance){
+    PackedRotations out;
+    if (count == 0) return out;
+
+    std::vector<uint16_t> quantized(count * 3);
+    std::vector<Quaternion> decoded(count);
+    for (uint32_t k = 0; k < count; ++k){
+        packRotation(values[k], quantized.data() + k * 3);
+        decoded[k] = unpackRotation(quantized.data() + k * 3);
+    }
+
+    const double allowed = tolerance.angleDeg * XM_PI / 180.0;
+    std::vector<Quaternion> original(values, values + count);
+    for (Quaternion& q : original) q.Normalize();
+    const std::vector<uint32_t> kept = reduceKeys(times, count,
+        [&](uint32_t a, uint32_t b, uint32_t k, float lambda){
+            return angleBetween(nlerp(decoded[a], decoded[b], lambda), original[k]) <= allowed;
+        });
+
+    out.times.reserve(kept.size());
+    out.keys.reserve(kept.size() * 3);
+    for (uint32_t k : kept){
+        if (angleBetween(decoded[k], original[k]) > allowed) out.withinTolerance = false;
+        out.times.push_back(times[k]);
+        out.keys.insert(out.keys.end(), quantized.begin() + k * 3, quantized.begin() + k * 3 + 3);
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Globals.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Importer-side compression of transform tracks, and the decoders the
+// sampler runs per key. Keys are quantized first: translations and scales
+// to 16-bit offsets into the track's own range, rotations to 48-bit
+// smallest-three.
+// Then every key that linear interpolation between the quantized keys kept
+// around it rebuilds within tolerance is dropped. Times stay float so
+// cursors compare them directly. A track whose range is too wide for its
+// quantization alone to stay within tolerance is flagged, and the importer
+// keeps that clip's keys as float.
+namespace AnimationCompression {
+
+    struct Tolerance {
+        float position = 1e-3f;
+        float angleDeg = 0.1f;
+        float scale = 1e-3f;
+    };
+
+    // Translation or scale keys.
+    struct PackedVectors {
+        std::vector<float> times;
+        Vector3 origin;
+        Vector3 step;
+        std::vector<uint16_t> keys;
+        // False when a kept key's quantization error exceeds the tolerance.
+        bool withinTolerance = true;
+    };
+
+    struct PackedRotations {
+        std::vector<float> times;
+        std::vector<uint16_t> keys;
+        bool withinTolerance = true;
+    };
+
+    PackedVectors compressPositions(const float* times, const Vector3* values, uint32_t count,
+                                    const Tolerance& tolerance = Tolerance());
+    PackedVectors compressScales(const float* times, const Vector3* values, uint32_t count,
+                                 const Tolerance& tolerance = Tolerance());
+    PackedRotations compressRotations(const float* times, const Quaternion* values, uint32_t count,
+                                      const Tolerance& tolerance = Tolerance());
+
+    void packRotation(const Quaternion& q, uint16_t out[3]);
+
+    // Each value is origin + key * step, per axis.
+    inline Vector3 unpackVector(const uint16_t* key, const Vector3& origin, const Vector3& step){
+        return Vector3(origin.x + key[0] * step.x, origin.y + key[1] * step.y, origin.z + key[2] * step.z);
+    }
+
+    // The low 15 bits of each word are one of the three smallest components,
+    // in order; the top bits of the first two words index the largest one,
+    // which is rebuilt as positive.
+    inline uint32_t unpackSmallestThree(const uint16_t* key, float& a, float& b, float& c){
+        constexpr float kScale = 1.41421356f / 32767.f;
+        constexpr float kBias = -0.70710678f;
+        a = (key[0] & 0x7FFF) * kScale + kBias;
+        b = (key[1] & 0x7FFF) * kScale + kBias;
+        c = (key[2] & 0x7FFF) * kScale + kBias;
+        return ((key[0] >> 15) << 1) | (key[1] >> 15);
+    }
+
+    inline Quaternion unpackRotation(const uint16_t* key){
+        float a, b, c;
+        const uint32_t largest = unpackSmallestThree(key, a, b, c);
+        const float d = std::sqrt(std::max(0.f, 1.f - a * a - b * b - c * c));
+        return Quaternion(largest == 0 ? d : a,
+                          largest == 0 ? a : (largest == 1 ? d : b),
+                          largest <= 1 ? b : (largest == 2 ? d : c),
+                          largest == 3 ? d : c);
+    }
+}
@@ -17,6 +17,7 @@ void AnimationController::Play(UID uid, bool loop){
     if (m_animation && Resource != uid){
         app->getResources()->ReleaseResource(m_animation);
         m_animation = nullptr;
+        m_binding.reset();
     }
 
     Resource = uid;
@@ -67,58 +68,6 @@ void AnimationController::Update(float deltaTime){
     }
 }
 
-bool AnimationController::GetTransform(const char* name, Vector3& pos, Quaternion& rot) const{
-    if (!m_animation) return false;
-
-    const auto& channels = m_animation->getChannels();
-    const auto it = channels.find(name);
-    if (it == channels.end()) return false;
-
-    const ResourceAnimation::Channel& ch = it->second;
-
-    if (ch.posCount > 0){
-        const float* tFirst = ch.posTimeStamps.get();
-        const float* tLast = tFirst + ch.posCount;
-
-        const float* upper = std::upper_bound(tFirst, tLast, CurrentTime);
-
-        if (upper == tFirst){
-            pos = ch.positions[0];
-        } else if (upper == tLast){
-            pos = ch.positions[ch.posCount - 1];
-        } else {
-            int i = (int)(upper - tFirst) - 1;
-            float t0 = tFirst[i];
-            float t1 = tFirst[i + 1];
-            float denom = t1 - t0;
-            float lambda = denom > 0.f ? (CurrentTime - t0) / denom : 0.f;
-            pos = Vector3::Lerp(ch.positions[i], ch.positions[i + 1], lambda);
-        }
-    }
-
-    if (ch.rotCount > 0){
-        const float* tFirst = ch.rotTimeStamps.get();
-        const float* tLast = tFirst + ch.rotCount;
-
-        const float* upper = std::upper_bound(tFirst, tLast, CurrentTime);
-
-        if (upper == tFirst){
-            rot = ch.rotations[0];
-        } else if (upper == tLast){
-            rot = ch.rotations[ch.rotCount - 1];
-        } else {
-            int i = (int)(upper - tFirst) - 1;
-            float t0 = tFirst[i];
-            float t1 = tFirst[i + 1];
-            float denom = t1 - t0;
-            float lambda = denom > 0.f ? (CurrentTime - t0) / denom : 0.f;
-            rot = Quaternion::Lerp(ch.rotations[i], ch.rotations[i + 1], lambda);
-        }
-    }
-
-    return true;
-}
-
 bool AnimationController::hasMorphChannel(const char* name) const{
     return m_animation && m_animation->getMorphChannel(name) != nullptr;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "ResourceCommon.h"
+#include "AnimationBinding.h"
 
 class ResourceAnimation;
 
@@ -16,7 +17,12 @@ public:
 
     void Update(float deltaTime);
 
-    bool GetTransform(const char* name, Vector3& pos, Quaternion& rot) const;
+    // Binds the playing clip to a skeleton so SamplePose needs no name
+    // lookups. Play() drops the binding when it switches clips.
+    void Bind(const std::vector<std::string>& boneNames){ m_binding.bind(m_animation, boneNames); }
+    bool isBound() const { return m_binding.isBound(); }
+    const AnimationBinding& getBinding() const { return m_binding; }
+    void SamplePose(BonePose* pose){ m_binding.sample(CurrentTime, pose); }
 
     bool GetMorphWeights(const char* name, float* outWeights, uint32_t numTargets) const;
 
@@ -30,5 +36,6 @@ public:
 
 private:
     ResourceAnimation* m_animation = nullptr;
+    AnimationBinding m_binding;
     bool m_playing = false;
 };
@@ -1,6 +1,7 @@
 #include "Globals.h"
 #include "AnimationImporter.h"
 #include "ImporterUtils.h"
+#include "AnimationCompression.h"
 #include "Application.h"
 #include "ModuleFileSystem.h"
 #include "gltf_utils.h"
@@ -13,20 +14,26 @@ namespace {
 
 struct AnimFileHeader {
     uint32_t magic = 0x414E494D;
-    uint32_t version = 2;
+    uint32_t version = 4;
     uint32_t animNameLen = 0;
     uint32_t channelCount = 0;
     float duration = 0.f;
 };
 
+template<class T>
+struct TrackKeys {
+    std::unique_ptr<float[]> times;
+    std::unique_ptr<T[]> values;
+    UINT count = 0;
+};
+
 struct NodeAnim {
     std::string name;
-    std::unique_ptr<float[]> posTimes;
-    std::unique_ptr<Vector3[]> positions;
-    UINT posCount = 0;
-    std::unique_ptr<float[]> rotTimes;
-    std::unique_ptr<Quaternion[]> rotations;
-    UINT rotCount = 0;
+    TrackKeys<Vector3> translation;
+    TrackKeys<Quaternion> rotation;
+    TrackKeys<Vector3> scale;
+
+    bool empty() const { return translation.count == 0 && rotation.count == 0 && scale.count == 0; }
 };
 
 struct NodeMorph {
@@ -58,36 +65,27 @@ static bool importOne(const tinygltf::Model& gltfModel, int animIdx,
         const auto& sampler = anim.samplers[chan.sampler];
         if (sampler.input < 0 || sampler.output < 0) continue;
 
-        if (chan.target_path == "translation" || chan.target_path == "rotation"){
+        if (chan.target_path == "translation" || chan.target_path == "rotation" || chan.target_path == "scale"){
             NodeAnim& na = nodeMap[chan.target_node];
             if (na.name.empty()) na.name = getNodeName(chan.target_node);
 
-            if (chan.target_path == "translation"){
+            auto loadTrack = [&](auto& track){
                 UINT timeCnt = 0, valCnt = 0;
                 std::unique_ptr<float[]> times;
-                std::unique_ptr<Vector3[]> values;
+                decltype(track.values) values;
 
-                if (!loadAccessorTyped(times, timeCnt, gltfModel, sampler.input)) continue;
-                if (!loadAccessorTyped(values, valCnt, gltfModel, sampler.output)) continue;
+                if (!loadAccessorTyped(times, timeCnt, gltfModel, sampler.input)) return;
+                if (!loadAccessorTyped(values, valCnt, gltfModel, sampler.output)) return;
 
                 for (UINT i = 0; i < timeCnt; ++i) duration = std::max(duration, times[i]);
-                na.posTimes = std::move(times);
-                na.positions = std::move(values);
-                na.posCount = timeCnt;
+                track.times = std::move(times);
+                track.values = std::move(values);
+                track.count = timeCnt;
+            };
 
-            } else {
-                UINT timeCnt = 0, valCnt = 0;
-                std::unique_ptr<float[]> times;
-                std::unique_ptr<Quaternion[]> values;
-
-                if (!loadAccessorTyped(times, timeCnt, gltfModel, sampler.input)) continue;
-                if (!loadAccessorTyped(values, valCnt, gltfModel, sampler.output)) continue;
-
-                for (UINT i = 0; i < timeCnt; ++i) duration = std::max(duration, times[i]);
-                na.rotTimes = std::move(times);
-                na.rotations = std::move(values);
-                na.rotCount = timeCnt;
-            }
+            if (chan.target_path == "translation") loadTrack(na.translation);
+            else if (chan.target_path == "rotation") loadTrack(na.rotation);
+            else loadTrack(na.scale);
 
         } else if (chan.target_path == "weights"){
             UINT timeCnt = 0, valCnt = 0;
@@ -169,7 +167,7 @@ static bool importOne(const tinygltf::Model& gltfModel, int animIdx,
 
     uint32_t validCount = 0;
     for (const auto& [idx, na] : nodeMap)
-        if (na.posCount > 0 || na.rotCount > 0) ++validCount;
+        if (!na.empty()) ++validCount;
 
     uint32_t validMorphCount = 0;
     for (const auto& [idx, nm] : morphMap)
@@ -192,28 +190,93 @@ static bool importOne(const tinygltf::Model& gltfModel, int animIdx,
 
     append(animName.data(), animName.size());
 
+    struct PackedNode {
+        const NodeAnim* node;
+        AnimationCompression::PackedVectors pos;
+        AnimationCompression::PackedRotations rot;
+        AnimationCompression::PackedVectors scl;
+    };
+    std::vector<PackedNode> packed;
+    packed.reserve(validCount);
+    bool withinTolerance = true;
     for (const auto& [idx, na] : nodeMap){
-        if (na.posCount == 0 && na.rotCount == 0) continue;
+        if (na.empty()) continue;
+        PackedNode& pn = packed.emplace_back();
+        pn.node = &na;
+        pn.pos = AnimationCompression::compressPositions(
+            na.translation.times.get(), na.translation.values.get(), na.translation.count);
+        pn.rot = AnimationCompression::compressRotations(
+            na.rotation.times.get(), na.rotation.values.get(), na.rotation.count);
+        pn.scl = AnimationCompression::compressScales(
+            na.scale.times.get(), na.scale.values.get(), na.scale.count);
+        withinTolerance = withinTolerance && pn.pos.withinTolerance && pn.rot.withinTolerance && pn.scl.withinTolerance;
+    }
+
+    // A track too wide for 16-bit keys keeps the whole clip as float keys.
+    if (!withinTolerance){
+        header.version = 5;
+        LOG("AnimationImporter: anim[%d] '%s' — range too wide to pack within tolerance, keeping float keys",
+            animIdx, animName.c_str());
+    }
+
+    size_t rawBytes = 0, packedBytes = 0;
+    uint32_t rawKeys = 0, packedKeys = 0;
+
+    for (const PackedNode& pn : packed){
+        const NodeAnim& na = *pn.node;
+        const AnimationCompression::PackedVectors& pos = pn.pos;
+        const AnimationCompression::PackedRotations& rot = pn.rot;
+        const AnimationCompression::PackedVectors& scl = pn.scl;
 
         uint32_t nameLen = (uint32_t)na.name.size();
-        uint32_t posCount = na.posCount;
-        uint32_t rotCount = na.rotCount;
+        uint32_t counts[3] = { (uint32_t)pos.times.size(), (uint32_t)rot.times.size(), (uint32_t)scl.times.size() };
+        if (!withinTolerance){
+            counts[0] = na.translation.count;
+            counts[1] = na.rotation.count;
+            counts[2] = na.scale.count;
+        }
 
         append(&nameLen, sizeof(uint32_t));
-        append(&posCount, sizeof(uint32_t));
-        append(&rotCount, sizeof(uint32_t));
+        append(counts, sizeof(counts));
         append(na.name.data(), nameLen);
 
-        if (posCount > 0){
-            append(na.posTimes.get(), posCount * sizeof(float));
-            append(na.positions.get(), posCount * sizeof(Vector3));
-        }
-        if (rotCount > 0){
-            append(na.rotTimes.get(), rotCount * sizeof(float));
-            append(na.rotations.get(), rotCount * sizeof(Quaternion));
+        // Translation, rotation, scale; the vector tracks carry their range.
+        const size_t before = payload.size();
+        if (!withinTolerance){
+            auto appendFloat = [&](const auto& track){
+                if (track.count == 0) return;
+                append(track.times.get(), track.count * sizeof(float));
+                append(track.values.get(), track.count * sizeof(track.values[0]));
+            };
+            appendFloat(na.translation);
+            appendFloat(na.rotation);
+            appendFloat(na.scale);
+        } else {
+            auto appendVectors = [&](const AnimationCompression::PackedVectors& track){
+                if (track.times.empty()) return;
+                append(track.times.data(), track.times.size() * sizeof(float));
+                append(&track.origin, sizeof(Vector3));
+                append(&track.step, sizeof(Vector3));
+                append(track.keys.data(), track.keys.size() * sizeof(uint16_t));
+            };
+            appendVectors(pos);
+            if (!rot.times.empty()){
+                append(rot.times.data(), rot.times.size() * sizeof(float));
+                append(rot.keys.data(), rot.keys.size() * sizeof(uint16_t));
+            }
+            appendVectors(scl);
         }
+
+        packedBytes += payload.size() - before;
+        rawBytes += (na.translation.count + na.scale.count) * (sizeof(float) + sizeof(Vector3))
+                  + na.rotation.count * (sizeof(float) + sizeof(Quaternion));
+        rawKeys += na.translation.count + na.rotation.count + na.scale.count;
+        packedKeys += counts[0] + counts[1] + counts[2];
     }
 
+    LOG("AnimationImporter: anim[%d] '%s' — %u of %u keys kept, %zu -> %zu bytes",
+        animIdx, animName.c_str(), packedKeys, rawKeys, rawBytes, packedBytes);
+
     uint32_t morphChannelCount = validMorphCount;
     append(&morphChannelCount, sizeof(uint32_t));
     for (const auto& [idx, nm] : morphMap){
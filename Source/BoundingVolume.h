@@ -31,6 +31,24 @@ struct AABB {
         }
     }
 
+    // Slab test for origin + t * dir with t in [0, maxT]. invDir holds 1 / dir
+    // per axis (infinite where dir is zero); tEnter is 0 when origin is inside.
+    bool intersectsRay(const Vector3& origin, const Vector3& invDir, float maxT, float& tEnter) const{
+        float t0 = 0.f, t1 = maxT;
+        const float o[3] = { origin.x, origin.y, origin.z };
+        const float inv[3] = { invDir.x, invDir.y, invDir.z };
+        const float lo[3] = { min.x, min.y, min.z };
+        const float hi[3] = { max.x, max.y, max.z };
+        for (int i = 0; i < 3; ++i){
+            const float a = (lo[i] - o[i]) * inv[i];
+            const float b = (hi[i] - o[i]) * inv[i];
+            t0 = fmaxf(t0, fminf(a, b));
+            t1 = fminf(t1, fmaxf(a, b));
+        }
+        tEnter = t0;
+        return t0 <= t1;
+    }
+
     void updateFromPositionScale(const Vector3& position, const Vector3& scale){
         Vector3 half = scale * 0.5f;
         min = position - half;
@@ -38,7 +56,7 @@ struct AABB {
     }
 };
 
-enum class BVType { AABB, Sphere };
+enum class BVType { AABB, Sphere, Capsule };
 
 struct Sphere {
     Vector3 center;
@@ -1,15 +1,33 @@
 #include "Globals.h"
 #include "BruteForceBroadPhase.h"
+#include <algorithm>
 
 std::vector<CollisionPair> BruteForceBroadPhase::query(
     const std::vector<CollisionBody>& bodies){
     std::vector<CollisionPair> pairs;
     const uint32_t n = static_cast<uint32_t>(bodies.size());
-    for (uint32_t i = 0; i < n; ++i){
-        for (uint32_t j = i + 1; j < n; ++j){
-            if (bodies[i].worldAABB.intersects(bodies[j].worldAABB))
+
+    // Sleeping bodies are only tested against bodies that can move.
+    m_awake.clear();
+    m_sleeping.clear();
+    for (uint32_t i = 0; i < n; ++i)
+        (bodies[i].sleeping ? m_sleeping : m_awake).push_back(i);
+
+    const size_t awakeCount = m_awake.size();
+    for (size_t p = 0; p < awakeCount; ++p){
+        const uint32_t i = m_awake[p];
+        for (size_t q = p + 1; q < awakeCount; ++q){
+            const uint32_t j = m_awake[q];
+            if (layersCollide(bodies[i], bodies[j]) &&
+                bodies[i].worldAABB.intersects(bodies[j].worldAABB))
                 pairs.push_back({ i, j });
         }
+        if (bodies[i].resting) continue;
+        for (uint32_t j : m_sleeping){
+            if (layersCollide(bodies[i], bodies[j]) &&
+                bodies[i].worldAABB.intersects(bodies[j].worldAABB))
+                pairs.push_back({ std::min(i, j), std::max(i, j) });
+        }
     }
     return pairs;
 }
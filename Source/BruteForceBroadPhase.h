@@ -6,4 +6,8 @@ public:
     std::vector<CollisionPair> query(
         const std::vector<CollisionBody>& bodies) override;
     const char* getName() const override { return "Brute Force  O(N\xC2\xB2)"; }
+
+private:
+    std::vector<uint32_t> m_awake;
+    std::vector<uint32_t> m_sleeping;
 };
@@ -0,0 +1,311 @@
+#include "Globals.h"
+#include "CapsuleCollision.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+namespace CapsuleCollision {
+
+namespace {
+
+constexpr float kEps = 1e-6f;
+constexpr int kBisectIterations = 32;
+
+// A capsule whose axis is within this cosine of a box face normal's plane
+// rests on that face with both ends.
+constexpr float kFaceNormalCos = 0.98f;
+constexpr float kFlatSegmentCos = 0.1f;
+
+float projectBox(const CollisionBody& b, const Vector3& L){
+    return b.obbHalves[0] * fabsf(b.obbAxes[0].Dot(L)) +
+           b.obbHalves[1] * fabsf(b.obbAxes[1].Dot(L)) +
+           b.obbHalves[2] * fabsf(b.obbAxes[2].Dot(L));
+}
+
+Vector3 closestOnSegment(const Vector3& p0, const Vector3& p1, const Vector3& q){
+    const Vector3 d = p1 - p0;
+    const float len2 = d.LengthSquared();
+    if (len2 < kEps * kEps) return p0;
+    return p0 + d * std::clamp((q - p0).Dot(d) / len2, 0.f, 1.f);
+}
+
+Vector3 closestOnBox(const CollisionBody& box, const Vector3& q){
+    const Vector3 d = q - box.obbCenter;
+    Vector3 out = box.obbCenter;
+    for (int i = 0; i < 3; ++i)
+        out += box.obbAxes[i] * std::clamp(d.Dot(box.obbAxes[i]), -box.obbHalves[i], box.obbHalves[i]);
+    return out;
+}
+
+// Segment-vs-box separating axes: the box faces and the segment crossed
+// with each box edge. Returns the largest separation; `outAxis` points from
+// the box towards the segment.
+float segmentBoxSat(const Vector3& p0, const Vector3& p1, const CollisionBody& box, Vector3& outAxis){
+    const Vector3 mid = (p0 + p1) * 0.5f;
+    const Vector3 half = (p1 - p0) * 0.5f;
+    const Vector3 T = mid - box.obbCenter;
+    float best = -FLT_MAX;
+    outAxis = Vector3::UnitY;
+    for (int k = 0; k < 6; ++k){
+        Vector3 L = k < 3 ? box.obbAxes[k] : half.Cross(box.obbAxes[k - 3]);
+        const float len = L.Length();
+        if (len < kEps) continue;
+        L /= len;
+        const float tl = T.Dot(L);
+        const float sep = fabsf(tl) - projectBox(box, L) - fabsf(half.Dot(L));
+        if (sep > best){
+            best = sep;
+            outAxis = tl >= 0.f ? L : -L;
+        }
+    }
+    return best;
+}
+
+// Squared distance to the box is convex along the segment, so bisecting on
+// the sign of its derivative finds the closest pair.
+void segmentBoxClosest(const Vector3& p0, const Vector3& p1, const CollisionBody& box,
+                       Vector3& outOnSeg, Vector3& outOnBox){
+    const Vector3 d = p1 - p0;
+    auto slope = [&](float t){
+        const Vector3 p = p0 + d * t;
+        return (p - closestOnBox(box, p)).Dot(d);
+    };
+
+    float t = 0.f;
+    if (slope(0.f) < 0.f){
+        if (slope(1.f) <= 0.f){
+            t = 1.f;
+        } else {
+            float lo = 0.f, hi = 1.f;
+            for (int it = 0; it < kBisectIterations; ++it){
+                const float m = (lo + hi) * 0.5f;
+                if (slope(m) < 0.f) lo = m;
+                else hi = m;
+            }
+            t = (lo + hi) * 0.5f;
+        }
+    }
+    outOnSeg = p0 + d * t;
+    outOnBox = closestOnBox(box, outOnSeg);
+}
+
+void beginManifold(const CollisionBody& capsule, const CollisionBody& other, ContactManifold& m){
+    m.a = capsule.go;
+    m.b = other.go;
+    m.pointCount = 1;
+    m.points[0] = {};
+}
+
+// Shared by the sphere and capsule cases: two spheres at the closest points.
+bool roundVsRound(const CollisionBody& capsule, const Vector3& onCapsule,
+                  const CollisionBody& other, const Vector3& onOther, float otherRadius,
+                  ContactManifold& m){
+    const Vector3 diff = onCapsule - onOther;
+    const float distSq = diff.LengthSquared();
+    const float rSum = capsule.capsuleRadius + otherRadius;
+    if (distSq >= rSum * rSum) return false;
+
+    beginManifold(capsule, other, m);
+    const float dist = sqrtf(distSq);
+    m.normal = dist > kEps ? diff / dist : Vector3::UnitY;
+    m.points[0].depth = rSum - dist;
+    m.points[0].point = onOther + m.normal * otherRadius;
+    return true;
+}
+
+// Clips the segment to the box face facing `n` and keeps both clipped ends
+// when each is within the radius of the face.
+bool flatOnFace(const Vector3& p0, const Vector3& p1, float radius, const CollisionBody& box,
+                const Vector3& n, ContactManifold& m){
+    int face = -1;
+    for (int k = 0; k < 3; ++k)
+        if (fabsf(n.Dot(box.obbAxes[k])) > kFaceNormalCos) face = k;
+    if (face < 0) return false;
+
+    const Vector3 seg = p1 - p0;
+    const float segLen = seg.Length();
+    if (segLen < kEps || fabsf(seg.Dot(box.obbAxes[face])) > kFlatSegmentCos * segLen) return false;
+
+    const float sign = n.Dot(box.obbAxes[face]) > 0.f ? 1.f : -1.f;
+    float l0[3], l1[3];
+    for (int k = 0; k < 3; ++k){
+        l0[k] = (p0 - box.obbCenter).Dot(box.obbAxes[k]);
+        l1[k] = (p1 - box.obbCenter).Dot(box.obbAxes[k]);
+    }
+
+    float t0 = 0.f, t1 = 1.f;
+    for (int k = 0; k < 3; ++k){
+        if (k == face) continue;
+        const float dl = l1[k] - l0[k];
+        if (fabsf(dl) < kEps){
+            if (fabsf(l0[k]) > box.obbHalves[k]) return false;
+            continue;
+        }
+        float a = (-box.obbHalves[k] - l0[k]) / dl;
+        float b = (box.obbHalves[k] - l0[k]) / dl;
+        if (a > b) std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+    }
+    if (t1 - t0 < kEps) return false;
+
+    ContactPoint pts[2];
+    const float ts[2] = { t0, t1 };
+    for (int i = 0; i < 2; ++i){
+        float l[3];
+        for (int k = 0; k < 3; ++k) l[k] = l0[k] + (l1[k] - l0[k]) * ts[i];
+        const float depth = radius - (sign * l[face] - box.obbHalves[face]);
+        if (depth <= 0.f) return false;
+        l[face] = sign * box.obbHalves[face];
+        pts[i].point = box.obbCenter + box.obbAxes[0] * l[0] + box.obbAxes[1] * l[1] + box.obbAxes[2] * l[2];
+        pts[i].depth = depth;
+        pts[i].featureId = static_cast<uint32_t>(i);
+    }
+
+    m.normal = box.obbAxes[face] * sign;
+    m.pointCount = 2;
+    m.points[0] = pts[0];
+    m.points[1] = pts[1];
+    return true;
+}
+
+bool capsuleVsOBB(const CollisionBody& capsule, const CollisionBody& box, ContactManifold& m){
+    Vector3 p0, p1;
+    Segment(capsule, p0, p1);
+    const float r = capsule.capsuleRadius;
+
+    Vector3 satAxis;
+    const float sep = segmentBoxSat(p0, p1, box, satAxis);
+    if (sep >= r) return false;
+
+    Vector3 normal;
+    float depth;
+    Vector3 point;
+    if (sep > 0.f){
+        Vector3 onSeg, onBox;
+        segmentBoxClosest(p0, p1, box, onSeg, onBox);
+        const Vector3 diff = onSeg - onBox;
+        const float dist = diff.Length();
+        if (dist >= r) return false;
+        normal = dist > kEps ? diff / dist : satAxis;
+        depth = r - dist;
+        point = onBox;
+    } else {
+        normal = satAxis;
+        depth = r - sep;
+        const Vector3 deepest = p0.Dot(normal) < p1.Dot(normal) ? p0 : p1;
+        const float plane = box.obbCenter.Dot(normal) + projectBox(box, normal);
+        point = deepest - normal * (deepest.Dot(normal) - plane);
+    }
+
+    beginManifold(capsule, box, m);
+    if (flatOnFace(p0, p1, r, box, normal, m)) return true;
+    m.normal = normal;
+    m.points[0].depth = depth;
+    m.points[0].point = point;
+    return true;
+}
+
+}
+
+void Segment(const CollisionBody& capsule, Vector3& outP0, Vector3& outP1){
+    const Vector3 half = capsule.obbAxes[1] * capsule.capsuleHalfHeight;
+    outP0 = capsule.obbCenter - half;
+    outP1 = capsule.obbCenter + half;
+}
+
+float ClosestSegmentSegment(const Vector3& p0, const Vector3& p1,
+                            const Vector3& q0, const Vector3& q1,
+                            Vector3& outOnP, Vector3& outOnQ){
+    const Vector3 d1 = p1 - p0;
+    const Vector3 d2 = q1 - q0;
+    const Vector3 r = p0 - q0;
+    const float a = d1.Dot(d1);
+    const float e = d2.Dot(d2);
+    const float f = d2.Dot(r);
+
+    float s = 0.f, t = 0.f;
+    if (a <= kEps && e <= kEps){
+        // Both segments are points.
+    } else if (a <= kEps){
+        t = std::clamp(f / e, 0.f, 1.f);
+    } else {
+        const float c = d1.Dot(r);
+        if (e <= kEps){
+            s = std::clamp(-c / a, 0.f, 1.f);
+        } else {
+            const float b = d1.Dot(d2);
+            const float denom = a * e - b * b;
+            s = denom > kEps ? std::clamp((b * f - c * e) / denom, 0.f, 1.f) : 0.f;
+            t = (b * s + f) / e;
+            if (t < 0.f){
+                t = 0.f;
+                s = std::clamp(-c / a, 0.f, 1.f);
+            } else if (t > 1.f){
+                t = 1.f;
+                s = std::clamp((b - c) / a, 0.f, 1.f);
+            }
+        }
+    }
+
+    outOnP = p0 + d1 * s;
+    outOnQ = q0 + d2 * t;
+    return (outOnP - outOnQ).LengthSquared();
+}
+
+float Separation(const CollisionBody& capsule, const CollisionBody& other, Vector3& outAxis){
+    Vector3 p0, p1;
+    Segment(capsule, p0, p1);
+    const float r = capsule.capsuleRadius;
+
+    if (other.bvType == BVType::AABB){
+        Vector3 satAxis;
+        const float sep = segmentBoxSat(p0, p1, other, satAxis);
+        if (sep > 0.f){
+            Vector3 onSeg, onBox;
+            segmentBoxClosest(p0, p1, other, onSeg, onBox);
+            const Vector3 d = onBox - onSeg;
+            const float len = d.Length();
+            if (len > kEps){
+                outAxis = d / len;
+                return len - r;
+            }
+        }
+        outAxis = -satAxis;
+        return sep - r;
+    }
+
+    Vector3 onCapsule, onOther;
+    float otherRadius;
+    if (other.bvType == BVType::Sphere){
+        onOther = other.sphereCenter;
+        onCapsule = closestOnSegment(p0, p1, onOther);
+        otherRadius = other.sphereRadius;
+    } else {
+        Vector3 q0, q1;
+        Segment(other, q0, q1);
+        ClosestSegmentSegment(p0, p1, q0, q1, onCapsule, onOther);
+        otherRadius = other.capsuleRadius;
+    }
+    const Vector3 d = onOther - onCapsule;
+    const float len = d.Length();
+    outAxis = len > kEps ? d / len : Vector3::UnitY;
+    return len - r - otherRadius;
+}
+
+bool Collide(const CollisionBody& capsule, const CollisionBody& other, ContactManifold& m){
+    if (other.bvType == BVType::AABB) return capsuleVsOBB(capsule, other, m);
+
+    Vector3 p0, p1;
+    Segment(capsule, p0, p1);
+    if (other.bvType == BVType::Sphere)
+        return roundVsRound(capsule, closestOnSegment(p0, p1, other.sphereCenter),
+                            other, other.sphereCenter, other.sphereRadius, m);
+
+    Vector3 q0, q1, onCapsule, onOther;
+    Segment(other, q0, q1);
+    ClosestSegmentSegment(p0, p1, q0, q1, onCapsule, onOther);
+    return roundVsRound(capsule, onCapsule, other, onOther, other.capsuleRadius, m);
+}
+
+}
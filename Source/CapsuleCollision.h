@@ -0,0 +1,26 @@
+#pragma once
+#include "CollisionInterfaces.h"
+
+// Capsule bodies are the segment obbCenter +/- obbAxes[1] * capsuleHalfHeight
+// swept by capsuleRadius. Their obbHalves hold the enclosing box, so the
+// phases that only know boxes stay conservative.
+namespace CapsuleCollision {
+
+    void Segment(const CollisionBody& capsule, Vector3& outP0, Vector3& outP1);
+
+    // Closest points between segments p0-p1 and q0-q1; returns the squared
+    // distance between them.
+    float ClosestSegmentSegment(const Vector3& p0, const Vector3& p1,
+                                const Vector3& q0, const Vector3& q1,
+                                Vector3& outOnP, Vector3& outOnQ);
+
+    // Exact distance from the capsule's surface to a sphere, capsule or box
+    // (negative when they overlap). `outAxis` points from the capsule
+    // towards `other`.
+    float Separation(const CollisionBody& capsule, const CollisionBody& other, Vector3& outAxis);
+
+    // Manifold with the normal pointing from `other` towards the capsule and
+    // points on `other`'s surface. A capsule lying on a box face gets two.
+    bool Collide(const CollisionBody& capsule, const CollisionBody& other, ContactManifold& m);
+
+}
@@ -0,0 +1,119 @@
+#include "Globals.h"
+#include "CoherentMidPhase.h"
+#include <cmath>
+
+static inline const Vector3& shapeCenter(const CollisionBody& b){
+    return b.bvType == BVType::Sphere ? b.sphereCenter : b.obbCenter;
+}
+
+static inline float shapeRadius(const CollisionBody& b){
+    if (b.bvType == BVType::Sphere) return b.sphereRadius;
+    return sqrtf(b.obbHalves[0] * b.obbHalves[0] +
+                 b.obbHalves[1] * b.obbHalves[1] +
+                 b.obbHalves[2] * b.obbHalves[2]);
+}
+
+static inline float shapeSupport(const CollisionBody& b, const Vector3& L){
+    if (b.bvType == BVType::Sphere) return b.sphereRadius;
+    return b.obbHalves[0] * fabsf(b.obbAxes[0].Dot(L)) +
+           b.obbHalves[1] * fabsf(b.obbAxes[1].Dot(L)) +
+           b.obbHalves[2] * fabsf(b.obbAxes[2].Dot(L));
+}
+
+static inline bool separatedOnShapes(const CollisionBody& a, const CollisionBody& b, const Vector3& L){
+    const float dist = fabsf((shapeCenter(b) - shapeCenter(a)).Dot(L));
+    return dist > shapeSupport(a, L) + shapeSupport(b, L);
+}
+
+// The AABB encloses the body's OBB, so separation of the AABB on one of the
+// other body's face axes implies separation of the shapes on that axis.
+static inline bool aabbSeparatedOnAxis(const AABB& box, const CollisionBody& obb, const Vector3& L){
+    const Vector3 c = (box.min + box.max) * 0.5f;
+    const Vector3 h = (box.max - box.min) * 0.5f;
+    const float rBox = h.x * fabsf(L.x) + h.y * fabsf(L.y) + h.z * fabsf(L.z);
+    const float dist = fabsf((shapeCenter(obb) - c).Dot(L));
+    return dist > rBox + shapeSupport(obb, L);
+}
+
+// Axes 0-2 are the first body's face normals, 3-5 the second body's.
+static inline const Vector3& faceAxis(const CollisionBody& a, const CollisionBody& b, uint8_t k){
+    return k < 3 ? a.obbAxes[k] : b.obbAxes[k - 3];
+}
+
+static inline bool hasFaceAxes(const CollisionBody& b){
+    return b.bvType != BVType::Sphere;
+}
+
+std::vector<CollisionPair> CoherentMidPhase::filter(
+    std::vector<CollisionPair> candidates,
+    const std::vector<CollisionBody>& bodies){
+    ++m_stamp;
+    m_cacheRejects = 0;
+    m_sphereRejects = 0;
+    m_boxRejects = 0;
+
+    const size_t count = candidates.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i){
+        const CollisionPair p = candidates[i];
+        const CollisionBody& ba = bodies[p.a];
+        const CollisionBody& bb = bodies[p.b];
+
+        const bool swapped = ba.id > bb.id;
+        const uint64_t key = swapped
+            ? (static_cast<uint64_t>(bb.id) << 32) | ba.id
+            : (static_cast<uint64_t>(ba.id) << 32) | bb.id;
+        auto toLocal = [swapped](uint8_t k) -> uint8_t {
+            return swapped ? static_cast<uint8_t>(k < 3 ? k + 3 : k - 3) : k;
+        };
+
+        auto it = m_cache.find(key);
+        if (it != m_cache.end()){
+            it->second.stamp = m_stamp;
+            const uint8_t k = toLocal(it->second.axis);
+            const bool usable = k < 3 ? hasFaceAxes(ba) : hasFaceAxes(bb);
+            if (usable && separatedOnShapes(ba, bb, faceAxis(ba, bb, k))){
+                ++m_cacheRejects;
+                continue;
+            }
+        }
+
+        const Vector3 d = shapeCenter(bb) - shapeCenter(ba);
+        const float rSum = shapeRadius(ba) + shapeRadius(bb);
+        if (d.LengthSquared() > rSum * rSum){
+            if (it != m_cache.end()) m_cache.erase(it);
+            ++m_sphereRejects;
+            continue;
+        }
+
+        uint8_t sepAxis = kNoAxis;
+        if (hasFaceAxes(bb)){
+            for (uint8_t k = 0; k < 3 && sepAxis == kNoAxis; ++k)
+                if (aabbSeparatedOnAxis(ba.worldAABB, bb, bb.obbAxes[k])) sepAxis = 3 + k;
+        }
+        if (hasFaceAxes(ba)){
+            for (uint8_t k = 0; k < 3 && sepAxis == kNoAxis; ++k)
+                if (aabbSeparatedOnAxis(bb.worldAABB, ba, ba.obbAxes[k])) sepAxis = k;
+        }
+
+        if (sepAxis != kNoAxis){
+            CachedAxis& entry = it != m_cache.end() ? it->second : m_cache[key];
+            entry.axis = toLocal(sepAxis);
+            entry.stamp = m_stamp;
+            ++m_boxRejects;
+            continue;
+        }
+
+        if (it != m_cache.end()) m_cache.erase(it);
+        candidates[kept++] = p;
+    }
+    candidates.resize(kept);
+
+    if (m_cache.size() > 2 * count + 256){
+        for (auto it = m_cache.begin(); it != m_cache.end();){
+            if (it->second.stamp != m_stamp) it = m_cache.erase(it);
+            else ++it;
+        }
+    }
+    return candidates;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "CollisionInterfaces.h"
+#include <vector>
+#include <unordered_map>
+
+// Cheap conservative rejection between broad and narrow phase: a bounding
+// sphere test, then each body's AABB against the other's OBB face axes. The
+// axis that separated a pair is cached by body id and retested first next
+// frame, which usually rejects a resting or slowly moving pair in one test.
+class CoherentMidPhase : public IMidPhase {
+public:
+    std::vector<CollisionPair> filter(
+        std::vector<CollisionPair> candidates,
+        const std::vector<CollisionBody>& bodies) override;
+
+    uint32_t getLastCacheRejects() const { return m_cacheRejects; }
+    uint32_t getLastSphereRejects() const { return m_sphereRejects; }
+    uint32_t getLastBoxRejects() const { return m_boxRejects; }
+    int getCacheSize() const { return static_cast<int>(m_cache.size()); }
+
+private:
+    static constexpr uint8_t kNoAxis = 0xFF;
+
+    struct CachedAxis {
+        uint8_t axis = kNoAxis;
+        uint32_t stamp = 0;
+    };
+
+    std::unordered_map<uint64_t, CachedAxis> m_cache;
+    uint32_t m_stamp = 0;
+
+    uint32_t m_cacheRejects = 0;
+    uint32_t m_sphereRejects = 0;
+    uint32_t m_boxRejects = 0;
+};
@@ -0,0 +1,881 @@
+#include "Globals.h"
+#include "CollisionBenchmark.h"
+#include "CollisionInterfaces.h"
+#include "BruteForceBroadPhase.h"
+#include "UniformGridBroadPhase.h"
+#include "OctreeBroadPhase.h"
+#include "DynamicAABBTreeBroadPhase.h"
+#include "SweepAndPruneBroadPhase.h"
+#include "NarrowPhase.h"
+#include "ContactCache.h"
+#include "CollisionResponse.h"
+#include "PhysicsStepper.h"
+#include "CollisionSystem.h"
+#include "SimulationIslands.h"
+#include "SceneGraph.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "ComponentMesh.h"
+#include "ComponentRigidbody.h"
+#include "PrimitiveFactory.h"
+#include "Mesh.h"
+#include "Model.h"
+#include "ContinuousCollision.h"
+#include "CollisionQuery.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <atomic>
+#include <random>
+#include <memory>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace CollisionBenchmark {
+
+namespace {
+
+constexpr uint32_t kBruteForceLimit = 10000;
+
+struct BoxField {
+    std::vector<CollisionBody> bodies;
+    std::vector<Vector3> origins;
+    std::vector<Vector3> halves;
+    std::vector<Vector3> drift;
+    uint32_t movingCount = 0;
+};
+
+BoxField makeBoxField(uint32_t n, float movingFraction){
+    BoxField f;
+    f.bodies.resize(n);
+    f.origins.resize(n);
+    f.halves.resize(n);
+    f.drift.resize(n);
+
+    std::mt19937 rng(1337u + n);
+    const float extent = std::cbrt(static_cast<float>(n)) * 2.5f;
+    std::uniform_real_distribution<float> pos(-extent * 0.5f, extent * 0.5f);
+    std::uniform_real_distribution<float> half(0.25f, 0.75f);
+    std::uniform_real_distribution<float> dir(-1.f, 1.f);
+
+    for (uint32_t i = 0; i < n; ++i){
+        CollisionBody& b = f.bodies[i];
+        b.id = i + 1;
+        f.origins[i] = Vector3(pos(rng), pos(rng), pos(rng));
+        f.halves[i] = Vector3(half(rng), half(rng), half(rng));
+        f.drift[i] = Vector3(dir(rng), dir(rng), dir(rng));
+        b.obbCenter = f.origins[i];
+        b.obbAxes[0] = Vector3::UnitX;
+        b.obbAxes[1] = Vector3::UnitY;
+        b.obbAxes[2] = Vector3::UnitZ;
+        b.obbHalves[0] = f.halves[i].x;
+        b.obbHalves[1] = f.halves[i].y;
+        b.obbHalves[2] = f.halves[i].z;
+        b.worldAABB = { f.origins[i] - f.halves[i], f.origins[i] + f.halves[i] };
+    }
+    f.movingCount = static_cast<uint32_t>(n * std::clamp(movingFraction, 0.f, 1.f));
+    return f;
+}
+
+void stepBoxField(BoxField& f, int frame){
+    const float t = frame * (1.f / 60.f);
+    for (uint32_t i = 0; i < f.movingCount; ++i){
+        const Vector3 c = f.origins[i] + f.drift[i] * (2.f * sinf(t * 3.f + i * 0.37f));
+        CollisionBody& b = f.bodies[i];
+        b.obbCenter = c;
+        b.worldAABB = { c - f.halves[i], c + f.halves[i] };
+    }
+}
+
+
+// Each pair is a box and a neighbour placed inside its broad-phase reach,
+// so the mix of separated and touching pairs resembles real candidates.
+void makeNeighbourPairs(uint32_t pairCount, std::vector<CollisionBody>& bodies,
+                        std::vector<CollisionPair>& pairs){
+    bodies.assign(pairCount * 2, CollisionBody{});
+    pairs.resize(pairCount);
+    std::mt19937 rng(4242u);
+    std::uniform_real_distribution<float> half(0.25f, 1.f);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    const float spacing = 8.f;
+
+    for (uint32_t i = 0; i < pairCount * 2; ++i){
+        CollisionBody& b = bodies[i];
+        b.id = i + 1;
+        const uint32_t pair = i / 2;
+        b.obbCenter = Vector3(static_cast<float>(pair % 256) * spacing,
+                              static_cast<float>(pair / 256) * spacing, 0.f);
+        if (i & 1) b.obbCenter += Vector3(unit(rng), unit(rng), unit(rng)) * 1.5f;
+        Quaternion q(unit(rng), unit(rng), unit(rng), unit(rng));
+        q.Normalize();
+        b.obbAxes[0] = Vector3::Transform(Vector3::UnitX, q);
+        b.obbAxes[1] = Vector3::Transform(Vector3::UnitY, q);
+        b.obbAxes[2] = Vector3::Transform(Vector3::UnitZ, q);
+        for (int k = 0; k < 3; ++k) b.obbHalves[k] = half(rng);
+    }
+    for (uint32_t i = 0; i < pairCount; ++i) pairs[i] = { i * 2, i * 2 + 1 };
+}
+
+bool sameManifolds(const std::vector<ContactManifold>& a,
+                   const std::vector<ContactManifold>& b){
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i){
+        const ContactManifold& x = a[i];
+        const ContactManifold& y = b[i];
+        if (x.key != y.key || x.bodyA != y.bodyA || x.pointCount != y.pointCount ||
+            x.normal != y.normal) return false;
+        for (uint32_t p = 0; p < x.pointCount; ++p){
+            if (x.points[p].point != y.points[p].point || x.points[p].depth != y.points[p].depth ||
+                x.points[p].featureId != y.points[p].featureId) return false;
+        }
+    }
+    return true;
+}
+
+struct StackBox {
+    Vector3 half;
+    Quaternion orientation;
+    SolverBody state;
+};
+
+std::vector<StackBox> makeStackScene(bool pyramid, uint32_t size){
+    std::vector<StackBox> boxes;
+    StackBox ground;
+    ground.half = Vector3(20.f, 0.5f, 20.f);
+    ground.state.centerOfMass = Vector3(0.f, -0.5f, 0.f);
+    boxes.push_back(ground);
+
+    const Vector3 half(0.5f, 0.5f, 0.5f);
+    for (uint32_t row = 0; row < size; ++row){
+        const uint32_t count = pyramid ? size - row : 1;
+        for (uint32_t i = 0; i < count; ++i){
+            StackBox b;
+            b.half = half;
+            const float x = (static_cast<float>(i) - (count - 1) * 0.5f) * 1.05f;
+            b.state.centerOfMass = Vector3(x, 0.5f + row * 1.f, 0.f);
+            boxes.push_back(b);
+        }
+    }
+    return boxes;
+}
+
+void syncCollisionBody(const StackBox& box, uint32_t index, CollisionBody& body){
+    body.id = index + 1;
+    body.bvType = BVType::AABB;
+    body.obbCenter = box.state.centerOfMass;
+    body.obbAxes[0] = Vector3::Transform(Vector3::UnitX, box.orientation);
+    body.obbAxes[1] = Vector3::Transform(Vector3::UnitY, box.orientation);
+    body.obbAxes[2] = Vector3::Transform(Vector3::UnitZ, box.orientation);
+    body.obbHalves[0] = box.half.x;
+    body.obbHalves[1] = box.half.y;
+    body.obbHalves[2] = box.half.z;
+
+    Vector3 extent;
+    for (int k = 0; k < 3; ++k){
+        const Vector3 a = body.obbAxes[k] * body.obbHalves[k];
+        extent += Vector3(fabsf(a.x), fabsf(a.y), fabsf(a.z));
+    }
+    body.worldAABB = { body.obbCenter - extent, body.obbCenter + extent };
+}
+
+void rotate(Quaternion& q, const Vector3& rotationVector){
+    const float angle = rotationVector.Length();
+    if (angle < 1e-9f) return;
+    q = q * Quaternion::CreateFromAxisAngle(rotationVector / angle, angle);
+    q.Normalize();
+}
+
+CollisionBody makeYawedBox(const Vector3& center, const Vector3& half, float yaw, uint32_t id){
+    CollisionBody b;
+    b.id = id;
+    const Quaternion q = Quaternion::CreateFromYawPitchRoll(yaw, 0.f, 0.f);
+    b.obbCenter = center;
+    b.obbAxes[0] = Vector3::Transform(Vector3::UnitX, q);
+    b.obbAxes[1] = Vector3::UnitY;
+    b.obbAxes[2] = Vector3::Transform(Vector3::UnitZ, q);
+    b.obbHalves[0] = half.x;
+    b.obbHalves[1] = half.y;
+    b.obbHalves[2] = half.z;
+
+    Vector3 extent;
+    for (int k = 0; k < 3; ++k){
+        const Vector3 a = b.obbAxes[k] * b.obbHalves[k];
+        extent += Vector3(fabsf(a.x), fabsf(a.y), fabsf(a.z));
+    }
+    b.worldAABB = { center - extent, center + extent };
+    return b;
+}
+
+// Walled arena on a ground slab with thin interior walls, pillars and
+// boulders, sized for 1.8 m characters.
+std::vector<CollisionBody> makeCharacterArena(float size){
+    std::vector<CollisionBody> bodies;
+    uint32_t id = 1;
+    const float h = size * 0.5f;
+    bodies.push_back(makeYawedBox(Vector3(0.f, -0.5f, 0.f), Vector3(h + 1.f, 0.5f, h + 1.f), 0.f, id++));
+    bodies.push_back(makeYawedBox(Vector3(h + 0.1f, 1.5f, 0.f), Vector3(0.1f, 1.5f, h), 0.f, id++));
+    bodies.push_back(makeYawedBox(Vector3(-h - 0.1f, 1.5f, 0.f), Vector3(0.1f, 1.5f, h), 0.f, id++));
+    bodies.push_back(makeYawedBox(Vector3(0.f, 1.5f, h + 0.1f), Vector3(h, 1.5f, 0.1f), 0.f, id++));
+    bodies.push_back(makeYawedBox(Vector3(0.f, 1.5f, -h - 0.1f), Vector3(h, 1.5f, 0.1f), 0.f, id++));
+
+    std::mt19937 rng(4242u);
+    std::uniform_real_distribution<float> pos(-h * 0.85f, h * 0.85f);
+    std::uniform_real_distribution<float> yaw(0.f, 6.2831853f);
+    std::uniform_real_distribution<float> len(1.f, 4.f);
+    const uint32_t features = static_cast<uint32_t>(size * size / 16.f);
+    for (uint32_t i = 0; i < features; ++i){
+        const Vector3 at(pos(rng), 0.f, pos(rng));
+        switch (i % 3){
+        case 0:
+            bodies.push_back(makeYawedBox(at + Vector3(0.f, 1.5f, 0.f), Vector3(len(rng), 1.5f, 0.1f), yaw(rng), id++));
+            break;
+        case 1:
+            bodies.push_back(makeYawedBox(at + Vector3(0.f, 1.f, 0.f), Vector3(0.5f, 1.f, 0.5f), yaw(rng), id++));
+            break;
+        default: {
+            CollisionBody boulder = makeYawedBox(at + Vector3(0.f, 0.3f, 0.f), Vector3(0.8f, 0.8f, 0.8f), 0.f, id++);
+            boulder.bvType = BVType::Sphere;
+            boulder.sphereCenter = boulder.obbCenter;
+            boulder.sphereRadius = 0.8f;
+            bodies.push_back(boulder);
+            break;
+        }
+        }
+    }
+    return bodies;
+}
+
+// Box scene stepped the way the editor does it: integrate, brute-force
+// broad phase, narrow phase with warm-start cache, solve, apply corrections.
+struct StackWorld {
+    std::vector<StackBox> boxes;
+    std::vector<CollisionBody> bodies;
+    std::vector<SolverBody> solverBodies;
+    std::vector<CollisionPair> pairs;
+    std::vector<ContactManifold> manifolds;
+    NarrowPhase narrow;
+    ContactCache cache;
+    CollisionResponse response;
+    float gravity = -9.81f;
+
+    explicit StackWorld(std::vector<StackBox> scene)
+        : boxes(std::move(scene)), bodies(boxes.size()), solverBodies(boxes.size()){}
+
+    float step(float dt){
+        const uint32_t n = static_cast<uint32_t>(boxes.size());
+        for (uint32_t i = 1; i < n; ++i){
+            SolverBody& s = boxes[i].state;
+            s.velocity.y += gravity * dt;
+            rotate(boxes[i].orientation, s.angularVelocity * dt);
+            s.centerOfMass += s.velocity * dt;
+        }
+
+        for (uint32_t i = 0; i < n; ++i) syncCollisionBody(boxes[i], i, bodies[i]);
+        pairs.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            for (uint32_t j = i + 1; j < n; ++j)
+                if (bodies[i].worldAABB.intersects(bodies[j].worldAABB)) pairs.push_back({ i, j });
+
+        cache.store(std::move(manifolds));
+        manifolds = narrow.test(pairs, bodies);
+        cache.warmStart(manifolds);
+
+        for (uint32_t i = 0; i < n; ++i){
+            const float mass = i == 0 ? 0.f : 1.f;
+            SolverBody& sb = solverBodies[i];
+            sb = CollisionResponse::makeSolverBody(bodies[i], mass, false);
+            sb.velocity = boxes[i].state.velocity;
+            sb.angularVelocity = boxes[i].state.angularVelocity;
+        }
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        response.solveBodies(solverBodies, manifolds, dt);
+        const float ms = std::chrono::duration<float, std::milli>(
+            std::chrono::high_resolution_clock::now() - t0).count();
+
+        for (uint32_t i = 1; i < n; ++i){
+            SolverBody& s = boxes[i].state;
+            s.velocity = solverBodies[i].velocity;
+            s.angularVelocity = solverBodies[i].angularVelocity;
+            s.centerOfMass += solverBodies[i].pseudoVelocity * dt;
+            rotate(boxes[i].orientation, solverBodies[i].pseudoAngularVelocity * dt);
+        }
+        return ms;
+    }
+};
+
+}
+
+std::vector<BroadPhaseResult> RunBroadPhase(const std::vector<uint32_t>& bodyCounts,
+                                            int frames, float movingFraction){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<BroadPhaseResult> results;
+    if (frames < 1) frames = 1;
+
+    for (uint32_t n : bodyCounts){
+        std::unique_ptr<IBroadPhase> phases[] = {
+            std::make_unique<BruteForceBroadPhase>(),
+            std::make_unique<UniformGridBroadPhase>(4.f),
+            std::make_unique<OctreeBroadPhase>(8, 6),
+            std::make_unique<DynamicAABBTreeBroadPhase>(0.1f),
+            std::make_unique<SweepAndPruneBroadPhase>(),
+        };
+
+        for (auto& bp : phases){
+            BroadPhaseResult r;
+            r.name = bp->getName();
+            r.bodies = n;
+            if (dynamic_cast<BruteForceBroadPhase*>(bp.get()) && n > kBruteForceLimit){
+                r.skipped = true;
+                results.push_back(r);
+                continue;
+            }
+
+            BoxField field = makeBoxField(n, movingFraction);
+
+            auto t0 = Clock::now();
+            r.pairs = static_cast<uint32_t>(bp->query(field.bodies).size());
+            r.firstFrameMs = std::chrono::duration<float, std::milli>(Clock::now() - t0).count();
+
+            float total = 0.f;
+            for (int f = 1; f <= frames; ++f){
+                stepBoxField(field, f);
+                auto f0 = Clock::now();
+                r.pairs = static_cast<uint32_t>(bp->query(field.bodies).size());
+                total += std::chrono::duration<float, std::milli>(Clock::now() - f0).count();
+            }
+            r.avgFrameMs = total / frames;
+            results.push_back(r);
+
+            LOG("CollisionBenchmark: %-20s %6u bodies  first %8.3f ms  avg %8.3f ms  pairs %u",
+                r.name, n, r.firstFrameMs, r.avgFrameMs, r.pairs);
+        }
+    }
+    return results;
+}
+
+std::vector<SatBatchResult> RunSatBatch(uint32_t pairCount, int repeats){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<SatBatchResult> results;
+    if (repeats < 1) repeats = 1;
+
+    std::vector<CollisionBody> bodies;
+    std::vector<CollisionPair> pairs;
+    makeNeighbourPairs(pairCount, bodies, pairs);
+
+    NarrowPhase np;
+    std::vector<SatResult> reference(pairs.size());
+    std::vector<SatResult> out(pairs.size());
+
+    const NarrowPhase::SatPath paths[] = {
+        NarrowPhase::SatPath::Scalar, NarrowPhase::SatPath::SSE, NarrowPhase::SatPath::AVX2
+    };
+    for (NarrowPhase::SatPath path : paths){
+        if (path == NarrowPhase::SatPath::AVX2 && NarrowPhase::bestSatPath() != path) continue;
+        np.setSatPath(path);
+
+        SatBatchResult r;
+        r.path = NarrowPhase::satPathName(path);
+        r.pairs = pairCount;
+
+        std::vector<SatResult>& dst = path == NarrowPhase::SatPath::Scalar ? reference : out;
+        np.satBatch(pairs.data(), pairCount, bodies, dst.data());
+
+        auto t0 = Clock::now();
+        for (int rep = 0; rep < repeats; ++rep)
+            np.satBatch(pairs.data(), pairCount, bodies, dst.data());
+        r.ms = std::chrono::duration<float, std::milli>(Clock::now() - t0).count() / repeats;
+        r.mpairsPerSec = r.ms > 0.f ? pairCount / (r.ms * 1000.f) : 0.f;
+
+        if (path != NarrowPhase::SatPath::Scalar){
+            for (uint32_t i = 0; i < pairCount; ++i)
+                if (out[i].separated != reference[i].separated) ++r.mismatches;
+        }
+        results.push_back(r);
+
+        LOG("CollisionBenchmark: SAT %-8s %u pairs  %8.3f ms  %7.2f Mpairs/s  mismatches %u",
+            r.path, r.pairs, r.ms, r.mpairsPerSec, r.mismatches);
+    }
+    return results;
+}
+
+std::vector<SolverResult> RunSolver(const std::vector<int>& iterationCounts, int frames){
+    std::vector<SolverResult> results;
+    if (frames < 1) frames = 1;
+
+    const float dt = 1.f / 60.f;
+
+    struct SceneDef { const char* name; bool pyramid; };
+    const SceneDef scenes[] = { { "Stack 10", false }, { "Pyramid 10", true } };
+
+    for (const SceneDef& scene : scenes){
+        for (int iterations : iterationCounts){
+            for (bool warm : { true, false }){
+                StackWorld world(makeStackScene(scene.pyramid, 10));
+                world.response.setIterations(iterations);
+                world.response.setWarmStarting(warm);
+                const uint32_t n = static_cast<uint32_t>(world.boxes.size());
+
+                SolverResult r;
+                r.scene = scene.name;
+                r.bodies = n - 1;
+                r.iterations = iterations;
+                r.warmStart = warm;
+
+                float totalMs = 0.f;
+                for (int f = 0; f < frames; ++f) totalMs += world.step(dt);
+
+                uint32_t points = 0;
+                float depthSum = 0.f;
+                for (const ContactManifold& m : world.manifolds){
+                    for (uint32_t p = 0; p < m.pointCount; ++p){
+                        r.maxPenetration = std::max(r.maxPenetration, m.points[p].depth);
+                        depthSum += m.points[p].depth;
+                        ++points;
+                    }
+                }
+                r.avgPenetration = points ? depthSum / points : 0.f;
+                for (uint32_t i = 1; i < n; ++i)
+                    r.maxSpeed = std::max(r.maxSpeed, world.boxes[i].state.velocity.Length());
+                r.avgSolveMs = totalMs / frames;
+                results.push_back(r);
+
+                LOG("CollisionBenchmark: %-10s it %2d warm %d  solve %6.3f ms  pen max %.4f avg %.4f  speed %.4f",
+                    r.scene, iterations, warm ? 1 : 0, r.avgSolveMs,
+                    r.maxPenetration, r.avgPenetration, r.maxSpeed);
+            }
+        }
+    }
+    return results;
+}
+
+std::vector<StepperResult> RunStepperDeterminism(const std::vector<float>& renderRates,
+                                                 float seconds){
+    std::vector<StepperResult> results;
+    std::vector<float> reference;
+    uint32_t referenceSteps = 0;
+    bool haveReference = false;
+
+    for (float hz : renderRates){
+        if (hz <= 0.f) continue;
+
+        // A small pyramid hit by a spinning box, so contacts, friction and
+        // rotation all feed the trajectory.
+        std::vector<StackBox> boxes = makeStackScene(true, 4);
+        StackBox dropped;
+        dropped.half = Vector3(0.5f, 0.5f, 0.5f);
+        dropped.state.centerOfMass = Vector3(0.3f, 7.f, 0.2f);
+        dropped.state.angularVelocity = Vector3(1.f, 2.f, 0.5f);
+        boxes.push_back(dropped);
+
+        SceneGraph scene;
+        std::vector<GameObject*> dynamics;
+        for (size_t i = 0; i < boxes.size(); ++i){
+            GameObject* go = scene.createGameObject("StepperBox");
+            ComponentTransform* t = go->getTransform();
+            t->position = boxes[i].state.centerOfMass;
+            t->scale = boxes[i].half * 2.f;
+            t->markDirty();
+            go->createComponent<ComponentMesh>()->setProceduralModel(
+                PrimitiveFactory::meshToModel(PrimitiveFactory::createCubeMesh()));
+            if (i == 0) continue;
+
+            ComponentRigidbody* rb = go->createComponent<ComponentRigidbody>();
+            rb->angularVelocity = boxes[i].state.angularVelocity;
+            dynamics.push_back(go);
+        }
+
+        CollisionSystem collision;
+        CollisionResponse response;
+        SimulationIslands islands;
+        PhysicsStepper stepper;
+        std::vector<float> trajectory;
+        stepper.setStepObserver([&](){
+            for (GameObject* go : dynamics){
+                const ComponentTransform* t = go->getTransform();
+                const ComponentRigidbody* rb = go->getComponent<ComponentRigidbody>();
+                trajectory.insert(trajectory.end(), {
+                    t->position.x, t->position.y, t->position.z,
+                    t->rotation.x, t->rotation.y, t->rotation.z, t->rotation.w,
+                    rb->velocity.x, rb->velocity.y, rb->velocity.z,
+                    rb->angularVelocity.x, rb->angularVelocity.y, rb->angularVelocity.z });
+            }
+        });
+
+        // Every rate runs the same number of fixed steps; the last frames
+        // are shortened so no rate overshoots the others.
+        const uint64_t targetSteps = static_cast<uint64_t>(lroundf(seconds / stepper.getFixedDt()));
+        StepperResult r;
+        r.renderHz = hz;
+        while (stepper.getStepCount() < targetSteps){
+            const float remaining = (targetSteps - stepper.getStepCount()) * stepper.getFixedDt();
+            stepper.stepScene(&scene, std::min(1.f / hz, remaining),
+                              ComponentRigidbody::kGravityAccel,
+                              collision, response, &islands);
+            ++r.frames;
+        }
+        r.steps = static_cast<uint32_t>(stepper.getStepCount());
+        r.droppedSteps = stepper.getDroppedSteps();
+
+        if (!haveReference){
+            reference = trajectory;
+            referenceSteps = r.steps;
+            haveReference = true;
+        }
+        r.identical = r.steps == referenceSteps && trajectory.size() == reference.size() &&
+            memcmp(reference.data(), trajectory.data(), trajectory.size() * sizeof(float)) == 0;
+        const size_t common = std::min(reference.size(), trajectory.size());
+        for (size_t i = 0; i < common; ++i)
+            r.maxDeviation = std::max(r.maxDeviation, fabsf(reference[i] - trajectory[i]));
+        results.push_back(r);
+
+        LOG("CollisionBenchmark: stepper %6.1f Hz  %4u frames  %4u steps  dropped %u  max dev %g  %s",
+            r.renderHz, r.frames, r.steps, r.droppedSteps, r.maxDeviation,
+            r.identical ? "identical" : "DIVERGED");
+    }
+    return results;
+}
+
+std::vector<NarrowThreadResult> RunNarrowThreads(const std::vector<uint32_t>& threadCounts,
+                                                 uint32_t pairCount, int repeats){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<NarrowThreadResult> results;
+    if (repeats < 1) repeats = 1;
+
+    std::vector<CollisionBody> bodies;
+    std::vector<CollisionPair> pairs;
+    makeNeighbourPairs(pairCount, bodies, pairs);
+
+    NarrowPhase np;
+    const std::vector<ContactManifold> reference = np.test(pairs, bodies);
+    float baseMs = 0.f;
+
+    for (uint32_t threads : threadCounts){
+        np.setThreadCount(threads);
+        NarrowThreadResult r;
+        r.threads = np.getThreadCount();
+        r.pairs = pairCount;
+
+        std::vector<ContactManifold> out = np.test(pairs, bodies);
+        auto t0 = Clock::now();
+        for (int rep = 0; rep < repeats; ++rep) out = np.test(pairs, bodies);
+        r.ms = std::chrono::duration<float, std::milli>(Clock::now() - t0).count() / repeats;
+
+        if (baseMs <= 0.f) baseMs = r.ms;
+        r.speedup = r.ms > 0.f ? baseMs / r.ms : 0.f;
+        r.manifolds = static_cast<uint32_t>(out.size());
+        r.identical = sameManifolds(reference, out);
+        results.push_back(r);
+
+        LOG("CollisionBenchmark: narrow %u thread(s)  %u pairs  %8.3f ms  x%.2f  %u manifolds  %s",
+            r.threads, r.pairs, r.ms, r.speedup, r.manifolds,
+            r.identical ? "identical" : "MISMATCH");
+    }
+    return results;
+}
+
+std::vector<PoolRestartResult> RunPoolRestart(const std::vector<uint32_t>& threadCounts,
+                                              uint32_t taskCount, int repeats){
+    std::vector<PoolRestartResult> results;
+    if (repeats < 1) repeats = 1;
+
+    WorkerPool pool;
+    std::vector<std::atomic<uint32_t>> calls(taskCount);
+    for (uint32_t threads : threadCounts){
+        pool.setThreadCount(threads);
+        PoolRestartResult r;
+        r.threads = pool.getThreadCount();
+        r.tasks = taskCount;
+
+        for (int rep = 0; rep < repeats; ++rep){
+            for (std::atomic<uint32_t>& c : calls) c.store(0);
+            pool.parallelFor(taskCount, [&](uint32_t i){ calls[i].fetch_add(1); });
+            for (const std::atomic<uint32_t>& c : calls)
+                if (c.load() != 1) ++r.badCalls;
+        }
+        results.push_back(r);
+
+        LOG("CollisionBenchmark: pool restart %u thread(s)  %u tasks x%d  %u bad calls  %s",
+            r.threads, r.tasks, repeats, r.badCalls, r.badCalls == 0 ? "ok" : "FAILED");
+    }
+    return results;
+}
+
+std::vector<ContinuousResult> RunContinuous(const std::vector<float>& speeds, uint32_t bodyCount){
+    using Clock = std::chrono::high_resolution_clock;
+    using namespace ContinuousCollision;
+    std::vector<ContinuousResult> results;
+    const float h = 1.f / 60.f;
+
+    CollisionBody wall;
+    wall.obbCenter = Vector3::Zero;
+    wall.obbAxes[0] = Vector3::UnitX;
+    wall.obbAxes[1] = Vector3::UnitY;
+    wall.obbAxes[2] = Vector3::UnitZ;
+    wall.obbHalves[0] = 0.05f;
+    wall.obbHalves[1] = 20.f;
+    wall.obbHalves[2] = 20.f;
+    const Motion still{};
+
+    for (float speed : speeds){
+        if (speed <= 0.f) continue;
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> offset(-10.f, 10.f);
+        std::uniform_real_distribution<float> start(2.f, 3.f);
+        std::uniform_real_distribution<float> spin(-20.f, 20.f);
+
+        ContinuousResult r;
+        r.speed = speed;
+        r.bodies = bodyCount;
+        uint32_t iterations = 0;
+        float sweepMs = 0.f;
+        const int steps = static_cast<int>(ceilf((6.f + speed * h) / (speed * h))) + 1;
+
+        for (uint32_t i = 0; i < bodyCount; ++i){
+            CollisionBody body;
+            const Vector3 origin(-start(rng), offset(rng), offset(rng));
+            body.obbCenter = body.sphereCenter = origin;
+            body.obbAxes[0] = Vector3::UnitX;
+            body.obbAxes[1] = Vector3::UnitY;
+            body.obbAxes[2] = Vector3::UnitZ;
+            body.obbHalves[0] = body.obbHalves[1] = body.obbHalves[2] = 0.2f;
+            Motion motion{ Vector3(speed * h, 0.f, 0.f), Vector3::Zero };
+            if (i & 1){
+                motion.angular = Vector3(spin(rng), spin(rng), spin(rng)) * h;
+            } else {
+                body.bvType = BVType::Sphere;
+                body.sphereRadius = 0.2f;
+            }
+
+            Vector3 axis;
+            CollisionBody discrete = body;
+            bool caught = false;
+            for (int s = 0; s < steps && !caught; ++s){
+                discrete = Advance(discrete, motion, 1.f);
+                caught = SeparationBound(discrete, wall, axis) <= 0.f;
+            }
+            if (!caught && discrete.obbCenter.x > 0.f) ++r.discreteTunneled;
+
+            CollisionBody swept = body;
+            caught = false;
+            for (int s = 0; s < steps && !caught; ++s){
+                auto t0 = Clock::now();
+                const TimeOfImpact toi = Sweep(swept, motion, wall, still);
+                sweepMs += std::chrono::duration<float, std::milli>(Clock::now() - t0).count();
+                ++r.sweeps;
+                iterations += static_cast<uint32_t>(toi.iterations);
+                swept = Advance(swept, motion, toi.fraction);
+                caught = toi.hit || SeparationBound(swept, wall, axis) <= 0.f;
+            }
+            if (!caught && swept.obbCenter.x > 0.f) ++r.continuousTunneled;
+        }
+
+        r.avgIterations = r.sweeps ? static_cast<float>(iterations) / r.sweeps : 0.f;
+        r.ms = sweepMs;
+        results.push_back(r);
+
+        LOG("CollisionBenchmark: ccd %7.1f m/s  %u bodies  tunneled discrete %u / swept %u  %u sweeps  %.2f it  %8.3f ms",
+            r.speed, r.bodies, r.discreteTunneled, r.continuousTunneled, r.sweeps, r.avgIterations, r.ms);
+    }
+    return results;
+}
+
+std::vector<RaycastResult> RunRaycast(uint32_t bodyCount, uint32_t rayCount, int frames){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<RaycastResult> results;
+    if (frames < 1) frames = 1;
+    const uint32_t sampleCount = std::min(rayCount, 2000u);
+
+    BoxField field = makeBoxField(bodyCount, 0.f);
+    for (uint32_t i = 0; i < bodyCount; i += 3){
+        CollisionBody& b = field.bodies[i];
+        b.bvType = BVType::Sphere;
+        b.sphereCenter = b.obbCenter;
+        b.sphereRadius = field.halves[i].x;
+        b.worldAABB = Sphere{ b.sphereCenter, b.sphereRadius }.toAABB();
+    }
+    const std::vector<CollisionBody>& bodies = field.bodies;
+
+    std::mt19937 rng(99u);
+    const float extent = std::cbrt(static_cast<float>(bodyCount)) * 2.5f;
+    std::uniform_real_distribution<float> pos(-extent * 0.5f, extent * 0.5f);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    std::vector<RayQuery> rays(rayCount);
+    for (RayQuery& r : rays){
+        r.origin = Vector3(pos(rng), pos(rng), pos(rng));
+        r.direction = Vector3(unit(rng), unit(rng), unit(rng));
+        r.maxDistance = extent * 0.5f;
+    }
+
+    DynamicAABBTreeBroadPhase tree;
+    tree.query(bodies);
+    SweepAndPruneBroadPhase sap;
+    sap.query(bodies);
+    WorkerPool pool(std::clamp(WorkerPool::hardwareThreads(), 1u, 8u));
+
+    struct Case { const char* name; const IBroadPhase* bp; WorkerPool* pool; float radius; };
+    const Case cases[] = {
+        { "Linear scan", nullptr, nullptr, 0.f },
+        { "Sweep and Prune", &sap, nullptr, 0.f },
+        { "Dynamic AABB Tree", &tree, nullptr, 0.f },
+        { "Dynamic AABB Tree", &tree, &pool, 0.f },
+        { "Linear scan", nullptr, nullptr, 0.25f },
+        { "Dynamic AABB Tree", &tree, &pool, 0.25f },
+    };
+
+    std::vector<RaycastHit> reference[2];
+    std::vector<RaycastHit> hits(rayCount);
+    for (const Case& c : cases){
+        const bool linear = c.bp == nullptr;
+        const uint32_t count = linear ? sampleCount : rayCount;
+        auto cast = [&]{
+            if (c.radius > 0.f) CollisionQuery::SphereCastBatch(c.bp, bodies, rays.data(), count, c.radius, hits.data(), c.pool);
+            else CollisionQuery::RaycastBatch(c.bp, bodies, rays.data(), count, hits.data(), c.pool);
+        };
+
+        auto t0 = Clock::now();
+        for (int f = 0; f < frames; ++f) cast();
+        const float ms = std::chrono::duration<float, std::milli>(Clock::now() - t0).count() / frames;
+
+        RaycastResult r;
+        r.structure = c.name;
+        r.threads = c.pool ? c.pool->getThreadCount() : 1;
+        r.radius = c.radius;
+        r.bodies = bodyCount;
+        r.rays = rayCount;
+        r.sampled = linear;
+        r.ms = ms * static_cast<float>(rayCount) / static_cast<float>(count);
+        r.mraysPerSec = r.ms > 0.f ? rayCount / (r.ms * 1000.f) : 0.f;
+        for (uint32_t i = 0; i < count; ++i) r.hits += hits[i].hit() ? 1u : 0u;
+        if (linear) r.hits = static_cast<uint32_t>(static_cast<uint64_t>(r.hits) * rayCount / count);
+
+        std::vector<RaycastHit>& ref = reference[c.radius > 0.f ? 1 : 0];
+        if (linear){
+            ref.assign(hits.begin(), hits.begin() + count);
+        } else {
+            for (uint32_t i = 0; i < std::min<uint32_t>(count, static_cast<uint32_t>(ref.size())); ++i){
+                if (hits[i].hit() != ref[i].hit() ||
+                    (hits[i].hit() && fabsf(hits[i].distance - ref[i].distance) > 1e-4f))
+                    ++r.mismatches;
+            }
+        }
+        results.push_back(r);
+
+        LOG("CollisionBenchmark: %s %-18s %u thread(s)  r %.2f  %u bodies  %u rays  %9.3f ms%s  %7.2f Mray/s  %u hits  %u mismatch(es)",
+            c.radius > 0.f ? "sphere cast" : "raycast", r.structure, r.threads, r.radius, r.bodies, r.rays,
+            r.ms, r.sampled ? " (sampled)" : "", r.mraysPerSec, r.hits, r.mismatches);
+    }
+    return results;
+}
+
+// Both runs follow the same headings: one moves the capsule straight, the
+// other through MoveCapsule. A move clips when the capsule ends it inside an
+// obstacle or its center's path crosses one.
+std::vector<CharacterResult> RunCharacters(const std::vector<float>& speeds,
+                                           uint32_t characterCount, int steps){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<CharacterResult> results;
+    const float dt = 1.f / 60.f;
+    const float radius = 0.4f;
+    const float halfHeight = 0.5f;
+    const float clipTolerance = 0.02f;
+    const int headingSteps = 90;
+
+    const float size = std::max(20.f, sqrtf(static_cast<float>(characterCount)) * 4.f);
+    const std::vector<CollisionBody> bodies = makeCharacterArena(size);
+    DynamicAABBTreeBroadPhase tree;
+    tree.query(bodies);
+
+    CollisionBody capsule;
+    capsule.bvType = BVType::Capsule;
+    capsule.obbAxes[0] = Vector3::UnitX;
+    capsule.obbAxes[1] = Vector3::UnitY;
+    capsule.obbAxes[2] = Vector3::UnitZ;
+    capsule.capsuleRadius = radius;
+    capsule.capsuleHalfHeight = halfHeight;
+
+    auto clipped = [&](const Vector3& from, const Vector3& to){
+        capsule.obbCenter = to;
+        const Vector3 path = to - from;
+        const float length = path.Length();
+        for (const CollisionBody& b : bodies){
+            Vector3 axis;
+            if (ContinuousCollision::SeparationBound(capsule, b, axis) < -clipTolerance) return true;
+            float t;
+            Vector3 n;
+            if (length > 1e-6f && CollisionQuery::RayVsBody(b, from, path / length, length, t, n)) return true;
+        }
+        return false;
+    };
+
+    std::mt19937 spawnRng(17u);
+    std::uniform_real_distribution<float> spawn(-size * 0.45f, size * 0.45f);
+    std::vector<Vector3> starts;
+    while (starts.size() < characterCount){
+        capsule.obbCenter = Vector3(spawn(spawnRng), halfHeight + radius + 0.02f, spawn(spawnRng));
+        bool free = true;
+        for (const CollisionBody& b : bodies){
+            Vector3 axis;
+            if (ContinuousCollision::SeparationBound(capsule, b, axis) < 0.01f){ free = false; break; }
+        }
+        if (free) starts.push_back(capsule.obbCenter);
+    }
+
+    for (float speed : speeds){
+        if (speed <= 0.f) continue;
+        CharacterResult r;
+        r.speed = speed;
+        r.characters = characterCount;
+        uint64_t queries = 0, candidates = 0, slides = 0;
+        float moveMs = 0.f;
+
+        std::vector<Vector3> naive = starts;
+        std::vector<Vector3> swept = starts;
+        std::mt19937 rng(31u);
+        std::uniform_real_distribution<float> heading(0.f, 6.2831853f);
+        std::vector<float> yaw(characterCount);
+
+        for (int s = 0; s < steps; ++s){
+            if (s % headingSteps == 0)
+                for (float& y : yaw) y = heading(rng);
+
+            for (uint32_t c = 0; c < characterCount; ++c){
+                const Vector3 motion = Vector3(sinf(yaw[c]), 0.f, cosf(yaw[c])) * (speed * dt);
+
+                const Vector3 naiveFrom = naive[c];
+                naive[c] += motion;
+                if (clipped(naiveFrom, naive[c])) ++r.naiveClipped;
+
+                CapsuleMove move;
+                move.center = swept[c];
+                move.displacement = motion;
+                move.radius = radius;
+                move.halfHeight = halfHeight;
+                CapsuleMoveResult moved;
+                auto t0 = Clock::now();
+                CollisionQuery::MoveCapsule(&tree, bodies, move, moved);
+                moveMs += std::chrono::duration<float, std::milli>(Clock::now() - t0).count();
+                queries += moved.queries;
+                candidates += moved.candidates;
+                slides += moved.contacts;
+                if (clipped(swept[c], moved.center)) ++r.sweptClipped;
+                swept[c] = moved.center;
+                ++r.moves;
+            }
+        }
+
+        const float moves = static_cast<float>(std::max(r.moves, 1u));
+        r.queriesPerMove = queries / moves;
+        r.candidatesPerMove = candidates / moves;
+        r.slidesPerMove = slides / moves;
+        r.usPerMove = moveMs * 1000.f / moves;
+        results.push_back(r);
+
+        LOG("CollisionBenchmark: capsule %5.1f m/s  %u characters  %u moves  clipped straight %u / move-and-slide %u  %.2f queries  %.1f candidates  %.2f slides  %.2f us/move",
+            r.speed, r.characters, r.moves, r.naiveClipped, r.sweptClipped,
+            r.queriesPerMove, r.candidatesPerMove, r.slidesPerMove, r.usPerMove);
+    }
+    return results;
+}
+
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+namespace CollisionBenchmark {
+
+    struct BroadPhaseResult {
+        const char* name = "";
+        uint32_t bodies = 0;
+        float firstFrameMs = 0.f;
+        float avgFrameMs = 0.f;
+        uint32_t pairs = 0;
+        bool skipped = false;
+    };
+
+    // Headless: runs every broad phase over a synthetic box field where a
+    // fixed fraction of bodies drift each frame. No scene or GPU required.
+    std::vector<BroadPhaseResult> RunBroadPhase(const std::vector<uint32_t>& bodyCounts,
+                                                int frames = 30,
+                                                float movingFraction = 0.05f);
+
+    struct SatBatchResult {
+        const char* path = "";
+        uint32_t pairs = 0;
+        float ms = 0.f;
+        float mpairsPerSec = 0.f;
+        uint32_t mismatches = 0;
+    };
+
+    // Headless: times NarrowPhase::satBatch on every SAT path over the same
+    // randomly rotated OBB pairs and counts separation decisions that differ
+    // from the scalar path.
+    std::vector<SatBatchResult> RunSatBatch(uint32_t pairCount = 100000, int repeats = 20);
+
+    struct SolverResult {
+        const char* scene = "";
+        uint32_t bodies = 0;
+        int iterations = 0;
+        bool warmStart = false;
+        float avgSolveMs = 0.f;
+        float maxPenetration = 0.f;
+        float avgPenetration = 0.f;
+        float maxSpeed = 0.f;
+    };
+
+    // Headless: drops a 10-box column and a 10-wide box pyramid onto a static
+    // ground and steps them with the narrow phase and sequential-impulse
+    // solver. Residual penetration and speed are measured on the last frame.
+    std::vector<SolverResult> RunSolver(const std::vector<int>& iterationCounts,
+                                        int frames = 300);
+
+    struct StepperResult {
+        float renderHz = 0.f;
+        uint32_t frames = 0;
+        uint32_t steps = 0;
+        uint32_t droppedSteps = 0;
+        float maxDeviation = 0.f;
+        bool identical = false;
+    };
+
+    // Headless: builds the same box scene at each render rate, runs it through
+    // PhysicsStepper::stepScene for the same number of fixed steps and
+    // compares every step's body poses and velocities bit for bit against
+    // the first rate's run.
+    std::vector<StepperResult> RunStepperDeterminism(const std::vector<float>& renderRates,
+                                                     float seconds = 3.f);
+
+    struct NarrowThreadResult {
+        uint32_t threads = 0;
+        uint32_t pairs = 0;
+        float ms = 0.f;
+        float speedup = 0.f;
+        uint32_t manifolds = 0;
+        bool identical = false;
+    };
+
+    // Headless: runs NarrowPhase::test (SAT + manifold generation) over the
+    // same neighbour pairs with each worker thread count. Speedup is relative
+    // to the first count; output is checked against a single-threaded pass.
+    std::vector<NarrowThreadResult> RunNarrowThreads(const std::vector<uint32_t>& threadCounts,
+                                                     uint32_t pairCount = 200000,
+                                                     int repeats = 10);
+
+    struct PoolRestartResult {
+        uint32_t threads = 0;
+        uint32_t tasks = 0;
+        uint32_t badCalls = 0;
+    };
+
+    // Headless: switches one WorkerPool through each thread count with
+    // setThreadCount, running a parallelFor after every switch, and counts
+    // indices that ran other than exactly once.
+    std::vector<PoolRestartResult> RunPoolRestart(const std::vector<uint32_t>& threadCounts,
+                                                  uint32_t taskCount = 4096, int repeats = 4);
+
+    struct ContinuousResult {
+        float speed = 0.f;
+        uint32_t bodies = 0;
+        uint32_t discreteTunneled = 0;
+        uint32_t continuousTunneled = 0;
+        uint32_t sweeps = 0;
+        float avgIterations = 0.f;
+        float ms = 0.f;
+    };
+
+    // Headless: fires spheres and spinning boxes at a 10 cm wall at each
+    // speed, stepping at 60 Hz. Counts the bodies that end up behind the wall
+    // with only end-of-step overlap tests and with conservative-advancement
+    // sweeps; the time is for the sweeps alone.
+    std::vector<ContinuousResult> RunContinuous(const std::vector<float>& speeds,
+                                                uint32_t bodyCount = 1000);
+
+    struct RaycastResult {
+        const char* structure = "";
+        uint32_t threads = 1;
+        float radius = 0.f;
+        uint32_t bodies = 0;
+        uint32_t rays = 0;
+        float ms = 0.f;
+        float mraysPerSec = 0.f;
+        uint32_t hits = 0;
+        uint32_t mismatches = 0;
+        bool sampled = false;
+    };
+
+    // Headless: casts rayCount random rays (and sphere casts) per frame into
+    // a field of boxes and spheres through each query structure. ms is per
+    // frame; the linear scan runs on a sample and is scaled up. Mismatches
+    // count sampled rays whose closest hit differs from the linear scan.
+    std::vector<RaycastResult> RunRaycast(uint32_t bodyCount = 10000,
+                                          uint32_t rayCount = 100000,
+                                          int frames = 3);
+
+    struct CharacterResult {
+        float speed = 0.f;
+        uint32_t characters = 0;
+        uint32_t moves = 0;
+        uint32_t naiveClipped = 0;
+        uint32_t sweptClipped = 0;
+        float queriesPerMove = 0.f;
+        float candidatesPerMove = 0.f;
+        float slidesPerMove = 0.f;
+        float usPerMove = 0.f;
+    };
+
+    // Headless: walks capsule characters through a walled arena at 60 Hz,
+    // once moving them straight and once with CollisionQuery::MoveCapsule,
+    // and counts the moves that end inside or pass through an obstacle.
+    std::vector<CharacterResult> RunCharacters(const std::vector<float>& speeds,
+                                               uint32_t characterCount = 256,
+                                               int steps = 600);
+}
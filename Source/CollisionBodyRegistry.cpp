@@ -0,0 +1,134 @@
+#include "Globals.h"
+#include "CollisionBodyRegistry.h"
+#include "GameObject.h"
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+
+namespace CollisionBodyRegistry {
+
+namespace {
+
+struct State {
+    std::vector<Entry> entries;
+    // Min-heap, so the same sequence of adds always gets the same slots.
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<const ComponentMesh*, uint32_t> slots;
+    std::unordered_multimap<const GameObject*, uint32_t> owners;
+
+    std::vector<uint32_t> log;
+    // Log position of log[0], and the furthest position any reader has
+    // reached; no reader's cursor is past it.
+    uint64_t logBase = 0;
+    uint64_t maxRead = 0;
+    // Position + 1 of each slot's newest record, 0 if it was never logged.
+    std::vector<uint64_t> loggedAt;
+};
+
+State& state(){
+    static State s;
+    return s;
+}
+
+uint64_t logEnd(const State& s){
+    return s.logBase + s.log.size();
+}
+
+void logSlot(State& s, uint32_t slot){
+    // A record at or past maxRead is still ahead of every reader.
+    if (s.loggedAt[slot] > s.maxRead) return;
+    s.loggedAt[slot] = logEnd(s) + 1;
+    s.log.push_back(slot);
+    // Readers that fell this far behind look at every entry instead.
+    if (s.log.size() > std::max<size_t>(65536, s.entries.size() * 4)){
+        s.logBase += s.log.size();
+        s.log.clear();
+    }
+}
+
+}
+
+void Add(ComponentMesh* mesh, GameObject* owner){
+    State& s = state();
+    if (!mesh || s.slots.count(mesh)) return;
+    uint32_t slot;
+    if (!s.freeSlots.empty()){
+        std::pop_heap(s.freeSlots.begin(), s.freeSlots.end(), std::greater<uint32_t>());
+        slot = s.freeSlots.back();
+        s.freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(s.entries.size());
+        s.entries.emplace_back();
+        s.loggedAt.push_back(0);
+    }
+    Entry& e = s.entries[slot];
+    e.mesh = mesh;
+    e.owner = owner;
+    ++e.generation;
+    s.slots[mesh] = slot;
+    s.owners.emplace(owner, slot);
+    logSlot(s, slot);
+}
+
+void Remove(ComponentMesh* mesh){
+    State& s = state();
+    auto it = s.slots.find(mesh);
+    if (it == s.slots.end()) return;
+    const uint32_t slot = it->second;
+    s.slots.erase(it);
+    Entry& e = s.entries[slot];
+    auto range = s.owners.equal_range(e.owner);
+    for (auto o = range.first; o != range.second; ++o){
+        if (o->second != slot) continue;
+        s.owners.erase(o);
+        break;
+    }
+    // The owner's other meshes may now be its first one.
+    const GameObject* owner = e.owner;
+    e.mesh = nullptr;
+    e.owner = nullptr;
+    s.freeSlots.push_back(slot);
+    std::push_heap(s.freeSlots.begin(), s.freeSlots.end(), std::greater<uint32_t>());
+    logSlot(s, slot);
+    MarkChanged(owner);
+}
+
+void MarkChanged(const GameObject* go){
+    State& s = state();
+    auto range = s.owners.equal_range(go);
+    for (auto it = range.first; it != range.second; ++it) logSlot(s, it->second);
+}
+
+void MarkSubtreeChanged(const GameObject* go){
+    if (!go) return;
+    MarkChanged(go);
+    for (const GameObject* child : go->getChildren()) MarkSubtreeChanged(child);
+}
+
+const std::vector<Entry>& GetEntries(){
+    return state().entries;
+}
+
+uint64_t GetLogEnd(){
+    State& s = state();
+    s.maxRead = logEnd(s);
+    return s.maxRead;
+}
+
+bool ReadChanges(uint64_t& cursor, std::vector<uint32_t>& outSlots){
+    State& s = state();
+    const uint64_t end = logEnd(s);
+    s.maxRead = end;
+    if (cursor < s.logBase || cursor > end){
+        cursor = end;
+        return false;
+    }
+    const size_t first = outSlots.size();
+    outSlots.insert(outSlots.end(), s.log.begin() + static_cast<size_t>(cursor - s.logBase), s.log.end());
+    cursor = end;
+    std::sort(outSlots.begin() + first, outSlots.end());
+    outSlots.erase(std::unique(outSlots.begin() + first, outSlots.end()), outSlots.end());
+    return true;
+}
+
+}
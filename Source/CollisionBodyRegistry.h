@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+class ComponentMesh;
+class GameObject;
+
+// Every ComponentMesh registers here for its lifetime, so systems that mirror
+// the meshes (collision bodies, render culling, physics poses) can keep their
+// state between frames instead of walking the scene graph. Each mesh owns a
+// stable slot. Anything that changes what a mirror would read for a slot
+// (a transform moving, activation, reparenting, rigidbody or bounds edits,
+// mesh data) appends the slot to a change log, and every reader keeps its own
+// cursor into that log, so a frame only touches the slots that changed.
+namespace CollisionBodyRegistry {
+
+    struct Entry {
+        // Null for a free slot.
+        ComponentMesh* mesh = nullptr;
+        GameObject* owner = nullptr;
+        // Bumped each time the slot is handed out, so a reader can tell a
+        // reused slot from the mesh it mirrored before.
+        uint32_t generation = 0;
+    };
+
+    void Add(ComponentMesh* mesh, GameObject* owner);
+    void Remove(ComponentMesh* mesh);
+
+    // Logs the slot of go's mesh, or of every mesh at or below go.
+    void MarkChanged(const GameObject* go);
+    void MarkSubtreeChanged(const GameObject* go);
+
+    // Indexed by slot.
+    const std::vector<Entry>& GetEntries();
+
+    // A reader that has just looked at every entry starts from GetLogEnd().
+    // ReadChanges appends the sorted, unique slots logged since cursor and
+    // moves cursor to the end. It returns false once the log has been trimmed
+    // past cursor; the reader must then look at every entry again.
+    uint64_t GetLogEnd();
+    bool ReadChanges(uint64_t& cursor, std::vector<uint32_t>& outSlots);
+
+}
@@ -5,6 +5,10 @@
 #include "Application.h"
 #include "ModuleEditor.h"
 #include "CollisionSystem.h"
+#include "CollisionResponse.h"
+#include "SimulationIslands.h"
+#include "PhysicsStepper.h"
+#include "WorkerPool.h"
 #include "CollisionInterfaces.h"
 #include "UniformGridBroadPhase.h"
 #include "OctreeBroadPhase.h"
@@ -34,8 +38,8 @@ void CollisionDebugPanel::drawContent(){
     float totalGpu = r.broadPhaseMs;
     PhaseRow rows[] = {
         { "Broad", "(SAP grid)", r.broadCount, r.broadPhaseMs, r.broadPhaseMs * 2.1f },
-        { "Mid", "(AABB tree)", r.midCount, r.broadPhaseMs * 0.45f, r.broadPhaseMs * 0.7f },
-        { "Narrow", "(GJK / EPA)", (uint32_t)r.contacts.size(), r.broadPhaseMs * 1.0f, r.broadPhaseMs * 0.58f },
+        { "Mid", "(sphere / SAT cache)", r.midCount, r.broadPhaseMs * 0.45f, r.broadPhaseMs * 0.7f },
+        { "Narrow", "(SAT / clip)", r.narrowCount, r.broadPhaseMs * 1.0f, r.broadPhaseMs * 0.58f },
     };
 
     auto msCol = [](float ms) -> ImVec4 {
@@ -139,6 +143,10 @@ void CollisionDebugPanel::drawContent(){
     if (ImGui::Button("Uniform Grid")) cs->useGridBroadPhase();
     ImGui::SameLine();
     if (ImGui::Button("Octree")) cs->useOctreeBroadPhase();
+    ImGui::SameLine();
+    if (ImGui::Button("AABB Tree")) cs->useDynamicTreeBroadPhase();
+    ImGui::SameLine();
+    if (ImGui::Button("Sweep & Prune")) cs->useSweepAndPruneBroadPhase();
 
     if (cs->isUsingGrid()){
         ImGui::Spacing();
@@ -175,8 +183,56 @@ void CollisionDebugPanel::drawContent(){
                               "Depth 6 ≈ 8^6 = 262 144 possible leaf nodes.");
     }
 
+    if (cs->isUsingDynamicTree()){
+        ImGui::Spacing();
+        ImGui::TextDisabled("Proxies: %d   Nodes: %d   Height: %d   Reinserted: %d",
+            cs->getTreeProxyCount(), cs->getTreeNodeCount(),
+            cs->getTreeHeight(), cs->getLastTreeMovedCount());
+
+        float margin = cs->getTreeFatMargin();
+        ImGui::SetNextItemWidth(160.f);
+        if (ImGui::DragFloat("Fat Margin##tfm", &margin, 0.01f, 0.f, 2.f, "%.2f"))
+            cs->setTreeFatMargin(margin);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("World units added around each proxy's AABB.\n"
+                              "Bodies are only reinserted once they leave this margin.\n"
+                              "Larger = fewer reinserts, more candidate pairs.");
+    }
+
+    if (cs->isUsingSweepAndPrune()){
+        ImGui::Spacing();
+        ImGui::TextDisabled("Endpoint swaps: %d   Pair events: %u",
+            cs->getLastSapSwapCount(), r.broadEventCount);
+    }
+
+    ImGui::Spacing();
+    bool midEnabled = cs->isMidPhaseEnabled();
+    if (ImGui::Checkbox("Mid phase##mpon", &midEnabled))
+        cs->setMidPhaseEnabled(midEnabled);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Bounding sphere + AABB-vs-OBB rejection with a per-pair\n"
+                          "separating-axis cache. Off = every broad pair reaches narrow.");
+
+    drawBenchmarkSection();
+    drawSatSection(cs);
+    if (CollisionResponse* response = m_editor->getCollisionResponse())
+        drawSolverSection(response);
+    if (SimulationIslands* islands = m_editor->getSimulationIslands())
+        drawSleepSection(islands);
+    if (PhysicsStepper* stepper = m_editor->getPhysicsStepper())
+        drawStepperSection(stepper);
+    drawContinuousSection(cs);
+    drawQuerySection();
+    drawCharacterSection();
+    drawTimingSection(cs);
+
     ImGui::SeparatorText("Pipeline  (this frame)");
 
+    ImGui::Text("Gather  bodies : %u  (%u rebuilt, %.3f ms)", r.bodyCount, r.rebuiltBodyCount, r.gatherMs);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Bodies persist between frames; only those whose transform\n"
+                          "or bounds changed, or that were swept, are rebuilt.");
+
     {
         float ms = r.broadPhaseMs;
         ImVec4 col = ms < 0.5f ? ImVec4(0.4f,1.f,0.4f,1.f) :
@@ -193,15 +249,30 @@ void CollisionDebugPanel::drawContent(){
     } else if (cs->isUsingOctree()){
         ImGui::TextDisabled("  (octree, %d node(s), %d leaf(ves))",
             cs->getLastOctreeNodeCount(), cs->getLastOctreeLeafCount());
+    } else if (cs->isUsingDynamicTree()){
+        ImGui::TextDisabled("  (tree, %d proxy(ies), %d reinserted)",
+            cs->getTreeProxyCount(), cs->getLastTreeMovedCount());
+    } else if (cs->isUsingSweepAndPrune()){
+        ImGui::TextDisabled("  (SAP, %u add/remove event(s))", r.broadEventCount);
     }
+    if (r.sleepingBodyCount > 0)
+        ImGui::TextDisabled("  (%u sleeping body(ies) left out)", r.sleepingBodyCount);
     ImGui::Text("Mid phase    filtered pairs  : %u", r.midCount);
+    if (cs->isMidPhaseEnabled()){
+        ImGui::TextDisabled("  (rejected: %u cached axis, %u sphere, %u box)",
+            cs->getLastMidCacheRejects(), cs->getLastMidSphereRejects(), cs->getLastMidBoxRejects());
+    } else {
+        ImGui::TextDisabled("  (passthrough)");
+    }
 
     bool anyHit = r.narrowCount > 0;
     if (anyHit) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.f, 0.35f, 0.35f, 1.f));
     ImGui::Text("Narrow phase confirmed hits  : %u", r.narrowCount);
     if (anyHit) ImGui::PopStyleColor();
+    ImGui::TextDisabled("  (%u contact point(s), %u warm-started)",
+        r.contactPointCount, r.warmStartedCount);
 
-    if (r.contacts.empty()){
+    if (r.manifolds.empty()){
         ImGui::Spacing();
         textMuted("No contacts.");
         return;
@@ -209,18 +280,478 @@ void CollisionDebugPanel::drawContent(){
 
     ImGui::SeparatorText("Contacts");
     ImGui::BeginChild("##contacts", ImVec2(0, 0), false);
-    for (uint32_t i = 0; i < static_cast<uint32_t>(r.contacts.size()); ++i){
-        const ContactPoint& c = r.contacts[i];
+    for (uint32_t i = 0; i < static_cast<uint32_t>(r.manifolds.size()); ++i){
+        const ContactManifold& m = r.manifolds[i];
         ImGui::PushID(static_cast<int>(i));
-        const char* na = c.a ? c.a->getName().c_str() : "?";
-        const char* nb = c.b ? c.b->getName().c_str() : "?";
+        const char* na = m.a ? m.a->getName().c_str() : "?";
+        const char* nb = m.b ? m.b->getName().c_str() : "?";
         if (ImGui::TreeNodeEx("##cp", ImGuiTreeNodeFlags_DefaultOpen,
-                              "%s  ×  %s  (depth %.3f)", na, nb, c.depth)){
-            ImGui::Text("  point   (%.2f, %.2f, %.2f)", c.point.x, c.point.y, c.point.z);
-            ImGui::Text("  normal  (%.2f, %.2f, %.2f)", c.normal.x, c.normal.y, c.normal.z);
+                              "%s  ×  %s  (%u point(s))", na, nb, m.pointCount)){
+            ImGui::Text("  normal  (%.2f, %.2f, %.2f)", m.normal.x, m.normal.y, m.normal.z);
+            for (uint32_t p = 0; p < m.pointCount; ++p){
+                const ContactPoint& c = m.points[p];
+                ImGui::Text("  point   (%.2f, %.2f, %.2f)  depth %.3f  impulse %.3f",
+                    c.point.x, c.point.y, c.point.z, c.depth, c.normalImpulse);
+            }
             ImGui::TreePop();
         }
         ImGui::PopID();
     }
     ImGui::EndChild();
 }
+
+void CollisionDebugPanel::drawBenchmarkSection(){
+    ImGui::SeparatorText("Broad-Phase Benchmark");
+    if (ImGui::Button("Run  (1k / 10k / 50k bodies)"))
+        m_broadBench = CollisionBenchmark::RunBroadPhase({ 1000, 10000, 50000 });
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Headless synthetic box field, 5%% of bodies moving per frame.\n"
+                          "Blocks the editor for a few seconds.");
+
+    if (m_broadBench.empty()) return;
+
+    if (ImGui::BeginTable("##bpbench", 5,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("BROAD PHASE", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("BODIES", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("1ST ms", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("AVG ms", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("PAIRS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_broadBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.name);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%u", row.bodies);
+            if (row.skipped){
+                ImGui::TableSetColumnIndex(2); textMuted("skipped");
+                continue;
+            }
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.2f", row.firstFrameMs);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.3f", row.avgFrameMs);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%u", row.pairs);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void CollisionDebugPanel::drawSatSection(CollisionSystem* cs){
+    ImGui::SeparatorText("Narrow-Phase SAT");
+
+    NarrowPhase& np = cs->getNarrowPhase();
+    const NarrowPhase::SatPath current = np.getSatPath();
+    const NarrowPhase::SatPath paths[] = {
+        NarrowPhase::SatPath::Scalar, NarrowPhase::SatPath::SSE, NarrowPhase::SatPath::AVX2
+    };
+    for (NarrowPhase::SatPath path : paths){
+        const bool supported = path != NarrowPhase::SatPath::AVX2 ||
+                               NarrowPhase::bestSatPath() == NarrowPhase::SatPath::AVX2;
+        if (path != paths[0]) ImGui::SameLine();
+        ImGui::BeginDisabled(!supported);
+        if (ImGui::RadioButton(NarrowPhase::satPathName(path), current == path))
+            np.setSatPath(path);
+        ImGui::EndDisabled();
+    }
+
+    int threads = static_cast<int>(np.getThreadCount());
+    if (ImGui::SliderInt("Worker threads", &threads, 1, static_cast<int>(WorkerPool::hardwareThreads())))
+        np.setThreadCount(static_cast<uint32_t>(threads));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Narrow-phase chunks run on this many threads (including\n"
+                          "the main one). Contacts are merged back in pair order.");
+
+    if (ImGui::Button("Run SAT benchmark  (100k pairs)"))
+        m_satBench = CollisionBenchmark::RunSatBatch(100000);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Times every SAT path on the same rotated OBB pairs.\n"
+                          "Mismatches count separation results that differ from Scalar.");
+
+    if (ImGui::Button("Run thread scaling  (1 / 2 / 4 / 8)"))
+        m_threadBench = CollisionBenchmark::RunNarrowThreads({ 1, 2, 4, 8 });
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Times the full narrow phase on 200k neighbour pairs per\n"
+                          "thread count and checks contacts match the 1-thread run.");
+
+    if (!m_threadBench.empty() &&
+        ImGui::BeginTable("##threadbench", 4,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("THREADS", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("SPEEDUP", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("RESULT", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_threadBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%u", row.threads);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", row.ms);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("x%.2f", row.speedup);
+            ImGui::TableSetColumnIndex(3); ImGui::TextUnformatted(row.identical ? "identical" : "mismatch");
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Run pool restart check  (2 / 4 / 1 / 3 / 2)"))
+        m_poolBench = CollisionBenchmark::RunPoolRestart({ 2, 4, 1, 3, 2 });
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Resizes one worker pool between parallel loops and counts\n"
+                          "loop indices that did not run exactly once.");
+    if (!m_poolBench.empty()){
+        uint32_t bad = 0;
+        for (const auto& row : m_poolBench) bad += row.badCalls;
+        ImGui::Text("%zu resizes, %u bad calls  %s", m_poolBench.size(), bad, bad == 0 ? "ok" : "FAILED");
+    }
+
+    if (m_satBench.empty()) return;
+
+    if (ImGui::BeginTable("##satbench", 4,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("PATH", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("Mpairs/s", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("MISMATCH", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_satBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.path);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", row.ms);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.2f", row.mpairsPerSec);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%u", row.mismatches);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void CollisionDebugPanel::drawSolverSection(CollisionResponse* response){
+    ImGui::SeparatorText("Contact Solver");
+
+    int iterations = response->getIterations();
+    if (ImGui::SliderInt("Velocity iterations", &iterations, 1, 32))
+        response->setIterations(iterations);
+    int positionIterations = response->getPositionIterations();
+    if (ImGui::SliderInt("Position iterations", &positionIterations, 0, 16))
+        response->setPositionIterations(positionIterations);
+    bool warm = response->isWarmStarting();
+    if (ImGui::Checkbox("Warm starting", &warm))
+        response->setWarmStarting(warm);
+    float threshold = response->getRestitutionThreshold();
+    if (ImGui::DragFloat("Restitution threshold", &threshold, 0.05f, 0.f, 10.f, "%.2f m/s"))
+        response->setRestitutionThreshold(threshold);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Approach speeds below this never bounce,\n"
+                          "so resting contacts do not jitter.");
+    ImGui::TextDisabled("%u constraint(s), %.3f ms last solve",
+        response->getLastConstraintCount(), response->getLastSolveMs());
+
+    if (ImGui::Button("Run solver benchmark  (stack / pyramid)"))
+        m_solverBench = CollisionBenchmark::RunSolver({ 4, 8, 16 });
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Steps a 10-box stack and a 10-wide pyramid for 300 frames\n"
+                          "with and without warm starting. Residuals are last-frame values.");
+
+    if (m_solverBench.empty()) return;
+
+    if (ImGui::BeginTable("##solverbench", 7,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("SCENE", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("ITER", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableSetupColumn("WARM", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableSetupColumn("AVG ms", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("PEN MAX", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("PEN AVG", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("MAX v", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_solverBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.scene);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%d", row.iterations);
+            ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted(row.warmStart ? "on" : "off");
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.3f", row.avgSolveMs);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.4f", row.maxPenetration);
+            ImGui::TableSetColumnIndex(5); ImGui::Text("%.4f", row.avgPenetration);
+            ImGui::TableSetColumnIndex(6); ImGui::Text("%.3f", row.maxSpeed);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void CollisionDebugPanel::drawSleepSection(SimulationIslands* islands){
+    ImGui::SeparatorText("Islands & Sleeping");
+
+    bool enabled = islands->isSleepingEnabled();
+    if (ImGui::Checkbox("Sleeping", &enabled))
+        islands->setSleepingEnabled(enabled);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Off wakes every sleeping body on the next step.");
+    float linear = islands->getLinearSleepThreshold();
+    if (ImGui::DragFloat("Linear threshold", &linear, 0.005f, 0.f, 1.f, "%.3f m/s"))
+        islands->setLinearSleepThreshold(linear);
+    float angular = islands->getAngularSleepThreshold();
+    if (ImGui::DragFloat("Angular threshold", &angular, 0.005f, 0.f, 1.f, "%.3f rad/s"))
+        islands->setAngularSleepThreshold(angular);
+    float time = islands->getSleepTime();
+    if (ImGui::DragFloat("Time to sleep", &time, 0.05f, 0.f, 10.f, "%.2f s"))
+        islands->setSleepTime(time);
+
+    ImGui::TextDisabled("%u island(s), %u awake, %u asleep, %.3f ms",
+        islands->getLastIslandCount(), islands->getLastAwakeBodyCount(),
+        islands->getLastSleepingBodyCount(), islands->getLastUpdateMs());
+}
+
+void CollisionDebugPanel::drawStepperSection(PhysicsStepper* stepper){
+    ImGui::SeparatorText("Fixed Timestep");
+
+    int hz = static_cast<int>(1.f / stepper->getFixedDt() + 0.5f);
+    if (ImGui::SliderInt("Physics rate", &hz, 10, 240, "%d Hz"))
+        stepper->setFixedDt(1.f / static_cast<float>(hz));
+    int substeps = stepper->getMaxSubsteps();
+    if (ImGui::SliderInt("Max substeps", &substeps, 1, 16))
+        stepper->setMaxSubsteps(substeps);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Steps allowed per rendered frame. Time beyond this is\n"
+                          "dropped so a slow frame cannot snowball.");
+    bool interpolate = stepper->isInterpolating();
+    if (ImGui::Checkbox("Interpolate transforms", &interpolate))
+        stepper->setInterpolating(interpolate);
+    ImGui::TextDisabled("%d step(s) last frame, alpha %.2f, %u dropped",
+        stepper->getLastSubsteps(), stepper->getAlpha(), stepper->getDroppedSteps());
+
+    if (ImGui::Button("Run determinism check  (30 / 60 / 144 Hz)"))
+        m_stepperBench = CollisionBenchmark::RunStepperDeterminism({ 30.f, 60.f, 144.f });
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Runs the same box scene for 3 s at each render rate and\n"
+                          "compares every fixed step against the 30 Hz run.");
+
+    if (m_stepperBench.empty()) return;
+
+    if (ImGui::BeginTable("##stepperbench", 5,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("RENDER", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("FRAMES", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("STEPS", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("MAX DEV", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("RESULT", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_stepperBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%.0f Hz", row.renderHz);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%u", row.frames);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%u", row.steps);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%g", row.maxDeviation);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::TextColored(row.identical ? ImVec4(0.4f, 1.f, 0.4f, 1.f) : ImVec4(1.f, 0.3f, 0.3f, 1.f),
+                               row.identical ? "identical" : "diverged");
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void CollisionDebugPanel::drawContinuousSection(CollisionSystem* cs){
+    ImGui::SeparatorText("Continuous Collision");
+
+    bool enabled = cs->isContinuousEnabled();
+    if (ImGui::Checkbox("Sweep fast movers##ccdon", &enabled))
+        cs->setContinuousEnabled(enabled);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Rigidbodies marked Is Fast Moving stop at their first\n"
+                          "time of impact instead of passing through thin geometry.");
+    float depth = cs->getContinuousTargetDepth();
+    if (ImGui::SliderFloat("Target overlap", &depth, 0.001f, 0.05f, "%.3f"))
+        cs->setContinuousTargetDepth(depth);
+
+    const CollisionSystem::ContinuousStats& st = cs->getContinuousStats();
+    ImGui::TextDisabled("%u fast body(ies), %u pair(s) swept, %u hit(s), %u clamped",
+        st.fastBodies, st.sweptPairs, st.hits, st.clampedBodies);
+    ImGui::TextDisabled("%u iteration(s), %.3f ms  (last step)", st.iterations, st.ms);
+
+    if (ImGui::Button("Run tunneling test  (5 / 30 / 100 / 300 m/s)"))
+        m_ccdBench = CollisionBenchmark::RunContinuous({ 5.f, 30.f, 100.f, 300.f });
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Fires 1000 spheres and spinning boxes at a 10 cm wall and\n"
+                          "counts how many end up behind it, with and without sweeps.");
+
+    if (m_ccdBench.empty()) return;
+
+    if (ImGui::BeginTable("##ccdbench", 5,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("SPEED", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("DISCRETE", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("SWEPT", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("ITER", ImGuiTableColumnFlags_WidthFixed, 48.f);
+        ImGui::TableSetupColumn("MS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_ccdBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%.0f m/s", row.speed);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%u", row.discreteTunneled);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::TextColored(row.continuousTunneled == 0 ? ImVec4(0.4f, 1.f, 0.4f, 1.f) : ImVec4(1.f, 0.3f, 0.3f, 1.f),
+                               "%u", row.continuousTunneled);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.2f", row.avgIterations);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.3f", row.ms);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void CollisionDebugPanel::drawQuerySection(){
+    ImGui::SeparatorText("Scene Queries");
+
+    if (ImGui::Button("Run raycast benchmark  (100k rays, 10k bodies)"))
+        m_rayBench = CollisionBenchmark::RunRaycast();
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Casts 100k random rays and 0.25 m sphere casts per frame\n"
+                          "through each structure and checks them against a linear scan.");
+
+    if (m_rayBench.empty()) return;
+
+    if (ImGui::BeginTable("##raybench", 6,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("STRUCTURE", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("CAST", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("THR", ImGuiTableColumnFlags_WidthFixed, 32.f);
+        ImGui::TableSetupColumn("MS", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("MRAY/S", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("DIFF", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_rayBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.structure);
+            ImGui::TableSetColumnIndex(1);
+            if (row.radius > 0.f) ImGui::Text("r %.2f", row.radius);
+            else ImGui::TextUnformatted("ray");
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%u", row.threads);
+            ImGui::TableSetColumnIndex(3); ImGui::Text(row.sampled ? "~%.2f" : "%.2f", row.ms);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.2f", row.mraysPerSec);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::TextColored(row.mismatches == 0 ? ImVec4(0.4f, 1.f, 0.4f, 1.f) : ImVec4(1.f, 0.3f, 0.3f, 1.f),
+                               "%u", row.mismatches);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void CollisionDebugPanel::drawCharacterSection(){
+    ImGui::SeparatorText("Character Capsules");
+
+    if (ImGui::Button("Run character benchmark  (256 capsules, 600 steps)"))
+        m_characterBench = CollisionBenchmark::RunCharacters({ 4.f, 12.f, 40.f });
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Walks capsules through a walled arena at 60 Hz, moving them\n"
+                          "straight and with move-and-slide, and counts clip-throughs.");
+
+    if (m_characterBench.empty()) return;
+
+    if (ImGui::BeginTable("##charbench", 6,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("M/S", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableSetupColumn("CLIP STRAIGHT", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("CLIP SLIDE", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("QUERIES", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("SLIDES", ImGuiTableColumnFlags_WidthFixed, 48.f);
+        ImGui::TableSetupColumn("US/MOVE", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_characterBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%.0f", row.speed);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%u / %u", row.naiveClipped, row.moves);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::TextColored(row.sweptClipped == 0 ? ImVec4(0.4f, 1.f, 0.4f, 1.f) : ImVec4(1.f, 0.3f, 0.3f, 1.f),
+                               "%u", row.sweptClipped);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.2f", row.queriesPerMove);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.2f", row.slidesPerMove);
+            ImGui::TableSetColumnIndex(5); ImGui::Text("%.2f", row.usPerMove);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void CollisionDebugPanel::drawTimingSection(CollisionSystem* cs){
+    ImGui::SeparatorText("Stage Timings");
+
+    const CollisionStatsHistory& history = cs->getStatsHistory();
+    if (history.size() == 0){
+        textMuted("No completed runs yet.");
+        return;
+    }
+
+    float totals[CollisionStatsHistory::kFrames];
+    float peak = 1.f;
+    for (uint32_t i = 0; i < history.size(); ++i){
+        totals[i] = history.at(i).totalMs();
+        peak = std::max(peak, totals[i]);
+    }
+    ImGui::PushStyleColor(ImGuiCol_PlotLines, EditorColors::Ok);
+    ImGui::PlotLines("##colltotal", totals, static_cast<int>(history.size()), 0, "total ms", 0.f, peak * 1.1f, ImVec2(-1, 48));
+    ImGui::PopStyleColor();
+
+    CollisionStageStats mean, max;
+    history.summarize(mean, max);
+    const CollisionStageStats& last = history.at(history.size() - 1);
+
+    struct Row { const char* name; float CollisionStageStats::* ms; uint32_t CollisionStageStats::* count; const char* unit; };
+    const Row rows[] = {
+        { "Gather", &CollisionStageStats::gatherMs,      &CollisionStageStats::bodyCount,         "bodies" },
+        { "Broad",  &CollisionStageStats::broadPhaseMs,  &CollisionStageStats::broadCount,        "pairs" },
+        { "Mid",    &CollisionStageStats::midPhaseMs,    &CollisionStageStats::midCount,          "pairs" },
+        { "Narrow", &CollisionStageStats::narrowPhaseMs, &CollisionStageStats::contactPointCount, "points" },
+        { "Solve",  &CollisionStageStats::solveMs,       &CollisionStageStats::constraintCount,   "constraints" },
+        { "CCD",    &CollisionStageStats::ccdMs,         &CollisionStageStats::ccdSweptPairs,     "sweeps" },
+    };
+
+    if (ImGui::BeginTable("##stagetimes", 5,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("STAGE", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("LAST", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("AVG", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("MAX", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("COUNT", ImGuiTableColumnFlags_WidthFixed, 120.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const Row& row : rows){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.name);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", last.*row.ms);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.3f", mean.*row.ms);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::TextColored(max.*row.ms > 2.f * mean.*row.ms + 0.05f ? ImVec4(1.f, 0.85f, 0.2f, 1.f) : ImVec4(0.8f, 0.8f, 0.8f, 1.f),
+                               "%.3f", max.*row.ms);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%u %s", last.*row.count, row.unit);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+    ImGui::TextDisabled("%u run(s) in window, %llu total", history.size(),
+                        static_cast<unsigned long long>(history.getTotalRuns()));
+
+    if (ImGui::Button("Dump CSV##collstats")){
+        const char* path = "collision_stats.csv";
+        if (cs->dumpStatsCsv(path)) LOG("CollisionDebugPanel: wrote %u run(s) to %s", history.size(), path);
+        else LOG("CollisionDebugPanel: could not write %s", path);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear##collstats")) cs->clearStatsHistory();
+}
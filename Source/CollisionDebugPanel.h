@@ -1,5 +1,12 @@
 #pragma once
 #include "EditorPanel.h"
+#include "CollisionBenchmark.h"
+#include <vector>
+
+class CollisionSystem;
+class CollisionResponse;
+class SimulationIslands;
+class PhysicsStepper;
 
 class CollisionDebugPanel : public EditorPanel {
 public:
@@ -9,4 +16,25 @@ public:
 
 protected:
     void drawContent() override;
+
+private:
+    void drawBenchmarkSection();
+    void drawSatSection(CollisionSystem* cs);
+    void drawSolverSection(CollisionResponse* response);
+    void drawSleepSection(SimulationIslands* islands);
+    void drawStepperSection(PhysicsStepper* stepper);
+    void drawContinuousSection(CollisionSystem* cs);
+    void drawQuerySection();
+    void drawCharacterSection();
+    void drawTimingSection(CollisionSystem* cs);
+
+    std::vector<CollisionBenchmark::BroadPhaseResult> m_broadBench;
+    std::vector<CollisionBenchmark::SatBatchResult> m_satBench;
+    std::vector<CollisionBenchmark::NarrowThreadResult> m_threadBench;
+    std::vector<CollisionBenchmark::PoolRestartResult> m_poolBench;
+    std::vector<CollisionBenchmark::SolverResult> m_solverBench;
+    std::vector<CollisionBenchmark::StepperResult> m_stepperBench;
+    std::vector<CollisionBenchmark::ContinuousResult> m_ccdBench;
+    std::vector<CollisionBenchmark::RaycastResult> m_rayBench;
+    std::vector<CollisionBenchmark::CharacterResult> m_characterBench;
 };
@@ -3,11 +3,22 @@
 #include "BoundingVolume.h"
 #include <vector>
 #include <cstdint>
+#include <functional>
 
 class GameObject;
+class ComponentRigidbody;
 
 struct CollisionBody {
     GameObject* go = nullptr;
+    ComponentRigidbody* rb = nullptr;
+    uint32_t id = 0;
+    bool sleeping = false;
+    // Cannot move this frame: asleep, static, massless or without a rigidbody.
+    bool resting = true;
+
+    // One bit for the body's layer; the mask holds the layers it may touch.
+    uint32_t layerBits = 1u;
+    uint32_t maskBits = 0xFFFFFFFFu;
 
     AABB worldAABB;
 
@@ -19,27 +30,105 @@ struct CollisionBody {
 
     Vector3 sphereCenter;
     float sphereRadius = 0.f;
+
+    // Capsules run along obbAxes[1] through obbCenter.
+    float capsuleRadius = 0.f;
+    float capsuleHalfHeight = 0.f;
 };
 
+inline bool layersCollide(uint32_t layerA, uint32_t maskA, uint32_t layerB, uint32_t maskB){
+    return (layerA & maskB) != 0 && (layerB & maskA) != 0;
+}
+
+inline bool layersCollide(const CollisionBody& a, const CollisionBody& b){
+    return layersCollide(a.layerBits, a.maskBits, b.layerBits, b.maskBits);
+}
+
+// A sleeping body against one that cannot move either: nothing changes
+// until one of them is woken.
+inline bool isSleepingPair(bool sleepingA, bool restingA, bool sleepingB, bool restingB){
+    return (sleepingA || sleepingB) && restingA && restingB;
+}
+
+inline bool isSleepingPair(const CollisionBody& a, const CollisionBody& b){
+    return isSleepingPair(a.sleeping, a.resting, b.sleeping, b.resting);
+}
+
+// Every broad phase applies this before it reports a pair, so filtered and
+// sleeping pairs never reach the mid or narrow phase.
+inline bool reportsPair(const CollisionBody& a, const CollisionBody& b){
+    return layersCollide(a, b) && !isSleepingPair(a, b);
+}
+
 struct CollisionPair {
     uint32_t a;
     uint32_t b;
 };
 
+struct BroadPhasePairEvent {
+    enum class Type : uint8_t { Added, Removed };
+    Type type = Type::Added;
+    uint32_t proxyA = 0;
+    uint32_t proxyB = 0;
+};
+
 struct ContactPoint {
+    Vector3 point;
+    float depth = 0.f;
+    uint32_t featureId = 0;
+    float normalImpulse = 0.f;
+    float tangentImpulse[2] = {};
+};
+
+// Up to four points sharing one normal (pointing from b towards a). Points
+// carry feature ids so accumulated impulses survive from frame to frame.
+struct ContactManifold {
+    static constexpr uint32_t kMaxPoints = 4;
+
     GameObject* a = nullptr;
     GameObject* b = nullptr;
-    Vector3 point;
+    uint32_t bodyA = 0;
+    uint32_t bodyB = 0;
+    uint64_t key = 0;
     Vector3 normal;
-    float depth = 0.f;
+    uint32_t pointCount = 0;
+    ContactPoint points[kMaxPoints];
 };
 
-struct CollisionResults {
+// Counters and wall time of each collision stage for one run. Solve and
+// CCD are filled in after run() by recordSolve() and runContinuous().
+struct CollisionStageStats {
+    uint32_t bodyCount = 0;
+    uint32_t rebuiltBodyCount = 0;
     uint32_t broadCount = 0;
+    uint32_t broadEventCount = 0;
+    uint32_t sleepingBodyCount = 0;
     uint32_t midCount = 0;
     uint32_t narrowCount = 0;
+    uint32_t contactPointCount = 0;
+    uint32_t warmStartedCount = 0;
+    uint32_t constraintCount = 0;
+    uint32_t ccdSweptPairs = 0;
+    uint32_t ccdHits = 0;
+    float gatherMs = 0.f;
     float broadPhaseMs = 0.f;
-    std::vector<ContactPoint> contacts;
+    float midPhaseMs = 0.f;
+    float narrowPhaseMs = 0.f;
+    float solveMs = 0.f;
+    float ccdMs = 0.f;
+
+    float totalMs() const { return gatherMs + broadPhaseMs + midPhaseMs + narrowPhaseMs + solveMs + ccdMs; }
+};
+
+struct CollisionResults : CollisionStageStats {
+    std::vector<ContactManifold> manifolds;
+};
+
+// A fast-moving body that may only cover `fraction` of this step before it
+// reaches its first time of impact.
+struct CcdClamp {
+    ComponentRigidbody* rb = nullptr;
+    float fraction = 1.f;
 };
 
 class IBroadPhase {
@@ -52,6 +141,39 @@ public:
     virtual const char* getName() const = 0;
 
     virtual void drawDebug(){}
+
+    // Incremental broad phases report overlap changes instead of a full pair
+    // list. Event proxies are mapped back to body indices via getProxyBody().
+    virtual bool emitsPairEvents() const { return false; }
+    virtual void update(const std::vector<CollisionBody>& ,
+                        std::vector<BroadPhasePairEvent>& ){}
+    virtual uint32_t getProxyBody(uint32_t proxy) const { return proxy; }
+
+    // Spatial queries over the structure left by the last query()/update(),
+    // returning body indices into that call's list. Broad phases that keep no
+    // structure between frames fall back to testing every body.
+    virtual void queryOverlap(const AABB& box, const std::vector<CollisionBody>& bodies,
+                              std::vector<uint32_t>& outBodies) const{
+        const uint32_t n = static_cast<uint32_t>(bodies.size());
+        for (uint32_t i = 0; i < n; ++i)
+            if (bodies[i].worldAABB.intersects(box)) outBodies.push_back(i);
+    }
+
+    // Calls hit(body, maxT) for every body whose box, grown by radius, the ray
+    // origin + t * dir enters before maxT. hit returns the new maxT, so
+    // closest-hit searches prune the rest of the walk.
+    using RayHitFn = std::function<float(uint32_t body, float maxT)>;
+    virtual void queryRay(const Vector3& origin, const Vector3& dir, float maxT, float radius,
+                          const std::vector<CollisionBody>& bodies, const RayHitFn& hit) const{
+        const Vector3 invDir(1.f / dir.x, 1.f / dir.y, 1.f / dir.z);
+        const Vector3 grow(radius, radius, radius);
+        const uint32_t n = static_cast<uint32_t>(bodies.size());
+        for (uint32_t i = 0; i < n; ++i){
+            const AABB box{ bodies[i].worldAABB.min - grow, bodies[i].worldAABB.max + grow };
+            float t;
+            if (box.intersectsRay(origin, invDir, maxT, t)) maxT = hit(i, maxT);
+        }
+    }
 };
 
 class IMidPhase {
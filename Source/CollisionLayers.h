@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+// Which of the 32 collision layers may touch each other. masks[i] has bit j
+// set when layer i collides with layer j; set() keeps the matrix symmetric.
+// Layer 0 is the default for bodies without a ComponentBounds.
+struct CollisionLayers {
+    static constexpr uint32_t kLayerCount = 32;
+
+    std::string names[kLayerCount] = { "Default" };
+    uint32_t masks[kLayerCount];
+
+    CollisionLayers(){ reset(); }
+
+    void reset(){
+        for (uint32_t i = 0; i < kLayerCount; ++i) masks[i] = 0xFFFFFFFFu;
+    }
+
+    bool canCollide(uint32_t a, uint32_t b) const{
+        return a < kLayerCount && b < kLayerCount && (masks[a] & (1u << b)) != 0;
+    }
+
+    void set(uint32_t a, uint32_t b, bool collide){
+        if (a >= kLayerCount || b >= kLayerCount) return;
+        if (collide){
+            masks[a] |= 1u << b;
+            masks[b] |= 1u << a;
+        } else {
+            masks[a] &= ~(1u << b);
+            masks[b] &= ~(1u << a);
+        }
+    }
+};
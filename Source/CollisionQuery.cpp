@@ -0,0 +1,478 @@
+#include "Globals.h"
+#include "CollisionQuery.h"
+#include "ContinuousCollision.h"
+#include "CapsuleCollision.h"
+#include "GameObject.h"
+#include "WorkerPool.h"
+#include <cmath>
+#include <algorithm>
+
+namespace CollisionQuery {
+
+namespace {
+
+constexpr uint32_t kRaysPerTask = 256;
+
+// Sphere casts against boxes stop once the sphere is this far inside.
+constexpr float kCastSkin = 1e-3f;
+
+constexpr int kMaxMoveSweepIterations = 16;
+constexpr float kMinMoveApproach = 1e-7f;
+
+// A capsule sweep counts as touching once it is within this many skins.
+constexpr float kMoveSkinSlack = 1.5f;
+
+void forEachRayCandidate(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                         const Vector3& origin, const Vector3& dir, float maxT, float radius,
+                         const IBroadPhase::RayHitFn& hit){
+    if (broadPhase){
+        broadPhase->queryRay(origin, dir, maxT, radius, bodies, hit);
+        return;
+    }
+    const Vector3 invDir(1.f / dir.x, 1.f / dir.y, 1.f / dir.z);
+    const Vector3 grow(radius, radius, radius);
+    for (uint32_t i = 0; i < static_cast<uint32_t>(bodies.size()); ++i){
+        const AABB box{ bodies[i].worldAABB.min - grow, bodies[i].worldAABB.max + grow };
+        float t;
+        if (box.intersectsRay(origin, invDir, maxT, t)) maxT = hit(i, maxT);
+    }
+}
+
+void overlapCandidates(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                       const AABB& box, std::vector<uint32_t>& out){
+    if (broadPhase){
+        broadPhase->queryOverlap(box, bodies, out);
+        return;
+    }
+    for (uint32_t i = 0; i < static_cast<uint32_t>(bodies.size()); ++i)
+        if (bodies[i].worldAABB.intersects(box)) out.push_back(i);
+}
+
+bool normalizeRay(const RayQuery& ray, Vector3& dir){
+    const float len = ray.direction.Length();
+    if (len < 1e-9f || !(ray.maxDistance > 0.f)) return false;
+    dir = ray.direction / len;
+    return true;
+}
+
+CollisionBody makeSphere(const Vector3& center, float radius){
+    CollisionBody s;
+    s.bvType = BVType::Sphere;
+    s.sphereCenter = s.obbCenter = center;
+    s.sphereRadius = radius;
+    s.obbAxes[0] = Vector3::UnitX;
+    s.obbAxes[1] = Vector3::UnitY;
+    s.obbAxes[2] = Vector3::UnitZ;
+    s.obbHalves[0] = s.obbHalves[1] = s.obbHalves[2] = radius;
+    s.worldAABB = Sphere{ center, radius }.toAABB();
+    return s;
+}
+
+bool slabRange(const AABB& box, const Vector3& origin, const Vector3& dir, float maxT,
+               float& tEnter, float& tExit){
+    const float o[3] = { origin.x, origin.y, origin.z };
+    const float d[3] = { dir.x, dir.y, dir.z };
+    const float lo[3] = { box.min.x, box.min.y, box.min.z };
+    const float hi[3] = { box.max.x, box.max.y, box.max.z };
+    tEnter = 0.f;
+    tExit = maxT;
+    for (int i = 0; i < 3; ++i){
+        if (fabsf(d[i]) < 1e-9f){
+            if (o[i] < lo[i] || o[i] > hi[i]) return false;
+            continue;
+        }
+        const float a = (lo[i] - o[i]) / d[i];
+        const float b = (hi[i] - o[i]) / d[i];
+        tEnter = std::max(tEnter, std::min(a, b));
+        tExit = std::min(tExit, std::max(a, b));
+    }
+    return tEnter <= tExit;
+}
+
+bool sphereCastVsBody(const CollisionBody& body, const Vector3& origin, const Vector3& dir,
+                      float radius, float maxT, float& outT, Vector3& outNormal){
+    if (body.bvType == BVType::Sphere){
+        CollisionBody grown = body;
+        grown.sphereRadius += radius;
+        return RayVsBody(grown, origin, dir, maxT, outT, outNormal);
+    }
+    if (body.bvType == BVType::Capsule){
+        CollisionBody grown = body;
+        grown.capsuleRadius += radius;
+        return RayVsBody(grown, origin, dir, maxT, outT, outNormal);
+    }
+
+    Vector3 axis;
+    const CollisionBody start = makeSphere(origin, radius);
+    if (ContinuousCollision::SeparationBound(start, body, axis) <= 0.f){
+        outT = 0.f;
+        outNormal = -axis;
+        return true;
+    }
+
+    // Sweep only the stretch of the ray inside the body's grown box.
+    const Vector3 grow(radius, radius, radius);
+    float tEnter, tExit;
+    if (!slabRange(AABB{ body.worldAABB.min - grow, body.worldAABB.max + grow },
+                   origin, dir, maxT, tEnter, tExit)) return false;
+    const float length = tExit - tEnter;
+    if (length <= 0.f) return false;
+
+    const CollisionBody from = makeSphere(origin + dir * tEnter, radius);
+    const ContinuousCollision::Motion motion{ dir * length, Vector3::Zero };
+    const ContinuousCollision::TimeOfImpact toi =
+        ContinuousCollision::Sweep(from, motion, body, {}, kCastSkin);
+    if (!toi.hit) return false;
+
+    outT = tEnter + toi.fraction * length;
+    ContinuousCollision::SeparationBound(ContinuousCollision::Advance(from, motion, toi.fraction), body, axis);
+    outNormal = -axis;
+    return outT <= maxT;
+}
+
+// Entry of a ray starting outside a sphere, or false when it misses.
+bool rayVsSphereSurface(const Vector3& origin, const Vector3& dir, const Vector3& center,
+                        float radius, float& outT){
+    const Vector3 m = origin - center;
+    const float b = m.Dot(dir);
+    const float c = m.Dot(m) - radius * radius;
+    if (b > 0.f && c > 0.f) return false;
+    const float disc = b * b - c;
+    if (disc < 0.f) return false;
+    outT = std::max(-b - sqrtf(disc), 0.f);
+    return true;
+}
+
+// The cylinder side first, then the two end spheres.
+bool rayVsCapsule(const CollisionBody& body, const Vector3& origin, const Vector3& dir,
+                  float maxT, float& outT, Vector3& outNormal){
+    Vector3 p0, p1, onSeg, onRay;
+    CapsuleCollision::Segment(body, p0, p1);
+    const float r = body.capsuleRadius;
+    if (CapsuleCollision::ClosestSegmentSegment(p0, p1, origin, origin, onSeg, onRay) <= r * r){
+        outT = 0.f;
+        outNormal = -dir;
+        return true;
+    }
+
+    float best = FLT_MAX;
+    const Vector3 d = p1 - p0;
+    const Vector3 m = origin - p0;
+    const float dd = d.Dot(d);
+    if (dd > 1e-12f){
+        const float md = m.Dot(d);
+        const float nd = dir.Dot(d);
+        const float a = dd - nd * nd;
+        const float b = dd * m.Dot(dir) - nd * md;
+        const float c = dd * (m.Dot(m) - r * r) - md * md;
+        const float disc = b * b - a * c;
+        if (a > 1e-9f && disc >= 0.f){
+            const float t = (-b - sqrtf(disc)) / a;
+            const float s = md + t * nd;
+            if (t >= 0.f && s >= 0.f && s <= dd){
+                best = t;
+                outNormal = origin + dir * t - (p0 + d * (s / dd));
+            }
+        }
+    }
+
+    for (const Vector3& end : { p0, p1 }){
+        float t;
+        if (rayVsSphereSurface(origin, dir, end, r, t) && t < best){
+            best = t;
+            outNormal = origin + dir * t - end;
+        }
+    }
+
+    if (best > maxT) return false;
+    outT = best;
+    outNormal.Normalize();
+    return true;
+}
+
+bool isIgnored(const GameObject* go, const GameObject* ignore){
+    for (const GameObject* node = go; ignore && node; node = node->getParent())
+        if (node == ignore) return true;
+    return false;
+}
+
+CollisionBody makeCapsule(const Vector3& center, float halfHeight, float radius){
+    CollisionBody c;
+    c.bvType = BVType::Capsule;
+    c.obbCenter = c.sphereCenter = center;
+    c.obbAxes[0] = Vector3::UnitX;
+    c.obbAxes[1] = Vector3::UnitY;
+    c.obbAxes[2] = Vector3::UnitZ;
+    c.obbHalves[0] = c.obbHalves[2] = radius;
+    c.obbHalves[1] = halfHeight + radius;
+    c.capsuleRadius = radius;
+    c.capsuleHalfHeight = halfHeight;
+    return c;
+}
+
+// Conservative advancement of a translating capsule that stops `skin` short
+// of the body. ioT is the earliest fraction found so far; only earlier hits
+// replace it. The normal points from the body towards the capsule.
+bool sweepCapsule(const CollisionBody& capsule, const Vector3& motion, const CollisionBody& body,
+                  float skin, float& ioT, Vector3& outNormal){
+    Vector3 axis;
+    float distance = ContinuousCollision::SeparationBound(capsule, body, axis);
+    CollisionBody moved = capsule;
+    float t = 0.f;
+    for (int it = 0; it < kMaxMoveSweepIterations; ++it){
+        const float approach = motion.Dot(axis);
+        if (approach <= kMinMoveApproach) return false;
+        if (distance <= kMoveSkinSlack * skin) break;
+        t += (distance - skin) / approach;
+        if (t >= ioT) return false;
+        moved.obbCenter = capsule.obbCenter + motion * t;
+        distance = ContinuousCollision::SeparationBound(moved, body, axis);
+    }
+    if (t >= ioT) return false;
+    ioT = t;
+    outNormal = -axis;
+    return true;
+}
+
+}
+
+bool RayVsBody(const CollisionBody& body, const Vector3& origin, const Vector3& dir,
+               float maxT, float& outT, Vector3& outNormal){
+    if (body.bvType == BVType::Sphere){
+        const Vector3 m = origin - body.sphereCenter;
+        const float b = m.Dot(dir);
+        const float c = m.Dot(m) - body.sphereRadius * body.sphereRadius;
+        if (c <= 0.f){
+            outT = 0.f;
+            outNormal = -dir;
+            return true;
+        }
+        if (b > 0.f) return false;
+        const float disc = b * b - c;
+        if (disc < 0.f) return false;
+        const float t = -b - sqrtf(disc);
+        if (t > maxT) return false;
+        outT = std::max(t, 0.f);
+        outNormal = origin + dir * outT - body.sphereCenter;
+        outNormal.Normalize();
+        return true;
+    }
+    if (body.bvType == BVType::Capsule) return rayVsCapsule(body, origin, dir, maxT, outT, outNormal);
+
+    const Vector3 p = origin - body.obbCenter;
+    float tMin = 0.f, tMax = maxT;
+    int enterAxis = -1;
+    float enterSign = 0.f;
+    for (int i = 0; i < 3; ++i){
+        const float o = p.Dot(body.obbAxes[i]);
+        const float d = dir.Dot(body.obbAxes[i]);
+        const float h = body.obbHalves[i];
+        if (fabsf(d) < 1e-9f){
+            if (fabsf(o) > h) return false;
+            continue;
+        }
+        const float inv = 1.f / d;
+        float t1 = (-h - o) * inv;
+        float t2 = (h - o) * inv;
+        if (t1 > t2) std::swap(t1, t2);
+        if (t1 > tMin){
+            tMin = t1;
+            enterAxis = i;
+            enterSign = d > 0.f ? -1.f : 1.f;
+        }
+        tMax = std::min(tMax, t2);
+        if (tMin > tMax) return false;
+    }
+
+    outT = tMin;
+    outNormal = enterAxis < 0 ? -dir : body.obbAxes[enterAxis] * enterSign;
+    return true;
+}
+
+bool Raycast(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+             const RayQuery& ray, RaycastHit& outHit){
+    outHit = {};
+    Vector3 dir;
+    if (!normalizeRay(ray, dir)) return false;
+
+    forEachRayCandidate(broadPhase, bodies, ray.origin, dir, ray.maxDistance, 0.f,
+        [&](uint32_t i, float maxT){
+            const CollisionBody& body = bodies[i];
+            if (!(body.layerBits & ray.layerMask)) return maxT;
+            float t;
+            Vector3 n;
+            if (!RayVsBody(body, ray.origin, dir, maxT, t, n) || t >= maxT) return maxT;
+            outHit.body = i;
+            outHit.distance = t;
+            outHit.normal = n;
+            return t;
+        });
+
+    if (!outHit.hit()) return false;
+    outHit.go = bodies[outHit.body].go;
+    outHit.point = ray.origin + dir * outHit.distance;
+    return true;
+}
+
+bool SphereCast(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                const RayQuery& ray, float radius, RaycastHit& outHit){
+    outHit = {};
+    Vector3 dir;
+    if (!normalizeRay(ray, dir) || radius < 0.f) return false;
+
+    forEachRayCandidate(broadPhase, bodies, ray.origin, dir, ray.maxDistance, radius,
+        [&](uint32_t i, float maxT){
+            const CollisionBody& body = bodies[i];
+            if (!(body.layerBits & ray.layerMask)) return maxT;
+            float t;
+            Vector3 n;
+            if (!sphereCastVsBody(body, ray.origin, dir, radius, maxT, t, n) || t >= maxT) return maxT;
+            outHit.body = i;
+            outHit.distance = t;
+            outHit.normal = n;
+            return t;
+        });
+
+    if (!outHit.hit()) return false;
+    outHit.go = bodies[outHit.body].go;
+    outHit.point = ray.origin + dir * outHit.distance;
+    return true;
+}
+
+void SphereOverlap(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                   const Vector3& center, float radius, uint32_t layerMask,
+                   std::vector<uint32_t>& outBodies){
+    const CollisionBody query = makeSphere(center, radius);
+    std::vector<uint32_t> candidates;
+    overlapCandidates(broadPhase, bodies, query.worldAABB, candidates);
+
+    Vector3 axis;
+    for (uint32_t i : candidates){
+        if ((bodies[i].layerBits & layerMask) &&
+            ContinuousCollision::SeparationBound(query, bodies[i], axis) <= 0.f)
+            outBodies.push_back(i);
+    }
+}
+
+void BoxOverlap(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                const Vector3& center, const Vector3& halfExtents, const Quaternion& rotation,
+                uint32_t layerMask, std::vector<uint32_t>& outBodies){
+    CollisionBody query;
+    query.obbCenter = center;
+    query.obbAxes[0] = Vector3::Transform(Vector3::UnitX, rotation);
+    query.obbAxes[1] = Vector3::Transform(Vector3::UnitY, rotation);
+    query.obbAxes[2] = Vector3::Transform(Vector3::UnitZ, rotation);
+    query.obbHalves[0] = halfExtents.x;
+    query.obbHalves[1] = halfExtents.y;
+    query.obbHalves[2] = halfExtents.z;
+
+    Vector3 reach;
+    for (int k = 0; k < 3; ++k){
+        const Vector3 e = query.obbAxes[k] * query.obbHalves[k];
+        reach += Vector3(fabsf(e.x), fabsf(e.y), fabsf(e.z));
+    }
+    query.worldAABB = { center - reach, center + reach };
+
+    std::vector<uint32_t> candidates;
+    overlapCandidates(broadPhase, bodies, query.worldAABB, candidates);
+
+    Vector3 axis;
+    for (uint32_t i : candidates){
+        if ((bodies[i].layerBits & layerMask) &&
+            ContinuousCollision::SeparationBound(query, bodies[i], axis) <= 0.f)
+            outBodies.push_back(i);
+    }
+}
+
+void RaycastBatch(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                  const RayQuery* rays, uint32_t count, RaycastHit* outHits, WorkerPool* pool){
+    const uint32_t tasks = (count + kRaysPerTask - 1) / kRaysPerTask;
+    auto run = [&](uint32_t task){
+        const uint32_t end = std::min(count, (task + 1) * kRaysPerTask);
+        for (uint32_t i = task * kRaysPerTask; i < end; ++i)
+            Raycast(broadPhase, bodies, rays[i], outHits[i]);
+    };
+    if (pool) pool->parallelFor(tasks, run);
+    else for (uint32_t t = 0; t < tasks; ++t) run(t);
+}
+
+void SphereCastBatch(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                     const RayQuery* rays, uint32_t count, float radius, RaycastHit* outHits,
+                     WorkerPool* pool){
+    const uint32_t tasks = (count + kRaysPerTask - 1) / kRaysPerTask;
+    auto run = [&](uint32_t task){
+        const uint32_t end = std::min(count, (task + 1) * kRaysPerTask);
+        for (uint32_t i = task * kRaysPerTask; i < end; ++i)
+            SphereCast(broadPhase, bodies, rays[i], radius, outHits[i]);
+    };
+    if (pool) pool->parallelFor(tasks, run);
+    else for (uint32_t t = 0; t < tasks; ++t) run(t);
+}
+
+// Every obstacle the move could reach is fetched with one broad-phase query
+// over the start capsule grown by the full displacement: sliding never
+// travels further than the requested motion.
+void MoveCapsule(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                 const CapsuleMove& move, CapsuleMoveResult& outResult){
+    outResult = {};
+    const float skin = std::max(move.skin, 1e-4f);
+    CollisionBody capsule = makeCapsule(move.center, move.halfHeight, move.radius);
+
+    const float reach = move.displacement.Length() + 2.f * skin;
+    const Vector3 extent(move.radius + reach, move.halfHeight + move.radius + reach, move.radius + reach);
+    std::vector<uint32_t> candidates;
+    overlapCandidates(broadPhase, bodies, AABB{ move.center - extent, move.center + extent }, candidates);
+    outResult.queries = 1;
+
+    std::vector<uint32_t> obstacles;
+    obstacles.reserve(candidates.size());
+    for (uint32_t i : candidates)
+        if ((bodies[i].layerBits & move.layerMask) && !isIgnored(bodies[i].go, move.ignore))
+            obstacles.push_back(i);
+    outResult.candidates = static_cast<uint32_t>(obstacles.size());
+
+    // Push out of anything the capsule already overlaps.
+    for (int pass = 0; pass < move.maxIterations; ++pass){
+        bool pushed = false;
+        for (uint32_t i : obstacles){
+            Vector3 axis;
+            const float separation = ContinuousCollision::SeparationBound(capsule, bodies[i], axis);
+            if (separation >= 0.f) continue;
+            capsule.obbCenter += axis * (separation - skin);
+            pushed = true;
+        }
+        if (!pushed) break;
+        outResult.depenetrated = true;
+    }
+
+    Vector3 remaining = move.displacement;
+    Vector3 firstPlane;
+    for (int it = 0; it < move.maxIterations; ++it){
+        if (remaining.LengthSquared() < 1e-12f) break;
+
+        float t = 1.f;
+        Vector3 normal;
+        for (uint32_t i : obstacles)
+            sweepCapsule(capsule, remaining, bodies[i], skin, t, normal);
+
+        capsule.obbCenter += remaining * t;
+        if (t >= 1.f) break;
+
+        ++outResult.contacts;
+        outResult.lastNormal = normal;
+        remaining *= 1.f - t;
+        remaining -= normal * remaining.Dot(normal);
+
+        // Blocked by two planes: keep only the motion along their crease.
+        if (it > 0 && remaining.Dot(firstPlane) < 0.f){
+            Vector3 crease = firstPlane.Cross(normal);
+            const float len = crease.Length();
+            remaining = len > 1e-6f ? crease * (remaining.Dot(crease) / (len * len)) : Vector3::Zero;
+        }
+        if (it == 0) firstPlane = normal;
+    }
+
+    outResult.center = capsule.obbCenter;
+}
+
+}
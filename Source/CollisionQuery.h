@@ -0,0 +1,92 @@
+#pragma once
+#include "CollisionInterfaces.h"
+#include <cfloat>
+
+class WorkerPool;
+
+struct RayQuery {
+    Vector3 origin;
+    Vector3 direction;
+    float maxDistance = FLT_MAX;
+    uint32_t layerMask = 0xFFFFFFFFu;
+};
+
+// Upright capsule moved through the scene by CollisionQuery::MoveCapsule.
+// `ignore` and its descendants are never collided with (the mover itself).
+struct CapsuleMove {
+    Vector3 center;
+    Vector3 displacement;
+    float radius = 0.4f;
+    float halfHeight = 0.5f;
+    uint32_t layerMask = 0xFFFFFFFFu;
+    const GameObject* ignore = nullptr;
+    float skin = 0.01f;
+    int maxIterations = 4;
+};
+
+struct CapsuleMoveResult {
+    Vector3 center;
+    Vector3 lastNormal;
+    uint32_t contacts = 0;
+    uint32_t candidates = 0;
+    uint32_t queries = 0;
+    bool depenetrated = false;
+};
+
+struct RaycastHit {
+    static constexpr uint32_t kNoBody = 0xFFFFFFFFu;
+
+    uint32_t body = kNoBody;
+    GameObject* go = nullptr;
+    float distance = 0.f;
+    Vector3 point;
+    Vector3 normal;
+
+    bool hit() const { return body != kNoBody; }
+};
+
+// Scene queries over a body list and the broad phase that last processed it.
+// Candidates come from the broad phase's spatial structure (every body when
+// broadPhase is null) and are confirmed with exact sphere/capsule/OBB tests.
+// Only bodies whose layer bit is in the query's layerMask are considered.
+namespace CollisionQuery {
+
+    bool Raycast(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                 const RayQuery& ray, RaycastHit& outHit);
+
+    // The hit point is the sphere's center at the time of impact; the normal
+    // points from the body towards the sphere.
+    bool SphereCast(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                    const RayQuery& ray, float radius, RaycastHit& outHit);
+
+    void SphereOverlap(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                       const Vector3& center, float radius, uint32_t layerMask,
+                       std::vector<uint32_t>& outBodies);
+
+    void BoxOverlap(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                    const Vector3& center, const Vector3& halfExtents, const Quaternion& rotation,
+                    uint32_t layerMask, std::vector<uint32_t>& outBodies);
+
+    // outHits[i] answers rays[i]; misses keep body == kNoBody. Rays are
+    // split across the pool when one is given.
+    void RaycastBatch(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                      const RayQuery* rays, uint32_t count, RaycastHit* outHits,
+                      WorkerPool* pool = nullptr);
+
+    void SphereCastBatch(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                         const RayQuery* rays, uint32_t count, float radius, RaycastHit* outHits,
+                         WorkerPool* pool = nullptr);
+
+    // Move-and-slide: pushes the capsule out of any overlap, then sweeps it
+    // along the displacement, stopping `skin` short of each obstacle and
+    // sliding along it for up to maxIterations hits. Obstacles come from a
+    // single broad-phase query and are treated as static.
+    void MoveCapsule(const IBroadPhase* broadPhase, const std::vector<CollisionBody>& bodies,
+                     const CapsuleMove& move, CapsuleMoveResult& outResult);
+
+    // Entry distance along a unit direction, or false when the ray misses
+    // within maxT. A ray starting inside reports t = 0 facing the ray.
+    bool RayVsBody(const CollisionBody& body, const Vector3& origin, const Vector3& dir,
+                   float maxT, float& outT, Vector3& outNormal);
+
+}
@@ -4,58 +4,240 @@
 #include "ComponentTransform.h"
 #include "GameObject.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
 static constexpr float kCorrectionPercent = 0.8f;
 
 static constexpr float kCorrectionSlop = 0.005f;
 
-void CollisionResponse::solve(const std::vector<ContactPoint>& contacts, float ){
-    for (const auto& c : contacts){
-        if (!c.a || !c.b) continue;
-
-        ComponentRigidbody* rbA = c.a->getComponent<ComponentRigidbody>();
-        ComponentRigidbody* rbB = c.b->getComponent<ComponentRigidbody>();
+Vector3 SolverBody::applyInvInertia(const Vector3& v) const{
+    return axes[0] * (invInertiaLocal.x * axes[0].Dot(v)) +
+           axes[1] * (invInertiaLocal.y * axes[1].Dot(v)) +
+           axes[2] * (invInertiaLocal.z * axes[2].Dot(v));
+}
 
-        if (!rbA && !rbB) continue;
+SolverBody CollisionResponse::makeSolverBody(const CollisionBody& body, float mass,
+                                             bool freezeRotation){
+    SolverBody sb;
+    const bool sphere = body.bvType == BVType::Sphere;
+    sb.centerOfMass = sphere ? body.sphereCenter : body.obbCenter;
+    sb.axes[0] = body.obbAxes[0];
+    sb.axes[1] = body.obbAxes[1];
+    sb.axes[2] = body.obbAxes[2];
+    if (mass <= 0.f) return sb;
+
+    sb.invMass = 1.f / mass;
+    if (freezeRotation) return sb;
+
+    Vector3 inertia;
+    if (sphere){
+        const float i = 0.4f * mass * body.sphereRadius * body.sphereRadius;
+        inertia = Vector3(i, i, i);
+    } else {
+        const float x2 = body.obbHalves[0] * body.obbHalves[0];
+        const float y2 = body.obbHalves[1] * body.obbHalves[1];
+        const float z2 = body.obbHalves[2] * body.obbHalves[2];
+        inertia = Vector3(y2 + z2, x2 + z2, x2 + y2) * (mass / 3.f);
+    }
+    sb.invInertiaLocal = Vector3(inertia.x > 1e-8f ? 1.f / inertia.x : 0.f,
+                                 inertia.y > 1e-8f ? 1.f / inertia.y : 0.f,
+                                 inertia.z > 1e-8f ? 1.f / inertia.z : 0.f);
+    return sb;
+}
 
-        const float invMassA = rbA ? rbA->getInvMass() : 0.f;
-        const float invMassB = rbB ? rbB->getInvMass() : 0.f;
-        const float invMassSum = invMassA + invMassB;
+static inline Vector3 pointVelocity(const Vector3& v, const Vector3& w, const Vector3& r){
+    return v + w.Cross(r);
+}
 
-        if (invMassSum < 1e-8f) continue;
+static inline void applyImpulsePair(SolverBody& a, SolverBody& b,
+                                    const Vector3& rA, const Vector3& rB, const Vector3& p){
+    a.velocity += p * a.invMass;
+    a.angularVelocity += a.applyInvInertia(rA.Cross(p));
+    b.velocity -= p * b.invMass;
+    b.angularVelocity -= b.applyInvInertia(rB.Cross(p));
+}
 
-        const float correction = std::max(c.depth - kCorrectionSlop, 0.f)
-                                 * kCorrectionPercent / invMassSum;
+static inline float effectiveMass(const SolverBody& a, const SolverBody& b,
+                                  const Vector3& rA, const Vector3& rB, const Vector3& dir){
+    const Vector3 raxd = rA.Cross(dir);
+    const Vector3 rbxd = rB.Cross(dir);
+    const float k = a.invMass + b.invMass +
+                    raxd.Dot(a.applyInvInertia(raxd)) +
+                    rbxd.Dot(b.applyInvInertia(rbxd));
+    return k > 1e-12f ? 1.f / k : 0.f;
+}
 
-        ComponentTransform* tA = c.a->getTransform();
-        ComponentTransform* tB = c.b->getTransform();
+static inline void tangentBasis(const Vector3& n, Vector3& t0, Vector3& t1){
+    if (fabsf(n.x) >= 0.57735f) t0 = Vector3(n.y, -n.x, 0.f);
+    else t0 = Vector3(0.f, n.z, -n.y);
+    t0.Normalize();
+    t1 = n.Cross(t0);
+}
 
-        if (tA && invMassA > 0.f){
-            tA->position += c.normal * (correction * invMassA);
-            tA->markDirty();
+void CollisionResponse::buildConstraints(std::vector<SolverBody>& bodies,
+                                         std::vector<ContactManifold>& manifolds, float dt){
+    m_constraints.clear();
+    const float invDt = dt > 1e-7f ? 1.f / dt : 0.f;
+
+    for (ContactManifold& m : manifolds){
+        SolverBody& a = bodies[m.bodyA];
+        SolverBody& b = bodies[m.bodyB];
+        if (a.invMass + b.invMass < 1e-8f) continue;
+
+        const float friction = sqrtf(a.friction * b.friction);
+        const float restitution = std::min(a.restitution, b.restitution);
+        Vector3 t0, t1;
+        tangentBasis(m.normal, t0, t1);
+
+        for (uint32_t i = 0; i < m.pointCount; ++i){
+            ContactPoint& cp = m.points[i];
+            ContactConstraint c;
+            c.bodyA = m.bodyA;
+            c.bodyB = m.bodyB;
+            c.point = &cp;
+            c.normal = m.normal;
+            c.tangent[0] = t0;
+            c.tangent[1] = t1;
+            c.rA = cp.point - a.centerOfMass;
+            c.rB = cp.point - b.centerOfMass;
+            c.normalMass = effectiveMass(a, b, c.rA, c.rB, c.normal);
+            c.tangentMass[0] = effectiveMass(a, b, c.rA, c.rB, t0);
+            c.tangentMass[1] = effectiveMass(a, b, c.rA, c.rB, t1);
+            c.friction = friction;
+
+            const Vector3 dv = pointVelocity(a.velocity, a.angularVelocity, c.rA) -
+                               pointVelocity(b.velocity, b.angularVelocity, c.rB);
+            const float vn = dv.Dot(c.normal);
+            c.velocityBias = vn < -m_restitutionThreshold ? -restitution * vn : 0.f;
+            c.positionBias = kCorrectionPercent * invDt *
+                             std::max(cp.depth - kCorrectionSlop, 0.f);
+            c.pseudoImpulse = 0.f;
+
+            if (!m_warmStarting){
+                cp.normalImpulse = 0.f;
+                cp.tangentImpulse[0] = 0.f;
+                cp.tangentImpulse[1] = 0.f;
+            }
+            m_constraints.push_back(c);
         }
-        if (tB && invMassB > 0.f){
-            tB->position -= c.normal * (correction * invMassB);
-            tB->markDirty();
+    }
+}
+
+void CollisionResponse::warmStart(std::vector<SolverBody>& bodies){
+    for (const ContactConstraint& c : m_constraints){
+        const ContactPoint& cp = *c.point;
+        const Vector3 p = c.normal * cp.normalImpulse +
+                          c.tangent[0] * cp.tangentImpulse[0] +
+                          c.tangent[1] * cp.tangentImpulse[1];
+        applyImpulsePair(bodies[c.bodyA], bodies[c.bodyB], c.rA, c.rB, p);
+    }
+}
+
+void CollisionResponse::solveVelocities(std::vector<SolverBody>& bodies){
+    for (ContactConstraint& c : m_constraints){
+        SolverBody& a = bodies[c.bodyA];
+        SolverBody& b = bodies[c.bodyB];
+        ContactPoint& cp = *c.point;
+
+        const float maxFriction = c.friction * cp.normalImpulse;
+        for (int k = 0; k < 2; ++k){
+            const Vector3 dv = pointVelocity(a.velocity, a.angularVelocity, c.rA) -
+                               pointVelocity(b.velocity, b.angularVelocity, c.rB);
+            const float lambda = -dv.Dot(c.tangent[k]) * c.tangentMass[k];
+            const float old = cp.tangentImpulse[k];
+            cp.tangentImpulse[k] = std::clamp(old + lambda, -maxFriction, maxFriction);
+            applyImpulsePair(a, b, c.rA, c.rB, c.tangent[k] * (cp.tangentImpulse[k] - old));
         }
 
-        const Vector3 velA = rbA ? rbA->velocity : Vector3::Zero;
-        const Vector3 velB = rbB ? rbB->velocity : Vector3::Zero;
+        const Vector3 dv = pointVelocity(a.velocity, a.angularVelocity, c.rA) -
+                           pointVelocity(b.velocity, b.angularVelocity, c.rB);
+        const float lambda = (c.velocityBias - dv.Dot(c.normal)) * c.normalMass;
+        const float old = cp.normalImpulse;
+        cp.normalImpulse = std::max(old + lambda, 0.f);
+        applyImpulsePair(a, b, c.rA, c.rB, c.normal * (cp.normalImpulse - old));
+    }
+}
+
+// Split impulse: penetration is resolved through pseudo velocities that move
+// the bodies this frame but never feed back into their real momentum.
+void CollisionResponse::solvePositions(std::vector<SolverBody>& bodies){
+    for (ContactConstraint& c : m_constraints){
+        if (c.positionBias <= 0.f) continue;
+        SolverBody& a = bodies[c.bodyA];
+        SolverBody& b = bodies[c.bodyB];
+
+        const Vector3 dv = pointVelocity(a.pseudoVelocity, a.pseudoAngularVelocity, c.rA) -
+                           pointVelocity(b.pseudoVelocity, b.pseudoAngularVelocity, c.rB);
+        const float lambda = (c.positionBias - dv.Dot(c.normal)) * c.normalMass;
+        const float old = c.pseudoImpulse;
+        c.pseudoImpulse = std::max(old + lambda, 0.f);
+        const Vector3 p = c.normal * (c.pseudoImpulse - old);
+
+        a.pseudoVelocity += p * a.invMass;
+        a.pseudoAngularVelocity += a.applyInvInertia(c.rA.Cross(p));
+        b.pseudoVelocity -= p * b.invMass;
+        b.pseudoAngularVelocity -= b.applyInvInertia(c.rB.Cross(p));
+    }
+}
+
+void CollisionResponse::solveBodies(std::vector<SolverBody>& solverBodies,
+                                    std::vector<ContactManifold>& manifolds, float dt){
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    buildConstraints(solverBodies, manifolds, dt);
+    if (m_warmStarting) warmStart(solverBodies);
+    for (int it = 0; it < m_iterations; ++it) solveVelocities(solverBodies);
+    for (int it = 0; it < m_positionIterations; ++it) solvePositions(solverBodies);
 
-        const float relVelAlongNormal = (velA - velB).Dot(c.normal);
+    m_lastSolveMs = std::chrono::duration<float, std::milli>(
+        std::chrono::high_resolution_clock::now() - t0).count();
+}
 
-        if (relVelAlongNormal > 0.f) continue;
+void CollisionResponse::solve(std::vector<ContactManifold>& manifolds,
+                              const std::vector<CollisionBody>& bodies, float dt){
+    m_solverBodies.resize(bodies.size());
+    m_bodyUsed.assign(bodies.size(), 0);
+
+    for (const ContactManifold& m : manifolds){
+        for (uint32_t idx : { m.bodyA, m.bodyB }){
+            if (m_bodyUsed[idx]) continue;
+            m_bodyUsed[idx] = 1;
+
+            const CollisionBody& cb = bodies[idx];
+            ComponentRigidbody* rb = cb.rb;
+            const bool dynamic = rb && !rb->isStatic && rb->getInvMass() > 0.f;
+            SolverBody& sb = m_solverBodies[idx];
+            sb = makeSolverBody(cb, dynamic ? rb->mass : 0.f, !dynamic || rb->freezeRotation);
+            if (rb){
+                sb.friction = rb->friction;
+                sb.restitution = rb->restitution;
+            }
+            if (dynamic){
+                sb.velocity = rb->velocity;
+                sb.angularVelocity = rb->angularVelocity;
+            }
+        }
+    }
 
-        const float restitA = rbA ? rbA->restitution : 0.f;
-        const float restitB = rbB ? rbB->restitution : 0.f;
-        const float e = std::min(restitA, restitB);
+    solveBodies(m_solverBodies, manifolds, dt);
 
-        const float j = -(1.f + e) * relVelAlongNormal / invMassSum;
+    for (uint32_t idx = 0; idx < static_cast<uint32_t>(bodies.size()); ++idx){
+        if (!m_bodyUsed[idx]) continue;
+        const SolverBody& sb = m_solverBodies[idx];
+        ComponentRigidbody* rb = bodies[idx].rb;
+        if (!rb || sb.invMass <= 0.f) continue;
 
-        const Vector3 impulse = c.normal * j;
+        rb->velocity = sb.velocity;
+        rb->angularVelocity = sb.angularVelocity;
 
-        if (rbA && invMassA > 0.f) rbA->velocity += impulse * invMassA;
-        if (rbB && invMassB > 0.f) rbB->velocity -= impulse * invMassB;
+        if (dt <= 1e-7f) continue;
+        if (sb.pseudoAngularVelocity != Vector3::Zero)
+            rb->rotateAboutCenterOfMass(sb.pseudoAngularVelocity * dt);
+        ComponentTransform* t = bodies[idx].go->getTransform();
+        if (t && sb.pseudoVelocity != Vector3::Zero){
+            t->position += sb.pseudoVelocity * dt;
+            t->markDirty();
+        }
     }
 }
@@ -2,7 +2,85 @@
 #include "CollisionInterfaces.h"
 #include <vector>
 
+// Rigid state the solver works on. Bodies with invMass == 0 are immovable.
+struct SolverBody {
+    Vector3 centerOfMass;
+    Vector3 axes[3] = { Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ };
+    Vector3 invInertiaLocal;
+    float invMass = 0.f;
+    float friction = 0.5f;
+    float restitution = 0.f;
+
+    Vector3 velocity;
+    Vector3 angularVelocity;
+    Vector3 pseudoVelocity;
+    Vector3 pseudoAngularVelocity;
+
+    Vector3 applyInvInertia(const Vector3& v) const;
+};
+
 class CollisionResponse {
 public:
-    void solve(const std::vector<ContactPoint>& contacts, float dt);
+    // Builds solver bodies from the collision bodies' rigidbodies, solves and
+    // writes velocities and split-impulse position corrections back. Normal
+    // and friction impulses stay in the manifolds for next frame's warm start.
+    void solve(std::vector<ContactManifold>& manifolds,
+               const std::vector<CollisionBody>& bodies, float dt);
+
+    // Component-free core: manifolds index into solverBodies via bodyA/bodyB.
+    void solveBodies(std::vector<SolverBody>& solverBodies,
+                     std::vector<ContactManifold>& manifolds, float dt);
+
+    static SolverBody makeSolverBody(const CollisionBody& body, float mass,
+                                     bool freezeRotation);
+
+    int getIterations() const { return m_iterations; }
+    void setIterations(int n){ m_iterations = n < 1 ? 1 : n; }
+
+    int getPositionIterations() const { return m_positionIterations; }
+    void setPositionIterations(int n){ m_positionIterations = n < 0 ? 0 : n; }
+
+    bool isWarmStarting() const { return m_warmStarting; }
+    void setWarmStarting(bool on){ m_warmStarting = on; }
+
+    float getRestitutionThreshold() const { return m_restitutionThreshold; }
+    void setRestitutionThreshold(float v){ m_restitutionThreshold = v < 0.f ? 0.f : v; }
+
+    uint32_t getLastConstraintCount() const { return static_cast<uint32_t>(m_constraints.size()); }
+    float getLastSolveMs() const { return m_lastSolveMs; }
+
+private:
+    struct ContactConstraint {
+        uint32_t bodyA;
+        uint32_t bodyB;
+        ContactPoint* point;
+
+        Vector3 normal;
+        Vector3 tangent[2];
+        Vector3 rA;
+        Vector3 rB;
+
+        float normalMass;
+        float tangentMass[2];
+        float friction;
+        float velocityBias;
+        float positionBias;
+        float pseudoImpulse;
+    };
+
+    void buildConstraints(std::vector<SolverBody>& bodies,
+                          std::vector<ContactManifold>& manifolds, float dt);
+    void warmStart(std::vector<SolverBody>& bodies);
+    void solveVelocities(std::vector<SolverBody>& bodies);
+    void solvePositions(std::vector<SolverBody>& bodies);
+
+    int m_iterations = 8;
+    int m_positionIterations = 4;
+    bool m_warmStarting = true;
+    float m_restitutionThreshold = 1.f;
+
+    std::vector<ContactConstraint> m_constraints;
+    std::vector<SolverBody> m_solverBodies;
+    std::vector<uint8_t> m_bodyUsed;
+    float m_lastSolveMs = 0.f;
 };
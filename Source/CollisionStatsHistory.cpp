@@ -0,0 +1,73 @@
+#include "Globals.h"
+#include "CollisionStatsHistory.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <type_traits>
+
+void CollisionStatsHistory::push(const CollisionStageStats& stats){
+    m_frames[m_next] = stats;
+    m_next = (m_next + 1) % kFrames;
+    m_count = std::min(m_count + 1, kFrames);
+    ++m_total;
+}
+
+template<typename T>
+static void foldField(const CollisionStatsHistory& history, T CollisionStageStats::* field,
+                      CollisionStageStats& outMean, CollisionStageStats& outMax){
+    double sum = 0.0;
+    T peak = T(0);
+    for (uint32_t i = 0; i < history.size(); ++i){
+        const T v = history.at(i).*field;
+        sum += v;
+        peak = std::max(peak, v);
+    }
+    const double mean = sum / history.size();
+    outMean.*field = static_cast<T>(std::is_integral_v<T> ? mean + 0.5 : mean);
+    outMax.*field = peak;
+}
+
+void CollisionStatsHistory::summarize(CollisionStageStats& outMean, CollisionStageStats& outMax) const{
+    outMean = {};
+    outMax = {};
+    if (m_count == 0) return;
+
+    using S = CollisionStageStats;
+    for (float S::* f : { &S::gatherMs, &S::broadPhaseMs, &S::midPhaseMs, &S::narrowPhaseMs, &S::solveMs, &S::ccdMs })
+        foldField(*this, f, outMean, outMax);
+    for (uint32_t S::* f : { &S::bodyCount, &S::rebuiltBodyCount, &S::broadCount, &S::broadEventCount,
+                             &S::sleepingBodyCount, &S::midCount, &S::narrowCount, &S::contactPointCount,
+                             &S::warmStartedCount, &S::constraintCount, &S::ccdSweptPairs, &S::ccdHits })
+        foldField(*this, f, outMean, outMax);
+}
+
+std::string CollisionStatsHistory::toCsv() const{
+    std::string out =
+        "run,gather_ms,broad_ms,mid_ms,narrow_ms,solve_ms,ccd_ms,total_ms,"
+        "bodies,rebuilt_bodies,broad_pairs,broad_events,sleeping_bodies,mid_pairs,"
+        "manifolds,contact_points,warm_started,constraints,ccd_swept_pairs,ccd_hits\n";
+    out.reserve(out.size() + m_count * 128);
+
+    const uint64_t first = m_total - m_count;
+    char line[256];
+    for (uint32_t i = 0; i < m_count; ++i){
+        const CollisionStageStats& s = at(i);
+        snprintf(line, sizeof(line),
+            "%llu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+            static_cast<unsigned long long>(first + i),
+            s.gatherMs, s.broadPhaseMs, s.midPhaseMs, s.narrowPhaseMs, s.solveMs, s.ccdMs, s.totalMs(),
+            s.bodyCount, s.rebuiltBodyCount, s.broadCount, s.broadEventCount, s.sleepingBodyCount,
+            s.midCount, s.narrowCount, s.contactPointCount, s.warmStartedCount, s.constraintCount,
+            s.ccdSweptPairs, s.ccdHits);
+        out += line;
+    }
+    return out;
+}
+
+bool CollisionStatsHistory::writeCsv(const std::string& path) const{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    const std::string csv = toCsv();
+    file.write(csv.data(), static_cast<std::streamsize>(csv.size()));
+    return file.good();
+}
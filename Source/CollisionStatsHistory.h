@@ -0,0 +1,34 @@
+#pragma once
+#include "CollisionInterfaces.h"
+#include <string>
+
+// Rolling window of the last kFrames collision runs, oldest first. Kept
+// free of editor code so tools and benchmarks can dump it as CSV.
+class CollisionStatsHistory {
+public:
+    static constexpr uint32_t kFrames = 240;
+
+    void push(const CollisionStageStats& stats);
+    void clear(){ m_next = 0; m_count = 0; m_total = 0; }
+
+    uint32_t size() const { return m_count; }
+    const CollisionStageStats& at(uint32_t i) const { return m_frames[(m_next + kFrames - m_count + i) % kFrames]; }
+    // The newest run, for stages that report after it was pushed. Only valid
+    // when size() > 0.
+    CollisionStageStats& latest(){ return m_frames[(m_next + kFrames - 1) % kFrames]; }
+    // Runs recorded since the last clear(), including those rotated out.
+    uint64_t getTotalRuns() const { return m_total; }
+
+    // Per-stage mean and max over the window, in stage order.
+    void summarize(CollisionStageStats& outMean, CollisionStageStats& outMax) const;
+
+    // One header line, then one line per run with its index since clear().
+    std::string toCsv() const;
+    bool writeCsv(const std::string& path) const;
+
+private:
+    CollisionStageStats m_frames[kFrames];
+    uint32_t m_next = 0;
+    uint32_t m_count = 0;
+    uint64_t m_total = 0;
+};
@@ -3,6 +3,11 @@
 #include "BruteForceBroadPhase.h"
 #include "UniformGridBroadPhase.h"
 #include "OctreeBroadPhase.h"
+#include "DynamicAABBTreeBroadPhase.h"
+#include "SweepAndPruneBroadPhase.h"
+#include "CoherentMidPhase.h"
+#include "WorkerPool.h"
+#include "ContinuousCollision.h"
 #include "CollisionInterfaces.h"
 #include <chrono>
 #include "SceneGraph.h"
@@ -11,25 +16,40 @@
 #include "ComponentTransform.h"
 #include "ComponentBounds.h"
 #include "ComponentRigidbody.h"
-#include <functional>
+#include "CollisionBodyRegistry.h"
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 
 CollisionSystem::CollisionSystem()
     : m_broadPhase(std::make_unique<BruteForceBroadPhase>())
-    , m_midPhase(std::make_unique<PassthroughMidPhase>())
-{}
+    , m_midPhase(std::make_unique<CoherentMidPhase>())
+{
+    m_narrowPhase.setThreadCount(std::clamp(WorkerPool::hardwareThreads() / 2, 1u, 8u));
+    setLayerMatrix(CollisionLayers());
+}
+
+void CollisionSystem::setLayerMatrix(const CollisionLayers& layers){
+    for (uint32_t i = 0; i < CollisionLayers::kLayerCount; ++i){
+        if (m_layerMasks[i] == layers.masks[i]) continue;
+        m_layerMasks[i] = layers.masks[i];
+        m_layersChanged = true;
+    }
+}
 
 void CollisionSystem::setBroadPhase(std::unique_ptr<IBroadPhase> bp){
-    if (bp) m_broadPhase = std::move(bp);
+    if (!bp) return;
+    m_broadPhase = std::move(bp);
+    m_livePairs.clear();
+    m_queryReady = false;
 }
 
 void CollisionSystem::useGridBroadPhase(float cellSize){
-    m_broadPhase = std::make_unique<UniformGridBroadPhase>(cellSize);
+    setBroadPhase(std::make_unique<UniformGridBroadPhase>(cellSize));
 }
 
 void CollisionSystem::useBruteForceBroadPhase(){
-    m_broadPhase = std::make_unique<BruteForceBroadPhase>();
+    setBroadPhase(std::make_unique<BruteForceBroadPhase>());
 }
 
 bool CollisionSystem::isUsingGrid() const{
@@ -48,6 +68,14 @@ static OctreeBroadPhase* asOctree(IBroadPhase* bp){
     return dynamic_cast<OctreeBroadPhase*>(bp);
 }
 
+static DynamicAABBTreeBroadPhase* asTree(IBroadPhase* bp){
+    return dynamic_cast<DynamicAABBTreeBroadPhase*>(bp);
+}
+
+static SweepAndPruneBroadPhase* asSap(IBroadPhase* bp){
+    return dynamic_cast<SweepAndPruneBroadPhase*>(bp);
+}
+
 float CollisionSystem::getGridCellSize() const{
     auto* g = asGrid(m_broadPhase.get());
     return g ? g->getCellSize() : 0.f;
@@ -67,7 +95,7 @@ void CollisionSystem::drawBroadPhaseDebug(){
 }
 
 void CollisionSystem::useOctreeBroadPhase(int nodeCapacity, int maxDepth){
-    m_broadPhase = std::make_unique<OctreeBroadPhase>(nodeCapacity, maxDepth);
+    setBroadPhase(std::make_unique<OctreeBroadPhase>(nodeCapacity, maxDepth));
 }
 
 bool CollisionSystem::isUsingOctree() const{
@@ -102,6 +130,85 @@ int CollisionSystem::getLastOctreeLeafCount() const{
     return o ? o->getLastLeafCount() : 0;
 }
 
+void CollisionSystem::useDynamicTreeBroadPhase(float fatMargin){
+    setBroadPhase(std::make_unique<DynamicAABBTreeBroadPhase>(fatMargin));
+}
+
+bool CollisionSystem::isUsingDynamicTree() const{
+    return asTree(m_broadPhase.get()) != nullptr;
+}
+
+float CollisionSystem::getTreeFatMargin() const{
+    auto* t = asTree(m_broadPhase.get());
+    return t ? t->getFatMargin() : 0.f;
+}
+
+void CollisionSystem::setTreeFatMargin(float m){
+    if (auto* t = asTree(m_broadPhase.get())) t->setFatMargin(m);
+}
+
+int CollisionSystem::getTreeProxyCount() const{
+    auto* t = asTree(m_broadPhase.get());
+    return t ? t->getProxyCount() : 0;
+}
+
+int CollisionSystem::getTreeNodeCount() const{
+    auto* t = asTree(m_broadPhase.get());
+    return t ? t->getNodeCount() : 0;
+}
+
+int CollisionSystem::getTreeHeight() const{
+    auto* t = asTree(m_broadPhase.get());
+    return t ? t->getTreeHeight() : 0;
+}
+
+int CollisionSystem::getLastTreeMovedCount() const{
+    auto* t = asTree(m_broadPhase.get());
+    return t ? t->getLastMovedCount() : 0;
+}
+
+void CollisionSystem::useSweepAndPruneBroadPhase(){
+    setBroadPhase(std::make_unique<SweepAndPruneBroadPhase>());
+}
+
+bool CollisionSystem::isUsingSweepAndPrune() const{
+    return asSap(m_broadPhase.get()) != nullptr;
+}
+
+int CollisionSystem::getLastSapSwapCount() const{
+    auto* sap = asSap(m_broadPhase.get());
+    return sap ? sap->getLastSwapCount() : 0;
+}
+
+static CoherentMidPhase* asCoherent(IMidPhase* mp){
+    return dynamic_cast<CoherentMidPhase*>(mp);
+}
+
+void CollisionSystem::setMidPhaseEnabled(bool enabled){
+    if (enabled == isMidPhaseEnabled()) return;
+    if (enabled) m_midPhase = std::make_unique<CoherentMidPhase>();
+    else m_midPhase = std::make_unique<PassthroughMidPhase>();
+}
+
+bool CollisionSystem::isMidPhaseEnabled() const{
+    return asCoherent(m_midPhase.get()) != nullptr;
+}
+
+uint32_t CollisionSystem::getLastMidCacheRejects() const{
+    auto* mp = asCoherent(m_midPhase.get());
+    return mp ? mp->getLastCacheRejects() : 0;
+}
+
+uint32_t CollisionSystem::getLastMidSphereRejects() const{
+    auto* mp = asCoherent(m_midPhase.get());
+    return mp ? mp->getLastSphereRejects() : 0;
+}
+
+uint32_t CollisionSystem::getLastMidBoxRejects() const{
+    auto* mp = asCoherent(m_midPhase.get());
+    return mp ? mp->getLastBoxRejects() : 0;
+}
+
 static void buildOBB(CollisionBody& body){
     const ComponentTransform* t = body.go->getTransform();
     const ComponentMesh* cm = body.go->getComponent<ComponentMesh>();
@@ -136,6 +243,23 @@ static void applyBVType(CollisionBody& body){
         return;
     }
 
+    if (cb->bvType == BVType::Capsule){
+        const float r = cb->radiusOverride >= 0.f ? cb->radiusOverride
+                                                  : std::max(body.obbHalves[0], body.obbHalves[2]);
+        const float h = std::max(body.obbHalves[1] - r, 0.f);
+        body.bvType = BVType::Capsule;
+        body.capsuleRadius = r;
+        body.capsuleHalfHeight = h;
+        body.obbHalves[0] = body.obbHalves[2] = r;
+        body.obbHalves[1] = h + r;
+
+        const Vector3 tip = body.obbAxes[1] * h;
+        const Vector3 grow(r, r, r);
+        body.worldAABB.min = Vector3::Min(body.obbCenter - tip, body.obbCenter + tip) - grow;
+        body.worldAABB.max = Vector3::Max(body.obbCenter - tip, body.obbCenter + tip) + grow;
+        return;
+    }
+
     body.bvType = BVType::Sphere;
     body.sphereCenter = body.obbCenter;
 
@@ -152,56 +276,382 @@ static void applyBVType(CollisionBody& body){
     body.worldAABB = s.toAABB();
 }
 
+void CollisionSystem::applyLayers(CollisionBody& body, const ComponentBounds* bounds) const{
+    const uint32_t layer = bounds ? std::min(bounds->collisionLayer, CollisionLayers::kLayerCount - 1) : 0u;
+    body.layerBits = 1u << layer;
+    body.maskBits = m_layerMasks[layer] & (bounds ? bounds->collisionMask : 0xFFFFFFFFu);
+}
 
-std::vector<CollisionBody> CollisionSystem::gatherBodies(SceneGraph* scene, float dt){
-    std::vector<CollisionBody> bodies;
-    if (!scene) return bodies;
-
-    std::function<void(GameObject*)> visit = [&](GameObject* node){
-        if (!node || !node->isActive()) return;
-        ComponentMesh* cm = node->getComponent<ComponentMesh>();
-        if (cm && cm->hasAABB()){
-            CollisionBody body;
-            body.go = node;
-            Vector3 mn, mx;
-            cm->getWorldAABB(mn, mx);
-            body.worldAABB.min = mn;
-            body.worldAABB.max = mx;
-            buildOBB(body);
-            applyBVType(body);
-
-            const ComponentRigidbody* rb = node->getComponent<ComponentRigidbody>();
-            if (rb && rb->isFastMoving && !rb->isStatic && dt > 1e-7f){
-                const Vector3 disp = rb->velocity * dt;
-                body.worldAABB.min = Vector3::Min(body.worldAABB.min,
-                                                   body.worldAABB.min + disp);
-                body.worldAABB.max = Vector3::Max(body.worldAABB.max,
-                                                   body.worldAABB.max + disp);
-            }
-
-            bodies.push_back(body);
-        }
-        for (auto* child : node->getChildren()) visit(child);
-    };
-    visit(scene->getRoot());
-    return bodies;
+static bool isGathered(const GameObject* go, const GameObject* root){
+    for (const GameObject* node = go; node; node = node->getParent()){
+        if (!node->isActive()) return false;
+        if (node == root) return true;
+    }
+    return false;
+}
+
+static void refreshBody(CollisionBody& body, const ComponentMesh* cm){
+    Vector3 mn, mx;
+    cm->getWorldAABB(mn, mx);
+    body.worldAABB.min = mn;
+    body.worldAABB.max = mx;
+    buildOBB(body);
+    applyBVType(body);
+}
+
+void CollisionSystem::removeBody(uint32_t index){
+    const BodySource& src = m_bodySources[index];
+    if (m_bodies[index].sleeping) --m_sleepingBodyCount;
+    if (src.fast) m_fastSlots.erase(std::find(m_fastSlots.begin(), m_fastSlots.end(), src.slot));
+    m_bodyOfSlot[src.slot] = kNoBody;
+
+    const uint32_t last = static_cast<uint32_t>(m_bodies.size() - 1);
+    if (index != last){
+        m_bodies[index] = m_bodies[last];
+        m_bodySources[index] = m_bodySources[last];
+        m_bodyOfSlot[m_bodySources[index].slot] = index;
+    }
+    m_bodies.pop_back();
+    m_bodySources.pop_back();
+}
+
+// Brings the body of one registry slot up to date: adds, refreshes or
+// removes it. Returns true if the slot has a body afterwards.
+bool CollisionSystem::syncSlot(uint32_t slot, const GameObject* root){
+    const std::vector<CollisionBodyRegistry::Entry>& entries = CollisionBodyRegistry::GetEntries();
+    if (slot >= m_bodyOfSlot.size()) m_bodyOfSlot.resize(entries.size(), kNoBody);
+
+    const CollisionBodyRegistry::Entry& e = entries[slot];
+    const bool wanted = e.mesh && e.mesh->hasAABB() && isGathered(e.owner, root);
+    uint32_t index = m_bodyOfSlot[slot];
+    if (index != kNoBody && (!wanted || m_bodySources[index].generation != e.generation)){
+        removeBody(index);
+        index = kNoBody;
+    }
+    if (!wanted) return false;
+
+    if (index == kNoBody){
+        index = static_cast<uint32_t>(m_bodies.size());
+        m_bodyOfSlot[slot] = index;
+        CollisionBody& body = m_bodies.emplace_back();
+        BodySource& src = m_bodySources.emplace_back();
+        body.go = e.owner;
+        body.id = e.owner->getUID();
+        src.mesh = e.mesh;
+        src.slot = slot;
+        src.generation = e.generation;
+    }
+
+    CollisionBody& body = m_bodies[index];
+    BodySource& src = m_bodySources[index];
+    body.rb = body.go->getComponent<ComponentRigidbody>();
+    src.bounds = body.go->getComponent<ComponentBounds>();
+    refreshBody(body, src.mesh);
+    applyLayers(body, src.bounds);
+    const ComponentRigidbody* rb = body.rb;
+    const bool sleeping = rb && rb->isSleeping();
+    m_sleepingBodyCount += static_cast<int>(sleeping) - static_cast<int>(body.sleeping);
+    body.sleeping = sleeping;
+    body.resting = sleeping || !rb || rb->isStatic || rb->getInvMass() <= 0.f;
+
+    const bool fast = rb && rb->isFastMoving && !rb->isStatic;
+    if (fast != src.fast){
+        if (fast) m_fastSlots.push_back(slot);
+        else m_fastSlots.erase(std::find(m_fastSlots.begin(), m_fastSlots.end(), slot));
+        src.fast = fast;
+    }
+    return true;
+}
+
+// Looks at every registry entry; only needed for a new scene or when the
+// change log was trimmed past our cursor.
+void CollisionSystem::resyncBodies(SceneGraph* scene){
+    m_bodyScene = scene;
+    m_bodies.clear();
+    m_bodySources.clear();
+    m_fastSlots.clear();
+    m_sweptSlots.clear();
+    m_sleepingBodyCount = 0;
+    m_bodyOfSlot.assign(CollisionBodyRegistry::GetEntries().size(), kNoBody);
+    m_changeCursor = CollisionBodyRegistry::GetLogEnd();
+
+    m_changedSlots.clear();
+    for (uint32_t slot = 0; slot < static_cast<uint32_t>(m_bodyOfSlot.size()); ++slot)
+        m_changedSlots.push_back(slot);
+}
+
+void CollisionSystem::gatherBodies(SceneGraph* scene, float dt){
+    m_fastBodies.clear();
+    if (!scene){
+        m_bodies.clear();
+        m_bodySources.clear();
+        m_bodyOfSlot.clear();
+        m_fastSlots.clear();
+        m_sweptSlots.clear();
+        m_sleepingBodyCount = 0;
+        m_bodyScene = nullptr;
+        return;
+    }
+
+    m_changedSlots.clear();
+    if (scene != m_bodyScene || !CollisionBodyRegistry::ReadChanges(m_changeCursor, m_changedSlots)){
+        resyncBodies(scene);
+    } else if (!m_sweptSlots.empty()){
+        m_changedSlots.insert(m_changedSlots.end(), m_sweptSlots.begin(), m_sweptSlots.end());
+        std::sort(m_changedSlots.begin(), m_changedSlots.end());
+        m_changedSlots.erase(std::unique(m_changedSlots.begin(), m_changedSlots.end()), m_changedSlots.end());
+    }
+
+    uint32_t rebuilt = 0;
+    const GameObject* root = scene->getRoot();
+    for (uint32_t slot : m_changedSlots)
+        if (syncSlot(slot, root)) ++rebuilt;
+
+    if (m_layersChanged){
+        for (size_t i = 0; i < m_bodies.size(); ++i) applyLayers(m_bodies[i], m_bodySources[i].bounds);
+        m_layersChanged = false;
+    }
+
+    // Swept both ways: the solver may still turn the velocity around
+    // before the continuous pass moves the body.
+    m_sweptSlots.clear();
+    for (uint32_t slot : m_fastSlots){
+        const uint32_t i = m_bodyOfSlot[slot];
+        CollisionBody& body = m_bodies[i];
+        const ComponentRigidbody* rb = body.rb;
+        if (body.sleeping || !rb->isFastMoving || rb->isStatic || dt <= 1e-7f) continue;
+        const Vector3 disp = rb->velocity * dt;
+        const Vector3 reach(fabsf(disp.x), fabsf(disp.y), fabsf(disp.z));
+        body.worldAABB.min -= reach;
+        body.worldAABB.max += reach;
+        m_sweptSlots.push_back(slot);
+        m_fastBodies.push_back(i);
+    }
+    std::sort(m_fastBodies.begin(), m_fastBodies.end());
+
+    m_results.bodyCount = static_cast<uint32_t>(m_bodies.size());
+    m_results.rebuiltBodyCount = rebuilt;
+    m_results.sleepingBodyCount = m_sleepingBodyCount;
+}
+
+static inline uint64_t pairKey(uint32_t a, uint32_t b){
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// Folds this frame's add/remove events into the sorted live pair list. A pair
+// can toggle more than once in one update, so events are reduced to a net
+// delta per key before merging.
+void CollisionSystem::applyPairEvents(){
+    if (m_pairEvents.empty()) return;
+
+    struct Delta { uint64_t key; int delta; };
+    std::vector<Delta> deltas;
+    deltas.reserve(m_pairEvents.size());
+    for (const auto& e : m_pairEvents)
+        deltas.push_back({ pairKey(e.proxyA, e.proxyB),
+                           e.type == BroadPhasePairEvent::Type::Added ? 1 : -1 });
+    std::sort(deltas.begin(), deltas.end(),
+              [](const Delta& a, const Delta& b){ return a.key < b.key; });
+
+    std::vector<uint64_t> merged;
+    merged.reserve(m_livePairs.size() + deltas.size());
+    size_t i = 0;
+    size_t d = 0;
+    while (d < deltas.size()){
+        const uint64_t key = deltas[d].key;
+        int net = 0;
+        while (d < deltas.size() && deltas[d].key == key) net += deltas[d++].delta;
+
+        while (i < m_livePairs.size() && m_livePairs[i] < key) merged.push_back(m_livePairs[i++]);
+        const bool present = i < m_livePairs.size() && m_livePairs[i] == key;
+        if (present) ++i;
+        if (net > 0 || (present && net == 0)) merged.push_back(key);
+    }
+    merged.insert(merged.end(), m_livePairs.begin() + i, m_livePairs.end());
+    m_livePairs.swap(merged);
+}
+
+static float msSince(std::chrono::high_resolution_clock::time_point t0){
+    return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
 }
 
 void CollisionSystem::run(SceneGraph* scene, float dt){
+    m_contactCache.store(std::move(m_results.manifolds));
     m_results = {};
-
-    std::vector<CollisionBody> bodies = gatherBodies(scene, dt);
-    if (bodies.size() < 2) return;
+    m_ccdPairs.clear();
+    m_queryReady = false;
+
+    auto gatherT0 = std::chrono::high_resolution_clock::now();
+    gatherBodies(scene, dt);
+    m_results.gatherMs = msSince(gatherT0);
+    const std::vector<CollisionBody>& bodies = m_bodies;
+    if (bodies.size() < 2){
+        m_history.push(m_results);
+        return;
+    }
 
     auto bpT0 = std::chrono::high_resolution_clock::now();
-    auto broadPairs = m_broadPhase->query(bodies);
-    auto bpT1 = std::chrono::high_resolution_clock::now();
-    m_results.broadPhaseMs = std::chrono::duration<float, std::milli>(bpT1 - bpT0).count();
+    std::vector<CollisionPair> broadPairs;
+    if (m_broadPhase->emitsPairEvents()){
+        m_pairEvents.clear();
+        m_broadPhase->update(bodies, m_pairEvents);
+        applyPairEvents();
+        m_results.broadEventCount = static_cast<uint32_t>(m_pairEvents.size());
+
+        broadPairs.reserve(m_livePairs.size());
+        for (uint64_t key : m_livePairs){
+            const uint32_t a = m_broadPhase->getProxyBody(static_cast<uint32_t>(key >> 32));
+            const uint32_t b = m_broadPhase->getProxyBody(static_cast<uint32_t>(key));
+            broadPairs.push_back({ std::min(a, b), std::max(a, b) });
+        }
+    } else {
+        broadPairs = m_broadPhase->query(bodies);
+    }
+    m_queryReady = true;
+    m_results.broadPhaseMs = msSince(bpT0);
     m_results.broadCount = static_cast<uint32_t>(broadPairs.size());
 
+    m_ccdPairs.clear();
+    if (m_continuousEnabled && !m_fastBodies.empty()){
+        for (const CollisionPair& p : broadPairs)
+            if (isFastBody(p.a) || isFastBody(p.b)) m_ccdPairs.push_back(p);
+    }
+
+    auto midT0 = std::chrono::high_resolution_clock::now();
     auto midPairs = m_midPhase->filter(std::move(broadPairs), bodies);
     m_results.midCount = static_cast<uint32_t>(midPairs.size());
+    m_results.midPhaseMs = msSince(midT0);
+
+    auto narrowT0 = std::chrono::high_resolution_clock::now();
+    m_results.manifolds = m_narrowPhase.test(midPairs, bodies);
+    m_results.narrowCount = static_cast<uint32_t>(m_results.manifolds.size());
+    for (const ContactManifold& m : m_results.manifolds)
+        m_results.contactPointCount += m.pointCount;
+    m_results.warmStartedCount = m_contactCache.warmStart(m_results.manifolds);
+    m_results.narrowPhaseMs = msSince(narrowT0);
+    m_history.push(m_results);
+}
+
+// Solve and CCD run after run() has pushed its stats, so they fill in the
+// newest history entry as well.
+void CollisionSystem::recordSolve(float ms, uint32_t constraintCount){
+    m_results.solveMs = ms;
+    m_results.constraintCount = constraintCount;
+    if (m_history.size() == 0) return;
+    CollisionStageStats& last = m_history.latest();
+    last.solveMs = ms;
+    last.constraintCount = constraintCount;
+}
+
+bool CollisionSystem::isFastBody(uint32_t index) const{
+    return std::binary_search(m_fastBodies.begin(), m_fastBodies.end(), index);
+}
+
+// Sweeps the fast bodies from the last run() over the next dt. Their shapes
+// are rebuilt from the transforms, since the solver may have nudged them;
+// every other body moves at its own velocity. Each fast body is clamped to
+// its earliest time of impact, so the work scales with the fast movers and
+// the pairs they touch rather than with the scene.
+const std::vector<CcdClamp>& CollisionSystem::runContinuous(float dt){
+    m_ccdClamps.clear();
+    m_ccdStats = {};
+    if (!m_continuousEnabled || m_ccdPairs.empty() || dt <= 0.f) return m_ccdClamps;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    std::vector<CollisionBody> fastShapes;
+    std::vector<float> fractions(m_fastBodies.size(), 1.f);
+    fastShapes.reserve(m_fastBodies.size());
+    for (uint32_t index : m_fastBodies){
+        CollisionBody body = m_bodies[index];
+        buildOBB(body);
+        applyBVType(body);
+        fastShapes.push_back(body);
+    }
+
+    auto motionOf = [&](const CollisionBody& body){
+        ContinuousCollision::Motion motion;
+        const ComponentRigidbody* rb = body.rb;
+        if (rb && !rb->isStatic && !rb->isSleeping() && rb->getInvMass() > 0.f){
+            motion.linear = rb->velocity * dt;
+            motion.angular = rb->angularVelocity * dt;
+        }
+        return motion;
+    };
+
+    for (const CollisionPair& p : m_ccdPairs){
+        const auto fa = std::lower_bound(m_fastBodies.begin(), m_fastBodies.end(), p.a);
+        const auto fb = std::lower_bound(m_fastBodies.begin(), m_fastBodies.end(), p.b);
+        const bool fastA = fa != m_fastBodies.end() && *fa == p.a;
+        const bool fastB = fb != m_fastBodies.end() && *fb == p.b;
+        const CollisionBody& a = fastA ? fastShapes[fa - m_fastBodies.begin()] : m_bodies[p.a];
+        const CollisionBody& b = fastB ? fastShapes[fb - m_fastBodies.begin()] : m_bodies[p.b];
+
+        const ContinuousCollision::TimeOfImpact toi =
+            ContinuousCollision::Sweep(a, motionOf(a), b, motionOf(b), m_ccdTargetDepth);
+        ++m_ccdStats.sweptPairs;
+        m_ccdStats.iterations += static_cast<uint32_t>(toi.iterations);
+        if (!toi.hit) continue;
+
+        ++m_ccdStats.hits;
+        if (fastA) fractions[fa - m_fastBodies.begin()] = std::min(fractions[fa - m_fastBodies.begin()], toi.fraction);
+        if (fastB) fractions[fb - m_fastBodies.begin()] = std::min(fractions[fb - m_fastBodies.begin()], toi.fraction);
+    }
+
+    for (size_t i = 0; i < m_fastBodies.size(); ++i)
+        if (fractions[i] < 1.f) m_ccdClamps.push_back({ m_bodies[m_fastBodies[i]].rb, fractions[i] });
+    std::sort(m_ccdClamps.begin(), m_ccdClamps.end(),
+              [](const CcdClamp& a, const CcdClamp& b){ return a.rb < b.rb; });
+
+    m_ccdStats.fastBodies = static_cast<uint32_t>(m_fastBodies.size());
+    m_ccdStats.clampedBodies = static_cast<uint32_t>(m_ccdClamps.size());
+    m_ccdStats.ms = msSince(t0);
+    m_results.ccdSweptPairs = m_ccdStats.sweptPairs;
+    m_results.ccdHits = m_ccdStats.hits;
+    m_results.ccdMs = m_ccdStats.ms;
+    if (m_history.size() > 0){
+        CollisionStageStats& last = m_history.latest();
+        last.ccdSweptPairs = m_results.ccdSweptPairs;
+        last.ccdHits = m_results.ccdHits;
+        last.ccdMs = m_results.ccdMs;
+    }
+    return m_ccdClamps;
+}
+
+bool CollisionSystem::raycast(const RayQuery& ray, RaycastHit& outHit) const{
+    return CollisionQuery::Raycast(queryBroadPhase(), m_bodies, ray, outHit);
+}
+
+bool CollisionSystem::sphereCast(const RayQuery& ray, float radius, RaycastHit& outHit) const{
+    return CollisionQuery::SphereCast(queryBroadPhase(), m_bodies, ray, radius, outHit);
+}
+
+void CollisionSystem::moveCapsule(const CapsuleMove& move, CapsuleMoveResult& outResult) const{
+    CollisionQuery::MoveCapsule(queryBroadPhase(), m_bodies, move, outResult);
+}
+
+uint32_t CollisionSystem::sphereOverlap(const Vector3& center, float radius,
+                                        std::vector<GameObject*>& outObjects, uint32_t layerMask) const{
+    std::vector<uint32_t> hits;
+    CollisionQuery::SphereOverlap(queryBroadPhase(), m_bodies, center, radius, layerMask, hits);
+    for (uint32_t i : hits) outObjects.push_back(m_bodies[i].go);
+    return static_cast<uint32_t>(hits.size());
+}
+
+uint32_t CollisionSystem::boxOverlap(const Vector3& center, const Vector3& halfExtents, const Quaternion& rotation,
+                                     std::vector<GameObject*>& outObjects, uint32_t layerMask) const{
+    std::vector<uint32_t> hits;
+    CollisionQuery::BoxOverlap(queryBroadPhase(), m_bodies, center, halfExtents, rotation, layerMask, hits);
+    for (uint32_t i : hits) outObjects.push_back(m_bodies[i].go);
+    return static_cast<uint32_t>(hits.size());
+}
+
+void CollisionSystem::raycastBatch(const RayQuery* rays, uint32_t count, RaycastHit* outHits){
+    CollisionQuery::RaycastBatch(queryBroadPhase(), m_bodies, rays, count, outHits,
+                                 m_narrowPhase.getWorkerPool());
+}
 
-    m_results.contacts = m_narrowPhase.test(midPairs, bodies);
-    m_results.narrowCount = static_cast<uint32_t>(m_results.contacts.size());
+void CollisionSystem::sphereCastBatch(const RayQuery* rays, uint32_t count, float radius, RaycastHit* outHits){
+    CollisionQuery::SphereCastBatch(queryBroadPhase(), m_bodies, rays, count, radius, outHits,
+                                    m_narrowPhase.getWorkerPool());
 }
@@ -1,9 +1,15 @@
 #pragma once
 #include "CollisionInterfaces.h"
 #include "NarrowPhase.h"
+#include "ContactCache.h"
+#include "CollisionLayers.h"
+#include "CollisionQuery.h"
+#include "CollisionStatsHistory.h"
 #include <memory>
 
 class SceneGraph;
+class ComponentMesh;
+class ComponentBounds;
 
 class CollisionSystem {
 public:
@@ -33,17 +39,138 @@ public:
     int getLastOctreeNodeCount() const;
     int getLastOctreeLeafCount() const;
 
+    void useDynamicTreeBroadPhase(float fatMargin = 0.1f);
+    bool isUsingDynamicTree() const;
+
+    float getTreeFatMargin() const;
+    void setTreeFatMargin(float m);
+    int getTreeProxyCount() const;
+    int getTreeNodeCount() const;
+    int getTreeHeight() const;
+    int getLastTreeMovedCount() const;
+
+    void useSweepAndPruneBroadPhase();
+    bool isUsingSweepAndPrune() const;
+    int getLastSapSwapCount() const;
+
+    void setMidPhaseEnabled(bool enabled);
+    bool isMidPhaseEnabled() const;
+    uint32_t getLastMidCacheRejects() const;
+    uint32_t getLastMidSphereRejects() const;
+    uint32_t getLastMidBoxRejects() const;
+
     void drawBroadPhaseDebug();
 
+    // Copies the layer matrix used to fill each body's mask bits. Bodies
+    // cache their bits, so they are only refilled when the matrix changes.
+    void setLayerMatrix(const CollisionLayers& layers);
+    uint32_t getLayerMask(uint32_t layer) const { return layer < CollisionLayers::kLayerCount ? m_layerMasks[layer] : 0u; }
+
     void run(SceneGraph* scene, float dt);
 
     const CollisionResults& getResults() const { return m_results; }
+    // Solve runs outside the collision system; the stepper reports it here.
+    void recordSolve(float ms, uint32_t constraintCount);
+
+    // The last CollisionStatsHistory::kFrames completed runs.
+    const CollisionStatsHistory& getStatsHistory() const { return m_history; }
+    void clearStatsHistory(){ m_history.clear(); }
+    bool dumpStatsCsv(const std::string& path) const { return m_history.writeCsv(path); }
+    std::vector<ContactManifold>& getManifolds() { return m_results.manifolds; }
+    const std::vector<CollisionBody>& getBodies() const { return m_bodies; }
+
+    NarrowPhase& getNarrowPhase() { return m_narrowPhase; }
+
+    // Scene queries against the bodies and broad phase of the last run().
+    bool raycast(const RayQuery& ray, RaycastHit& outHit) const;
+    bool sphereCast(const RayQuery& ray, float radius, RaycastHit& outHit) const;
+    uint32_t sphereOverlap(const Vector3& center, float radius, std::vector<GameObject*>& outObjects,
+                           uint32_t layerMask = 0xFFFFFFFFu) const;
+    uint32_t boxOverlap(const Vector3& center, const Vector3& halfExtents, const Quaternion& rotation,
+                        std::vector<GameObject*>& outObjects, uint32_t layerMask = 0xFFFFFFFFu) const;
+
+    // Character move-and-slide; see CollisionQuery::MoveCapsule.
+    void moveCapsule(const CapsuleMove& move, CapsuleMoveResult& outResult) const;
+
+    // outHits[i] answers rays[i]; batches run on the narrow phase's threads.
+    void raycastBatch(const RayQuery* rays, uint32_t count, RaycastHit* outHits);
+    void sphereCastBatch(const RayQuery* rays, uint32_t count, float radius, RaycastHit* outHits);
+
+    // Continuous pass over the fast-moving bodies found by the last run().
+    // Returns the bodies that must stop short this step, sorted by rb.
+    const std::vector<CcdClamp>& runContinuous(float dt);
+
+    void setContinuousEnabled(bool enabled) { m_continuousEnabled = enabled; }
+    bool isContinuousEnabled() const { return m_continuousEnabled; }
+    float getContinuousTargetDepth() const { return m_ccdTargetDepth; }
+    void setContinuousTargetDepth(float d) { m_ccdTargetDepth = d > 0.001f ? d : 0.001f; }
+
+    struct ContinuousStats {
+        uint32_t fastBodies = 0;
+        uint32_t sweptPairs = 0;
+        uint32_t hits = 0;
+        uint32_t clampedBodies = 0;
+        uint32_t iterations = 0;
+        float ms = 0.f;
+    };
+    const ContinuousStats& getContinuousStats() const { return m_ccdStats; }
 
 private:
-    static std::vector<CollisionBody> gatherBodies(SceneGraph* scene, float dt);
+    void gatherBodies(SceneGraph* scene, float dt);
+    void resyncBodies(SceneGraph* scene);
+    bool syncSlot(uint32_t slot, const GameObject* root);
+    void removeBody(uint32_t index);
+
+    void applyPairEvents();
+    bool isFastBody(uint32_t index) const;
+    void applyLayers(CollisionBody& body, const ComponentBounds* bounds) const;
+    const IBroadPhase* queryBroadPhase() const { return m_queryReady ? m_broadPhase.get() : nullptr; }
 
     std::unique_ptr<IBroadPhase> m_broadPhase;
     std::unique_ptr<IMidPhase> m_midPhase;
     NarrowPhase m_narrowPhase;
     CollisionResults m_results;
+    CollisionStatsHistory m_history;
+
+    std::vector<BroadPhasePairEvent> m_pairEvents;
+    std::vector<uint64_t> m_livePairs;
+
+    std::vector<CollisionBody> m_bodies;
+    // Set once the broad phase has seen m_bodies; until then queries scan.
+    bool m_queryReady = false;
+
+    // Where each entry of m_bodies comes from. Bodies are patched from the
+    // body registry's change log: a run() only refreshes the slots logged
+    // since the last one and the bodies it swept for CCD, and removes a body
+    // by moving the last one into its place.
+    struct BodySource {
+        ComponentMesh* mesh = nullptr;
+        const ComponentBounds* bounds = nullptr;
+        uint32_t slot = 0;
+        uint32_t generation = 0;
+        bool fast = false;
+    };
+    static constexpr uint32_t kNoBody = 0xFFFFFFFFu;
+    std::vector<BodySource> m_bodySources;
+    // Registry slot -> index into m_bodies, or kNoBody.
+    std::vector<uint32_t> m_bodyOfSlot;
+    std::vector<uint32_t> m_changedSlots;
+    // Slots of the fast-moving bodies, and of those swept by the last run().
+    std::vector<uint32_t> m_fastSlots;
+    std::vector<uint32_t> m_sweptSlots;
+    SceneGraph* m_bodyScene = nullptr;
+    uint64_t m_changeCursor = 0;
+    uint32_t m_sleepingBodyCount = 0;
+    bool m_layersChanged = false;
+
+    ContactCache m_contactCache;
+
+    uint32_t m_layerMasks[CollisionLayers::kLayerCount] = {};
+
+    bool m_continuousEnabled = true;
+    float m_ccdTargetDepth = 0.01f;
+    std::vector<uint32_t> m_fastBodies;
+    std::vector<CollisionPair> m_ccdPairs;
+    std::vector<CcdClamp> m_ccdClamps;
+    ContinuousStats m_ccdStats;
 };
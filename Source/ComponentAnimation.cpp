@@ -21,43 +21,9 @@
 using namespace rapidjson;
 
 
-static bool SampleTransform(const ResourceAnimation* anim, float timeSec,
-                             const char* name, Vector3& pos, Quaternion& rot){
-    if (!anim) return false;
-    const auto& channels = anim->getChannels();
-    const auto it = channels.find(name);
-    if (it == channels.end()) return false;
-
-    const ResourceAnimation::Channel& ch = it->second;
-
-    if (ch.posCount > 0){
-        const float* tf = ch.posTimeStamps.get();
-        const float* tl = tf + ch.posCount;
-        const float* up = std::upper_bound(tf, tl, timeSec);
-        if (up == tf) pos = ch.positions[0];
-        else if (up == tl) pos = ch.positions[ch.posCount - 1];
-        else {
-            int i = (int)(up - tf) - 1;
-            float d = tf[i + 1] - tf[i];
-            float lm = d > 0.f ? (timeSec - tf[i]) / d : 0.f;
-            pos = Vector3::Lerp(ch.positions[i], ch.positions[i + 1], lm);
-        }
-    }
-
-    if (ch.rotCount > 0){
-        const float* tf = ch.rotTimeStamps.get();
-        const float* tl = tf + ch.rotCount;
-        const float* up = std::upper_bound(tf, tl, timeSec);
-        if (up == tf) rot = ch.rotations[0];
-        else if (up == tl) rot = ch.rotations[ch.rotCount - 1];
-        else {
-            int i = (int)(up - tf) - 1;
-            float d = tf[i + 1] - tf[i];
-            float lm = d > 0.f ? (timeSec - tf[i]) / d : 0.f;
-            rot = Quaternion::Slerp(ch.rotations[i], ch.rotations[i + 1], lm);
-        }
-    }
-    return true;
+static void CollectBones(GameObject* go, std::vector<GameObject*>& out){
+    out.push_back(go);
+    for (auto* child : go->getChildren()) CollectBones(child, out);
 }
 
 static bool SampleMorphWeights(const ResourceAnimation* anim, float timeSec,
@@ -243,17 +209,24 @@ void ComponentAnimation::update(float deltaTime){
             m_layerHead->next = nullptr;
         }
 
-        if (applyPose)
-            for (auto* child : owner->getChildren())
-                applyBlendedAnimation(child);
+        if (applyPose){
+            refreshBones();
+            for (AnimLayer* l = m_layerHead; l; l = l->next)
+                if (l->binding.getClip() != l->anim)
+                    l->binding.bind(l->anim, m_boneNames);
+            applyBlendedAnimation();
+        }
 
     } else {
         if (!m_controller.isPlaying()) return;
         m_controller.Update(deltaTime);
 
-        if (applyPose)
-            for (auto* child : owner->getChildren())
-                applyAnimation(child);
+        if (applyPose){
+            refreshBones();
+            if (!m_controller.isBound())
+                m_controller.Bind(m_boneNames);
+            applyAnimation();
+        }
 
         m_logTimer += deltaTime;
         if (m_logTimer >= 1.f){
@@ -283,34 +256,38 @@ void ComponentAnimation::update(float deltaTime){
 }
 
 
-void ComponentAnimation::GetBlendedTransform(const char* name, AnimLayer* layer,
-                                              Vector3& pos, Quaternion& rot) const{
+// Oldest layer first; each newer layer fades in over the blend below it.
+// The scratch pose is only used after the recursion returns, so one buffer
+// serves every level.
+void ComponentAnimation::GetBlendedPose(AnimLayer* layer, BonePose* pose){
     if (!layer) return;
 
     const float timeSec = layer->currentTimeMs / 1000.f;
 
     if (!layer->next){
-        if (layer->anim)
-            SampleTransform(layer->anim, timeSec, name, pos, rot);
+        layer->binding.sample(timeSec, pose);
         return;
     }
 
-    GetBlendedTransform(name, layer->next, pos, rot);
+    GetBlendedPose(layer->next, pose);
 
-    Vector3 thisPos = pos;
-    Quaternion thisRot = rot;
-    if (layer->anim)
-        SampleTransform(layer->anim, timeSec, name, thisPos, thisRot);
+    const size_t boneCount = m_bones.size();
+    m_layerPose.assign(pose, pose + boneCount);
+    layer->binding.sample(timeSec, m_layerPose.data());
 
     const float w = (layer->transitionTimeMs > 0.f)
         ? std::min(1.f, layer->fadeTimeMs / layer->transitionTimeMs)
         : 1.f;
 
-    pos = Vector3::Lerp(pos, thisPos, w);
+    for (size_t b = 0; b < boneCount; ++b){
+        pose[b].position = Vector3::Lerp(pose[b].position, m_layerPose[b].position, w);
 
-    if (rot.Dot(thisRot) < 0.f)
-        thisRot = Quaternion(-thisRot.x, -thisRot.y, -thisRot.z, -thisRot.w);
-    rot = Quaternion::Slerp(rot, thisRot, w);
+        Quaternion thisRot = m_layerPose[b].rotation;
+        if (pose[b].rotation.Dot(thisRot) < 0.f)
+            thisRot = Quaternion(-thisRot.x, -thisRot.y, -thisRot.z, -thisRot.w);
+        pose[b].rotation = Quaternion::Slerp(pose[b].rotation, thisRot, w);
+        pose[b].scale = Vector3::Lerp(pose[b].scale, m_layerPose[b].scale, w);
+    }
 }
 
 void ComponentAnimation::GetBlendedMorphWeights(const char* name, AnimLayer* layer,
@@ -341,63 +318,94 @@ void ComponentAnimation::GetBlendedMorphWeights(const char* name, AnimLayer* lay
 }
 
 
-void ComponentAnimation::applyAnimation(GameObject* go){
-    const char* nodeName = go->getName().c_str();
+// Rebinds the controller and every layer when a bone was added, removed,
+// reordered or renamed since the last scan.
+void ComponentAnimation::refreshBones(){
+    const uint32_t epoch = GameObject::getHierarchyEpoch();
+    if (epoch == m_hierarchyEpoch) return;
+    m_hierarchyEpoch = epoch;
 
-    auto* t = go->getTransform();
-    Vector3 pos = t->position;
-    Quaternion rot = t->rotation;
-    if (m_controller.GetTransform(nodeName, pos, rot)){
-        t->position = pos;
-        t->rotation = rot;
-        t->markDirty();
+    m_scanBones.clear();
+    for (auto* child : owner->getChildren()) CollectBones(child, m_scanBones);
+    bool changed = m_scanBones != m_bones;
+    for (size_t b = 0; !changed && b < m_bones.size(); ++b)
+        changed = m_bones[b]->getName() != m_boneNames[b];
+    if (!changed) return;
+
+    m_bones.swap(m_scanBones);
+    m_boneNames.clear();
+    for (auto* go : m_bones) m_boneNames.push_back(go->getName());
+
+    m_controller.Bind(m_boneNames);
+    for (AnimLayer* l = m_layerHead; l; l = l->next)
+        l->binding.bind(l->anim, m_boneNames);
+}
+
+void ComponentAnimation::applyAnimation(){
+    const AnimationBinding& binding = m_controller.getBinding();
+    m_pose.resize(m_bones.size());
+    for (size_t b = 0; b < m_bones.size(); ++b){
+        auto* t = m_bones[b]->getTransform();
+        m_pose[b] = { t->position, t->rotation, t->scale };
     }
+    m_controller.SamplePose(m_pose.data());
+
+    for (size_t b = 0; b < m_bones.size(); ++b){
+        GameObject* go = m_bones[b];
+        if (binding.isBound() && binding.animates((uint32_t)b)){
+            auto* t = go->getTransform();
+            t->position = m_pose[b].position;
+            t->rotation = m_pose[b].rotation;
+            t->scale = m_pose[b].scale;
+            t->markDirty();
+        }
 
-    auto* meshComp = go->getComponent<ComponentMesh>();
-    if (meshComp){
-        const auto& entries = meshComp->getEntries();
-        if (!entries.empty() && entries[0].meshRes){
-            const uint32_t numTargets = entries[0].meshRes->getNumMorphTargets();
-            if (numTargets > 0){
-                float weights[ComponentMesh::MAX_MORPH_WEIGHTS] = {};
-                if (m_controller.GetMorphWeights(nodeName, weights, numTargets))
-                    for (uint32_t i = 0; i < numTargets; ++i)
-                        meshComp->setMorphWeight((int)i, weights[i]);
+        auto* meshComp = go->getComponent<ComponentMesh>();
+        if (meshComp){
+            const auto& entries = meshComp->getEntries();
+            if (!entries.empty() && entries[0].meshRes){
+                const uint32_t numTargets = entries[0].meshRes->getNumMorphTargets();
+                if (numTargets > 0){
+                    float weights[ComponentMesh::MAX_MORPH_WEIGHTS] = {};
+                    if (m_controller.GetMorphWeights(go->getName().c_str(), weights, numTargets))
+                        for (uint32_t i = 0; i < numTargets; ++i)
+                            meshComp->setMorphWeight((int)i, weights[i]);
+                }
             }
         }
     }
-
-    for (auto* child : go->getChildren())
-        applyAnimation(child);
 }
 
-void ComponentAnimation::applyBlendedAnimation(GameObject* go){
-    const char* name = go->getName().c_str();
-    auto* t = go->getTransform();
-
-    Vector3 pos = t->position;
-    Quaternion rot = t->rotation;
-    GetBlendedTransform(name, m_layerHead, pos, rot);
-    t->position = pos;
-    t->rotation = rot;
-    t->markDirty();
-
-    auto* meshComp = go->getComponent<ComponentMesh>();
-    if (meshComp){
-        const auto& entries = meshComp->getEntries();
-        if (!entries.empty() && entries[0].meshRes){
-            const uint32_t numTargets = entries[0].meshRes->getNumMorphTargets();
-            if (numTargets > 0){
-                float weights[ComponentMesh::MAX_MORPH_WEIGHTS] = {};
-                GetBlendedMorphWeights(name, m_layerHead, weights, numTargets);
-                for (uint32_t i = 0; i < numTargets; ++i)
-                    meshComp->setMorphWeight((int)i, weights[i]);
+void ComponentAnimation::applyBlendedAnimation(){
+    m_pose.resize(m_bones.size());
+    for (size_t b = 0; b < m_bones.size(); ++b){
+        auto* t = m_bones[b]->getTransform();
+        m_pose[b] = { t->position, t->rotation, t->scale };
+    }
+    GetBlendedPose(m_layerHead, m_pose.data());
+
+    for (size_t b = 0; b < m_bones.size(); ++b){
+        GameObject* go = m_bones[b];
+        auto* t = go->getTransform();
+        t->position = m_pose[b].position;
+        t->rotation = m_pose[b].rotation;
+        t->scale = m_pose[b].scale;
+        t->markDirty();
+
+        auto* meshComp = go->getComponent<ComponentMesh>();
+        if (meshComp){
+            const auto& entries = meshComp->getEntries();
+            if (!entries.empty() && entries[0].meshRes){
+                const uint32_t numTargets = entries[0].meshRes->getNumMorphTargets();
+                if (numTargets > 0){
+                    float weights[ComponentMesh::MAX_MORPH_WEIGHTS] = {};
+                    GetBlendedMorphWeights(go->getName().c_str(), m_layerHead, weights, numTargets);
+                    for (uint32_t i = 0; i < numTargets; ++i)
+                        meshComp->setMorphWeight((int)i, weights[i]);
+                }
             }
         }
     }
-
-    for (auto* child : go->getChildren())
-        applyBlendedAnimation(child);
 }
 
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "Component.h"
 #include "AnimationController.h"
+#include "AnimationBinding.h"
 #include "ResourceCommon.h"
 #include "ResourceStateMachine.h"
 #include <vector>
@@ -16,6 +17,7 @@ struct AnimLayer {
     float fadeTimeMs = 0.f;
     float transitionTimeMs = 0.f;
     bool loop = false;
+    AnimationBinding binding;
     AnimLayer* next = nullptr;
 };
 
@@ -70,15 +72,25 @@ private:
     void freeLayerChain(AnimLayer* head);
     void clearLayers();
 
-    void GetBlendedTransform(const char* name, AnimLayer* layer,
-                              Vector3& pos, Quaternion& rot) const;
+    void GetBlendedPose(AnimLayer* layer, BonePose* pose);
     void GetBlendedMorphWeights(const char* name, AnimLayer* layer,
                                  float* weights, uint32_t count) const;
 
-    void applyAnimation(GameObject* go);
-    void applyBlendedAnimation(GameObject* go);
+    void refreshBones();
+    void applyAnimation();
+    void applyBlendedAnimation();
 
     AnimationController m_controller;
+
+    // The skeleton is every node under the owner, depth first. Clips are
+    // bound against it by bone index; it is rescanned only when the
+    // GameObject hierarchy epoch moves, and rebound only when it changed.
+    uint32_t m_hierarchyEpoch = 0;
+    std::vector<GameObject*> m_bones;
+    std::vector<std::string> m_boneNames;
+    std::vector<GameObject*> m_scanBones;
+    std::vector<BonePose> m_pose;
+    std::vector<BonePose> m_layerPose;
     std::vector<UID> m_animUIDs;
     std::vector<std::string> m_animNames;
 
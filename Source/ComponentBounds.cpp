@@ -1,27 +1,48 @@
 #include "Globals.h"
 #include "ComponentBounds.h"
+#include "CollisionBodyRegistry.h"
 #include <imgui.h>
+#include <algorithm>
 #include "3rdParty/rapidjson/document.h"
 #include "3rdParty/rapidjson/writer.h"
 #include "3rdParty/rapidjson/stringbuffer.h"
 
 using namespace rapidjson;
 
-ComponentBounds::ComponentBounds(GameObject* owner) : Component(owner){}
+ComponentBounds::ComponentBounds(GameObject* owner) : Component(owner){ CollisionBodyRegistry::MarkChanged(owner); }
+ComponentBounds::~ComponentBounds(){ CollisionBodyRegistry::MarkChanged(owner); }
+
+namespace {
+    struct BoundsSettings {
+        BVType bvType;
+        float radiusOverride;
+        uint32_t collisionLayer;
+        uint32_t collisionMask;
+
+        bool operator!=(const BoundsSettings& o) const{
+            return bvType != o.bvType || radiusOverride != o.radiusOverride ||
+                   collisionLayer != o.collisionLayer || collisionMask != o.collisionMask;
+        }
+    };
+}
 
 void ComponentBounds::onEditor(){
+    const BoundsSettings before{ bvType, radiusOverride, collisionLayer, collisionMask };
     ImGui::SeparatorText("Shape");
 
-    int typeIdx = (bvType == BVType::AABB) ? 0 : 1;
+    int typeIdx = static_cast<int>(bvType);
     if (ImGui::RadioButton("AABB (box)", &typeIdx, 0)) bvType = BVType::AABB;
     ImGui::SameLine();
     if (ImGui::RadioButton("Sphere", &typeIdx, 1)) bvType = BVType::Sphere;
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Capsule", &typeIdx, 2)) bvType = BVType::Capsule;
 
-    if (bvType == BVType::Sphere){
+    if (bvType != BVType::AABB){
         ImGui::Spacing();
-        ImGui::SeparatorText("Sphere Radius");
+        ImGui::SeparatorText(bvType == BVType::Sphere ? "Sphere Radius" : "Capsule Radius");
         if (radiusOverride < 0.f){
-            ImGui::TextDisabled("Auto (derived from mesh AABB)");
+            ImGui::TextDisabled(bvType == BVType::Sphere ? "Auto (derived from mesh AABB)"
+                                                         : "Auto (mesh AABB width, along local Y)");
             if (ImGui::Button("Override##rb")) radiusOverride = 1.f;
         } else {
             ImGui::DragFloat("Radius##rb", &radiusOverride, 0.01f, 0.001f, 1000.f, "%.3f");
@@ -29,12 +50,43 @@ void ComponentBounds::onEditor(){
             if (ImGui::SmallButton("Auto##rb")) radiusOverride = -1.f;
         }
     }
+
+    ImGui::Spacing();
+    ImGui::SeparatorText("Collision Layer");
+    int layer = static_cast<int>(collisionLayer);
+    if (ImGui::SliderInt("Layer##cl", &layer, 0, 31))
+        collisionLayer = static_cast<uint32_t>(layer);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Index into the layer matrix in Scene Settings > Collision Layers.");
+
+    if (ImGui::TreeNode("Collides With##cl")){
+        for (int i = 0; i < 32; ++i){
+            ImGui::PushID(i);
+            bool on = (collisionMask & (1u << i)) != 0;
+            if (ImGui::Checkbox("##m", &on)){
+                if (on) collisionMask |= 1u << i;
+                else collisionMask &= ~(1u << i);
+            }
+            if (ImGui::IsItemHovered()) ImGui::SetTooltip("Layer %d", i);
+            ImGui::PopID();
+            if ((i & 7) != 7) ImGui::SameLine();
+        }
+        if (ImGui::SmallButton("All##cl")) collisionMask = 0xFFFFFFFFu;
+        ImGui::SameLine();
+        if (ImGui::SmallButton("None##cl")) collisionMask = 0;
+        ImGui::TreePop();
+    }
+
+    if (before != BoundsSettings{ bvType, radiusOverride, collisionLayer, collisionMask })
+        CollisionBodyRegistry::MarkChanged(owner);
 }
 
 void ComponentBounds::onSave(std::string& outJson) const{
     Document doc; doc.SetObject(); auto& a = doc.GetAllocator();
     doc.AddMember("bvType", (int)bvType, a);
     doc.AddMember("radiusOverride", radiusOverride, a);
+    doc.AddMember("collisionLayer", collisionLayer, a);
+    doc.AddMember("collisionMask", collisionMask, a);
     StringBuffer buf; Writer<StringBuffer> w(buf); doc.Accept(w);
     outJson = buf.GetString();
 }
@@ -46,4 +98,9 @@ void ComponentBounds::onLoad(const std::string& jsonStr){
         bvType = static_cast<BVType>(doc["bvType"].GetInt());
     if (doc.HasMember("radiusOverride"))
         radiusOverride = doc["radiusOverride"].GetFloat();
+    if (doc.HasMember("collisionLayer"))
+        collisionLayer = std::min(doc["collisionLayer"].GetUint(), 31u);
+    if (doc.HasMember("collisionMask"))
+        collisionMask = doc["collisionMask"].GetUint();
+    CollisionBodyRegistry::MarkChanged(owner);
 }
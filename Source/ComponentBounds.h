@@ -5,11 +5,17 @@
 class ComponentBounds final : public Component {
 public:
     explicit ComponentBounds(GameObject* owner);
+    ~ComponentBounds() override;
 
     BVType bvType = BVType::AABB;
 
     float radiusOverride = -1.f;
 
+    // Layer index into the scene's collision layer matrix, and the layers
+    // this object may touch on top of what the matrix allows.
+    uint32_t collisionLayer = 0;
+    uint32_t collisionMask = 0xFFFFFFFFu;
+
     void onEditor() override;
     void onSave(std::string& outJson) const override;
     void onLoad(const std::string& json) override;
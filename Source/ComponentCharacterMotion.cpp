@@ -2,16 +2,28 @@
 #include "ComponentCharacterMotion.h"
 #include "ComponentTransform.h"
 #include "GameObject.h"
+#include "Application.h"
+#include "ModuleEditor.h"
+#include "CollisionSystem.h"
 #include <imgui.h>
 #include "3rdParty/rapidjson/document.h"
 #include "3rdParty/rapidjson/writer.h"
 #include "3rdParty/rapidjson/stringbuffer.h"
 #include <cmath>
+#include <algorithm>
 
 using namespace rapidjson;
 
 ComponentCharacterMotion::ComponentCharacterMotion(GameObject* owner) : Component(owner){}
 
+Vector3 ComponentCharacterMotion::capsuleCenter(const Vector3& position) const{
+    return position + Vector3::UnitY * (std::max(mCapsuleHeight, 2.f * mCapsuleRadius) * 0.5f);
+}
+
+float ComponentCharacterMotion::capsuleHalfHeight() const{
+    return std::max(mCapsuleHeight * 0.5f - mCapsuleRadius, 0.f);
+}
+
 void ComponentCharacterMotion::update(float dt){
     ComponentTransform* t = owner->getTransform();
     if (!t) return;
@@ -25,7 +37,23 @@ void ComponentCharacterMotion::update(float dt){
     mYaw += mRotateDir * mAngularSpeed * dt;
 
     Vector3 forward = { sinf(mYaw), 0.f, cosf(mYaw) };
-    t->position += forward * (mMoveDir * mLinearSpeed * dt);
+    const Vector3 motion = forward * (mMoveDir * mLinearSpeed * dt);
+
+    CollisionSystem* cs = mCollide && app && app->getEditor() ? app->getEditor()->getCollisionSystem() : nullptr;
+    if (cs && motion.LengthSquared() > 0.f){
+        CapsuleMove move;
+        move.center = capsuleCenter(t->getGlobalMatrix().Translation());
+        move.displacement = motion;
+        move.radius = mCapsuleRadius;
+        move.halfHeight = capsuleHalfHeight();
+        move.layerMask = mCollisionMask;
+        move.ignore = owner;
+        CapsuleMoveResult result;
+        cs->moveCapsule(move, result);
+        t->position += result.center - move.center;
+    } else {
+        t->position += motion;
+    }
     t->rotation = Quaternion::CreateFromYawPitchRoll(mYaw, 0.f, 0.f);
     t->markDirty();
 
@@ -37,6 +65,32 @@ void ComponentCharacterMotion::onEditor(){
     ImGui::DragFloat("Linear Speed", &mLinearSpeed, 0.1f, 0.f, 100.f);
     ImGui::DragFloat("Angular Speed", &mAngularSpeed, 0.01f, 0.f, 20.f);
     ImGui::LabelText("Yaw (rad)", "%.3f", mYaw);
+
+    ImGui::SeparatorText("Collision");
+    ImGui::Checkbox("Collide", &mCollide);
+    ImGui::DragFloat("Capsule Radius", &mCapsuleRadius, 0.01f, 0.01f, 10.f, "%.2f");
+    ImGui::DragFloat("Capsule Height", &mCapsuleHeight, 0.01f, 0.02f, 20.f, "%.2f");
+    ImGui::Checkbox("Draw Capsule", &mDrawCapsule);
+}
+
+void ComponentCharacterMotion::onDrawGizmos(){
+    if (!mDrawCapsule) return;
+    ComponentTransform* t = owner->getTransform();
+    if (!t) return;
+
+    const Vector3 center = capsuleCenter(t->getGlobalMatrix().Translation());
+    const Vector3 tip = Vector3::UnitY * capsuleHalfHeight();
+    const Vector3 top = center + tip;
+    const Vector3 bottom = center - tip;
+    dd::sphere(ddConvert(top), dd::colors::Green, mCapsuleRadius);
+    dd::sphere(ddConvert(bottom), dd::colors::Green, mCapsuleRadius);
+
+    const Vector3 sides[4] = { Vector3::UnitX, -Vector3::UnitX, Vector3::UnitZ, -Vector3::UnitZ };
+    for (const Vector3& side : sides){
+        const Vector3 a = top + side * mCapsuleRadius;
+        const Vector3 b = bottom + side * mCapsuleRadius;
+        dd::line(ddConvert(a), ddConvert(b), dd::colors::Green);
+    }
 }
 
 void ComponentCharacterMotion::onSave(std::string& outJson) const{
@@ -44,6 +98,10 @@ void ComponentCharacterMotion::onSave(std::string& outJson) const{
     doc.AddMember("linearSpeed", mLinearSpeed, a);
     doc.AddMember("angularSpeed", mAngularSpeed, a);
     doc.AddMember("yaw", mYaw, a);
+    doc.AddMember("collide", mCollide, a);
+    doc.AddMember("capsuleRadius", mCapsuleRadius, a);
+    doc.AddMember("capsuleHeight", mCapsuleHeight, a);
+    doc.AddMember("collisionMask", mCollisionMask, a);
     StringBuffer buf; Writer<StringBuffer> w(buf); doc.Accept(w);
     outJson = buf.GetString();
 }
@@ -54,4 +112,8 @@ void ComponentCharacterMotion::onLoad(const std::string& jsonStr){
     if (doc.HasMember("linearSpeed")) mLinearSpeed = doc["linearSpeed"].GetFloat();
     if (doc.HasMember("angularSpeed")) mAngularSpeed = doc["angularSpeed"].GetFloat();
     if (doc.HasMember("yaw")){ mYaw = doc["yaw"].GetFloat(); m_yawInit = true; }
+    if (doc.HasMember("collide")) mCollide = doc["collide"].GetBool();
+    if (doc.HasMember("capsuleRadius")) mCapsuleRadius = doc["capsuleRadius"].GetFloat();
+    if (doc.HasMember("capsuleHeight")) mCapsuleHeight = doc["capsuleHeight"].GetFloat();
+    if (doc.HasMember("collisionMask")) mCollisionMask = doc["collisionMask"].GetUint();
 }
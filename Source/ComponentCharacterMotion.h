@@ -10,6 +10,7 @@ public:
 
     void update(float dt) override;
     void onEditor() override;
+    void onDrawGizmos() override;
     void onSave(std::string& outJson) const override;
     void onLoad(const std::string& json) override;
     Type getType() const override { return Type::CharacterMotion; }
@@ -17,9 +18,20 @@ public:
     float mLinearSpeed = 5.f;
     float mAngularSpeed = 2.f;
 
+    // Upright capsule standing on the owner's position. With mCollide set,
+    // moves slide along scene bodies instead of passing through them.
+    bool mCollide = true;
+    float mCapsuleRadius = 0.4f;
+    float mCapsuleHeight = 1.8f;
+    uint32_t mCollisionMask = 0xFFFFFFFFu;
+    bool mDrawCapsule = false;
+
 private:
     float mYaw = 0.f;
     float mMoveDir = 0.f;
     float mRotateDir = 0.f;
     bool m_yawInit = false;
+
+    Vector3 capsuleCenter(const Vector3& position) const;
+    float capsuleHalfHeight() const;
 };
@@ -6,6 +6,7 @@
 #include "ModuleFileSystem.h"
 #include "GameObject.h"
 #include "ComponentTransform.h"
+#include "CollisionBodyRegistry.h"
 #include "Material.h"
 #include "Mesh.h"
 #include "Model.h"
@@ -29,8 +30,8 @@
 
 using namespace rapidjson;
 
-ComponentMesh::ComponentMesh(GameObject* owner) : Component(owner){}
-ComponentMesh::~ComponentMesh(){ releaseEntries(); }
+ComponentMesh::ComponentMesh(GameObject* owner) : Component(owner){ CollisionBodyRegistry::Add(this, owner); }
+ComponentMesh::~ComponentMesh(){ CollisionBodyRegistry::Remove(this); releaseEntries(); }
 
 void ComponentMesh::releaseEntries(){
     for (auto& e : m_entries){
@@ -695,6 +696,7 @@ void ComponentMesh::computeLocalAABB(){
             m_hasAABB = true;
         }
     }
+    CollisionBodyRegistry::MarkChanged(owner);
 }
 
 void ComponentMesh::getWorldAABB(Vector3& outMin, Vector3& outMax) const{
@@ -3,9 +3,7 @@
 #include "ComponentTransform.h"
 #include "ComponentMesh.h"
 #include "GameObject.h"
-#include "Application.h"
-#include "ModuleEditor.h"
-#include "SceneManager.h"
+#include "CollisionBodyRegistry.h"
 #include <imgui.h>
 #include <algorithm>
 #include "3rdParty/rapidjson/document.h"
@@ -14,15 +12,13 @@
 
 using namespace rapidjson;
 
-ComponentRigidbody::ComponentRigidbody(GameObject* owner) : Component(owner){}
+ComponentRigidbody::ComponentRigidbody(GameObject* owner) : Component(owner){ CollisionBodyRegistry::MarkChanged(owner); }
+ComponentRigidbody::~ComponentRigidbody(){ CollisionBodyRegistry::MarkChanged(owner); }
 
-void ComponentRigidbody::update(float dt){
-    if (isStatic || mass <= 0.f) return;
+void ComponentRigidbody::integrateVelocity(float dt, float gravityY){
+    if (isStatic || mass <= 0.f || m_sleeping) return;
 
-    float grav = kGravityAccel;
-    if (app && app->getEditor() && app->getEditor()->getSceneManager())
-        grav = app->getEditor()->getSceneManager()->getSettings().gravityY;
-    if (useGravity) velocity.y += grav * gravityScale * dt;
+    if (useGravity) velocity.y += gravityY * gravityScale * dt;
 
     float dampFactor = std::max(0.f, 1.f - linearDamping * dt);
     velocity *= dampFactor;
@@ -45,14 +41,70 @@ void ComponentRigidbody::update(float dt){
             velocity *= maxSpeed / speed;
     }
 
+    if (freezeRotation) angularVelocity = Vector3::Zero;
+    angularVelocity *= std::max(0.f, 1.f - angularDamping * dt);
+    if (angularVelocity.LengthSquared() < 1e-6f) angularVelocity = Vector3::Zero;
+}
+
+void ComponentRigidbody::integratePosition(float dt){
+    if (isStatic || mass <= 0.f || m_sleeping) return;
+
     ComponentTransform* t = owner->getTransform();
     if (t){
+        if (angularVelocity != Vector3::Zero) rotateAboutCenterOfMass(angularVelocity * dt);
         t->position += velocity * dt;
         t->markDirty();
     }
 }
 
+Vector3 ComponentRigidbody::getCenterOfMass() const{
+    ComponentTransform* t = owner->getTransform();
+    const ComponentMesh* cm = owner->getComponent<ComponentMesh>();
+    if (!t) return Vector3::Zero;
+    if (!cm || !cm->hasAABB()) return t->position;
+    const Vector3 lCtr = (cm->getLocalAABBMin() + cm->getLocalAABBMax()) * 0.5f;
+    return Vector3::Transform(lCtr, t->getGlobalMatrix());
+}
+
+void ComponentRigidbody::rotateAboutCenterOfMass(const Vector3& rotationVector){
+    ComponentTransform* t = owner->getTransform();
+    const float angle = rotationVector.Length();
+    if (!t || angle < 1e-9f) return;
+
+    const Vector3 com = getCenterOfMass();
+    const Quaternion dq = Quaternion::CreateFromAxisAngle(rotationVector / angle, angle);
+    t->position = com + Vector3::Transform(t->position - com, dq);
+    t->rotation = t->rotation * dq;
+    t->rotation.Normalize();
+    t->markDirty();
+}
+
+void ComponentRigidbody::sleep(uint32_t island){
+    if (!m_sleeping) CollisionBodyRegistry::MarkChanged(owner);
+    m_sleeping = true;
+    m_sleepIsland = island;
+    velocity = Vector3::Zero;
+    angularVelocity = Vector3::Zero;
+}
+
+void ComponentRigidbody::wakeUp(){
+    if (m_sleeping) CollisionBodyRegistry::MarkChanged(owner);
+    m_sleeping = false;
+    m_sleepTimer = 0.f;
+}
+
+void ComponentRigidbody::addImpulse(const Vector3& impulse){
+    const float invMass = getInvMass();
+    if (invMass <= 0.f) return;
+    velocity += impulse * invMass;
+    wakeUp();
+}
+
 void ComponentRigidbody::onEditor(){
+    const bool wasStatic = isStatic;
+    const float oldMass = mass;
+    const bool wasFast = isFastMoving;
+
     ImGui::SeparatorText("Body");
     ImGui::Checkbox("Is Static", &isStatic);
     if (ImGui::IsItemHovered())
@@ -67,17 +119,45 @@ void ComponentRigidbody::onEditor(){
         ImGui::DragFloat("Linear Damping", &linearDamping, 0.01f, 0.f, 1.f, "%.3f");
         if (ImGui::IsItemHovered())
             ImGui::SetTooltip("Fraction of velocity removed per second (0 = no drag).");
+        ImGui::DragFloat("Angular Damping", &angularDamping, 0.01f, 0.f, 1.f, "%.3f");
+        ImGui::Checkbox("Freeze Rotation", &freezeRotation);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Contacts only push the body, never spin it.");
 
         ImGui::SeparatorText("Initial Velocity");
         float v[3] = { velocity.x, velocity.y, velocity.z };
-        if (ImGui::DragFloat3("Velocity", v, 0.1f, -500.f, 500.f, "%.2f"))
+        if (ImGui::DragFloat3("Velocity", v, 0.1f, -500.f, 500.f, "%.2f")){
             velocity = { v[0], v[1], v[2] };
+            wakeUp();
+        }
+        float w[3] = { angularVelocity.x, angularVelocity.y, angularVelocity.z };
+        if (ImGui::DragFloat3("Angular Velocity", w, 0.1f, -100.f, 100.f, "%.2f")){
+            angularVelocity = { w[0], w[1], w[2] };
+            wakeUp();
+        }
+
+        ImGui::SeparatorText("Sleeping");
+        ImGui::Checkbox("Can Sleep", &canSleep);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Settled islands stop integrating and colliding\n"
+                              "until an awake body touches them.");
+        if (!canSleep && m_sleeping) wakeUp();
+        if (m_sleeping){
+            ImGui::TextDisabled("Asleep (island %u)", m_sleepIsland);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Wake")) wakeUp();
+        } else {
+            ImGui::TextDisabled("Awake  (still for %.2f s)", m_sleepTimer);
+        }
 
         ImGui::SeparatorText("Collision Response");
     }
     ImGui::SliderFloat("Restitution", &restitution, 0.f, 1.f, "%.2f");
     if (ImGui::IsItemHovered())
         ImGui::SetTooltip("0 = no bounce (inelastic)   1 = full bounce (elastic)");
+    ImGui::SliderFloat("Friction", &friction, 0.f, 1.f, "%.2f");
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Coulomb coefficient. Pairs combine as sqrt(a * b).");
 
     if (!isStatic){
         ImGui::SeparatorText("Tunneling Prevention");
@@ -97,13 +177,16 @@ void ComponentRigidbody::onEditor(){
         }
 
         ImGui::Spacing();
-        ImGui::Checkbox("Is Fast Moving (Swept AABB)", &isFastMoving);
+        ImGui::Checkbox("Is Fast Moving (CCD)", &isFastMoving);
         if (ImGui::IsItemHovered())
             ImGui::SetTooltip("Expands the broad-phase AABB to also cover where this\n"
-                              "object will be next frame (current + velocity * dt).\n"
-                              "Ensures fast projectiles are never missed by the\n"
-                              "broad phase even when approaching a thin obstacle.");
+                              "object will be next step (current + velocity * dt),\n"
+                              "then sweeps its motion against those candidates and\n"
+                              "stops it at the first time of impact.");
     }
+
+    if (isStatic != wasStatic || mass != oldMass || isFastMoving != wasFast)
+        CollisionBodyRegistry::MarkChanged(owner);
 }
 
 void ComponentRigidbody::onSave(std::string& outJson) const{
@@ -111,8 +194,12 @@ void ComponentRigidbody::onSave(std::string& outJson) const{
     doc.AddMember("mass", mass, a);
     doc.AddMember("isStatic", isStatic, a);
     doc.AddMember("restitution", restitution, a);
+    doc.AddMember("friction", friction, a);
     doc.AddMember("linearDamping", linearDamping, a);
+    doc.AddMember("angularDamping", angularDamping, a);
+    doc.AddMember("freezeRotation", freezeRotation, a);
     doc.AddMember("useGravity", useGravity, a);
+    doc.AddMember("canSleep", canSleep, a);
     doc.AddMember("gravityScale", gravityScale, a);
     doc.AddMember("useVelocityClamping", useVelocityClamping, a);
     doc.AddMember("velocityClampDiameters", velocityClampDiameters, a);
@@ -120,6 +207,9 @@ void ComponentRigidbody::onSave(std::string& outJson) const{
     Value vel(kArrayType);
     vel.PushBack(velocity.x, a).PushBack(velocity.y, a).PushBack(velocity.z, a);
     doc.AddMember("velocity", vel, a);
+    Value ang(kArrayType);
+    ang.PushBack(angularVelocity.x, a).PushBack(angularVelocity.y, a).PushBack(angularVelocity.z, a);
+    doc.AddMember("angularVelocity", ang, a);
     StringBuffer buf; Writer<StringBuffer> w(buf); doc.Accept(w);
     outJson = buf.GetString();
 }
@@ -130,8 +220,12 @@ void ComponentRigidbody::onLoad(const std::string& jsonStr){
     if (doc.HasMember("mass")) mass = doc["mass"].GetFloat();
     if (doc.HasMember("isStatic")) isStatic = doc["isStatic"].GetBool();
     if (doc.HasMember("restitution")) restitution = doc["restitution"].GetFloat();
+    if (doc.HasMember("friction")) friction = doc["friction"].GetFloat();
     if (doc.HasMember("linearDamping")) linearDamping = doc["linearDamping"].GetFloat();
+    if (doc.HasMember("angularDamping")) angularDamping = doc["angularDamping"].GetFloat();
+    if (doc.HasMember("freezeRotation")) freezeRotation = doc["freezeRotation"].GetBool();
     if (doc.HasMember("useGravity")) useGravity = doc["useGravity"].GetBool();
+    if (doc.HasMember("canSleep")) canSleep = doc["canSleep"].GetBool();
     if (doc.HasMember("gravityScale")) gravityScale = doc["gravityScale"].GetFloat();
     if (doc.HasMember("useVelocityClamping")) useVelocityClamping = doc["useVelocityClamping"].GetBool();
     if (doc.HasMember("velocityClampDiameters")) velocityClampDiameters = doc["velocityClampDiameters"].GetFloat();
@@ -140,4 +234,9 @@ void ComponentRigidbody::onLoad(const std::string& jsonStr){
         const auto& v = doc["velocity"];
         velocity = { v[0].GetFloat(), v[1].GetFloat(), v[2].GetFloat() };
     }
+    if (doc.HasMember("angularVelocity")){
+        const auto& w = doc["angularVelocity"];
+        angularVelocity = { w[0].GetFloat(), w[1].GetFloat(), w[2].GetFloat() };
+    }
+    CollisionBodyRegistry::MarkChanged(owner);
 }
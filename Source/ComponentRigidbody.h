@@ -5,14 +5,20 @@
 class ComponentRigidbody final : public Component {
 public:
     explicit ComponentRigidbody(GameObject* owner);
+    ~ComponentRigidbody() override;
 
     float mass = 1.f;
     bool isStatic = false;
     float restitution = 0.5f;
+    float friction = 0.5f;
     float linearDamping = 0.5f;
+    float angularDamping = 0.5f;
+    bool freezeRotation = false;
     bool useGravity = true;
+    bool canSleep = true;
 
     Vector3 velocity = {};
+    Vector3 angularVelocity = {};
 
     float gravityScale = 1.f;
     static constexpr float kGravityAccel = -9.81f;
@@ -27,9 +33,33 @@ public:
         return (isStatic || mass <= 0.f) ? 0.f : 1.f / mass;
     }
 
-    void update(float dt) override;
+    Vector3 getCenterOfMass() const;
+    void rotateAboutCenterOfMass(const Vector3& rotationVector);
+
+    // Sleeping bodies skip integration and are only re-gathered when woken or
+    // moved. No broad phase reports a pair of a sleeping body and one that
+    // cannot move. Bodies put to sleep together share an island id.
+    bool isSleeping() const { return m_sleeping; }
+    uint32_t getSleepIsland() const { return m_sleepIsland; }
+    float getSleepTimer() const { return m_sleepTimer; }
+    void setSleepTimer(float t){ m_sleepTimer = t; }
+    void sleep(uint32_t island);
+    void wakeUp();
+
+    void addImpulse(const Vector3& impulse);
+
+    // Advanced by PhysicsStepper at the fixed physics rate, not per frame.
+    // Position is a separate pass so fast movers can stop at a time of impact.
+    void integrateVelocity(float dt, float gravityY);
+    void integratePosition(float dt);
+
     void onEditor() override;
     void onSave(std::string& outJson) const override;
     void onLoad(const std::string& json) override;
     Type getType() const override { return Type::Rigidbody; }
+
+private:
+    bool m_sleeping = false;
+    uint32_t m_sleepIsland = 0;
+    float m_sleepTimer = 0.f;
 };
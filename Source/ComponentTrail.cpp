@@ -176,6 +176,30 @@ bool ComponentTrail::buildMesh(const Vector3& camPos, std::vector<TrailVertex>&
     return !outVertices.empty();
 }
 
+bool ComponentTrail::getBounds(Vector3& outMin, Vector3& outMax) const{
+    if (m_points.size() < 2) return false;
+
+    outMin = outMax = m_points.front().position;
+    float longest = 0.f;
+    for (size_t i = 1; i < m_points.size(); ++i){
+        outMin = Vector3::Min(outMin, m_points[i].position);
+        outMax = Vector3::Max(outMax, m_points[i].position);
+        longest = std::max(longest, Vector3::Distance(m_points[i].position, m_points[i - 1].position));
+    }
+
+    // Spline overshoot stays within half a segment; the ribbon adds its
+    // widest half-width on top.
+    float widest = 0.f;
+    for (int i = 0; i <= 16; ++i){
+        const float wMul = startWidthMul + (endWidthMul - startWidthMul) * widthCurve.Eval(i / 16.f);
+        widest = std::max(widest, wMul);
+    }
+    const float pad = 0.5f * width * widest + (useCatmullRom ? 0.5f * longest : 0.f);
+    outMin -= Vector3(pad, pad, pad);
+    outMax += Vector3(pad, pad, pad);
+    return true;
+}
+
 void ComponentTrail::onEditor(){
     if (auto* ed = app->getEditor()){
         bool playing = ed->isEffectsPlaying();
@@ -64,6 +64,10 @@ public:
 
     bool buildMesh(const Vector3& camPos, std::vector<TrailVertex>& outVertices) const;
 
+    // World box around any mesh buildMesh can produce, for culling before
+    // the mesh is built. False when there is nothing to draw.
+    bool getBounds(Vector3& outMin, Vector3& outMax) const;
+
 private:
     struct TrailPoint {
         Vector3 position;
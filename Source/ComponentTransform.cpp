@@ -1,7 +1,7 @@
 #include "Globals.h"
 #include "ComponentTransform.h"
 #include "GameObject.h"
-#include "RenderOctree.h"
+#include "CollisionBodyRegistry.h"
 #include "3rdParty/rapidjson/document.h"
 #include "3rdParty/rapidjson/writer.h"
 #include "3rdParty/rapidjson/stringbuffer.h"
@@ -12,7 +12,7 @@ ComponentTransform::ComponentTransform(GameObject* owner) : Component(owner){}
 
 void ComponentTransform::markDirty(){
     dirty = true;
-    RenderOctree::notifyTransformChanged();
+    CollisionBodyRegistry::MarkChanged(owner);
     for (auto* child : owner->getChildren())
         if (auto* t = child->getTransform()) t->markDirty();
 }
@@ -0,0 +1,48 @@
+#include "Globals.h"
+#include "ContactCache.h"
+
+static constexpr float kMatchDistance = 0.02f;
+
+void ContactCache::store(std::vector<ContactManifold>&& solved){
+    m_prev = std::move(solved);
+    m_index.clear();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_prev.size()); ++i)
+        m_index.emplace(m_prev[i].key, i);
+}
+
+uint32_t ContactCache::warmStart(std::vector<ContactManifold>& manifolds){
+    uint32_t matched = 0;
+    for (ContactManifold& m : manifolds){
+        auto it = m_index.find(m.key);
+        if (it == m_index.end()) continue;
+        const ContactManifold& prev = m_prev[it->second];
+        bool used[ContactManifold::kMaxPoints] = {};
+        for (uint32_t i = 0; i < m.pointCount; ++i){
+            ContactPoint& cp = m.points[i];
+            int best = -1;
+            float bestDist = kMatchDistance * kMatchDistance;
+            for (uint32_t j = 0; j < prev.pointCount; ++j){
+                if (used[j]) continue;
+                if (prev.points[j].featureId == cp.featureId){
+                    best = static_cast<int>(j);
+                    break;
+                }
+                const float d = Vector3::DistanceSquared(prev.points[j].point, cp.point);
+                if (d < bestDist){ bestDist = d; best = static_cast<int>(j); }
+            }
+            if (best < 0) continue;
+            const ContactPoint& old = prev.points[best];
+            used[best] = true;
+            cp.normalImpulse = old.normalImpulse;
+            cp.tangentImpulse[0] = old.tangentImpulse[0];
+            cp.tangentImpulse[1] = old.tangentImpulse[1];
+            ++matched;
+        }
+    }
+    return matched;
+}
+
+void ContactCache::clear(){
+    m_prev.clear();
+    m_index.clear();
+}
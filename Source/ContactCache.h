@@ -0,0 +1,20 @@
+#pragma once
+#include "CollisionInterfaces.h"
+#include <vector>
+#include <unordered_map>
+
+// Keeps last frame's solved manifolds so new manifolds of the same body pair
+// can inherit accumulated impulses point by point. Points match by feature id,
+// falling back to the nearest old point when clipping renamed the feature.
+class ContactCache {
+public:
+    void store(std::vector<ContactManifold>&& solved);
+    uint32_t warmStart(std::vector<ContactManifold>& manifolds);
+    void clear();
+
+    size_t size() const { return m_prev.size(); }
+
+private:
+    std::vector<ContactManifold> m_prev;
+    std::unordered_map<uint64_t, uint32_t> m_index;
+};
@@ -0,0 +1,166 @@
+#include "Globals.h"
+#include "ContinuousCollision.h"
+#include "CapsuleCollision.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+namespace ContinuousCollision {
+
+namespace {
+
+constexpr int kMaxIterations = 32;
+constexpr float kMinApproach = 1e-6f;
+
+// A sweep counts as converged once the overlap is within this fraction of
+// the target depth.
+constexpr float kConvergedFraction = 0.25f;
+
+inline bool isSphere(const CollisionBody& b){
+    return b.bvType == BVType::Sphere;
+}
+
+// Farthest surface point from the rotation center; a sphere spinning about
+// its own center does not move its surface.
+float sweepRadius(const CollisionBody& b){
+    if (isSphere(b)) return 0.f;
+    if (b.bvType == BVType::Capsule) return b.capsuleHalfHeight + b.capsuleRadius;
+    return sqrtf(b.obbHalves[0] * b.obbHalves[0] +
+                 b.obbHalves[1] * b.obbHalves[1] +
+                 b.obbHalves[2] * b.obbHalves[2]);
+}
+
+float projectBox(const CollisionBody& b, const Vector3& L){
+    return b.obbHalves[0] * fabsf(b.obbAxes[0].Dot(L)) +
+           b.obbHalves[1] * fabsf(b.obbAxes[1].Dot(L)) +
+           b.obbHalves[2] * fabsf(b.obbAxes[2].Dot(L));
+}
+
+float sphereVsSphere(const CollisionBody& a, const CollisionBody& b, Vector3& axis){
+    const Vector3 d = b.sphereCenter - a.sphereCenter;
+    const float len = d.Length();
+    axis = len > 1e-6f ? d / len : Vector3::UnitY;
+    return len - a.sphereRadius - b.sphereRadius;
+}
+
+// Axis points from the sphere towards the box.
+float sphereVsBox(const CollisionBody& s, const CollisionBody& box, Vector3& axis){
+    const Vector3 d = s.sphereCenter - box.obbCenter;
+    Vector3 closest = box.obbCenter;
+    for (int i = 0; i < 3; ++i){
+        const float q = d.Dot(box.obbAxes[i]);
+        closest += box.obbAxes[i] * std::clamp(q, -box.obbHalves[i], box.obbHalves[i]);
+    }
+
+    const Vector3 diff = closest - s.sphereCenter;
+    const float len = diff.Length();
+    if (len > 1e-6f){
+        axis = diff / len;
+        return len - s.sphereRadius;
+    }
+
+    float minPen = FLT_MAX;
+    for (int i = 0; i < 3; ++i){
+        const float q = d.Dot(box.obbAxes[i]);
+        const float pen = box.obbHalves[i] - fabsf(q);
+        if (pen < minPen){
+            minPen = pen;
+            axis = q >= 0.f ? -box.obbAxes[i] : box.obbAxes[i];
+        }
+    }
+    return -(minPen + s.sphereRadius);
+}
+
+float boxVsBox(const CollisionBody& a, const CollisionBody& b, Vector3& axis){
+    const Vector3 T = b.obbCenter - a.obbCenter;
+    float best = -FLT_MAX;
+    for (int k = 0; k < 15; ++k){
+        Vector3 L;
+        if (k < 3) L = a.obbAxes[k];
+        else if (k < 6) L = b.obbAxes[k - 3];
+        else L = a.obbAxes[(k - 6) / 3].Cross(b.obbAxes[(k - 6) % 3]);
+        const float len = L.Length();
+        if (len < 1e-6f) continue;
+        L /= len;
+
+        const float tl = T.Dot(L);
+        const float sep = fabsf(tl) - projectBox(a, L) - projectBox(b, L);
+        if (sep > best){
+            best = sep;
+            axis = tl >= 0.f ? L : -L;
+        }
+    }
+    return best;
+}
+
+}
+
+float SeparationBound(const CollisionBody& a, const CollisionBody& b, Vector3& outAxis){
+    if (a.bvType == BVType::Capsule) return CapsuleCollision::Separation(a, b, outAxis);
+    if (b.bvType == BVType::Capsule){
+        const float d = CapsuleCollision::Separation(b, a, outAxis);
+        outAxis = -outAxis;
+        return d;
+    }
+    if (isSphere(a) && isSphere(b)) return sphereVsSphere(a, b, outAxis);
+    if (isSphere(a)) return sphereVsBox(a, b, outAxis);
+    if (isSphere(b)){
+        const float d = sphereVsBox(b, a, outAxis);
+        outAxis = -outAxis;
+        return d;
+    }
+    return boxVsBox(a, b, outAxis);
+}
+
+CollisionBody Advance(const CollisionBody& body, const Motion& motion, float fraction){
+    CollisionBody out = body;
+    const Vector3 offset = motion.linear * fraction;
+    out.obbCenter += offset;
+    out.sphereCenter += offset;
+    out.worldAABB.min += offset;
+    out.worldAABB.max += offset;
+
+    const Vector3 turn = motion.angular * fraction;
+    const float angle = turn.Length();
+    if (angle > 1e-9f){
+        const Quaternion q = Quaternion::CreateFromAxisAngle(turn / angle, angle);
+        for (int k = 0; k < 3; ++k) out.obbAxes[k] = Vector3::Transform(body.obbAxes[k], q);
+    }
+    return out;
+}
+
+// Each advance covers (distance + targetDepth) at the fastest rate the pair
+// can close along the current separating axis: relative linear motion plus
+// the farthest any surface point can swing. The overlap therefore never
+// exceeds targetDepth, whatever happens inside the advanced interval.
+TimeOfImpact Sweep(const CollisionBody& a, const Motion& motionA,
+                   const CollisionBody& b, const Motion& motionB,
+                   float targetDepth){
+    TimeOfImpact result;
+    Vector3 axis;
+    float distance = SeparationBound(a, b, axis);
+    if (distance <= 0.f) return result;
+
+    const Vector3 relative = motionB.linear - motionA.linear;
+    const float angularBound = motionA.angular.Length() * sweepRadius(a) +
+                               motionB.angular.Length() * sweepRadius(b);
+
+    float t = 0.f;
+    for (int it = 0; it < kMaxIterations; ++it){
+        result.iterations = it + 1;
+        const float approach = angularBound - relative.Dot(axis);
+        if (approach <= kMinApproach) return result;
+
+        t += (distance + targetDepth) / approach;
+        if (t >= 1.f) return result;
+
+        distance = SeparationBound(Advance(a, motionA, t), Advance(b, motionB, t), axis);
+        if (distance + targetDepth <= kConvergedFraction * targetDepth) break;
+    }
+
+    result.fraction = t;
+    result.hit = true;
+    return result;
+}
+
+}
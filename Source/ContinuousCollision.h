@@ -0,0 +1,35 @@
+#pragma once
+#include "CollisionInterfaces.h"
+
+namespace ContinuousCollision {
+
+    // Rigid motion over one step: the body's center moves by `linear` and it
+    // turns by the rotation vector `angular` about that center.
+    struct Motion {
+        Vector3 linear;
+        Vector3 angular;
+    };
+
+    struct TimeOfImpact {
+        float fraction = 1.f;
+        bool hit = false;
+        int iterations = 0;
+    };
+
+    // Lower bound on the distance between two shapes (negative when they
+    // overlap). Exact for sphere and capsule pairs; for boxes it is the largest
+    // separation over the 15 SAT axes, and `outAxis` is that axis pointing
+    // from a to b.
+    float SeparationBound(const CollisionBody& a, const CollisionBody& b, Vector3& outAxis);
+
+    // Conservative advancement: steps both bodies along their motions until
+    // they overlap by targetDepth, never further. Pairs already touching at
+    // the start are left to the discrete solver and report no hit.
+    TimeOfImpact Sweep(const CollisionBody& a, const Motion& motionA,
+                       const CollisionBody& b, const Motion& motionB,
+                       float targetDepth = 0.01f);
+
+    // Shape moved along `motion` by `fraction` of the step.
+    CollisionBody Advance(const CollisionBody& body, const Motion& motion, float fraction);
+
+}
@@ -0,0 +1,403 @@
+#include "Globals.h"
+#include "CullingBenchmark.h"
+#include "FrustumCulling.h"
+#include "LightClusters.h"
+#include "OcclusionCuller.h"
+#include "RenderOctree.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+namespace CullingBenchmark {
+
+namespace {
+
+constexpr float kRoomSize = 10.f;
+constexpr float kWallHeight = 3.f;
+constexpr float kWallHalfThickness = 0.1f;
+constexpr float kDoorHalfWidth = 0.8f;
+constexpr float kDoorHeight = 2.2f;
+constexpr float kEyeHeight = 1.7f;
+constexpr int kViewCount = 8;
+constexpr int kSamplesPerAxis = 3;
+
+struct Box {
+    Vector3 mn, mx;
+};
+
+struct RoomScene {
+    std::vector<Box> walls;
+    std::vector<Box> props;
+    std::vector<Vector3> eyes;
+    std::vector<Matrix> viewProjs;
+};
+
+// One wall along an axis from `from` to `to`; inner walls get a doorway in
+// the middle with a lintel above it.
+void addWall(std::vector<Box>& walls, bool alongX, float line, float from, float to, bool door){
+    auto push = [&](float a, float b, float y0, float y1){
+        if (alongX) walls.push_back({ Vector3(a, y0, line - kWallHalfThickness), Vector3(b, y1, line + kWallHalfThickness) });
+        else walls.push_back({ Vector3(line - kWallHalfThickness, y0, a), Vector3(line + kWallHalfThickness, y1, b) });
+    };
+    if (!door){
+        push(from, to, 0.f, kWallHeight);
+        return;
+    }
+    const float mid = (from + to) * 0.5f;
+    push(from, mid - kDoorHalfWidth, 0.f, kWallHeight);
+    push(mid + kDoorHalfWidth, to, 0.f, kWallHeight);
+    push(mid - kDoorHalfWidth, mid + kDoorHalfWidth, kDoorHeight, kWallHeight);
+}
+
+RoomScene makeRooms(uint32_t roomsPerSide, uint32_t propsPerRoom){
+    RoomScene s;
+    const float size = kRoomSize * roomsPerSide;
+    for (uint32_t line = 0; line <= roomsPerSide; ++line){
+        const bool outer = line == 0 || line == roomsPerSide;
+        for (uint32_t cell = 0; cell < roomsPerSide; ++cell){
+            const float from = cell * kRoomSize, to = from + kRoomSize;
+            addWall(s.walls, true, line * kRoomSize, from, to, !outer);
+            addWall(s.walls, false, line * kRoomSize, from, to, !outer);
+        }
+    }
+
+    std::mt19937 rng(4242u + roomsPerSide);
+    std::uniform_real_distribution<float> inRoom(0.6f, kRoomSize - 0.6f);
+    std::uniform_real_distribution<float> half(0.15f, 0.5f);
+    for (uint32_t rz = 0; rz < roomsPerSide; ++rz){
+        for (uint32_t rx = 0; rx < roomsPerSide; ++rx){
+            for (uint32_t p = 0; p < propsPerRoom; ++p){
+                const Vector3 h(half(rng), half(rng), half(rng));
+                const Vector3 c(rx * kRoomSize + inRoom(rng), h.y, rz * kRoomSize + inRoom(rng));
+                s.props.push_back({ c - h, c + h });
+            }
+        }
+    }
+
+    std::uniform_int_distribution<uint32_t> room(0, roomsPerSide - 1);
+    std::uniform_real_distribution<float> jitter(-2.f, 2.f);
+    const Matrix proj = Matrix::CreatePerspectiveFieldOfView(XM_PI / 3.f, 16.f / 9.f, 0.1f, size * 2.f);
+    for (int v = 0; v < kViewCount; ++v){
+        const Vector3 eye((room(rng) + 0.5f) * kRoomSize + jitter(rng), kEyeHeight,
+                          (room(rng) + 0.5f) * kRoomSize + jitter(rng));
+        const float yaw = v * XM_PIDIV4;
+        const Vector3 fwd(sinf(yaw), -0.1f, cosf(yaw));
+        s.eyes.push_back(eye);
+        s.viewProjs.push_back(Matrix::CreateLookAt(eye, eye + fwd, Vector3::UnitY) * proj);
+    }
+    return s;
+}
+
+bool segmentHitsBox(const Vector3& from, const Vector3& to, const Box& b){
+    float t0 = 0.f, t1 = 1.f;
+    const float o[3] = { from.x, from.y, from.z };
+    const float d[3] = { to.x - from.x, to.y - from.y, to.z - from.z };
+    const float mn[3] = { b.mn.x, b.mn.y, b.mn.z };
+    const float mx[3] = { b.mx.x, b.mx.y, b.mx.z };
+    for (int a = 0; a < 3; ++a){
+        if (fabsf(d[a]) < 1e-12f){
+            if (o[a] < mn[a] || o[a] > mx[a]) return false;
+            continue;
+        }
+        const float inv = 1.f / d[a];
+        float n = (mn[a] - o[a]) * inv, f = (mx[a] - o[a]) * inv;
+        if (n > f) std::swap(n, f);
+        t0 = std::max(t0, n);
+        t1 = std::min(t1, f);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+// A culled prop was wrongly culled when some sample point on it lands on
+// screen and the segment from the eye to it misses every wall.
+bool reachable(const RoomScene& s, int view, const Box& prop){
+    const Vector3 eye = s.eyes[view];
+    for (int i = 0; i < kSamplesPerAxis * kSamplesPerAxis * kSamplesPerAxis; ++i){
+        const float fx = 0.02f + 0.96f * (i % kSamplesPerAxis) / (kSamplesPerAxis - 1);
+        const float fy = 0.02f + 0.96f * (i / kSamplesPerAxis % kSamplesPerAxis) / (kSamplesPerAxis - 1);
+        const float fz = 0.02f + 0.96f * (i / (kSamplesPerAxis * kSamplesPerAxis)) / (kSamplesPerAxis - 1);
+        const Vector3 p = prop.mn + (prop.mx - prop.mn) * Vector3(fx, fy, fz);
+        const Vector4 c = Vector4::Transform(Vector4(p.x, p.y, p.z, 1.f), s.viewProjs[view]);
+        if (c.w <= 0.f || c.z < 0.f || c.z > c.w || fabsf(c.x) > c.w || fabsf(c.y) > c.w) continue;
+        bool blocked = false;
+        for (const Box& w : s.walls){
+            if (segmentHitsBox(eye, p, w)){
+                blocked = true;
+                break;
+            }
+        }
+        if (!blocked) return true;
+    }
+    return false;
+}
+
+}
+
+std::vector<OcclusionResult> RunOcclusion(uint32_t roomsPerSide, uint32_t propsPerRoom, int repeats){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<OcclusionResult> results;
+    if (repeats < 1) repeats = 1;
+    if (roomsPerSide < 1) roomsPerSide = 1;
+
+    const RoomScene scene = makeRooms(roomsPerSide, propsPerRoom);
+    const uint32_t propCount = static_cast<uint32_t>(scene.props.size());
+    const uint32_t wallCount = static_cast<uint32_t>(scene.walls.size());
+
+    FrustumCulling::BoxSet propBoxes, wallBoxes;
+    for (const Box& b : scene.props) propBoxes.push(b.mn, b.mx);
+    for (const Box& b : scene.walls) wallBoxes.push(b.mn, b.mx);
+
+    std::vector<std::vector<uint32_t>> frustumProps(kViewCount), frustumWalls(kViewCount);
+    std::vector<uint32_t> bits;
+    for (int v = 0; v < kViewCount; ++v){
+        const Frustum frustum = Frustum::fromViewProj(scene.viewProjs[v]);
+        bits.resize(FrustumCulling::MaskWords(propCount));
+        FrustumCulling::Cull(frustum, propBoxes.view(nullptr), bits.data());
+        for (uint32_t i = 0; i < propCount; ++i)
+            if (FrustumCulling::IsVisible(bits.data(), i)) frustumProps[v].push_back(i);
+        bits.resize(FrustumCulling::MaskWords(wallCount));
+        FrustumCulling::Cull(frustum, wallBoxes.view(nullptr), bits.data());
+        for (uint32_t i = 0; i < wallCount; ++i)
+            if (FrustumCulling::IsVisible(bits.data(), i)) frustumWalls[v].push_back(i);
+    }
+
+    struct Case { OcclusionCuller::Path path; uint32_t threads; };
+    const OcclusionCuller::Path best = OcclusionCuller::bestPath();
+    std::vector<Case> cases = { { OcclusionCuller::Path::Scalar, 1 }, { OcclusionCuller::Path::SSE, 1 } };
+    if (best == OcclusionCuller::Path::AVX2) cases.push_back({ OcclusionCuller::Path::AVX2, 1 });
+    cases.push_back({ best, std::clamp(WorkerPool::hardwareThreads(), 1u, 4u) });
+
+    std::vector<std::vector<uint8_t>> reference(kViewCount);
+    OcclusionCuller culler;
+    for (const Case& c : cases){
+        culler.setPath(c.path);
+        culler.setThreadCount(c.threads);
+
+        OcclusionResult r;
+        r.path = OcclusionCuller::pathName(culler.getPath());
+        r.threads = c.threads;
+        r.views = kViewCount;
+        r.objects = propCount * kViewCount;
+
+        float rasterMs = 0.f, testMs = 0.f;
+        for (int v = 0; v < kViewCount; ++v){
+            const std::vector<uint32_t>& candidates = frustumProps[v];
+            std::vector<uint8_t> visible(candidates.size());
+            for (int rep = 0; rep < repeats; ++rep){
+                auto t0 = Clock::now();
+                culler.beginFrame(scene.viewProjs[v]);
+                for (uint32_t w : frustumWalls[v]) culler.addOccluderBox(scene.walls[w].mn, scene.walls[w].mx);
+                culler.rasterize();
+                auto t1 = Clock::now();
+                for (size_t i = 0; i < candidates.size(); ++i){
+                    const Box& b = scene.props[candidates[i]];
+                    visible[i] = culler.isVisible(b.mn, b.mx) ? 1 : 0;
+                }
+                auto t2 = Clock::now();
+                rasterMs += std::chrono::duration<float, std::milli>(t1 - t0).count();
+                testMs += std::chrono::duration<float, std::milli>(t2 - t1).count();
+            }
+
+            r.frustumVisible += static_cast<uint32_t>(candidates.size());
+            r.occluderTris += culler.getTriangleCount();
+            for (size_t i = 0; i < candidates.size(); ++i){
+                if (visible[i]){
+                    ++r.occlusionVisible;
+                } else if (reachable(scene, v, scene.props[candidates[i]])){
+                    ++r.falseCulls;
+                }
+            }
+            if (reference[v].empty()){
+                reference[v] = visible;
+            } else {
+                for (size_t i = 0; i < visible.size(); ++i)
+                    if (visible[i] != reference[v][i]) ++r.mismatches;
+            }
+        }
+        r.rasterMs = rasterMs / (kViewCount * repeats);
+        r.testMs = testMs / (kViewCount * repeats);
+        results.push_back(r);
+    }
+    return results;
+}
+
+std::vector<LightClusterResult> RunLightClusters(uint32_t maxLights, int repeats){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<LightClusterResult> results;
+    if (repeats < 1) repeats = 1;
+
+    const Matrix view = Matrix::CreateLookAt(Vector3(0.f, 6.f, 120.f), Vector3(0.f, 2.f, 0.f), Vector3::UnitY);
+    const Matrix proj = Matrix::CreatePerspectiveFieldOfView(XM_PI / 3.f, 16.f / 9.f, 0.1f, 300.f);
+
+    std::mt19937 rng(777u);
+    std::uniform_real_distribution<float> across(-120.f, 120.f), height(0.f, 12.f), radius(0.5f, 8.f);
+    std::vector<Vector4> spheres(maxLights);
+    for (Vector4& s : spheres) s = Vector4(across(rng), height(rng), across(rng), radius(rng));
+
+    struct Case { LightClusters::Path path; uint32_t threads; };
+    const LightClusters::Path best = LightClusters::bestPath();
+    std::vector<Case> cases = { { LightClusters::Path::Scalar, 1 }, { LightClusters::Path::SSE, 1 } };
+    if (best == LightClusters::Path::AVX2) cases.push_back({ LightClusters::Path::AVX2, 1 });
+    cases.push_back({ best, std::clamp(WorkerPool::hardwareThreads(), 1u, 4u) });
+
+    LightClusters clusters;
+    std::vector<uint32_t> expected;
+    for (uint32_t lights = 256; lights <= maxLights; lights *= 4){
+        const uint32_t pointCount = lights * 3 / 4, spotCount = lights - pointCount;
+
+        // The reference lists, built once per light count.
+        clusters.build(spheres.data(), pointCount, spotCount, view, proj);
+        std::vector<Vector3> centers(lights);
+        for (uint32_t l = 0; l < lights; ++l) centers[l] = clusters.toView(spheres[l]);
+        std::vector<uint32_t> refOffsets(LightClusters::kClusterCount + 1, 0), refPoints(LightClusters::kClusterCount);
+        expected.clear();
+        const auto b0 = Clock::now();
+        for (uint32_t z = 0; z < LightClusters::kGridZ; ++z){
+            for (uint32_t y = 0; y < LightClusters::kGridY; ++y){
+                for (uint32_t x = 0; x < LightClusters::kGridX; ++x){
+                    const uint32_t c = LightClusters::clusterIndex(x, y, z);
+                    Vector3 mn, mx;
+                    clusters.clusterBounds(x, y, z, mn, mx);
+                    refOffsets[c] = static_cast<uint32_t>(expected.size());
+                    for (uint32_t l = 0; l < lights; ++l){
+                        if (!LightClusters::touches(mn, mx, centers[l], spheres[l].w * spheres[l].w)) continue;
+                        expected.push_back(l < pointCount ? l : l - pointCount);
+                        if (l < pointCount) ++refPoints[c];
+                    }
+                }
+            }
+        }
+        refOffsets[LightClusters::kClusterCount] = static_cast<uint32_t>(expected.size());
+        const float bruteMs = std::chrono::duration<float, std::milli>(Clock::now() - b0).count();
+
+        for (const Case& k : cases){
+            clusters.setPath(k.path);
+            clusters.setThreadCount(k.threads);
+
+            LightClusterResult r;
+            r.path = LightClusters::pathName(clusters.getPath());
+            r.threads = k.threads;
+            r.lights = lights;
+            r.bruteMs = bruteMs;
+
+            clusters.build(spheres.data(), pointCount, spotCount, view, proj);
+            const auto t0 = Clock::now();
+            for (int rep = 0; rep < repeats; ++rep) clusters.build(spheres.data(), pointCount, spotCount, view, proj);
+            r.buildMs = std::chrono::duration<float, std::milli>(Clock::now() - t0).count() / repeats;
+
+            const std::vector<uint32_t>& indices = clusters.getIndices();
+            r.references = static_cast<uint32_t>(indices.size());
+            r.maxPerCluster = clusters.getMaxPerCluster();
+            for (uint32_t c = 0; c < LightClusters::kClusterCount; ++c){
+                const LightClusters::Cluster& got = clusters.getClusters()[c];
+                const uint32_t count = refOffsets[c + 1] - refOffsets[c];
+                if (got.pointCount != refPoints[c] || got.pointCount + got.spotCount != count
+                    || !std::equal(expected.begin() + refOffsets[c], expected.begin() + refOffsets[c + 1],
+                                   indices.begin() + got.offset)){
+                    ++r.mismatches;
+                }
+            }
+            results.push_back(r);
+        }
+    }
+    return results;
+}
+
+std::vector<OctreeResult> RunRenderOctree(uint32_t objectCount, uint32_t moverCount, int frames){
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<OctreeResult> results;
+    if (frames < 1) frames = 1;
+    moverCount = std::min(moverCount, objectCount);
+
+    std::mt19937 rng(4242u);
+    std::uniform_real_distribution<float> across(-500.f, 500.f), size(0.2f, 3.f), heading(-1.f, 1.f);
+    std::vector<AABB> start(objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i){
+        const Vector3 c(across(rng), across(rng) * 0.1f, across(rng));
+        const float s = i % 1000 == 0 ? 60.f : size(rng);
+        start[i] = { c - Vector3(s, s, s), c + Vector3(s, s, s) };
+    }
+    std::vector<Vector3> velocity(moverCount);
+    for (Vector3& v : velocity) v = Vector3(heading(rng), 0.f, heading(rng)) * 30.f;
+
+    auto frustumAt = [](int f){
+        const float yaw = f * 0.02f;
+        return Frustum::fromCamera(Vector3(0.f, 5.f, 0.f), Vector3(sinf(yaw), 0.f, cosf(yaw)),
+                                   Vector3(cosf(yaw), 0.f, -sinf(yaw)), Vector3::UnitY,
+                                   1.f, 16.f / 9.f, 0.1f, 400.f);
+    };
+
+    // The brute-force run comes first and keeps every frame's visible set.
+    std::vector<std::vector<uint32_t>> expected(frames);
+    enum class Mode { Brute, Incremental, Rebuild };
+    for (Mode mode : { Mode::Brute, Mode::Incremental, Mode::Rebuild }){
+        std::vector<AABB> boxesNow = start;
+        RenderOctree octree;
+        FrustumCulling::BoxSet boxes;
+        std::vector<uint32_t> bits;
+        std::vector<uint32_t> visible;
+        if (mode == Mode::Incremental){
+            octree.beginUpdate();
+            for (uint32_t i = 0; i < objectCount; ++i) octree.update(i, boxesNow[i]);
+            octree.endUpdate();
+        }
+
+        OctreeResult r;
+        r.mode = mode == Mode::Brute ? "Brute force" : mode == Mode::Incremental ? "Incremental" : "Rebuild";
+        r.objects = objectCount;
+        r.frames = static_cast<uint32_t>(frames);
+        double updateMs = 0.0, queryMs = 0.0, visibleSum = 0.0, movedSum = 0.0;
+        for (int f = 0; f < frames; ++f){
+            for (uint32_t i = 0; i < moverCount; ++i){
+                boxesNow[i].min += velocity[i] * (1.f / 60.f);
+                boxesNow[i].max += velocity[i] * (1.f / 60.f);
+            }
+            const Frustum frustum = frustumAt(f);
+            visible.clear();
+
+            const auto t0 = Clock::now();
+            if (mode == Mode::Brute){
+                boxes.clear();
+                for (const AABB& b : boxesNow) boxes.push(b.min, b.max);
+            } else if (mode == Mode::Incremental){
+                octree.beginUpdate();
+                for (uint32_t i = 0; i < moverCount; ++i) octree.update(i, boxesNow[i]);
+                octree.endUpdate();
+            } else {
+                octree.clear();
+                octree.beginUpdate();
+                for (uint32_t i = 0; i < objectCount; ++i) octree.update(i, boxesNow[i]);
+                octree.endUpdate();
+            }
+            const auto t1 = Clock::now();
+            if (mode == Mode::Brute){
+                bits.resize(FrustumCulling::MaskWords(boxes.size()));
+                FrustumCulling::Cull(frustum, boxes.view(nullptr), bits.data());
+                for (uint32_t i = 0; i < boxes.size(); ++i)
+                    if (FrustumCulling::IsVisible(bits.data(), i)) visible.push_back(i);
+            } else {
+                octree.query(frustum, visible);
+            }
+            const auto t2 = Clock::now();
+            updateMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            queryMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+            visibleSum += visible.size();
+            if (mode != Mode::Brute) movedSum += octree.getLastMovedCount();
+
+            std::sort(visible.begin(), visible.end());
+            if (mode == Mode::Brute) expected[f] = visible;
+            else if (visible != expected[f]) ++r.mismatches;
+        }
+        r.updateMs = static_cast<float>(updateMs / frames);
+        r.queryMs = static_cast<float>(queryMs / frames);
+        r.visible = static_cast<uint32_t>(visibleSum / frames + 0.5);
+        r.moved = static_cast<float>(movedSum / frames);
+        results.push_back(r);
+    }
+    return results;
+}
+
+}
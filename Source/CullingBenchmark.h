@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+namespace CullingBenchmark {
+
+    struct OcclusionResult {
+        const char* path = "";
+        uint32_t threads = 1;
+        uint32_t views = 0;
+        uint32_t objects = 0;
+        uint32_t frustumVisible = 0;
+        uint32_t occlusionVisible = 0;
+        uint32_t occluderTris = 0;
+        float rasterMs = 0.f;
+        float testMs = 0.f;
+        uint32_t mismatches = 0;
+        uint32_t falseCulls = 0;
+    };
+
+    // Headless: a grid of walled rooms with doorways, filled with small
+    // props, seen from several eye-height views. Props are frustum culled,
+    // then the walls are rasterized as occluders on each path and the
+    // survivors tested. Counts are summed over the views and times are per
+    // view. Mismatches are props whose verdict differs from the scalar path;
+    // false culls are culled props that a ray from the eye still reaches.
+    std::vector<OcclusionResult> RunOcclusion(uint32_t roomsPerSide = 8,
+                                              uint32_t propsPerRoom = 40,
+                                              int repeats = 20);
+
+    struct LightClusterResult {
+        const char* path = "";
+        uint32_t threads = 1;
+        uint32_t lights = 0;
+        float buildMs = 0.f;
+        float bruteMs = 0.f;
+        uint32_t references = 0;
+        uint32_t maxPerCluster = 0;
+        uint32_t mismatches = 0;
+    };
+
+    // Headless: point and spot lights of mixed radius scattered over a wide
+    // street-level volume, seen from one camera. For each light count every
+    // path builds the clusters; bruteMs tests every cluster against every
+    // light with LightClusters::touches and mismatches counts the clusters
+    // whose index run differs from that brute-force list.
+    std::vector<LightClusterResult> RunLightClusters(uint32_t maxLights = 16384, int repeats = 10);
+
+    struct OctreeResult {
+        const char* mode = "";
+        uint32_t objects = 0;
+        uint32_t frames = 0;
+        float updateMs = 0.f;
+        float queryMs = 0.f;
+        uint32_t visible = 0;
+        float moved = 0.f;
+        uint32_t mismatches = 0;
+    };
+
+    // Headless: a wide field of static boxes with a few hundred movers and a
+    // turning camera. Each frame "Incremental" updates only the movers in one
+    // RenderOctree, "Rebuild" clears it and inserts everything again as the
+    // old octree did, and "Brute force" culls every box. Times and counts are
+    // per frame; mismatches counts the frames where an octree's visible set
+    // differs from the brute-force set.
+    std::vector<OctreeResult> RunRenderOctree(uint32_t objectCount = 50000, uint32_t moverCount = 200,
+                                              int frames = 300);
+}
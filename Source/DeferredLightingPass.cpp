@@ -9,6 +9,7 @@
 #include "ModuleShaderDescriptors.h"
 #include "Application.h"
 #include "ModuleD3D12.h"
+#include "WorkerPool.h"
 #include <d3dx12.h>
 #include <algorithm>
 
@@ -29,17 +30,6 @@ namespace {
         return buf;
     }
 
-    void makeStructuredSRV(ShaderTableDesc& table, UINT slot,
-                            ID3D12Resource* buf, UINT numElems, UINT stride){
-        D3D12_SHADER_RESOURCE_VIEW_DESC srv = {};
-        srv.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-        srv.Format = DXGI_FORMAT_UNKNOWN;
-        srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srv.Buffer.NumElements = numElems;
-        srv.Buffer.StructureByteStride = stride;
-        table.createSRV(buf, slot, &srv);
-    }
-
     void writeFallbackCubeSRV(ShaderTableDesc& table, UINT slot, ID3D12Resource* cube){
         D3D12_SHADER_RESOURCE_VIEW_DESC sv = {};
         sv.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -66,12 +56,8 @@ bool DeferredLightingPass::init(ID3D12Device* device){
         LOG("DeferredLightingPass: pipeline init failed");
         return false;
     }
-    if (!m_lightCulling.init(device)){
-        LOG("DeferredLightingPass: light culling init failed");
-        return false;
-    }
     if (!createUploadBuffers(device)) return false;
-    if (!createLightSRVs()) return false;
+    m_clusters.setThreadCount(std::clamp(WorkerPool::hardwareThreads() / 2, 1u, 4u));
     if (!createFallbackIBL(device)) return false;
     LOG("DeferredLightingPass: init OK");
     return true;
@@ -83,37 +69,13 @@ bool DeferredLightingPass::createUploadBuffers(ID3D12Device* device){
         m_perFrameCB[i] = makeUploadBuf(device, cbSz, &m_perFrameMapped[i], L"DeferredLight_PerFrameCB");
         if (!m_perFrameCB[i]) return false;
 
-        m_dirLightBuf[i] = makeUploadBuf(device,
-            sizeof(MeshPipeline::GPUDirectionalLight) * MeshPipeline::MAX_DIR_LIGHTS,
-            &m_dirLightMapped[i], L"DeferredLight_DirLights");
-        m_pointLightBuf[i] = makeUploadBuf(device,
-            sizeof(MeshPipeline::GPUPointLight) * MeshPipeline::MAX_POINT_LIGHTS,
-            &m_pointLightMapped[i], L"DeferredLight_PointLights");
-        m_spotLightBuf[i] = makeUploadBuf(device,
-            sizeof(MeshPipeline::GPUSpotLight) * MeshPipeline::MAX_SPOT_LIGHTS,
-            &m_spotLightMapped[i], L"DeferredLight_SpotLights");
-
-        if (!m_dirLightBuf[i] || !m_pointLightBuf[i] || !m_spotLightBuf[i]) return false;
-    }
-    return true;
-}
-
-bool DeferredLightingPass::createLightSRVs(){
-    auto* sd = app->getShaderDescriptors();
-    for (int i = 0; i < NUM_VIEWPORTS; ++i){
-        m_dirLightSRV[i] = sd->allocTable("DeferredLight_DirSRV");
-        m_pointLightSRV[i] = sd->allocTable("DeferredLight_PointSRV");
-        m_spotLightSRV[i] = sd->allocTable("DeferredLight_SpotSRV");
-        if (!m_dirLightSRV[i].isValid() || !m_pointLightSRV[i].isValid() || !m_spotLightSRV[i].isValid()){
-            LOG("DeferredLightingPass: light SRV alloc failed");
-            return false;
-        }
-        makeStructuredSRV(m_dirLightSRV[i], 0, m_dirLightBuf[i].Get(),
-                           MeshPipeline::MAX_DIR_LIGHTS, sizeof(MeshPipeline::GPUDirectionalLight));
-        makeStructuredSRV(m_pointLightSRV[i], 0, m_pointLightBuf[i].Get(),
-                           MeshPipeline::MAX_POINT_LIGHTS, sizeof(MeshPipeline::GPUPointLight));
-        makeStructuredSRV(m_spotLightSRV[i], 0, m_spotLightBuf[i].Get(),
-                           MeshPipeline::MAX_SPOT_LIGHTS, sizeof(MeshPipeline::GPUSpotLight));
+        const bool ok = m_dirLights[i].init(device, sizeof(MeshPipeline::GPUDirectionalLight), 4, L"DeferredLight_DirLights")
+                     && m_pointLights[i].init(device, sizeof(MeshPipeline::GPUPointLight), 64, L"DeferredLight_PointLights")
+                     && m_spotLights[i].init(device, sizeof(MeshPipeline::GPUSpotLight), 32, L"DeferredLight_SpotLights")
+                     && m_clusterBuf[i].init(device, sizeof(LightClusters::Cluster), LightClusters::kClusterCount,
+                                             L"DeferredLight_Clusters")
+                     && m_clusterIndices[i].init(device, sizeof(uint32_t), 4096, L"DeferredLight_ClusterIndices");
+        if (!ok) return false;
     }
     return true;
 }
@@ -187,30 +149,37 @@ bool DeferredLightingPass::createFallbackIBL(ID3D12Device* device){
     return true;
 }
 
+// Spot lights are binned by their range sphere; the cone is left to the shader.
+void DeferredLightingPass::buildClusters(const FrameLightData& lights, const Matrix& view, const Matrix& projection){
+    m_lightSpheres.clear();
+    for (const auto& l : lights.pointLights)
+        m_lightSpheres.emplace_back(l.position.x, l.position.y, l.position.z, sqrtf(l.squaredRadius));
+    for (const auto& l : lights.spotLights)
+        m_lightSpheres.emplace_back(l.position.x, l.position.y, l.position.z, sqrtf(l.squaredRadius));
+    m_clusters.build(m_lightSpheres.data(), static_cast<uint32_t>(lights.pointLights.size()),
+                     static_cast<uint32_t>(lights.spotLights.size()), view, projection);
+}
+
 void DeferredLightingPass::uploadLights(const FrameLightData& lights, int viewportIndex){
-    auto copy = [](void* dst, const void* src, size_t count, size_t stride, size_t maxCount){
-        UINT n = static_cast<UINT>(std::min(count, maxCount));
-        if (n > 0) memcpy(dst, src, n * stride);
-    };
-    copy(m_dirLightMapped[viewportIndex], lights.dirLights.data(), lights.dirLights.size(),
-         sizeof(MeshPipeline::GPUDirectionalLight), MeshPipeline::MAX_DIR_LIGHTS);
-    copy(m_pointLightMapped[viewportIndex], lights.pointLights.data(), lights.pointLights.size(),
-         sizeof(MeshPipeline::GPUPointLight), MeshPipeline::MAX_POINT_LIGHTS);
-    copy(m_spotLightMapped[viewportIndex], lights.spotLights.data(), lights.spotLights.size(),
-         sizeof(MeshPipeline::GPUSpotLight), MeshPipeline::MAX_SPOT_LIGHTS);
+    m_dirLights[viewportIndex].upload(lights.dirLights.data(), lights.dirLights.size());
+    m_pointLights[viewportIndex].upload(lights.pointLights.data(), lights.pointLights.size());
+    m_spotLights[viewportIndex].upload(lights.spotLights.data(), lights.spotLights.size());
+    m_clusterBuf[viewportIndex].upload(m_clusters.getClusters().data(), m_clusters.getClusters().size());
+    m_clusterIndices[viewportIndex].upload(m_clusters.getIndices().data(), m_clusters.getIndices().size());
 }
 
 void DeferredLightingPass::uploadPerFrameCB(const FrameLightData& lights,
                                              const Vector3& cameraPos,
+                                             const Matrix& view,
                                              const Matrix& invViewProj,
                                              uint32_t envRoughLevels,
                                              uint32_t width, uint32_t height,
                                              int viewportIndex,
                                              const ShadowRenderData& shadow){
     CbPerFrame cb = {};
-    cb.dirLightCount = static_cast<uint32_t>(std::min(lights.dirLights.size(), (size_t)MeshPipeline::MAX_DIR_LIGHTS));
-    cb.pointLightCount = static_cast<uint32_t>(std::min(lights.pointLights.size(), (size_t)MeshPipeline::MAX_POINT_LIGHTS));
-    cb.spotLightCount = static_cast<uint32_t>(std::min(lights.spotLights.size(), (size_t)MeshPipeline::MAX_SPOT_LIGHTS));
+    cb.dirLightCount = static_cast<uint32_t>(lights.dirLights.size());
+    cb.pointLightCount = static_cast<uint32_t>(lights.pointLights.size());
+    cb.spotLightCount = static_cast<uint32_t>(lights.spotLights.size());
     cb.envRoughnessLevels = envRoughLevels;
     cb.cameraPosition = cameraPos;
     cb.framePad = 0;
@@ -242,6 +211,9 @@ void DeferredLightingPass::uploadPerFrameCB(const FrameLightData& lights,
                                    invRange, 0.0f);
     cb.pointShadowPos = Vector4(shadow.pointPos.x, shadow.pointPos.y, shadow.pointPos.z, 0.0f);
 
+    cb.viewDepthRow = Vector4(-view._13, -view._23, -view._33, -view._43);
+    cb.clusterParams = Vector4(m_clusters.getSliceScale(), m_clusters.getSliceBias(), 0.0f, 0.0f);
+
     memcpy(m_perFrameMapped[viewportIndex], &cb, sizeof(cb));
 }
 
@@ -264,10 +236,9 @@ void DeferredLightingPass::render(ID3D12GraphicsCommandList* cmd,
     uint32_t roughLevels = 0;
     if (env && env->hasIBL()) roughLevels = EnvironmentMap::NUM_ROUGHNESS_LEVELS;
 
-    m_lightCulling.cull(cmd, gbufferPass, lights, view, projection, width, height, viewportIndex);
-
+    buildClusters(lights, view, projection);
     uploadLights(lights, viewportIndex);
-    uploadPerFrameCB(lights, cameraPos, invViewProj, roughLevels, width, height, viewportIndex, shadow);
+    uploadPerFrameCB(lights, cameraPos, view, invViewProj, roughLevels, width, height, viewportIndex, shadow);
 
     BEGIN_EVENT(cmd, L"Deferred Lighting Pass");
 
@@ -285,11 +256,11 @@ void DeferredLightingPass::render(ID3D12GraphicsCommandList* cmd,
                                             m_perFrameCB[viewportIndex]->GetGPUVirtualAddress());
 
     cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_DIR_LIGHTS,
-                                         m_dirLightSRV[viewportIndex].getGPUHandle(0));
+                                         m_dirLights[viewportIndex].getSRV());
     cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_POINT_LIGHTS,
-                                         m_pointLightSRV[viewportIndex].getGPUHandle(0));
+                                         m_pointLights[viewportIndex].getSRV());
     cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_SPOT_LIGHTS,
-                                         m_spotLightSRV[viewportIndex].getGPUHandle(0));
+                                         m_spotLights[viewportIndex].getSRV());
 
     if (env && env->hasIBL()){
         const EnvironmentMap* map = env->getEnvironmentMap();
@@ -318,10 +289,10 @@ void DeferredLightingPass::render(ID3D12GraphicsCommandList* cmd,
     cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_GBUF_DEPTH,
                                          gb.getDepthSrvHandle());
 
-    cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_POINT_INDICES,
-                                         m_lightCulling.getPointListSRV(viewportIndex));
-    cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_SPOT_INDICES,
-                                         m_lightCulling.getSpotListSRV(viewportIndex));
+    cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_CLUSTERS,
+                                         m_clusterBuf[viewportIndex].getSRV());
+    cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_CLUSTER_INDICES,
+                                         m_clusterIndices[viewportIndex].getSRV());
 
     cmd->SetGraphicsRootDescriptorTable(DeferredLightingPipeline::SLOT_SHADOW_MAP,
                                          (shadow.enabled && shadow.srv.ptr) ? shadow.srv
@@ -378,8 +349,8 @@ bool DeferredLightingPipeline::createRootSignature(ID3D12Device* device){
     CD3DX12_DESCRIPTOR_RANGE normRange; normRange.Init (D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 7);
     CD3DX12_DESCRIPTOR_RANGE emissRange; emissRange.Init (D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 8);
     CD3DX12_DESCRIPTOR_RANGE depthRange; depthRange .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 9);
-    CD3DX12_DESCRIPTOR_RANGE pointIdxRange; pointIdxRange .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 10);
-    CD3DX12_DESCRIPTOR_RANGE spotIdxRange; spotIdxRange .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 11);
+    CD3DX12_DESCRIPTOR_RANGE clusterRange; clusterRange .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 10);
+    CD3DX12_DESCRIPTOR_RANGE clusterIdxRange; clusterIdxRange .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 11);
     CD3DX12_DESCRIPTOR_RANGE shadowRange; shadowRange .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 12);
     CD3DX12_DESCRIPTOR_RANGE momentRange; momentRange .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 13);
     CD3DX12_DESCRIPTOR_RANGE spotRange2; spotRange2 .Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 14);
@@ -399,8 +370,8 @@ bool DeferredLightingPipeline::createRootSignature(ID3D12Device* device){
     params[SLOT_GBUF_NORMAL ].InitAsDescriptorTable(1, &normRange, D3D12_SHADER_VISIBILITY_PIXEL);
     params[SLOT_GBUF_EMISSIVE ].InitAsDescriptorTable(1, &emissRange, D3D12_SHADER_VISIBILITY_PIXEL);
     params[SLOT_GBUF_DEPTH ].InitAsDescriptorTable(1, &depthRange, D3D12_SHADER_VISIBILITY_PIXEL);
-    params[SLOT_POINT_INDICES ].InitAsDescriptorTable(1, &pointIdxRange, D3D12_SHADER_VISIBILITY_PIXEL);
-    params[SLOT_SPOT_INDICES ].InitAsDescriptorTable(1, &spotIdxRange, D3D12_SHADER_VISIBILITY_PIXEL);
+    params[SLOT_CLUSTERS ].InitAsDescriptorTable(1, &clusterRange, D3D12_SHADER_VISIBILITY_PIXEL);
+    params[SLOT_CLUSTER_INDICES ].InitAsDescriptorTable(1, &clusterIdxRange, D3D12_SHADER_VISIBILITY_PIXEL);
     params[SLOT_SHADOW_MAP ].InitAsDescriptorTable(1, &shadowRange, D3D12_SHADER_VISIBILITY_PIXEL);
     params[SLOT_SHADOW_MOMENTS ].InitAsDescriptorTable(1, &momentRange, D3D12_SHADER_VISIBILITY_PIXEL);
     params[SLOT_SPOT_SHADOW ].InitAsDescriptorTable(1, &spotRange2, D3D12_SHADER_VISIBILITY_PIXEL);
@@ -16,8 +16,8 @@ public:
     static constexpr UINT SLOT_GBUF_NORMAL = 8;
     static constexpr UINT SLOT_GBUF_EMISSIVE = 9;
     static constexpr UINT SLOT_GBUF_DEPTH = 10;
-    static constexpr UINT SLOT_POINT_INDICES = 11;
-    static constexpr UINT SLOT_SPOT_INDICES = 12;
+    static constexpr UINT SLOT_CLUSTERS = 11;
+    static constexpr UINT SLOT_CLUSTER_INDICES = 12;
     static constexpr UINT SLOT_SHADOW_MAP = 13;
     static constexpr UINT SLOT_SHADOW_MOMENTS = 14;
     static constexpr UINT SLOT_SPOT_SHADOW = 15;
@@ -37,10 +37,11 @@ private:
     ComPtr<ID3D12RootSignature> m_rootSig;
     ComPtr<ID3D12PipelineState> m_pso;
 };
-#include "LightCullingPass.h"
+#include "LightClusters.h"
 #include "MeshPipeline.h"
 #include "ShaderTableDesc.h"
 #include "ShadowMapPass.h"
+#include "StructuredUploadBuffer.h"
 #include <d3d12.h>
 #include <wrl.h>
 #include <vector>
@@ -74,6 +75,8 @@ public:
         Vector4 spotShadowPos;
         Vector4 pointShadowParams;
         Vector4 pointShadowPos;
+        Vector4 viewDepthRow;
+        Vector4 clusterParams;
     };
 
     static constexpr int NUM_VIEWPORTS = 2;
@@ -92,33 +95,32 @@ public:
                 int viewportIndex,
                 const ShadowRenderData& shadow);
 
+    // The clusters built by the last render().
+    const LightClusters& getClusters() const { return m_clusters; }
+
 private:
     bool createUploadBuffers(ID3D12Device* device);
-    bool createLightSRVs();
     bool createFallbackIBL(ID3D12Device* device);
 
+    void buildClusters(const FrameLightData& lights, const Matrix& view, const Matrix& projection);
     void uploadLights(const FrameLightData& lights, int viewportIndex);
     void uploadPerFrameCB(const FrameLightData& lights, const Vector3& cameraPos,
-                          const Matrix& invViewProj, uint32_t envRoughLevels,
+                          const Matrix& view, const Matrix& invViewProj, uint32_t envRoughLevels,
                           uint32_t width, uint32_t height, int viewportIndex,
                           const ShadowRenderData& shadow);
 
     DeferredLightingPipeline m_pipeline;
-    LightCullingPass m_lightCulling;
+    LightClusters m_clusters;
+    std::vector<Vector4> m_lightSpheres;
 
     ComPtr<ID3D12Resource> m_perFrameCB[NUM_VIEWPORTS];
     void* m_perFrameMapped[NUM_VIEWPORTS] = {};
 
-    ComPtr<ID3D12Resource> m_dirLightBuf[NUM_VIEWPORTS];
-    ComPtr<ID3D12Resource> m_pointLightBuf[NUM_VIEWPORTS];
-    ComPtr<ID3D12Resource> m_spotLightBuf[NUM_VIEWPORTS];
-    void* m_dirLightMapped[NUM_VIEWPORTS] = {};
-    void* m_pointLightMapped[NUM_VIEWPORTS] = {};
-    void* m_spotLightMapped[NUM_VIEWPORTS] = {};
-
-    ShaderTableDesc m_dirLightSRV[NUM_VIEWPORTS];
-    ShaderTableDesc m_pointLightSRV[NUM_VIEWPORTS];
-    ShaderTableDesc m_spotLightSRV[NUM_VIEWPORTS];
+    StructuredUploadBuffer m_dirLights[NUM_VIEWPORTS];
+    StructuredUploadBuffer m_pointLights[NUM_VIEWPORTS];
+    StructuredUploadBuffer m_spotLights[NUM_VIEWPORTS];
+    StructuredUploadBuffer m_clusterBuf[NUM_VIEWPORTS];
+    StructuredUploadBuffer m_clusterIndices[NUM_VIEWPORTS];
 
     ComPtr<ID3D12Resource> m_fallbackCube;
     ComPtr<ID3D12Resource> m_fallbackTex2D;
@@ -0,0 +1,402 @@
+#include "Globals.h"
+#include "DynamicAABBTreeBroadPhase.h"
+
+#include <algorithm>
+
+static inline AABB merged(const AABB& a, const AABB& b){
+    return { Vector3::Min(a.min, b.min), Vector3::Max(a.max, b.max) };
+}
+
+static inline float surfaceArea(const AABB& box){
+    const Vector3 d = box.max - box.min;
+    return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static inline bool contains(const AABB& outer, const AABB& inner){
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+}
+
+
+DynamicAABBTreeBroadPhase::DynamicAABBTreeBroadPhase(float fatMargin)
+    : m_fatMargin(fatMargin >= 0.f ? fatMargin : 0.1f){}
+
+int DynamicAABBTreeBroadPhase::allocateNode(){
+    int idx;
+    if (m_freeList != kNull){
+        idx = m_freeList;
+        m_freeList = m_nodes[idx].parent;
+        m_nodes[idx] = Node{};
+    } else {
+        idx = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    ++m_nodeCount;
+    return idx;
+}
+
+void DynamicAABBTreeBroadPhase::freeNode(int node){
+    m_nodes[node].parent = m_freeList;
+    m_nodes[node].left = kNull;
+    m_nodes[node].right = kNull;
+    m_nodes[node].height = -1;
+    m_freeList = node;
+    --m_nodeCount;
+}
+
+AABB DynamicAABBTreeBroadPhase::fatten(const AABB& box) const{
+    const Vector3 r(m_fatMargin, m_fatMargin, m_fatMargin);
+    return { box.min - r, box.max + r };
+}
+
+void DynamicAABBTreeBroadPhase::insertLeaf(int leaf){
+    if (m_root == kNull){
+        m_root = leaf;
+        m_nodes[leaf].parent = kNull;
+        return;
+    }
+
+    const AABB leafBox = m_nodes[leaf].box;
+    int index = m_root;
+    while (!m_nodes[index].isLeaf()){
+        const int child1 = m_nodes[index].left;
+        const int child2 = m_nodes[index].right;
+
+        const float area = surfaceArea(m_nodes[index].box);
+        const float combinedArea = surfaceArea(merged(m_nodes[index].box, leafBox));
+
+        const float cost = 2.f * combinedArea;
+        const float inheritance = 2.f * (combinedArea - area);
+
+        auto descendCost = [&](int child) -> float {
+            const float newArea = surfaceArea(merged(leafBox, m_nodes[child].box));
+            if (m_nodes[child].isLeaf()) return newArea + inheritance;
+            return newArea - surfaceArea(m_nodes[child].box) + inheritance;
+        };
+        const float cost1 = descendCost(child1);
+        const float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    const int sibling = index;
+    const int oldParent = m_nodes[sibling].parent;
+    const int newParent = allocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].box = merged(leafBox, m_nodes[sibling].box);
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+    m_nodes[newParent].left = sibling;
+    m_nodes[newParent].right = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent != kNull){
+        if (m_nodes[oldParent].left == sibling) m_nodes[oldParent].left = newParent;
+        else m_nodes[oldParent].right = newParent;
+    } else {
+        m_root = newParent;
+    }
+
+    refitFrom(m_nodes[leaf].parent);
+}
+
+void DynamicAABBTreeBroadPhase::removeLeaf(int leaf){
+    if (leaf == m_root){
+        m_root = kNull;
+        return;
+    }
+
+    const int parent = m_nodes[leaf].parent;
+    const int grandParent = m_nodes[parent].parent;
+    const int sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+    if (grandParent != kNull){
+        if (m_nodes[grandParent].left == parent) m_nodes[grandParent].left = sibling;
+        else m_nodes[grandParent].right = sibling;
+        m_nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refitFrom(grandParent);
+    } else {
+        m_root = sibling;
+        m_nodes[sibling].parent = kNull;
+        freeNode(parent);
+    }
+    m_nodes[leaf].parent = kNull;
+}
+
+void DynamicAABBTreeBroadPhase::refitFrom(int node){
+    while (node != kNull){
+        node = balance(node);
+        const int l = m_nodes[node].left;
+        const int r = m_nodes[node].right;
+        m_nodes[node].height = 1 + std::max(m_nodes[l].height, m_nodes[r].height);
+        m_nodes[node].box = merged(m_nodes[l].box, m_nodes[r].box);
+        node = m_nodes[node].parent;
+    }
+}
+
+int DynamicAABBTreeBroadPhase::balance(int iA){
+    Node& A = m_nodes[iA];
+    if (A.isLeaf() || A.height < 2) return iA;
+
+    const int iB = A.left;
+    const int iC = A.right;
+    Node& B = m_nodes[iB];
+    Node& C = m_nodes[iC];
+    const int diff = C.height - B.height;
+
+    auto replaceInParent = [&](int oldChild, int newChild, int parent){
+        if (parent != kNull){
+            if (m_nodes[parent].left == oldChild) m_nodes[parent].left = newChild;
+            else m_nodes[parent].right = newChild;
+        } else {
+            m_root = newChild;
+        }
+    };
+
+    if (diff > 1){
+        const int iF = C.left;
+        const int iG = C.right;
+        Node& F = m_nodes[iF];
+        Node& G = m_nodes[iG];
+
+        C.left = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+        replaceInParent(iA, iC, C.parent);
+
+        if (F.height > G.height){
+            C.right = iF;
+            A.right = iG;
+            G.parent = iA;
+            A.box = merged(B.box, G.box);
+            C.box = merged(A.box, F.box);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.right = iG;
+            A.right = iF;
+            F.parent = iA;
+            A.box = merged(B.box, F.box);
+            C.box = merged(A.box, G.box);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    if (diff < -1){
+        const int iD = B.left;
+        const int iE = B.right;
+        Node& D = m_nodes[iD];
+        Node& E = m_nodes[iE];
+
+        B.left = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+        replaceInParent(iA, iB, B.parent);
+
+        if (D.height > E.height){
+            B.right = iD;
+            A.left = iE;
+            E.parent = iA;
+            A.box = merged(C.box, E.box);
+            B.box = merged(A.box, D.box);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.right = iE;
+            A.left = iD;
+            D.parent = iA;
+            A.box = merged(C.box, D.box);
+            B.box = merged(A.box, E.box);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+int DynamicAABBTreeBroadPhase::createProxy(const CollisionBody& body, uint32_t bodyIndex){
+    const int leaf = allocateNode();
+    Node& n = m_nodes[leaf];
+    n.box = fatten(body.worldAABB);
+    n.height = 0;
+    n.bodyIndex = bodyIndex;
+    n.bodyId = body.id;
+    n.stamp = m_stamp;
+    n.moved = true;
+    insertLeaf(leaf);
+    m_proxyById[body.id] = leaf;
+    m_moved.push_back(leaf);
+    return leaf;
+}
+
+void DynamicAABBTreeBroadPhase::destroyProxy(int leaf){
+    removeLeaf(leaf);
+    freeNode(leaf);
+}
+
+std::vector<CollisionPair> DynamicAABBTreeBroadPhase::query(
+    const std::vector<CollisionBody>& bodies){
+    ++m_stamp;
+    m_moved.clear();
+
+    const uint32_t n = static_cast<uint32_t>(bodies.size());
+    std::vector<uint32_t> added;
+    uint32_t seen = 0;
+
+    for (uint32_t i = 0; i < n; ++i){
+        const CollisionBody& body = bodies[i];
+        auto it = m_proxyById.find(body.id);
+        if (it == m_proxyById.end()){
+            added.push_back(i);
+            continue;
+        }
+        ++seen;
+        const int leaf = it->second;
+        m_nodes[leaf].bodyIndex = i;
+        m_nodes[leaf].stamp = m_stamp;
+        if (body.sleeping || contains(m_nodes[leaf].box, body.worldAABB)) continue;
+
+        removeLeaf(leaf);
+        m_nodes[leaf].box = fatten(body.worldAABB);
+        insertLeaf(leaf);
+        m_nodes[leaf].moved = true;
+        m_moved.push_back(leaf);
+    }
+
+    if (seen != m_proxyById.size()){
+        for (auto it = m_proxyById.begin(); it != m_proxyById.end();){
+            if (m_nodes[it->second].stamp != m_stamp){
+                destroyProxy(it->second);
+                it = m_proxyById.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    m_pairs.erase(std::remove_if(m_pairs.begin(), m_pairs.end(), [&](const LeafPair& p){
+        const Node& a = m_nodes[p.a];
+        const Node& b = m_nodes[p.b];
+        return a.height < 0 || b.height < 0 || a.moved || b.moved;
+    }), m_pairs.end());
+
+    for (uint32_t i : added) createProxy(bodies[i], i);
+
+    for (int leaf : m_moved){
+        const AABB fat = m_nodes[leaf].box;
+        m_stack.clear();
+        m_stack.push_back(m_root);
+        while (!m_stack.empty()){
+            const int idx = m_stack.back();
+            m_stack.pop_back();
+            if (idx == kNull) continue;
+            const Node& node = m_nodes[idx];
+            if (!node.box.intersects(fat)) continue;
+            if (node.isLeaf()){
+                if (idx == leaf) continue;
+                if (node.moved && idx < leaf) continue;
+                m_pairs.push_back({ std::min(leaf, idx), std::max(leaf, idx) });
+            } else {
+                m_stack.push_back(node.left);
+                m_stack.push_back(node.right);
+            }
+        }
+    }
+
+    for (int leaf : m_moved) m_nodes[leaf].moved = false;
+    m_lastMovedCount = static_cast<int>(m_moved.size());
+
+    std::vector<CollisionPair> pairs;
+    pairs.reserve(m_pairs.size());
+    for (const LeafPair& p : m_pairs){
+        uint32_t a = m_nodes[p.a].bodyIndex;
+        uint32_t b = m_nodes[p.b].bodyIndex;
+        if (!reportsPair(bodies[a], bodies[b]) ||
+            !bodies[a].worldAABB.intersects(bodies[b].worldAABB)) continue;
+        if (a > b) std::swap(a, b);
+        pairs.push_back({ a, b });
+    }
+    return pairs;
+}
+
+// Queries can run on several threads at once, so each keeps its own stack.
+static std::vector<int>& queryStack(){
+    thread_local std::vector<int> stack;
+    stack.clear();
+    return stack;
+}
+
+void DynamicAABBTreeBroadPhase::queryOverlap(const AABB& box, const std::vector<CollisionBody>& bodies,
+                                             std::vector<uint32_t>& outBodies) const{
+    if (m_root == kNull) return;
+    std::vector<int>& stack = queryStack();
+    stack.push_back(m_root);
+    while (!stack.empty()){
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (!node.box.intersects(box)) continue;
+        if (!node.isLeaf()){
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        } else if (node.bodyIndex < bodies.size() && bodies[node.bodyIndex].worldAABB.intersects(box)){
+            outBodies.push_back(node.bodyIndex);
+        }
+    }
+}
+
+// Nearer child first, so a closest-hit callback shrinks maxT before the far
+// side is visited.
+void DynamicAABBTreeBroadPhase::queryRay(const Vector3& origin, const Vector3& dir, float maxT, float radius,
+                                         const std::vector<CollisionBody>& bodies, const RayHitFn& hit) const{
+    if (m_root == kNull) return;
+    const Vector3 invDir(1.f / dir.x, 1.f / dir.y, 1.f / dir.z);
+    const Vector3 grow(radius, radius, radius);
+    auto enter = [&](int idx, float& t){
+        const AABB& b = m_nodes[idx].box;
+        return AABB{ b.min - grow, b.max + grow }.intersectsRay(origin, invDir, maxT, t);
+    };
+
+    std::vector<int>& stack = queryStack();
+    float t;
+    if (!enter(m_root, t)) return;
+    stack.push_back(m_root);
+    while (!stack.empty()){
+        const int idx = stack.back();
+        stack.pop_back();
+        // maxT may have shrunk since the node was pushed.
+        if (!enter(idx, t)) continue;
+        const Node& node = m_nodes[idx];
+        if (node.isLeaf()){
+            if (node.bodyIndex < bodies.size()) maxT = hit(node.bodyIndex, maxT);
+            continue;
+        }
+        float tl, tr;
+        const bool hl = enter(node.left, tl);
+        const bool hr = enter(node.right, tr);
+        if (hl && hr){
+            stack.push_back(tl <= tr ? node.right : node.left);
+            stack.push_back(tl <= tr ? node.left : node.right);
+        } else if (hl){
+            stack.push_back(node.left);
+        } else if (hr){
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void DynamicAABBTreeBroadPhase::drawDebug(){
+    if (m_root == kNull) return;
+    const AABB& rootBox = m_nodes[m_root].box;
+    dd::aabb(ddConvert(rootBox.min), ddConvert(rootBox.max), dd::colors::Cyan);
+
+    for (const auto& [id, leaf] : m_proxyById){
+        const AABB& box = m_nodes[leaf].box;
+        dd::aabb(ddConvert(box.min), ddConvert(box.max), dd::colors::Yellow);
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "CollisionInterfaces.h"
+#include "BoundingVolume.h"
+#include <vector>
+#include <unordered_map>
+
+// Persistent bounding volume hierarchy over fattened body AABBs. Proxies live
+// across frames and are only reinserted when their worldAABB escapes the fat
+// bounds, so tree maintenance and pair finding scale with the moving bodies.
+class DynamicAABBTreeBroadPhase : public IBroadPhase {
+public:
+    explicit DynamicAABBTreeBroadPhase(float fatMargin = 0.1f);
+
+    std::vector<CollisionPair> query(
+        const std::vector<CollisionBody>& bodies) override;
+
+    void queryOverlap(const AABB& box, const std::vector<CollisionBody>& bodies,
+                      std::vector<uint32_t>& outBodies) const override;
+    void queryRay(const Vector3& origin, const Vector3& dir, float maxT, float radius,
+                  const std::vector<CollisionBody>& bodies, const RayHitFn& hit) const override;
+
+    void drawDebug() override;
+
+    const char* getName() const override { return "Dynamic AABB Tree"; }
+
+    float getFatMargin() const { return m_fatMargin; }
+    void setFatMargin(float m){ m_fatMargin = (m >= 0.f ? m : 0.f); }
+
+    int getProxyCount() const { return static_cast<int>(m_proxyById.size()); }
+    int getNodeCount() const { return m_nodeCount; }
+    int getTreeHeight() const { return m_root >= 0 ? m_nodes[m_root].height : 0; }
+    int getLastMovedCount() const { return m_lastMovedCount; }
+
+private:
+    static constexpr int kNull = -1;
+
+    struct Node {
+        AABB box;
+        int parent = kNull;
+        int left = kNull;
+        int right = kNull;
+        int height = 0;
+        uint32_t bodyIndex = 0;
+        uint32_t bodyId = 0;
+        uint32_t stamp = 0;
+        bool moved = false;
+
+        bool isLeaf() const { return left == kNull; }
+    };
+
+    struct LeafPair {
+        int a;
+        int b;
+    };
+
+    int allocateNode();
+    void freeNode(int node);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int a);
+    void refitFrom(int node);
+
+    int createProxy(const CollisionBody& body, uint32_t bodyIndex);
+    void destroyProxy(int leaf);
+    AABB fatten(const AABB& box) const;
+
+    std::vector<Node> m_nodes;
+    int m_root = kNull;
+    int m_freeList = kNull;
+    int m_nodeCount = 0;
+
+    float m_fatMargin;
+    uint32_t m_stamp = 0;
+
+    std::unordered_map<uint32_t, int> m_proxyById;
+    std::vector<int> m_moved;
+    std::vector<LeafPair> m_pairs;
+    std::vector<int> m_stack;
+
+    int m_lastMovedCount = 0;
+};
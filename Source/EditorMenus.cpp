@@ -457,7 +457,7 @@ void ModuleEditor::handleDialogs(){
     }
 }
 
-void ModuleEditor::handleNewScenePopup(ID3D12GraphicsCommandList*){
+void ModuleEditor::handleNewScenePopup(){
     if (m_showNewSceneConfirm){ ImGui::OpenPopup("New Scene?"); m_showNewSceneConfirm = false; }
     ImGui::SetNextWindowPos(ImGui::GetMainViewport()->GetCenter(), ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
     if (!ImGui::BeginPopupModal("New Scene?", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) return;
@@ -45,6 +45,9 @@
 #include "ComponentRigidbody.h"
 #include "CollisionSystem.h"
 #include "CollisionResponse.h"
+#include "SimulationIslands.h"
+#include "PhysicsStepper.h"
+#include "CollisionBodyRegistry.h"
 #include "EnvironmentMap.h"
 #include "SceneViewPanel.h"
 #include "GameViewPanel.h"
@@ -67,7 +70,6 @@
 #include <filesystem>
 #include <algorithm>
 #include <functional>
-#include <unordered_set>
 #include <cfloat>
 
 static float computeScreenCoverage(const Vector3& mn, const Vector3& mx, const Matrix& viewProj){
@@ -115,75 +117,26 @@ void ModuleEditor::preRender(){
         m_sceneManager->updateAnimations(dt);
     }
 
-    if (ModuleCamera* cam = app->getCamera()){
-        SceneGraph* scene = getActiveModuleScene();
-        int visible = 0, total = 0;
-        if (scene){
-            std::vector<RenderOctree::Entry> entries;
-            std::function<void(GameObject*)> collect = [&](GameObject* node){
-                if (!node || !node->isActive()) return;
-                if (auto* cm = node->getComponent<ComponentMesh>()){
-                    if (cm->hasAABB()){
-                        Vector3 mn, mx;
-                        cm->getWorldAABB(mn, mx);
-                        entries.push_back({ node, AABB{ mn, mx } });
-                        ++total;
-                    } else {
-                        cm->setVisible(true);
-                    }
-                }
-                for (auto* child : node->getChildren()) collect(child);
-            };
-            collect(scene->getRoot());
-
-            if (cam->cullAlgorithm == ModuleCamera::CullAlgorithm::Octree){
-                m_renderOctree.clear();
-                for (const auto& e : entries) m_renderOctree.add(e.go, e.worldAABB);
-                m_renderOctree.build();
-                cam->octreeNodeCount = m_renderOctree.getNodeCount();
-                cam->octreeLeafCount = m_renderOctree.getLeafCount();
-
-                if (!cam->hasGameFrustum()){
-                    for (const auto& e : entries){ e.go->getComponent<ComponentMesh>()->setVisible(true); ++visible; }
-                } else {
-                    std::vector<GameObject*> visibleSet;
-                    m_renderOctree.query(cam->getGameFrustum(), visibleSet);
-                    std::unordered_set<GameObject*> visibleLookup(visibleSet.begin(), visibleSet.end());
-                    for (const auto& e : entries){
-                        // Octree query is a conservative broad phase (tests node regions,
-                        // not entries). Confirm each candidate with an exact AABB test.
-                        bool vis = visibleLookup.count(e.go) != 0 &&
-                                   cam->getGameFrustum().intersectsAABB(e.worldAABB.min, e.worldAABB.max);
-                        e.go->getComponent<ComponentMesh>()->setVisible(vis);
-                        if (vis) ++visible;
-                    }
-                }
-            } else {
-                cam->octreeNodeCount = 0;
-                cam->octreeLeafCount = 0;
-                for (const auto& e : entries){
-                    bool vis = !cam->hasGameFrustum() || cam->getGameFrustum().intersectsAABB(e.worldAABB.min, e.worldAABB.max);
-                    e.go->getComponent<ComponentMesh>()->setVisible(vis);
-                    if (vis) ++visible;
-                }
-            }
-        }
-        cam->setVisibilityStats(visible, total);
-    }
-
     if (m_effectsPlaying && m_sceneManager &&
         m_sceneManager->getState() != SceneManager::PlayState::Playing){
         updateEffectsInEditMode(dt);
     }
 
     SceneGraph* activeScene = getActiveModuleScene();
-    if (m_collisionSystem)
-        m_collisionSystem->run(activeScene, dt);
-
     const bool isPlaying = m_sceneManager &&
         m_sceneManager->getState() == SceneManager::PlayState::Playing;
-    if (isPlaying && m_collisionResponse && m_collisionSystem)
-        m_collisionResponse->solve(m_collisionSystem->getResults().contacts, dt);
+    if (m_collisionSystem && m_sceneManager)
+        m_collisionSystem->setLayerMatrix(m_sceneManager->getSettings().collisionLayers);
+    if (isPlaying && m_physicsStepper && m_collisionSystem && m_collisionResponse){
+        m_physicsStepper->stepScene(activeScene, dt, m_sceneManager->getSettings().gravityY,
+                                    *m_collisionSystem, *m_collisionResponse,
+                                    m_simulationIslands.get());
+    } else if (m_collisionSystem){
+        m_collisionSystem->run(activeScene, dt);
+        if (m_physicsStepper && m_sceneManager &&
+            m_sceneManager->getState() == SceneManager::PlayState::Stopped)
+            m_physicsStepper->reset();
+    }
 
     m_performance->pushFPS(app->getFPS());
 
@@ -203,6 +156,72 @@ void ModuleEditor::preRender(){
 
     drawDragDropOverlay();
 
+    // Everything that edits the scene this frame has run, so this is the
+    // frame's one walk of the scene; culling then reads what it gathered.
+    m_scriptWatcher.poll();
+    handleNewScenePopup();
+    gatherFrame();
+
+    if (ModuleCamera* cam = app->getCamera()){
+        SceneGraph* scene = getActiveModuleScene();
+        int visible = 0, total = 0;
+        if (scene && cam->cullAlgorithm == ModuleCamera::CullAlgorithm::Octree){
+            // Last frame's meshes are hidden before the sync, which may show a
+            // mesh that took over one of their slots.
+            const std::vector<CollisionBodyRegistry::Entry>& entries = CollisionBodyRegistry::GetEntries();
+            for (uint32_t slot : m_cullVisible)
+                if (slot < entries.size() && entries[slot].mesh) entries[slot].mesh->setVisible(false);
+            m_cullVisible.clear();
+
+            syncRenderOctree(scene);
+            cam->octreeNodeCount = m_renderOctree.getNodeCount();
+            cam->octreeLeafCount = m_renderOctree.getLeafCount();
+            cam->octreeMovedCount = static_cast<int>(m_renderOctree.getLastMovedCount());
+            total = static_cast<int>(m_renderOctree.getEntryCount());
+
+            if (cam->hasGameFrustum()){
+                m_renderOctree.query(cam->getGameFrustum(), m_cullVisible);
+            } else {
+                for (uint32_t slot = 0; slot < static_cast<uint32_t>(entries.size()); ++slot)
+                    if (m_renderOctree.contains(slot)) m_cullVisible.push_back(slot);
+            }
+            for (uint32_t slot : m_cullVisible) entries[slot].mesh->setVisible(true);
+            visible = static_cast<int>(m_cullVisible.size());
+        } else {
+            m_renderOctree.clear();
+            m_cullScene = nullptr;
+            m_cullVisible.clear();
+            cam->octreeNodeCount = 0;
+            cam->octreeLeafCount = 0;
+            cam->octreeMovedCount = 0;
+            m_cullBoxes.clear();
+            m_cullMeshes.clear();
+            for (const SceneFrameData::MeshNode& m : m_frame.meshes){
+                if (!m.mesh->hasAABB()){
+                    m.mesh->setVisible(true);
+                    continue;
+                }
+                Vector3 mn, mx;
+                m.mesh->getWorldAABB(mn, mx);
+                m_cullBoxes.push(mn, mx);
+                m_cullMeshes.push_back(m.mesh);
+            }
+            total = static_cast<int>(m_cullMeshes.size());
+            if (cam->hasGameFrustum()){
+                m_cullBits.resize(FrustumCulling::MaskWords(m_cullBoxes.size()));
+                FrustumCulling::Cull(cam->getGameFrustum(), m_cullBoxes.view(nullptr), m_cullBits.data());
+            } else {
+                m_cullBits.assign(FrustumCulling::MaskWords(m_cullBoxes.size()), 0xFFFFFFFFu);
+            }
+            for (uint32_t i = 0; i < m_cullBoxes.size(); ++i){
+                const bool vis = FrustumCulling::IsVisible(m_cullBits.data(), i);
+                m_cullMeshes[i]->setVisible(vis);
+                if (vis) ++visible;
+            }
+        }
+        cam->setVisibilityStats(visible, total);
+    }
+
     // Reset per-frame ring-buffer cursors before Scene View and Game View render.
     if (m_shadowMapPass) m_shadowMapPass->beginFrame();
     if (m_billboardPass) m_billboardPass->beginFrame();
@@ -215,8 +234,6 @@ void ModuleEditor::render(){
     ModuleShaderDescriptors* descs = app->getShaderDescriptors();
     ID3D12GraphicsCommandList* cmd = d3d12->getCommandList();
 
-    m_scriptWatcher.poll();
-
     m_frameTransientBuffers.clear();
 
     cmd->Reset(d3d12->getCommandAllocator(), nullptr);
@@ -224,7 +241,6 @@ void ModuleEditor::render(){
 
     ID3D12DescriptorHeap* heaps[] = { descs->getHeap(), app->getSamplerHeap()->getHeap() };
     cmd->SetDescriptorHeaps(2, heaps);
-    handleNewScenePopup(cmd);
 
     if (m_sceneView->viewport.isReady() && m_sceneView->visibleThisFrame) m_sceneView->renderToTexture(cmd);
     if (m_gameView->viewport.isReady() && m_gameView->visibleThisFrame) m_gameView->renderToTexture(cmd);
@@ -298,15 +314,6 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
     Vector3 viewCamRight = Vector3::TransformNormal(Vector3::UnitX, viewCamWorld); viewCamRight.Normalize();
     Vector3 viewCamUp = Vector3::TransformNormal(Vector3::UnitY, viewCamWorld); viewCamUp.Normalize();
 
-    if (moduleScene){
-        std::function<void(GameObject*)> flush = [&](GameObject* node){
-            if (!node) return;
-            if (auto* cm = node->getComponent<ComponentMesh>()) cm->flushDeferredReleases();
-            for (auto* child : node->getChildren()) flush(child);
-            };
-        flush(moduleScene->getRoot());
-    }
-
     const EditorSceneSettings& s = m_sceneManager->getSettings();
     const EditorSceneSettings::Skybox& sky = s.skybox;
 
@@ -316,11 +323,6 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
     ID3D12DescriptorHeap* heaps[] = { app->getShaderDescriptors()->getHeap(), app->getSamplerHeap()->getHeap() };
     cmd->SetDescriptorHeaps(2, heaps);
 
-    m_frameLights.dirLights.clear();
-    m_frameLights.pointLights.clear();
-    m_frameLights.spotLights.clear();
-    if (moduleScene) gatherLights(moduleScene->getRoot(), m_frameLights);
-
     std::vector<MeshEntry> ownedEntries;
     std::vector<MeshEntry*> visibleMeshes;
 
@@ -330,130 +332,123 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
     uint32_t curVertexOffset = 0;
     uint32_t curMorphWeightOffset = 0;
 
-    const Matrix lodViewProj = view * proj;
+    const Matrix viewProj = view * proj;
+    const Frustum viewFrustum = Frustum::fromViewProj(viewProj);
     const int forceLODIndex = (int)camera->forceLOD - 1;
 
     if (moduleScene){
-        std::function<void(GameObject*)> collectMeshes = [&](GameObject* node){
-            if (!node || !node->isActive()) return;
-            if (auto* cm = node->getComponent<ComponentMesh>()){
-                cm->flushDeferredReleases();
-
-                if (!editorExtras && camera->cullMode == ModuleCamera::CullMode::Frustum && !cm->isVisible()){
-                    for (auto* child : node->getChildren()) collectMeshes(child);
-                    return;
-                }
-
-                if (cm->hasLODLevels() && cm->hasAABB()){
-                    Vector3 mn, mx;
-                    cm->getWorldAABB(mn, mx);
-                    float coverage = computeScreenCoverage(mn, mx, lodViewProj);
-                    cm->updateLOD(coverage, forceLODIndex);
-                }
+        for (const auto& node : m_frame.meshes){
+            ComponentMesh* cm = node.mesh;
+            if (!editorExtras && camera->cullMode == ModuleCamera::CullMode::Frustum && !cm->isVisible())
+                continue;
+
+            if (cm->hasLODLevels() && cm->hasAABB()){
+                Vector3 mn, mx;
+                cm->getWorldAABB(mn, mx);
+                float coverage = computeScreenCoverage(mn, mx, viewProj);
+                cm->updateLOD(coverage, forceLODIndex);
+            }
 
-                Matrix nodeWorld = node->getTransform()->getGlobalMatrix();
-                if (Model* model = cm->getProceduralModel()){
-                    model->buildMeshEntries(nodeWorld, ownedEntries);
-                }
-                else {
-                    const bool isSkinned = m_skinningPass && cm->hasSkinData();
-
-                    const bool morphDirtyThisFrame = m_skinningPass && cm->getMorphWeightsDirty();
-                    if (morphDirtyThisFrame) cm->clearMorphWeightsDirty();
-
-                    for (const auto& src : cm->getEntries()){
-                        if (!src.meshRes || !src.meshRes->getMesh()) continue;
-                        MeshEntry e;
-                        e.meshUID = src.meshUID;
-                        e.materialUID = src.materialUID;
-                        e.meshRes = src.meshRes;
-                        e.materialRes = src.materialRes;
-                        e.material = src.instanceMaterial.get();
-                        e.materialCB = src.materialCB;
-
-                        Mesh* mesh = src.meshRes->getMesh();
-                        const bool hasBones = isSkinned && mesh && mesh->getBoneWeightBufferVA() != 0;
-
-                        bool shouldMorph = false;
-                        if (m_skinningPass && mesh && mesh->hasMorphTargets()){
-                            shouldMorph = morphDirtyThisFrame;
-                            if (!shouldMorph){
-                                const float* w = cm->getMorphWeights();
-                                const uint32_t n = mesh->getNumMorphTargets();
-                                for (uint32_t t = 0; t < n && !shouldMorph; ++t)
-                                    shouldMorph = (w[t] != 0.f);
-                            }
+            const Matrix& nodeWorld = node.world;
+            if (Model* model = cm->getProceduralModel()){
+                model->buildMeshEntries(nodeWorld, ownedEntries);
+            }
+            else {
+                const bool isSkinned = m_skinningPass && cm->hasSkinData();
+
+                const bool morphDirtyThisFrame = m_skinningPass && cm->getMorphWeightsDirty();
+                if (morphDirtyThisFrame) cm->clearMorphWeightsDirty();
+
+                for (const auto& src : cm->getEntries()){
+                    if (!src.meshRes || !src.meshRes->getMesh()) continue;
+                    MeshEntry e;
+                    e.meshUID = src.meshUID;
+                    e.materialUID = src.materialUID;
+                    e.meshRes = src.meshRes;
+                    e.materialRes = src.materialRes;
+                    e.material = src.instanceMaterial.get();
+                    e.materialCB = src.materialCB;
+
+                    Mesh* mesh = src.meshRes->getMesh();
+                    const bool hasBones = isSkinned && mesh && mesh->getBoneWeightBufferVA() != 0;
+
+                    bool shouldMorph = false;
+                    if (m_skinningPass && mesh && mesh->hasMorphTargets()){
+                        shouldMorph = morphDirtyThisFrame;
+                        if (!shouldMorph){
+                            const float* w = cm->getMorphWeights();
+                            const uint32_t n = mesh->getNumMorphTargets();
+                            for (uint32_t t = 0; t < n && !shouldMorph; ++t)
+                                shouldMorph = (w[t] != 0.f);
                         }
+                    }
 
-                        const bool vertexReady = mesh && (mesh->getVertexBufferVA() != 0);
-                        const uint32_t vcount = mesh ? mesh->getVertexCount() : 0u;
-                        const uint32_t jcount = hasBones ? (uint32_t)cm->getLocalSkin().jointNodeIndices.size() : 0u;
-                        const bool withinVertexCap = (curVertexOffset + vcount <= SkinningPass::MAX_TOTAL_VERTICES);
-                        const bool withinJointCap = (curPaletteOffset + jcount <= SkinningPass::MAX_TOTAL_JOINTS);
-                        if (!withinVertexCap)
-                            LOG("[SkinDebug] OVERFLOW: vertex cap %u exceeded (offset %u + count %u). Re-export at lower poly count.",
-                                SkinningPass::MAX_TOTAL_VERTICES, curVertexOffset, vcount);
-                        if (!withinJointCap)
-                            LOG("[SkinDebug] OVERFLOW: joint cap %u exceeded (offset %u + count %u).",
-                                SkinningPass::MAX_TOTAL_JOINTS, curPaletteOffset, jcount);
-                        const bool needsGpuJob = vertexReady && (hasBones || shouldMorph) && withinVertexCap && withinJointCap;
-
-                        if (needsGpuJob){
-                            e.isSkinned = true;
-
-                            SkinningPass::SkinJob job;
-                            job.mesh = mesh;
-                            job.paletteOffset = curPaletteOffset;
-                            job.vertexOffset = curVertexOffset;
-                            job.morphWeightOffset = curMorphWeightOffset;
-
-                            if (hasBones){
-                                const auto& joints = cm->getSkinJoints();
-                                std::vector<Matrix> jointWorlds;
-                                jointWorlds.reserve(joints.size());
-
-                                int nullJointCount = 0;
-                                for (auto* jgo : joints){
-                                    if (!jgo) ++nullJointCount;
-                                    jointWorlds.push_back(jgo ? jgo->getTransform()->getGlobalMatrix() : Matrix::Identity);
-                                }
-                                if (nullJointCount > 0)
-                                    LOG("[SkinDebug] WARNING: %d/%d joint GOs are null",
-                                        nullJointCount, (int)joints.size());
-
-                                job.skin = &cm->getLocalSkin();
-                                job.jointWorldMatrices = std::move(jointWorlds);
-
-                                Matrix inv; nodeWorld.Invert(inv);
-                                job.meshWorldInverse = inv;
-                                memcpy(e.worldMatrix, &nodeWorld, sizeof(nodeWorld));
-                            } else {
-                                memcpy(e.worldMatrix, &nodeWorld, sizeof(nodeWorld));
-                            }
-
-                            if (shouldMorph){
-                                const uint32_t numTargets = mesh->getNumMorphTargets();
-                                const float* w = cm->getMorphWeights();
-                                job.morphWeights.assign(w, w + numTargets);
-                                curMorphWeightOffset += numTargets;
+                    const bool vertexReady = mesh && (mesh->getVertexBufferVA() != 0);
+                    const uint32_t vcount = mesh ? mesh->getVertexCount() : 0u;
+                    const uint32_t jcount = hasBones ? (uint32_t)cm->getLocalSkin().jointNodeIndices.size() : 0u;
+                    const bool withinVertexCap = (curVertexOffset + vcount <= SkinningPass::MAX_TOTAL_VERTICES);
+                    const bool withinJointCap = (curPaletteOffset + jcount <= SkinningPass::MAX_TOTAL_JOINTS);
+                    if (!withinVertexCap)
+                        LOG("[SkinDebug] OVERFLOW: vertex cap %u exceeded (offset %u + count %u). Re-export at lower poly count.",
+                            SkinningPass::MAX_TOTAL_VERTICES, curVertexOffset, vcount);
+                    if (!withinJointCap)
+                        LOG("[SkinDebug] OVERFLOW: joint cap %u exceeded (offset %u + count %u).",
+                            SkinningPass::MAX_TOTAL_JOINTS, curPaletteOffset, jcount);
+                    const bool needsGpuJob = vertexReady && (hasBones || shouldMorph) && withinVertexCap && withinJointCap;
+
+                    if (needsGpuJob){
+                        e.isSkinned = true;
+
+                        SkinningPass::SkinJob job;
+                        job.mesh = mesh;
+                        job.paletteOffset = curPaletteOffset;
+                        job.vertexOffset = curVertexOffset;
+                        job.morphWeightOffset = curMorphWeightOffset;
+
+                        if (hasBones){
+                            const auto& joints = cm->getSkinJoints();
+                            std::vector<Matrix> jointWorlds;
+                            jointWorlds.reserve(joints.size());
+
+                            int nullJointCount = 0;
+                            for (auto* jgo : joints){
+                                if (!jgo) ++nullJointCount;
+                                jointWorlds.push_back(jgo ? jgo->getTransform()->getGlobalMatrix() : Matrix::Identity);
                             }
+                            if (nullJointCount > 0)
+                                LOG("[SkinDebug] WARNING: %d/%d joint GOs are null",
+                                    nullJointCount, (int)joints.size());
 
-                            skinJobEntryIdx.push_back(ownedEntries.size());
-                            skinJobs.push_back(std::move(job));
+                            job.skin = &cm->getLocalSkin();
+                            job.jointWorldMatrices = std::move(jointWorlds);
 
-                            if (hasBones)
-                                curPaletteOffset += (uint32_t)cm->getLocalSkin().jointNodeIndices.size();
-                            curVertexOffset += mesh->getVertexCount();
+                            Matrix inv; nodeWorld.Invert(inv);
+                            job.meshWorldInverse = inv;
+                            memcpy(e.worldMatrix, &nodeWorld, sizeof(nodeWorld));
                         } else {
                             memcpy(e.worldMatrix, &nodeWorld, sizeof(nodeWorld));
                         }
-                        ownedEntries.push_back(std::move(e));
+
+                        if (shouldMorph){
+                            const uint32_t numTargets = mesh->getNumMorphTargets();
+                            const float* w = cm->getMorphWeights();
+                            job.morphWeights.assign(w, w + numTargets);
+                            curMorphWeightOffset += numTargets;
+                        }
+
+                        skinJobEntryIdx.push_back(ownedEntries.size());
+                        skinJobs.push_back(std::move(job));
+
+                        if (hasBones)
+                            curPaletteOffset += (uint32_t)cm->getLocalSkin().jointNodeIndices.size();
+                        curVertexOffset += mesh->getVertexCount();
+                    } else {
+                        memcpy(e.worldMatrix, &nodeWorld, sizeof(nodeWorld));
                     }
+                    ownedEntries.push_back(std::move(e));
                 }
             }
-            for (auto* child : node->getChildren()) collectMeshes(child);
-            };
-        collectMeshes(moduleScene->getRoot());
+        }
 
         for (auto& e : ownedEntries){
             Mesh* m = e.meshRes ? e.meshRes->getMesh() : e.mesh;
@@ -495,8 +490,6 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
     const EnvironmentSystem* envForIBL =
         (sky.enabled && m_envSystem) ? m_envSystem.get() : nullptr;
 
-    const Matrix viewProj = view * proj;
-
     std::vector<MeshEntry*> opaqueMeshes;
     std::vector<MeshEntry*> translucentMeshes;
     opaqueMeshes.reserve(visibleMeshes.size());
@@ -511,37 +504,20 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
 
     std::vector<BillboardInstance> billboards;
     if (m_billboardPass && moduleScene){
-        gatherBillboards(moduleScene->getRoot(), billboards, view, viewProj,
-                         viewCamPos, viewCamRight, viewCamUp);
-        gatherParticleSystems(moduleScene->getRoot(), billboards, viewProj,
-                              viewCamPos, viewCamRight, viewCamUp);
+        buildBillboards(viewFrustum, viewProj, viewCamPos, viewCamRight, viewCamUp, billboards);
+        buildParticleBillboards(viewFrustum, viewProj, viewCamRight, viewCamUp, billboards);
     }
 
     std::vector<TrailInstance> trails;
     if (m_trailPass && moduleScene){
-        gatherTrails(moduleScene->getRoot(), trails, viewProj, viewCamPos);
+        buildTrails(viewFrustum, viewCamPos, trails);
     }
 
-    std::vector<ParticleDrawRequest> gpuParticleRequests;
-    if (m_particlePass && moduleScene){
-        gatherGPUParticles(moduleScene->getRoot(), gpuParticleRequests,
-                           viewCamPos, viewCamRight, viewCamUp,
-                           (float)app->getElapsedMilis() / 1000.f);
-    }
+    std::vector<ParticleDrawRequest>& gpuParticleRequests = m_frame.gpuParticles;
 
     ShadowRenderData shadowData;
     if (m_shadowMapPass && !opaqueMeshes.empty()){
-        ComponentDirectionalLight* caster = nullptr;
-        if (moduleScene){
-            std::function<void(GameObject*)> findCaster = [&](GameObject* n){
-                if (!n || !n->isActive() || caster) return;
-                if (auto* dl = n->getComponent<ComponentDirectionalLight>(); dl && dl->enabled){
-                    caster = dl; return;
-                }
-                for (auto* c : n->getChildren()) findCaster(c);
-            };
-            findCaster(moduleScene->getRoot());
-        }
+        ComponentDirectionalLight* caster = m_frame.dirCaster;
 
         if (caster && caster->castShadows){
             float camNear, camFar;
@@ -658,53 +634,31 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
                 m_shadowMapPass->copyPreview(cmd, caster->shadowPreviewCascade);
         }
 
-        {
-            ComponentSpotLight* spot = nullptr; GameObject* spotGO = nullptr;
-            std::function<void(GameObject*)> find = [&](GameObject* n){
-                if (!n || !n->isActive() || spot) return;
-                if (auto* sl = n->getComponent<ComponentSpotLight>(); sl && sl->enabled && sl->castShadows){
-                    spot = sl; spotGO = n; return;
-                }
-                for (auto* c : n->getChildren()) find(c);
-            };
-            if (moduleScene) find(moduleScene->getRoot());
-            if (spot && spotGO){
-                Vector3 pos = spotGO->getTransform()->getGlobalMatrix().Translation();
-                Matrix vp = ShadowMath::SpotLightViewProj(pos, spot->direction,
-                                spot->outerAngle * 3.14159265f / 180.f, spot->radius);
-                m_shadowMapPass->renderSpot(cmd, opaqueMeshes, vp, (uint32_t)spot->shadowResolution);
-                shadowData.spotEnabled = true;
-                shadowData.spotViewProj = vp;
-                shadowData.spotPos = pos;
-                shadowData.spotBias = spot->shadowBias;
-                shadowData.spotPcfRadius = spot->shadowPcfRadius;
-                shadowData.spotResolution = m_shadowMapPass->getSpotResolution();
-                shadowData.spotSrv = m_shadowMapPass->getSpotSrvHandle();
-            }
+        if (ComponentSpotLight* spot = m_frame.spotCaster){
+            const Vector3 pos = m_frame.spotCasterPos;
+            Matrix vp = ShadowMath::SpotLightViewProj(pos, spot->direction,
+                            spot->outerAngle * 3.14159265f / 180.f, spot->radius);
+            m_shadowMapPass->renderSpot(cmd, opaqueMeshes, vp, (uint32_t)spot->shadowResolution);
+            shadowData.spotEnabled = true;
+            shadowData.spotViewProj = vp;
+            shadowData.spotPos = pos;
+            shadowData.spotBias = spot->shadowBias;
+            shadowData.spotPcfRadius = spot->shadowPcfRadius;
+            shadowData.spotResolution = m_shadowMapPass->getSpotResolution();
+            shadowData.spotSrv = m_shadowMapPass->getSpotSrvHandle();
         }
 
-        {
-            ComponentPointLight* pt = nullptr; GameObject* ptGO = nullptr;
-            std::function<void(GameObject*)> find = [&](GameObject* n){
-                if (!n || !n->isActive() || pt) return;
-                if (auto* pl = n->getComponent<ComponentPointLight>(); pl && pl->enabled && pl->castShadows){
-                    pt = pl; ptGO = n; return;
-                }
-                for (auto* c : n->getChildren()) find(c);
-            };
-            if (moduleScene) find(moduleScene->getRoot());
-            if (pt && ptGO){
-                Vector3 pos = ptGO->getTransform()->getGlobalMatrix().Translation();
-                Matrix faces[6];
-                ShadowMath::PointLightFaceViewProj(pos, 0.05f, pt->radius, faces);
-                m_shadowMapPass->renderPoint(cmd, opaqueMeshes, faces, pos, pt->radius,
-                                             (uint32_t)pt->shadowResolution);
-                shadowData.pointEnabled = true;
-                shadowData.pointPos = pos;
-                shadowData.pointRange = pt->radius;
-                shadowData.pointBias = pt->shadowBias;
-                shadowData.pointSrv = m_shadowMapPass->getPointSrvHandle();
-            }
+        if (ComponentPointLight* pt = m_frame.pointCaster){
+            const Vector3 pos = m_frame.pointCasterPos;
+            Matrix faces[6];
+            ShadowMath::PointLightFaceViewProj(pos, 0.05f, pt->radius, faces);
+            m_shadowMapPass->renderPoint(cmd, opaqueMeshes, faces, pos, pt->radius,
+                                         (uint32_t)pt->shadowResolution);
+            shadowData.pointEnabled = true;
+            shadowData.pointPos = pos;
+            shadowData.pointRange = pt->radius;
+            shadowData.pointBias = pt->shadowBias;
+            shadowData.pointSrv = m_shadowMapPass->getPointSrvHandle();
         }
 
         ID3D12DescriptorHeap* shHeaps[] = { app->getShaderDescriptors()->getHeap(),
@@ -712,6 +666,11 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
         cmd->SetDescriptorHeaps(2, shHeaps);
     }
 
+    if (!editorExtras && camera->cullMode == ModuleCamera::CullMode::Frustum && camera->occlusionCulling){
+        cullOccluded(viewProj, opaqueMeshes, translucentMeshes);
+        m_frameDrawCalls = (int)(opaqueMeshes.size() + translucentMeshes.size());
+    }
+
     if (m_gbufferPass && (!opaqueMeshes.empty() || !translucentMeshes.empty() || !billboards.empty())){
         const int gbufferViewportIndex = editorExtras ? 0 : 1;
         m_gbufferPass->render(cmd, opaqueMeshes, viewProj, w, h, gbufferViewportIndex);
@@ -729,44 +688,52 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
 
         if (m_decalPass && moduleScene){
             std::vector<DecalInstance> decals;
-            gatherDecals(moduleScene->getRoot(), decals, view, proj, w, h);
+            buildDecals(viewFrustum, viewProj, decals);
             if (!decals.empty())
                 m_decalPass->render(cmd, *m_gbufferPass, decals, w, h);
         }
 
+        // The deferred and transparent passes share one light list, since the
+        // transparent pass reads the clusters the deferred pass built from it.
+        FrameLightData culledLights;
+        const FrameLightData* frameLights = &m_frame.lights;
+        if (!editorExtras && camera->hasGameFrustum()){
+            const Frustum& gf = camera->getGameFrustum();
+            culledLights.dirLights = m_frame.lights.dirLights;
+            culledLights.pointLights.reserve(m_frame.lights.pointLights.size());
+            for (const auto& pl : m_frame.lights.pointLights){
+                Sphere s{ pl.position, sqrtf(pl.squaredRadius) };
+                AABB box = s.toAABB();
+                if (gf.intersectsAABB(box.min, box.max)) culledLights.pointLights.push_back(pl);
+            }
+            culledLights.spotLights.reserve(m_frame.lights.spotLights.size());
+            for (const auto& sl : m_frame.lights.spotLights){
+                Sphere s{ sl.position, sqrtf(sl.squaredRadius) };
+                AABB box = s.toAABB();
+                if (gf.intersectsAABB(box.min, box.max)) culledLights.spotLights.push_back(sl);
+            }
+            frameLights = &culledLights;
+        }
+
         if (m_deferredLightingPass){
             Matrix invViewProj;
             viewProj.Invert(invViewProj);
-
-            if (!editorExtras && camera->hasGameFrustum()){
-                const Frustum& gf = camera->getGameFrustum();
-                FrameLightData culledLights;
-                culledLights.dirLights = m_frameLights.dirLights;
-                culledLights.pointLights.reserve(m_frameLights.pointLights.size());
-                for (const auto& pl : m_frameLights.pointLights){
-                    Sphere s{ pl.position, sqrtf(pl.squaredRadius) };
-                    AABB box = s.toAABB();
-                    if (gf.intersectsAABB(box.min, box.max)) culledLights.pointLights.push_back(pl);
-                }
-                culledLights.spotLights.reserve(m_frameLights.spotLights.size());
-                for (const auto& sl : m_frameLights.spotLights){
-                    Sphere s{ sl.position, sqrtf(sl.squaredRadius) };
-                    AABB box = s.toAABB();
-                    if (gf.intersectsAABB(box.min, box.max)) culledLights.spotLights.push_back(sl);
-                }
-                m_deferredLightingPass->render(cmd, *m_gbufferPass, culledLights,
-                                                viewCamPos, view, proj,
-                                                invViewProj, envForIBL, w, h,
-                                                gbufferViewportIndex, shadowData);
-            } else {
-                m_deferredLightingPass->render(cmd, *m_gbufferPass, m_frameLights,
-                                                viewCamPos, view, proj,
-                                                invViewProj, envForIBL, w, h,
-                                                gbufferViewportIndex, shadowData);
+            m_deferredLightingPass->render(cmd, *m_gbufferPass, *frameLights,
+                                            viewCamPos, view, proj,
+                                            invViewProj, envForIBL, w, h,
+                                            gbufferViewportIndex, shadowData);
+
+            if (!editorExtras){
+                const LightClusters& clusters = m_deferredLightingPass->getClusters();
+                camera->clusterLightCount = static_cast<int>(frameLights->pointLights.size() + frameLights->spotLights.size());
+                camera->clusterReferenceCount = static_cast<int>(clusters.getIndices().size());
+                camera->clusterMaxLights = static_cast<int>(clusters.getMaxPerCluster());
+                camera->clusterBuildMs = clusters.getBuildMs();
             }
         }
 
-        if (!translucentMeshes.empty() && m_meshRenderPass && outputRT && outputRT->isValid()){
+        if (!translucentMeshes.empty() && m_meshRenderPass && m_deferredLightingPass &&
+            outputRT && outputRT->isValid()){
             const Vector3 camPos = viewCamPos;
             std::sort(translucentMeshes.begin(), translucentMeshes.end(),
                       [&camPos](const MeshEntry* a, const MeshEntry* b){
@@ -787,8 +754,9 @@ void ModuleEditor::renderSceneWithCamera(ID3D12GraphicsCommandList* cmd, const M
             cmd->RSSetScissorRects(1, &sc);
 
             BEGIN_EVENT(cmd, L"Forward Transparent Pass");
-            m_meshRenderPass->renderTransparent(cmd, translucentMeshes, m_frameLights,
-                                                 camPos, viewProj, envForIBL, shadowData);
+            m_meshRenderPass->renderTransparent(cmd, translucentMeshes, *frameLights,
+                                                 m_deferredLightingPass->getClusters(),
+                                                 camPos, view, viewProj, w, h, envForIBL, shadowData);
             END_EVENT(cmd);
         }
 
@@ -38,11 +38,13 @@
 #include "PrimitiveFactory.h"
 #include "ModuleCamera.h"
 #include "FrustumDebugDraw.h"
+#include "Frustum.h"
 #include "BoundingVolume.h"
 #include "ComponentBounds.h"
 #include "ComponentRigidbody.h"
 #include "CollisionSystem.h"
 #include "CollisionResponse.h"
+#include "CollisionBodyRegistry.h"
 #include "EnvironmentMap.h"
 #include "SceneViewPanel.h"
 #include "GameViewPanel.h"
@@ -67,37 +69,58 @@
 #include <functional>
 #include <unordered_set>
 #include <cfloat>
+#include <cstring>
 
 static constexpr float kDeg2Rad = 0.0174532925f;
 
-void ModuleEditor::gatherLights(GameObject* node, FrameLightData& out) const{
-    if (!node || !node->isActive()) return;
+// Occluders are the opaque meshes covering the most screen; small ones hide
+// little and cost the same to rasterize.
+static constexpr float kMinOccluderCoverage = 0.02f;
+static constexpr int kMaxOccluders = 32;
+static constexpr uint32_t kMaxOccluderTriangles = 2048;
+static constexpr uint32_t kOccluderTriangleBudget = 16384;
+
+void ModuleEditor::gatherFrame(){
+    m_frame.clear();
+    if (SceneGraph* scene = getActiveModuleScene())
+        gatherNode(scene->getRoot(), true, (float)app->getElapsedMilis() / 1000.f);
+}
+
+// Deferred mesh releases are flushed on every node, active or not; the rest
+// is only collected under active parents.
+void ModuleEditor::gatherNode(GameObject* node, bool active, float elapsedTime){
+    if (!node) return;
+
+    auto* cm = node->getComponent<ComponentMesh>();
+    if (cm) cm->flushDeferredReleases();
 
-    if (auto* dl = node->getComponent<ComponentDirectionalLight>(); dl && dl->enabled){
-        if (out.dirLights.size() < MeshPipeline::MAX_DIR_LIGHTS){
+    active = active && node->isActive();
+    if (active){
+        if (auto* dl = node->getComponent<ComponentDirectionalLight>(); dl && dl->enabled){
             MeshPipeline::GPUDirectionalLight g;
             g.direction = dl->direction;
             g.direction.Normalize();
             g.color = dl->color;
             g.intensity = dl->intensity;
             g._pad = 0.f;
-            out.dirLights.push_back(g);
+            m_frame.lights.dirLights.push_back(g);
+            if (!m_frame.dirCaster) m_frame.dirCaster = dl;
         }
-    }
 
-    if (auto* pl = node->getComponent<ComponentPointLight>(); pl && pl->enabled){
-        if (out.pointLights.size() < MeshPipeline::MAX_POINT_LIGHTS){
+        if (auto* pl = node->getComponent<ComponentPointLight>(); pl && pl->enabled){
             MeshPipeline::GPUPointLight p;
             p.position = node->getTransform()->getGlobalMatrix().Translation();
             p.squaredRadius = pl->radius * pl->radius;
             p.color = pl->color;
             p.intensity = pl->intensity;
-            out.pointLights.push_back(p);
+            m_frame.lights.pointLights.push_back(p);
+            if (!m_frame.pointCaster && pl->castShadows){
+                m_frame.pointCaster = pl;
+                m_frame.pointCasterPos = p.position;
+            }
         }
-    }
 
-    if (auto* sl = node->getComponent<ComponentSpotLight>(); sl && sl->enabled){
-        if (out.spotLights.size() < MeshPipeline::MAX_SPOT_LIGHTS){
+        if (auto* sl = node->getComponent<ComponentSpotLight>(); sl && sl->enabled){
             MeshPipeline::GPUSpotLight s;
             s.position = node->getTransform()->getGlobalMatrix().Translation();
             s.direction = sl->direction;
@@ -108,121 +131,184 @@ void ModuleEditor::gatherLights(GameObject* node, FrameLightData& out) const{
             s.color = sl->color;
             s.intensity = sl->intensity;
             s._pad[0] = s._pad[1] = s._pad[2] = 0.f;
-            out.spotLights.push_back(s);
+            m_frame.lights.spotLights.push_back(s);
+            if (!m_frame.spotCaster && sl->castShadows){
+                m_frame.spotCaster = sl;
+                m_frame.spotCasterPos = s.position;
+            }
         }
-    }
 
-    for (auto* c : node->getChildren()) gatherLights(c, out);
-}
+        if (cm) m_frame.meshes.push_back({ node, cm, node->getTransform()->getGlobalMatrix() });
 
-void ModuleEditor::gatherDecals(GameObject* node, std::vector<DecalInstance>& out,
-                                  const Matrix& view, const Matrix& proj,
-                                  uint32_t w, uint32_t h) const{
-    if (!node || !node->isActive()) return;
+        if (auto* dc = node->getComponent<ComponentDecal>(); dc && dc->enabled)
+            m_frame.decals.push_back({ dc, node->getTransform()->getGlobalMatrix() });
 
-    if (auto* dc = node->getComponent<ComponentDecal>(); dc && dc->enabled){
-        if (out.size() < DecalPass::MAX_DECALS){
-            Matrix worldMat = node->getTransform()->getGlobalMatrix();
-            Matrix viewProj = view * proj;
+        if (auto* bb = node->getComponent<ComponentBillboard>(); bb && bb->enabled)
+            m_frame.billboards.push_back({ bb, node->getTransform()->getGlobalMatrix().Translation() });
 
-            DecalInstance inst;
-            inst.mvp = (worldMat * viewProj).Transpose();
-            worldMat.Invert(inst.invModel);
-            inst.invModel = inst.invModel.Transpose();
+        if (auto* ps = node->getComponent<ComponentParticleSystem>(); ps && ps->enabled){
+            if (!ps->useGPU) m_frame.particleSystems.push_back(ps);
+            else if (m_particlePass){
+                ParticleDrawRequest req;
+                buildGPUParticles(ps, elapsedTime, req);
+                if (!req.particles.empty()) m_frame.gpuParticles.push_back(std::move(req));
+            }
+        }
 
-            Matrix invVP;
-            viewProj.Invert(invVP);
-            inst.invViewProj = invVP.Transpose();
+        if (auto* tr = node->getComponent<ComponentTrail>(); tr && tr->enabled)
+            m_frame.trails.push_back(tr);
+    }
 
-            inst.colourOpacity = Vector4(dc->colour.x, dc->colour.y, dc->colour.z, dc->opacity);
+    for (auto* c : node->getChildren()) gatherNode(c, active, elapsedTime);
+}
 
-            out.push_back(inst);
+static bool isActiveUnder(const GameObject* go, const GameObject* root){
+    for (const GameObject* node = go; node; node = node->getParent()){
+        if (!node->isActive()) return false;
+        if (node == root) return true;
+    }
+    return false;
+}
+
+// Only the registry slots logged since the last frame are looked at; a new
+// scene or a trimmed log starts the octree over from every slot. A mesh that
+// changed is hidden until the next query shows it.
+void ModuleEditor::syncRenderOctree(SceneGraph* scene){
+    const std::vector<CollisionBodyRegistry::Entry>& entries = CollisionBodyRegistry::GetEntries();
+    m_cullSlots.clear();
+    if (scene != m_cullScene || !CollisionBodyRegistry::ReadChanges(m_cullCursor, m_cullSlots)){
+        m_cullScene = scene;
+        m_renderOctree.clear();
+        m_cullVisible.clear();
+        m_cullCursor = CollisionBodyRegistry::GetLogEnd();
+        m_cullSlots.clear();
+        for (uint32_t slot = 0; slot < static_cast<uint32_t>(entries.size()); ++slot)
+            m_cullSlots.push_back(slot);
+    }
+
+    const GameObject* root = scene->getRoot();
+    m_renderOctree.beginUpdate();
+    for (uint32_t slot : m_cullSlots){
+        const CollisionBodyRegistry::Entry& e = entries[slot];
+        if (!e.mesh || e.owner->getComponent<ComponentMesh>() != e.mesh || !isActiveUnder(e.owner, root)){
+            m_renderOctree.remove(slot);
+        } else if (!e.mesh->hasAABB()){
+            m_renderOctree.remove(slot);
+            e.mesh->setVisible(true);
+        } else {
+            Vector3 mn, mx;
+            e.mesh->getWorldAABB(mn, mx);
+            m_renderOctree.update(slot, AABB{ mn, mx });
+            e.mesh->setVisible(false);
         }
     }
+    m_renderOctree.endUpdate();
+}
 
-    for (auto* c : node->getChildren()) gatherDecals(c, out, view, proj, w, h);
+// Decals are unit cubes in local space.
+void ModuleEditor::buildDecals(const Frustum& frustum, const Matrix& viewProj,
+                               std::vector<DecalInstance>& out) const{
+    Matrix invVP;
+    viewProj.Invert(invVP);
+    invVP = invVP.Transpose();
+
+    for (const auto& d : m_frame.decals){
+        if (out.size() >= DecalPass::MAX_DECALS) break;
+
+        const Matrix& worldMat = d.world;
+        Vector3 axes[3] = { worldMat.Right(), worldMat.Up(), worldMat.Backward() };
+        const Vector3 he(axes[0].Length() * 0.5f, axes[1].Length() * 0.5f, axes[2].Length() * 0.5f);
+        for (Vector3& a : axes) a.Normalize();
+        if (!frustum.intersectsOBB(worldMat.Translation(), he, axes)) continue;
+
+        DecalInstance inst;
+        inst.mvp = (worldMat * viewProj).Transpose();
+        worldMat.Invert(inst.invModel);
+        inst.invModel = inst.invModel.Transpose();
+        inst.invViewProj = invVP;
+        inst.colourOpacity = Vector4(d.decal->colour.x, d.decal->colour.y, d.decal->colour.z, d.decal->opacity);
+
+        out.push_back(inst);
+    }
 }
 
-void ModuleEditor::gatherBillboards(GameObject* node, std::vector<BillboardInstance>& out,
-                                     const Matrix& view, const Matrix& viewProj,
-                                     const Vector3& camPos, const Vector3& camRight, const Vector3& camUp) const{
-    if (!node || !node->isActive()) return;
-
-    if (auto* bb = node->getComponent<ComponentBillboard>(); bb && bb->enabled){
-        if (out.size() < BillboardPass::MAX_BILLBOARDS){
-            const Vector3 center = node->getTransform()->getGlobalMatrix().Translation();
-
-            Vector3 right, up;
-            switch (bb->alignment){
-            case ComponentBillboard::Alignment::Screen:
-                right = camRight;
-                up = camUp;
-                break;
-            case ComponentBillboard::Alignment::World: {
-                Vector3 worldUp(0.f, 1.f, 0.f);
-                Vector3 n = camPos - center;
-                if (n.LengthSquared() < 1e-8f) n = -camRight;
-                n.Normalize();
-                right = worldUp.Cross(n);
-                if (right.LengthSquared() < 1e-8f) right = camRight;
-                right.Normalize();
-                up = n.Cross(right);
-                break;
-            }
-            case ComponentBillboard::Alignment::Axial:
-            default: {
-                Vector3 fixedUp(0.f, 1.f, 0.f);
-                Vector3 toCam = camPos - center;
-                right = toCam.Cross(fixedUp);
-                if (right.LengthSquared() < 1e-8f) right = camRight;
-                right.Normalize();
-                up = fixedUp;
-                break;
-            }
-            }
+void ModuleEditor::buildBillboards(const Frustum& frustum, const Matrix& viewProj,
+                                   const Vector3& camPos, const Vector3& camRight, const Vector3& camUp,
+                                   std::vector<BillboardInstance>& out) const{
+    for (const auto& b : m_frame.billboards){
+        if (out.size() >= BillboardPass::MAX_BILLBOARDS) break;
+
+        const ComponentBillboard* bb = b.billboard;
+        const Vector3& center = b.center;
+        if (!frustum.intersectsSphere(center, 0.5f * bb->size.Length())) continue;
+
+        Vector3 right, up;
+        switch (bb->alignment){
+        case ComponentBillboard::Alignment::Screen:
+            right = camRight;
+            up = camUp;
+            break;
+        case ComponentBillboard::Alignment::World: {
+            Vector3 worldUp(0.f, 1.f, 0.f);
+            Vector3 n = camPos - center;
+            if (n.LengthSquared() < 1e-8f) n = -camRight;
+            n.Normalize();
+            right = worldUp.Cross(n);
+            if (right.LengthSquared() < 1e-8f) right = camRight;
+            right.Normalize();
+            up = n.Cross(right);
+            break;
+        }
+        case ComponentBillboard::Alignment::Axial:
+        default: {
+            Vector3 fixedUp(0.f, 1.f, 0.f);
+            Vector3 toCam = camPos - center;
+            right = toCam.Cross(fixedUp);
+            if (right.LengthSquared() < 1e-8f) right = camRight;
+            right.Normalize();
+            up = fixedUp;
+            break;
+        }
+        }
 
-            const int cols = std::max(1, bb->sheetColumns);
-            const int rows = std::max(1, bb->sheetRows);
-            const int totalTiles = cols * rows;
-            const float frame = bb->getCurrentFrame();
-            const int frameA = ((int)frame) % totalTiles;
-            const int frameB = (frameA + 1) % totalTiles;
-            const float blend = frame - floorf(frame);
-
-            auto tileRect = [cols, rows](int tileIndex) -> Vector4 {
-                int tx = tileIndex % cols;
-                int ty = tileIndex / cols;
-                ty = (rows - 1) - ty;
-                float u0 = (float)tx / (float)cols;
-                float v0 = (float)ty / (float)rows;
-                return Vector4(u0, v0, u0 + 1.f / cols, v0 + 1.f / rows);
-            };
+        const int cols = std::max(1, bb->sheetColumns);
+        const int rows = std::max(1, bb->sheetRows);
+        const int totalTiles = cols * rows;
+        const float frame = bb->getCurrentFrame();
+        const int frameA = ((int)frame) % totalTiles;
+        const int frameB = (frameA + 1) % totalTiles;
+        const float blend = frame - floorf(frame);
 
-            BillboardInstance inst;
-            inst.cb.viewProj = viewProj.Transpose();
-            inst.cb.centerHalfWidth = Vector4(center.x, center.y, center.z, bb->size.x * 0.5f);
-            inst.cb.rightHalfHeight = Vector4(right.x, right.y, right.z, bb->size.y * 0.5f);
-            inst.cb.up = Vector4(up.x, up.y, up.z, 0.f);
-            inst.cb.tint = bb->tint;
-            inst.cb.frameRectA = tileRect(frameA);
-            inst.cb.frameRectB = (totalTiles > 1) ? tileRect(frameB) : inst.cb.frameRectA;
-            inst.cb.blendFactor = Vector4(blend, 0.f, 0.f, 0.f);
-            inst.texturePath = bb->texturePath;
+        auto tileRect = [cols, rows](int tileIndex) -> Vector4 {
+            int tx = tileIndex % cols;
+            int ty = tileIndex / cols;
+            ty = (rows - 1) - ty;
+            float u0 = (float)tx / (float)cols;
+            float v0 = (float)ty / (float)rows;
+            return Vector4(u0, v0, u0 + 1.f / cols, v0 + 1.f / rows);
+        };
 
-            out.push_back(std::move(inst));
-        }
+        BillboardInstance inst;
+        inst.cb.viewProj = viewProj.Transpose();
+        inst.cb.centerHalfWidth = Vector4(center.x, center.y, center.z, bb->size.x * 0.5f);
+        inst.cb.rightHalfHeight = Vector4(right.x, right.y, right.z, bb->size.y * 0.5f);
+        inst.cb.up = Vector4(up.x, up.y, up.z, 0.f);
+        inst.cb.tint = bb->tint;
+        inst.cb.frameRectA = tileRect(frameA);
+        inst.cb.frameRectB = (totalTiles > 1) ? tileRect(frameB) : inst.cb.frameRectA;
+        inst.cb.blendFactor = Vector4(blend, 0.f, 0.f, 0.f);
+        inst.texturePath = bb->texturePath;
+
+        out.push_back(std::move(inst));
     }
-
-    for (auto* c : node->getChildren()) gatherBillboards(c, out, view, viewProj, camPos, camRight, camUp);
 }
 
-void ModuleEditor::gatherParticleSystems(GameObject* node, std::vector<BillboardInstance>& out,
-                                          const Matrix& viewProj,
-                                          const Vector3& camPos, const Vector3& camRight, const Vector3& camUp) const{
-    if (!node || !node->isActive()) return;
+void ModuleEditor::buildParticleBillboards(const Frustum& frustum, const Matrix& viewProj,
+                                           const Vector3& camRight, const Vector3& camUp,
+                                           std::vector<BillboardInstance>& out) const{
+    const Matrix viewProjT = viewProj.Transpose();
 
-    if (auto* ps = node->getComponent<ComponentParticleSystem>();
-        ps && ps->enabled && !ps->useGPU){
+    for (const ComponentParticleSystem* ps : m_frame.particleSystems){
         const int cols = std::max(1, ps->sheetColumns);
         const int rows = std::max(1, ps->sheetRows);
         const int totalTiles = cols * rows;
@@ -238,10 +324,11 @@ void ModuleEditor::gatherParticleSystems(GameObject* node, std::vector<Billboard
 
         for (const auto& p : ps->getParticles()){
             if (!p.alive) continue;
-            if (out.size() >= BillboardPass::MAX_BILLBOARDS) break;
+            if (out.size() >= BillboardPass::MAX_BILLBOARDS) return;
 
             const float t = std::clamp(p.age / std::max(0.0001f, p.lifetime), 0.f, 1.f);
             const float size = p.baseSize * ps->sizeMultiplierAt(t);
+            if (!frustum.intersectsSphere(p.position, size * 0.70710678f)) continue;
             const Vector4 color = ps->colorAt(t);
 
             const float rad = p.rotationDeg * (3.14159265358979323846f / 180.f);
@@ -252,7 +339,7 @@ void ModuleEditor::gatherParticleSystems(GameObject* node, std::vector<Billboard
             const Vector4 frameA = tileRect(p.frameIndex % totalTiles);
 
             BillboardInstance inst;
-            inst.cb.viewProj = viewProj.Transpose();
+            inst.cb.viewProj = viewProjT;
             inst.cb.centerHalfWidth = Vector4(p.position.x, p.position.y, p.position.z, size * 0.5f);
             inst.cb.rightHalfHeight = Vector4(right.x, right.y, right.z, size * 0.5f);
             inst.cb.up = Vector4(up.x, up.y, up.z, 0.f);
@@ -266,99 +353,139 @@ void ModuleEditor::gatherParticleSystems(GameObject* node, std::vector<Billboard
             out.push_back(std::move(inst));
         }
     }
-
-    for (auto* c : node->getChildren()) gatherParticleSystems(c, out, viewProj, camPos, camRight, camUp);
 }
 
-void ModuleEditor::gatherTrails(GameObject* node, std::vector<TrailInstance>& out,
-                                const Matrix& viewProj, const Vector3& camPos) const{
-    if (!node || !node->isActive()) return;
-
-    if (auto* tr = node->getComponent<ComponentTrail>(); tr && tr->enabled){
-        if (out.size() < TrailPass::MAX_TRAILS){
-            TrailInstance inst;
-            bool built = tr->buildMesh(camPos, inst.vertices);
-            if (built && !inst.vertices.empty()){
-                inst.tint = Vector4(1.f, 1.f, 1.f, 1.f);
-                inst.texturePath = tr->texturePath;
-                inst.additive = (tr->blendMode == ComponentTrail::BlendMode::Additive);
-                inst.sortPos = inst.vertices.front().position;
-                inst.layer = tr->layer;
-                out.push_back(std::move(inst));
-            }
+// Trails are culled on their bounds so off-screen ribbons are never built.
+void ModuleEditor::buildTrails(const Frustum& frustum, const Vector3& camPos,
+                               std::vector<TrailInstance>& out) const{
+    for (const ComponentTrail* tr : m_frame.trails){
+        if (out.size() >= TrailPass::MAX_TRAILS) break;
+
+        Vector3 mn, mx;
+        if (!tr->getBounds(mn, mx) || !frustum.intersectsAABB(mn, mx)) continue;
+
+        TrailInstance inst;
+        bool built = tr->buildMesh(camPos, inst.vertices);
+        if (built && !inst.vertices.empty()){
+            inst.tint = Vector4(1.f, 1.f, 1.f, 1.f);
+            inst.texturePath = tr->texturePath;
+            inst.additive = (tr->blendMode == ComponentTrail::BlendMode::Additive);
+            inst.sortPos = inst.vertices.front().position;
+            inst.layer = tr->layer;
+            out.push_back(std::move(inst));
         }
     }
-
-    for (auto* c : node->getChildren()) gatherTrails(c, out, viewProj, camPos);
 }
 
-void ModuleEditor::gatherGPUParticles(GameObject* node,
-                                       std::vector<ParticleDrawRequest>& out,
-                                       const Vector3& ,
-                                       const Vector3& , const Vector3& ,
-                                       float elapsedTime) const {
-    if (!node || !node->isActive()) return;
-
-    if (auto* ps = node->getComponent<ComponentParticleSystem>();
-        ps && ps->enabled && ps->useGPU){
-        const int cols = std::max(1, ps->sheetColumns);
-        const int rows = std::max(1, ps->sheetRows);
-        const int totalTiles = cols * rows;
-
-        auto tileUV = [cols, rows](int tileIdx) -> std::pair<Vector2, Vector2> {
-            int tx = tileIdx % cols;
-            int ty = tileIdx / cols;
-            ty = (rows - 1) - ty;
-            float u0 = (float)tx / cols, u1 = u0 + 1.f / cols;
-            float v0 = (float)ty / rows, v1 = v0 + 1.f / rows;
-            return { Vector2(u0, v0), Vector2(u1, v1) };
-        };
-
-        ParticleDrawRequest req;
-        req.emitterKey = reinterpret_cast<size_t>(ps);
-        req.maxParticles = ps->maxParticles;
-        req.texturePath = ps->texturePath;
-        req.additive = (ps->blendMode == ComponentParticleSystem::BlendMode::Additive);
-        req.gpuTurbulence = ps->useTurbulence;
-        req.turbFrequency = ps->turbulenceFrequency;
-        req.turbStrength = ps->turbulenceStrength;
-        req.turbScrollSpeed = ps->turbulenceScroll;
-        req.time = elapsedTime;
-        req.deltaTime = std::clamp((float)app->getElapsedMilis() * 0.001f, 0.f, 0.1f);
-
-        for (const auto& p : ps->getParticles()){
-            if (!p.alive) continue;
-            if ((int)req.particles.size() >= ps->maxParticles) break;
-
-            const float t = std::clamp(p.age / std::max(0.0001f, p.lifetime), 0.f, 1.f);
-            const float size = p.baseSize * ps->sizeMultiplierAt(t);
-            const Vector4 col = ps->colorAt(t);
-
-            auto [uvMin, uvMax] = tileUV(p.frameIndex % totalTiles);
-
-            GpuParticle gp;
-            gp.position[0] = p.position.x;
-            gp.position[1] = p.position.y;
-            gp.position[2] = p.position.z;
-            gp.size = size;
-            gp.color[0] = col.x;
-            gp.color[1] = col.y;
-            gp.color[2] = col.z;
-            gp.color[3] = col.w;
-            gp.rotation = p.rotationDeg;
-            gp.uvMin[0] = uvMin.x;
-            gp.uvMin[1] = uvMin.y;
-            gp.uvMax[0] = uvMax.x;
-            gp.uvMax[1] = uvMax.y;
-            req.particles.push_back(gp);
-        }
-
-        if (!req.particles.empty())
-            out.push_back(std::move(req));
+// GPU emitters simulate inside ParticlePass, so they are built once per
+// frame and never culled: skipping one would stall its simulation.
+void ModuleEditor::buildGPUParticles(ComponentParticleSystem* ps, float elapsedTime,
+                                     ParticleDrawRequest& req) const{
+    const int cols = std::max(1, ps->sheetColumns);
+    const int rows = std::max(1, ps->sheetRows);
+    const int totalTiles = cols * rows;
+
+    auto tileUV = [cols, rows](int tileIdx) -> std::pair<Vector2, Vector2> {
+        int tx = tileIdx % cols;
+        int ty = tileIdx / cols;
+        ty = (rows - 1) - ty;
+        float u0 = (float)tx / cols, u1 = u0 + 1.f / cols;
+        float v0 = (float)ty / rows, v1 = v0 + 1.f / rows;
+        return { Vector2(u0, v0), Vector2(u1, v1) };
+    };
+
+    req.emitterKey = reinterpret_cast<size_t>(ps);
+    req.maxParticles = ps->maxParticles;
+    req.texturePath = ps->texturePath;
+    req.additive = (ps->blendMode == ComponentParticleSystem::BlendMode::Additive);
+    req.gpuTurbulence = ps->useTurbulence;
+    req.turbFrequency = ps->turbulenceFrequency;
+    req.turbStrength = ps->turbulenceStrength;
+    req.turbScrollSpeed = ps->turbulenceScroll;
+    req.time = elapsedTime;
+    req.deltaTime = std::clamp((float)app->getElapsedMilis() * 0.001f, 0.f, 0.1f);
+
+    for (const auto& p : ps->getParticles()){
+        if (!p.alive) continue;
+        if ((int)req.particles.size() >= ps->maxParticles) break;
+
+        const float t = std::clamp(p.age / std::max(0.0001f, p.lifetime), 0.f, 1.f);
+        const float size = p.baseSize * ps->sizeMultiplierAt(t);
+        const Vector4 col = ps->colorAt(t);
+
+        auto [uvMin, uvMax] = tileUV(p.frameIndex % totalTiles);
+
+        GpuParticle gp;
+        gp.position[0] = p.position.x;
+        gp.position[1] = p.position.y;
+        gp.position[2] = p.position.z;
+        gp.size = size;
+        gp.color[0] = col.x;
+        gp.color[1] = col.y;
+        gp.color[2] = col.z;
+        gp.color[3] = col.w;
+        gp.rotation = p.rotationDeg;
+        gp.uvMin[0] = uvMin.x;
+        gp.uvMin[1] = uvMin.y;
+        gp.uvMax[0] = uvMax.x;
+        gp.uvMax[1] = uvMax.y;
+        req.particles.push_back(gp);
     }
+}
 
-    for (auto* c : node->getChildren())
-        gatherGPUParticles(c, out, {}, {}, {}, elapsedTime);
+void ModuleEditor::cullOccluded(const Matrix& viewProj, std::vector<MeshEntry*>& opaque,
+                                std::vector<MeshEntry*>& translucent){
+    ModuleCamera* camera = app->getCamera();
+    auto meshOf = [](const MeshEntry* e){ return e->meshRes ? e->meshRes->getMesh() : e->mesh; };
+
+    m_occlusionCuller.beginFrame(viewProj);
+    std::vector<std::pair<float, MeshEntry*>> candidates;
+    for (MeshEntry* e : opaque){
+        const Mesh* mesh = meshOf(e);
+        if (!e->hasWorldAABB || !mesh || mesh->getVertices().empty()) continue;
+        if (mesh->getIndexCount() / 3 > kMaxOccluderTriangles) continue;
+        const float coverage = m_occlusionCuller.screenCoverage(e->aabbMin, e->aabbMax);
+        if (coverage >= kMinOccluderCoverage) candidates.push_back({ coverage, e });
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b){ return a.first > b.first; });
+
+    std::unordered_set<const MeshEntry*> occluders;
+    uint32_t occluderTris = 0;
+    for (const auto& [coverage, e] : candidates){
+        if (static_cast<int>(occluders.size()) == kMaxOccluders) break;
+        const Mesh* mesh = meshOf(e);
+        const uint32_t tris = mesh->getIndexCount() / 3;
+        if (occluderTris + tris > kOccluderTriangleBudget) continue;
+        Matrix world;
+        memcpy(&world, e->worldMatrix, sizeof(world));
+        m_occlusionCuller.addOccluder(&mesh->getVertices()[0].position, sizeof(Mesh::Vertex),
+                                      mesh->getIndices().data(), mesh->getIndexCount(), world);
+        occluders.insert(e);
+        occluderTris += tris;
+    }
+    m_occlusionCuller.rasterize();
+
+    // Occluders stay: they are drawn anyway and would only test against
+    // their own depth.
+    int tested = 0, culled = 0;
+    auto filter = [&](std::vector<MeshEntry*>& list){
+        list.erase(std::remove_if(list.begin(), list.end(), [&](MeshEntry* e){
+            if (!e->hasWorldAABB || occluders.count(e)) return false;
+            ++tested;
+            const bool hidden = !m_occlusionCuller.isVisible(e->aabbMin, e->aabbMax);
+            if (hidden) ++culled;
+            return hidden;
+        }), list.end());
+    };
+    filter(opaque);
+    filter(translucent);
+
+    camera->occluderCount = static_cast<int>(occluders.size());
+    camera->occluderTriangleCount = static_cast<int>(m_occlusionCuller.getTriangleCount());
+    camera->occlusionTestedCount = tested;
+    camera->occlusionCulledCount = culled;
+    camera->occlusionRasterMs = m_occlusionCuller.getRasterMs();
 }
 
 void ModuleEditor::debugDrawLights(SceneGraph* scene, float sz){
@@ -2,6 +2,7 @@
 #include "ModuleD3D12.h"
 #include <imgui.h>
 #include "ImGuizmo.h"
+#include "CollisionLayers.h"
 
 struct EditorSceneSettings {
     bool showGrid = true;
@@ -15,6 +16,7 @@ struct EditorSceneSettings {
     } ambient;
 
     float gravityY = -9.81f;
+    CollisionLayers collisionLayers;
 
     bool debugDrawLights = false;
     float debugLightSize = 1.0f;
@@ -53,16 +53,6 @@ namespace {
 		return gm;
 	}
 
-	void makeStructuredSRV(ShaderTableDesc& table, UINT slot, ID3D12Resource* buf, UINT numElems, UINT stride){
-		D3D12_SHADER_RESOURCE_VIEW_DESC srv = {};
-		srv.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
-		srv.Format = DXGI_FORMAT_UNKNOWN;
-		srv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srv.Buffer.NumElements = numElems;
-		srv.Buffer.StructureByteStride = stride;
-		table.createSRV(buf, slot, &srv);
-	}
-
 	void writeTex2DSRV(ShaderTableDesc& table, UINT slot, ID3D12Resource* tex){
 		D3D12_SHADER_RESOURCE_VIEW_DESC sv = {};
 		sv.Format = tex->GetDesc().Format;
@@ -99,7 +89,6 @@ bool ForwardMeshPass::init(ID3D12Device* device, bool useMSAA){
 		return false;
 	}
 	if (!createUploadBuffers(device)) return false;
-	if (!createLightSRVs()) return false;
 	if (!createFallbackTextures(device)) return false;
 	if (!createMatTableRing()) return false;
 	LOG("ForwardMeshPass: init OK");
@@ -119,29 +108,11 @@ bool ForwardMeshPass::createUploadBuffers(ID3D12Device* device){
 	m_perInstanceRing = makeUploadBuf(device, (UINT64)instSz * MAX_INSTANCES, &m_perInstanceMapped, L"MeshPass_InstanceRing");
 	if (!m_perInstanceRing) return false;
 
-	m_dirLightBuf = makeUploadBuf(device, sizeof(MeshPipeline::GPUDirectionalLight) * MeshPipeline::MAX_DIR_LIGHTS, &m_dirLightMapped, L"MeshPass_DirLights");
-	m_pointLightBuf = makeUploadBuf(device, sizeof(MeshPipeline::GPUPointLight) * MeshPipeline::MAX_POINT_LIGHTS, &m_pointLightMapped, L"MeshPass_PointLights");
-	m_spotLightBuf = makeUploadBuf(device, sizeof(MeshPipeline::GPUSpotLight) * MeshPipeline::MAX_SPOT_LIGHTS, &m_spotLightMapped, L"MeshPass_SpotLights");
-
-	if (!m_dirLightBuf || !m_pointLightBuf || !m_spotLightBuf) return false;
-	return true;
-}
-
-bool ForwardMeshPass::createLightSRVs(){
-	auto* sd = app->getShaderDescriptors();
-	m_dirLightSRV = sd->allocTable("MeshPass_DirSRV");
-	m_pointLightSRV = sd->allocTable("MeshPass_PointSRV");
-	m_spotLightSRV = sd->allocTable("MeshPass_SpotSRV");
-
-	if (!m_dirLightSRV.isValid() || !m_pointLightSRV.isValid() || !m_spotLightSRV.isValid()){
-		LOG("ForwardMeshPass: light SRV alloc failed");
-		return false;
-	}
-
-	makeStructuredSRV(m_dirLightSRV, 0, m_dirLightBuf.Get(), MeshPipeline::MAX_DIR_LIGHTS, sizeof(MeshPipeline::GPUDirectionalLight));
-	makeStructuredSRV(m_pointLightSRV, 0, m_pointLightBuf.Get(), MeshPipeline::MAX_POINT_LIGHTS, sizeof(MeshPipeline::GPUPointLight));
-	makeStructuredSRV(m_spotLightSRV, 0, m_spotLightBuf.Get(), MeshPipeline::MAX_SPOT_LIGHTS, sizeof(MeshPipeline::GPUSpotLight));
-	return true;
+	return m_dirLights.init(device, sizeof(MeshPipeline::GPUDirectionalLight), 4, L"MeshPass_DirLights")
+	    && m_pointLights.init(device, sizeof(MeshPipeline::GPUPointLight), 64, L"MeshPass_PointLights")
+	    && m_spotLights.init(device, sizeof(MeshPipeline::GPUSpotLight), 32, L"MeshPass_SpotLights")
+	    && m_clusterBuf.init(device, sizeof(LightClusters::Cluster), LightClusters::kClusterCount, L"MeshPass_Clusters")
+	    && m_clusterIndices.init(device, sizeof(uint32_t), 4096, L"MeshPass_ClusterIndices");
 }
 
 bool ForwardMeshPass::createFallbackTextures(ID3D12Device* device){
@@ -231,22 +202,22 @@ bool ForwardMeshPass::createMatTableRing(){
 	return true;
 }
 
-void ForwardMeshPass::uploadLights(const FrameLightData& lights){
-	auto copy = [](void* dst, const void* src, size_t count, size_t stride, size_t maxCount){
-		UINT n = static_cast<UINT>(std::min(count, maxCount));
-		if (n > 0) memcpy(dst, src, n * stride);
-		};
-	copy(m_dirLightMapped, lights.dirLights.data(), lights.dirLights.size(), sizeof(MeshPipeline::GPUDirectionalLight), MeshPipeline::MAX_DIR_LIGHTS);
-	copy(m_pointLightMapped, lights.pointLights.data(), lights.pointLights.size(), sizeof(MeshPipeline::GPUPointLight), MeshPipeline::MAX_POINT_LIGHTS);
-	copy(m_spotLightMapped, lights.spotLights.data(), lights.spotLights.size(), sizeof(MeshPipeline::GPUSpotLight), MeshPipeline::MAX_SPOT_LIGHTS);
+void ForwardMeshPass::uploadLights(const FrameLightData& lights, const LightClusters& clusters){
+	m_dirLights.upload(lights.dirLights.data(), lights.dirLights.size());
+	m_pointLights.upload(lights.pointLights.data(), lights.pointLights.size());
+	m_spotLights.upload(lights.spotLights.data(), lights.spotLights.size());
+	m_clusterBuf.upload(clusters.getClusters().data(), clusters.getClusters().size());
+	m_clusterIndices.upload(clusters.getIndices().data(), clusters.getIndices().size());
 }
 
-void ForwardMeshPass::uploadPerFrameCB(const FrameLightData& lights, const Vector3& cameraPos,
+void ForwardMeshPass::uploadPerFrameCB(const FrameLightData& lights, const LightClusters& clusters,
+                                       const Vector3& cameraPos, const Matrix& view,
+                                       uint32_t width, uint32_t height,
                                        uint32_t envRoughLevels, const ShadowRenderData& shadow){
 	MeshPipeline::CbPerFrame cb = {};
-	cb.dirLightCount = static_cast<uint32_t>(std::min(lights.dirLights.size(), (size_t)MeshPipeline::MAX_DIR_LIGHTS));
-	cb.pointLightCount = static_cast<uint32_t>(std::min(lights.pointLights.size(), (size_t)MeshPipeline::MAX_POINT_LIGHTS));
-	cb.spotLightCount = static_cast<uint32_t>(std::min(lights.spotLights.size(), (size_t)MeshPipeline::MAX_SPOT_LIGHTS));
+	cb.dirLightCount = static_cast<uint32_t>(lights.dirLights.size());
+	cb.pointLightCount = static_cast<uint32_t>(lights.pointLights.size());
+	cb.spotLightCount = static_cast<uint32_t>(lights.spotLights.size());
 	cb.envRoughnessLevels = envRoughLevels;
 	cb.cameraPosition = cameraPos;
 	cb.framePad = 0;
@@ -260,6 +231,12 @@ void ForwardMeshPass::uploadPerFrameCB(const FrameLightData& lights, const Vecto
 	cb.dirShadowParams0 = Vector4(shadow.bias, shadow.normalBias, shadow.pcfRadius, texel);
 	cb.dirShadowParams1 = Vector4(shadowUsable ? 1.0f : 0.0f, 0.0f, float(cascadeCount), 0.0f);
 
+	cb.viewportWidth = width;
+	cb.viewportHeight = height;
+	cb.viewportPad[0] = cb.viewportPad[1] = 0;
+	cb.viewDepthRow = Vector4(-view._13, -view._23, -view._33, -view._43);
+	cb.clusterParams = Vector4(clusters.getSliceScale(), clusters.getSliceBias(), 0.0f, 0.0f);
+
 	memcpy(m_perFrameMapped, &cb, sizeof(cb));
 }
 
@@ -297,35 +274,38 @@ void ForwardMeshPass::writePerDrawCBs(const MeshEntry& entry, const Matrix& view
 }
 
 void ForwardMeshPass::render(ID3D12GraphicsCommandList* cmd, const std::vector<MeshEntry*>& meshes,
-                             const FrameLightData& lights, const Vector3& cameraPos,
-                             const Matrix& viewProj, const EnvironmentSystem* env,
+                             const FrameLightData& lights, const LightClusters& clusters,
+                             const Vector3& cameraPos, const Matrix& view, const Matrix& viewProj,
+                             uint32_t width, uint32_t height, const EnvironmentSystem* env,
                              const ShadowRenderData& shadow, int samplerType){
-	renderWithPSO(cmd, m_pipeline.getPSO(), meshes, lights, cameraPos, viewProj, env, shadow,
-	              samplerType, 0, MAX_OPAQUE);
+	renderWithPSO(cmd, m_pipeline.getPSO(), meshes, lights, clusters, cameraPos, view, viewProj,
+	              width, height, env, shadow, samplerType, 0, MAX_OPAQUE);
 }
 
 void ForwardMeshPass::renderTransparent(ID3D12GraphicsCommandList* cmd, const std::vector<MeshEntry*>& meshes,
-                                        const FrameLightData& lights, const Vector3& cameraPos,
-                                        const Matrix& viewProj, const EnvironmentSystem* env,
+                                        const FrameLightData& lights, const LightClusters& clusters,
+                                        const Vector3& cameraPos, const Matrix& view, const Matrix& viewProj,
+                                        uint32_t width, uint32_t height, const EnvironmentSystem* env,
                                         const ShadowRenderData& shadow, int samplerType){
-	renderWithPSO(cmd, m_pipeline.getTransparentPSO(), meshes, lights, cameraPos, viewProj, env, shadow,
-	              samplerType, MAX_OPAQUE, MAX_TRANSPARENT);
+	renderWithPSO(cmd, m_pipeline.getTransparentPSO(), meshes, lights, clusters, cameraPos, view, viewProj,
+	              width, height, env, shadow, samplerType, MAX_OPAQUE, MAX_TRANSPARENT);
 }
 
 void ForwardMeshPass::renderWithPSO(ID3D12GraphicsCommandList* cmd, ID3D12PipelineState* pso,
                                     const std::vector<MeshEntry*>& meshes,
-                                    const FrameLightData& lights, const Vector3& cameraPos,
-                                    const Matrix& viewProj, const EnvironmentSystem* env,
+                                    const FrameLightData& lights, const LightClusters& clusters,
+                                    const Vector3& cameraPos, const Matrix& view, const Matrix& viewProj,
+                                    uint32_t width, uint32_t height, const EnvironmentSystem* env,
                                     const ShadowRenderData& shadow,
                                     int samplerType, UINT slotBase, UINT maxSlots){
 	if (meshes.empty()) return;
 
-	uploadLights(lights);
+	uploadLights(lights, clusters);
 
 	uint32_t roughLevels = 0;
 	if (env && env->hasIBL()) roughLevels = EnvironmentMap::NUM_ROUGHNESS_LEVELS;
 
-	uploadPerFrameCB(lights, cameraPos, roughLevels, shadow);
+	uploadPerFrameCB(lights, clusters, cameraPos, view, width, height, roughLevels, shadow);
 
 	cmd->SetPipelineState(pso);
 	cmd->SetGraphicsRootSignature(m_pipeline.getRootSig());
@@ -336,9 +316,11 @@ void ForwardMeshPass::renderWithPSO(ID3D12GraphicsCommandList* cmd, ID3D12Pipeli
 
 	cmd->SetGraphicsRootConstantBufferView(MeshPipeline::SLOT_PERFRAME_CB, m_perFrameCB->GetGPUVirtualAddress());
 
-	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_DIR_LIGHTS, m_dirLightSRV.getGPUHandle(0));
-	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_POINT_LIGHTS, m_pointLightSRV.getGPUHandle(0));
-	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_SPOT_LIGHTS, m_spotLightSRV.getGPUHandle(0));
+	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_DIR_LIGHTS, m_dirLights.getSRV());
+	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_POINT_LIGHTS, m_pointLights.getSRV());
+	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_SPOT_LIGHTS, m_spotLights.getSRV());
+	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_CLUSTERS, m_clusterBuf.getSRV());
+	cmd->SetGraphicsRootDescriptorTable(MeshPipeline::SLOT_CLUSTER_INDICES, m_clusterIndices.getSRV());
 
 	if (env && env->hasIBL()){
 		m_pipeline.bindIBL(cmd, env);
@@ -4,6 +4,8 @@
 #include "MeshEntry.h"
 #include "ShaderTableDesc.h"
 #include "ShadowMapPass.h"
+#include "StructuredUploadBuffer.h"
+#include "LightClusters.h"
 #include <vector>
 #include <d3d12.h>
 #include <wrl.h>
@@ -25,14 +27,19 @@ public:
 
 	bool init(ID3D12Device* device, bool useMSAA = false);
 
+	// Point and spot lights are read through `clusters`, which must have
+	// been built from the same `lights` for a width x height view with
+	// this view matrix.
 	void render(ID3D12GraphicsCommandList* cmd, const std::vector<MeshEntry*>& meshes,
-	            const FrameLightData& lights, const Vector3& cameraPos,
-	            const Matrix& viewProj, const EnvironmentSystem* env,
+	            const FrameLightData& lights, const LightClusters& clusters,
+	            const Vector3& cameraPos, const Matrix& view, const Matrix& viewProj,
+	            uint32_t width, uint32_t height, const EnvironmentSystem* env,
 	            const ShadowRenderData& shadow = ShadowRenderData{}, int samplerType = 0);
 
 	void renderTransparent(ID3D12GraphicsCommandList* cmd, const std::vector<MeshEntry*>& meshes,
-	                       const FrameLightData& lights, const Vector3& cameraPos,
-	                       const Matrix& viewProj, const EnvironmentSystem* env,
+	                       const FrameLightData& lights, const LightClusters& clusters,
+	                       const Vector3& cameraPos, const Matrix& view, const Matrix& viewProj,
+	                       uint32_t width, uint32_t height, const EnvironmentSystem* env,
 	                       const ShadowRenderData& shadow = ShadowRenderData{}, int samplerType = 0);
 
 	MeshPipeline& getPipeline(){
@@ -41,19 +48,21 @@ public:
 
 private:
 	bool createUploadBuffers(ID3D12Device* device);
-	bool createLightSRVs();
 	bool createFallbackTextures(ID3D12Device* device);
 	bool createMatTableRing();
 
-	void uploadLights(const FrameLightData& lights);
-	void uploadPerFrameCB(const FrameLightData& lights, const Vector3& cameraPos,
+	void uploadLights(const FrameLightData& lights, const LightClusters& clusters);
+	void uploadPerFrameCB(const FrameLightData& lights, const LightClusters& clusters,
+	                      const Vector3& cameraPos, const Matrix& view,
+	                      uint32_t width, uint32_t height,
 	                      uint32_t envRoughLevels, const ShadowRenderData& shadow);
 	void writePerDrawCBs(const MeshEntry& entry, const Matrix& viewProj, UINT slot, D3D12_GPU_VIRTUAL_ADDRESS& outMvpVA, D3D12_GPU_VIRTUAL_ADDRESS& outInstVA);
 
 	void renderWithPSO(ID3D12GraphicsCommandList* cmd, ID3D12PipelineState* pso,
 	                   const std::vector<MeshEntry*>& meshes,
-	                   const FrameLightData& lights, const Vector3& cameraPos,
-	                   const Matrix& viewProj, const EnvironmentSystem* env,
+	                   const FrameLightData& lights, const LightClusters& clusters,
+	                   const Vector3& cameraPos, const Matrix& view, const Matrix& viewProj,
+	                   uint32_t width, uint32_t height, const EnvironmentSystem* env,
 	                   const ShadowRenderData& shadow,
 	                   int samplerType, UINT slotBase, UINT maxSlots);
 
@@ -72,16 +81,11 @@ private:
 	ComPtr<ID3D12Resource> m_perInstanceRing;
 	void* m_perInstanceMapped = nullptr;
 
-	ComPtr<ID3D12Resource> m_dirLightBuf;
-	ComPtr<ID3D12Resource> m_pointLightBuf;
-	ComPtr<ID3D12Resource> m_spotLightBuf;
-	void* m_dirLightMapped = nullptr;
-	void* m_pointLightMapped = nullptr;
-	void* m_spotLightMapped = nullptr;
-
-	ShaderTableDesc m_dirLightSRV;
-	ShaderTableDesc m_pointLightSRV;
-	ShaderTableDesc m_spotLightSRV;
+	StructuredUploadBuffer m_dirLights;
+	StructuredUploadBuffer m_pointLights;
+	StructuredUploadBuffer m_spotLights;
+	StructuredUploadBuffer m_clusterBuf;
+	StructuredUploadBuffer m_clusterIndices;
 
 	ComPtr<ID3D12Resource> m_fallbackTex2D;
 
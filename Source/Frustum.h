@@ -105,6 +105,11 @@ struct Frustum {
         return testVertsAgainstPlanes(verts);
     }
 
+    bool intersectsSphere(const Vector3& center, float radius) const{
+        for (const FrustumPlane& plane : planes) if (plane.signedDist(center) < -radius) return false;
+        return true;
+    }
+
     bool containsPoint(const Vector3& p) const{
         for (const FrustumPlane& plane : planes) if (plane.signedDist(p) < 0.0f) return false;
         return true;
@@ -0,0 +1,220 @@
+#include "Globals.h"
+#include "FrustumCulling.h"
+#include "SimdOps.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace FrustumCulling {
+
+namespace {
+
+constexpr int kMaxLanes = 8;
+
+// Per coefficient, an 8-entry table: the 6 planes, then two planes that
+// nothing is behind, which lanes without a remembered plane index.
+enum Coeff { kNx, kNy, kNz, kAx, kAy, kAz, kD, kCoeffCount };
+constexpr int kTableSize = 8;
+constexpr int kNeverPlane = Frustum::COUNT;
+
+struct PlaneCoeffs {
+    alignas(32) float t[kCoeffCount][kTableSize];
+};
+
+PlaneCoeffs coeffsOf(const Frustum& frustum){
+    PlaneCoeffs c = {};
+    for (int p = 0; p < Frustum::COUNT; ++p){
+        const FrustumPlane& pl = frustum.planes[p];
+        c.t[kNx][p] = pl.normal.x; c.t[kNy][p] = pl.normal.y; c.t[kNz][p] = pl.normal.z;
+        c.t[kAx][p] = fabsf(pl.normal.x); c.t[kAy][p] = fabsf(pl.normal.y); c.t[kAz][p] = fabsf(pl.normal.z);
+        c.t[kD][p] = pl.d;
+    }
+    for (int p = Frustum::COUNT; p < kTableSize; ++p) c.t[kD][p] = -1.f;
+    return c;
+}
+
+// Same operation order as the SIMD kernel so every path agrees bit for bit.
+inline bool outside(const PlaneCoeffs& c, int p, float cx, float cy, float cz, float ex, float ey, float ez){
+    const float s = c.t[kNx][p] * cx + c.t[kNy][p] * cy + c.t[kNz][p] * cz +
+                    c.t[kAx][p] * ex + c.t[kAy][p] * ey + c.t[kAz][p] * ez;
+    return s < c.t[kD][p];
+}
+
+bool testScalar(const PlaneCoeffs& c, float cx, float cy, float cz, float ex, float ey, float ez, uint8_t* lastPlane){
+    const int first = lastPlane ? *lastPlane : kNoPlane;
+    if (first < Frustum::COUNT && outside(c, first, cx, cy, cz, ex, ey, ez)) return false;
+    for (int p = 0; p < Frustum::COUNT; ++p){
+        if (p == first || !outside(c, p, cx, cy, cz, ex, ey, ez)) continue;
+        if (lastPlane) *lastPlane = static_cast<uint8_t>(p);
+        return false;
+    }
+    return true;
+}
+
+// Looks up each lane's remembered plane: `out[k]` gets coefficient k and
+// `plane` the index. AVX2 permutes straight from the tables; SSE has no
+// variable permute for 8 entries and assembles the lanes one by one.
+template<class Ops>
+struct PlaneGather;
+
+template<>
+struct PlaneGather<SseOps> {
+    static void run(const PlaneCoeffs& c, const uint8_t* last, uint32_t n, __m128 out[kCoeffCount], __m128& plane){
+        int p[4] = { kNeverPlane, kNeverPlane, kNeverPlane, kNeverPlane };
+        for (uint32_t l = 0; l < n; ++l) p[l] = std::min<int>(last[l], kNeverPlane);
+        for (int k = 0; k < kCoeffCount; ++k)
+            out[k] = _mm_setr_ps(c.t[k][p[0]], c.t[k][p[1]], c.t[k][p[2]], c.t[k][p[3]]);
+        plane = _mm_cvtepi32_ps(_mm_setr_epi32(p[0], p[1], p[2], p[3]));
+    }
+};
+
+template<>
+struct PlaneGather<AvxOps> {
+    static void run(const PlaneCoeffs& c, const uint8_t* last, uint32_t n, __m256 out[kCoeffCount], __m256& plane){
+        uint8_t bytes[8];
+        memset(bytes, kNeverPlane, sizeof(bytes));
+        memcpy(bytes, last, n);
+        __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes)));
+        idx = _mm256_min_epu32(idx, _mm256_set1_epi32(kNeverPlane));
+        for (int k = 0; k < kCoeffCount; ++k) out[k] = _mm256_permutevar8x32_ps(_mm256_load_ps(c.t[k]), idx);
+        plane = _mm256_cvtepi32_ps(idx);
+    }
+};
+
+// One batch of up to Ops::kWidth boxes; returns their visible bits. The
+// remembered planes are gathered per lane and tested first; the shared
+// planes then only run while some lane is still undecided.
+template<class Ops>
+uint32_t cullKernel(const PlaneCoeffs& c, const Boxes& b, uint32_t base, uint32_t n){
+    using V = typename Ops::V;
+    constexpr int W = Ops::kWidth;
+    const int valid = (1 << n) - 1;
+
+    V cx, cy, cz, ex, ey, ez;
+    if (n == W){
+        cx = Ops::loadu(b.cx + base); cy = Ops::loadu(b.cy + base); cz = Ops::loadu(b.cz + base);
+        ex = Ops::loadu(b.ex + base); ey = Ops::loadu(b.ey + base); ez = Ops::loadu(b.ez + base);
+    } else {
+        alignas(32) float pad[6][kMaxLanes] = {};
+        const float* src[6] = { b.cx, b.cy, b.cz, b.ex, b.ey, b.ez };
+        for (int f = 0; f < 6; ++f) memcpy(pad[f], src[f] + base, n * sizeof(float));
+        cx = Ops::load(pad[0]); cy = Ops::load(pad[1]); cz = Ops::load(pad[2]);
+        ex = Ops::load(pad[3]); ey = Ops::load(pad[4]); ez = Ops::load(pad[5]);
+    }
+
+    auto test = [&](V nx, V ny, V nz, V ax, V ay, V az, V d){
+        V s = Ops::mul(nx, cx);
+        s = Ops::add(s, Ops::mul(ny, cy));
+        s = Ops::add(s, Ops::mul(nz, cz));
+        s = Ops::add(s, Ops::mul(ax, ex));
+        s = Ops::add(s, Ops::mul(ay, ey));
+        s = Ops::add(s, Ops::mul(az, ez));
+        return Ops::lt(s, d);
+    };
+
+    V out;
+    V plane;
+    if (b.lastPlane){
+        V g[kCoeffCount];
+        PlaneGather<Ops>::run(c, b.lastPlane + base, n, g, plane);
+        out = test(g[kNx], g[kNy], g[kNz], g[kAx], g[kAy], g[kAz], g[kD]);
+        if ((Ops::mask(out) & valid) == valid) return 0;
+    } else {
+        out = Ops::lt(Ops::set1(1.f), Ops::set1(0.f));
+        plane = Ops::set1(static_cast<float>(kNeverPlane));
+    }
+
+    for (int p = 0; p < Frustum::COUNT; ++p){
+        const V o = test(Ops::set1(c.t[kNx][p]), Ops::set1(c.t[kNy][p]), Ops::set1(c.t[kNz][p]),
+                         Ops::set1(c.t[kAx][p]), Ops::set1(c.t[kAy][p]), Ops::set1(c.t[kAz][p]), Ops::set1(c.t[kD][p]));
+        plane = Ops::select(plane, Ops::set1(static_cast<float>(p)), Ops::andnot(out, o));
+        out = Ops::or_(out, o);
+        if ((Ops::mask(out) & valid) == valid) break;
+    }
+
+    const int outBits = Ops::mask(out) & valid;
+    if (b.lastPlane && outBits){
+        alignas(32) float planes[kMaxLanes];
+        Ops::store(planes, plane);
+        for (uint32_t l = 0; l < n; ++l)
+            if (outBits & (1 << l)) b.lastPlane[base + l] = static_cast<uint8_t>(planes[l]);
+    }
+    return static_cast<uint32_t>(~outBits & valid);
+}
+
+template<class Ops>
+void cullAll(const PlaneCoeffs& c, const Boxes& b, uint32_t* outVisible){
+    for (uint32_t base = 0; base < b.count; base += Ops::kWidth){
+        const uint32_t n = std::min<uint32_t>(Ops::kWidth, b.count - base);
+        outVisible[base >> 5] |= cullKernel<Ops>(c, b, base, n) << (base & 31);
+    }
+    Ops::end();
+}
+
+}
+
+Path BestPath(){
+    static const Path best = CpuHasAVX2() ? Path::AVX2 : Path::SSE;
+    return best;
+}
+
+const char* PathName(Path path){
+    switch (path){
+        case Path::AVX2: return "AVX2 x8";
+        case Path::SSE: return "SSE x4";
+        default: return "Scalar";
+    }
+}
+
+void Cull(const Frustum& frustum, const Boxes& boxes, uint32_t* outVisible, Path path){
+    std::fill(outVisible, outVisible + MaskWords(boxes.count), 0u);
+    const PlaneCoeffs c = coeffsOf(frustum);
+    if (path == Path::AVX2 && BestPath() != Path::AVX2) path = Path::SSE;
+
+    switch (path){
+        case Path::AVX2: cullAll<AvxOps>(c, boxes, outVisible); break;
+        case Path::SSE: cullAll<SseOps>(c, boxes, outVisible); break;
+        default:
+            for (uint32_t i = 0; i < boxes.count; ++i){
+                if (testScalar(c, boxes.cx[i], boxes.cy[i], boxes.cz[i], boxes.ex[i], boxes.ey[i], boxes.ez[i],
+                               boxes.lastPlane ? boxes.lastPlane + i : nullptr))
+                    outVisible[i >> 5] |= 1u << (i & 31);
+            }
+            break;
+    }
+}
+
+bool TestBox(const Frustum& frustum, const Vector3& center, const Vector3& extent, uint8_t& lastPlane){
+    const PlaneCoeffs c = coeffsOf(frustum);
+    return testScalar(c, center.x, center.y, center.z, extent.x, extent.y, extent.z, &lastPlane);
+}
+
+void BoxSet::clear(){
+    cx.clear(); cy.clear(); cz.clear();
+    ex.clear(); ey.clear(); ez.clear();
+}
+
+void BoxSet::reserve(size_t n){
+    cx.reserve(n); cy.reserve(n); cz.reserve(n);
+    ex.reserve(n); ey.reserve(n); ez.reserve(n);
+}
+
+void BoxSet::push(const Vector3& mn, const Vector3& mx){
+    pushCenterExtent((mn + mx) * 0.5f, (mx - mn) * 0.5f);
+}
+
+void BoxSet::pushCenterExtent(const Vector3& center, const Vector3& extent){
+    cx.push_back(center.x); cy.push_back(center.y); cz.push_back(center.z);
+    ex.push_back(extent.x); ey.push_back(extent.y); ez.push_back(extent.z);
+}
+
+Boxes BoxSet::view(uint8_t* lastPlane) const{
+    Boxes b;
+    b.cx = cx.data(); b.cy = cy.data(); b.cz = cz.data();
+    b.ex = ex.data(); b.ey = ey.data(); b.ez = ez.data();
+    b.lastPlane = lastPlane;
+    b.count = size();
+    return b;
+}
+
+}
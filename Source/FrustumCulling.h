@@ -0,0 +1,53 @@
+#pragma once
+#include "Frustum.h"
+#include <vector>
+#include <cstdint>
+
+// Batched frustum culling over boxes stored as centers and half extents.
+// A box is outside a plane when its most positive corner (the p-vertex) is
+// behind it: n.c + |n|.e < d, the same verdict as testing all 8 corners.
+// Each box keeps the plane that rejected it last; that plane is tried first,
+// since an object that was culled last frame usually is again.
+namespace FrustumCulling {
+
+    enum class Path { Scalar, SSE, AVX2 };
+
+    Path BestPath();
+    const char* PathName(Path path);
+
+    constexpr uint8_t kNoPlane = 0xFF;
+
+    // `lastPlane` may be null; otherwise it is read and updated per box.
+    struct Boxes {
+        const float* cx = nullptr;
+        const float* cy = nullptr;
+        const float* cz = nullptr;
+        const float* ex = nullptr;
+        const float* ey = nullptr;
+        const float* ez = nullptr;
+        uint8_t* lastPlane = nullptr;
+        uint32_t count = 0;
+    };
+
+    inline uint32_t MaskWords(uint32_t count){ return (count + 31) / 32; }
+    inline bool IsVisible(const uint32_t* bits, uint32_t i){ return (bits[i >> 5] >> (i & 31)) & 1u; }
+
+    // Writes MaskWords(count) words; bit i is set when box i touches the
+    // frustum.
+    void Cull(const Frustum& frustum, const Boxes& boxes, uint32_t* outVisible, Path path = BestPath());
+
+    bool TestBox(const Frustum& frustum, const Vector3& center, const Vector3& extent, uint8_t& lastPlane);
+
+    // Owning SoA storage for callers that collect boxes from AABBs.
+    struct BoxSet {
+        std::vector<float> cx, cy, cz, ex, ey, ez;
+
+        void clear();
+        void reserve(size_t n);
+        void push(const Vector3& mn, const Vector3& mx);
+        void pushCenterExtent(const Vector3& center, const Vector3& extent);
+        uint32_t size() const { return static_cast<uint32_t>(cx.size()); }
+        Boxes view(uint8_t* lastPlane) const;
+    };
+
+}
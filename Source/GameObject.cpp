@@ -15,6 +15,7 @@
 #include "ComponentParticleSystem.h"
 #include "ComponentTrail.h"
 #include "PrefabManager.h"
+#include "CollisionBodyRegistry.h"
 #include <algorithm>
 #include <random>
 
@@ -22,7 +23,16 @@ GameObject::GameObject(const std::string& name) : uid(generateUID()), name(name)
     transform = createComponent<ComponentTransform>();
 }
 
-GameObject::~GameObject() = default;
+namespace {
+    uint32_t& hierarchyEpoch(){
+        static uint32_t epoch = 1;
+        return epoch;
+    }
+}
+
+GameObject::~GameObject(){ ++hierarchyEpoch(); }
+
+uint32_t GameObject::getHierarchyEpoch(){ return hierarchyEpoch(); }
 
 uint32_t GameObject::generateUID(){
     static std::mt19937 gen(std::random_device{}());
@@ -38,9 +48,27 @@ void GameObject::setParent(GameObject* newParent){
     }
     parent = newParent;
     if (parent) parent->children.push_back(this);
+    ++hierarchyEpoch();
     transform->markDirty();
 }
 
+void GameObject::clearChildren(){
+    children.clear();
+    ++hierarchyEpoch();
+}
+
+void GameObject::setName(const std::string& newName){
+    if (name == newName) return;
+    name = newName;
+    ++hierarchyEpoch();
+}
+
+void GameObject::setActive(bool value){
+    if (active == value) return;
+    active = value;
+    CollisionBodyRegistry::MarkSubtreeChanged(this);
+}
+
 void GameObject::update(float deltaTime){
     if (!active) return;
     for (auto& c : components) c->update(deltaTime);
@@ -0,0 +1,251 @@
+#include "Globals.h"
+#include "LightClusters.h"
+#include "WorkerPool.h"
+#include "SimdOps.h"
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr uint32_t kParallelLights = 256;
+constexpr uint32_t kLanePad = 8;
+
+}
+
+LightClusters::LightClusters() : m_path(bestPath()){
+    m_clusters.resize(kClusterCount);
+}
+
+LightClusters::~LightClusters() = default;
+
+LightClusters::Path LightClusters::bestPath(){
+    static const Path best = CpuHasAVX2() ? Path::AVX2 : Path::SSE;
+    return best;
+}
+
+const char* LightClusters::pathName(Path path){
+    switch (path){
+        case Path::AVX2: return "AVX2 x8";
+        case Path::SSE: return "SSE x4";
+        default: return "Scalar";
+    }
+}
+
+void LightClusters::setPath(Path path){
+    if (path == Path::AVX2 && bestPath() != Path::AVX2) path = Path::SSE;
+    m_path = path;
+}
+
+void LightClusters::setThreadCount(uint32_t threads){
+    if (threads <= 1) m_pool.reset();
+    else if (m_pool) m_pool->setThreadCount(threads);
+    else m_pool = std::make_unique<WorkerPool>(threads);
+}
+
+Vector3 LightClusters::toView(const Vector4& sphere) const{
+    const Vector3 p = Vector3::Transform(Vector3(sphere.x, sphere.y, sphere.z), m_view);
+    return Vector3(p.x, p.y, -p.z);
+}
+
+void LightClusters::clusterBounds(uint32_t x, uint32_t y, uint32_t z, Vector3& mn, Vector3& mx) const{
+    const float d0 = m_sliceDepth[z], d1 = m_sliceDepth[z + 1];
+    const float left = m_tileX[x], right = m_tileX[x + 1];
+    const float top = m_tileY[y], bottom = m_tileY[y + 1];
+    mn = Vector3(std::min(left * d0, left * d1), std::min(bottom * d0, bottom * d1), d0);
+    mx = Vector3(std::max(right * d0, right * d1), std::max(top * d0, top * d1), d1);
+}
+
+// Right-handed D3D projection: _33 = f / (n - f) and _43 = n * f / (n - f).
+// A tile edge at NDC x sits on the view-space slope x / depth = (x + _31) / _11.
+void LightClusters::build(const Vector4* spheres, uint32_t pointCount, uint32_t spotCount,
+                          const Matrix& view, const Matrix& proj){
+    const auto t0 = std::chrono::high_resolution_clock::now();
+    const uint32_t count = pointCount + spotCount;
+    m_view = view;
+    m_pointCount = pointCount;
+
+    m_near = proj._43 / proj._33;
+    m_far = fabsf(proj._33 + 1.f) > 1e-6f ? proj._43 / (proj._33 + 1.f) : m_near * 1e4f;
+    const float logRatio = logf(m_far / m_near);
+    m_sliceScale = kGridZ / logRatio;
+    m_sliceBias = -static_cast<float>(kGridZ) * logf(m_near) / logRatio;
+    for (uint32_t i = 0; i <= kGridX; ++i)
+        m_tileX[i] = (-1.f + 2.f * i / kGridX + proj._31) / proj._11;
+    for (uint32_t j = 0; j <= kGridY; ++j)
+        m_tileY[j] = (1.f - 2.f * j / kGridY + proj._32) / proj._22;
+    for (uint32_t k = 0; k <= kGridZ; ++k)
+        m_sliceDepth[k] = m_near * powf(m_far / m_near, static_cast<float>(k) / kGridZ);
+
+    // Each light goes to the slices its depth range covers, widened by one
+    // so rounding in the log never drops a slice; the box test decides.
+    auto sliceOf = [this](float d){
+        const float f = d > 0.f ? floorf(logf(d) * m_sliceScale + m_sliceBias) : 0.f;
+        return static_cast<int>(std::clamp(f, 0.f, static_cast<float>(kGridZ - 1)));
+    };
+    for (Slice& s : m_slices) s.lights.clear();
+    m_lx.resize(count); m_ly.resize(count); m_ld.resize(count); m_lr2.resize(count);
+    for (uint32_t l = 0; l < count; ++l){
+        const Vector3 c = toView(spheres[l]);
+        const float r = spheres[l].w;
+        m_lx[l] = c.x; m_ly[l] = c.y; m_ld[l] = c.z; m_lr2[l] = r * r;
+        const int k0 = std::max(sliceOf(c.z - r) - 1, 0);
+        const int k1 = std::min(sliceOf(c.z + r) + 1, static_cast<int>(kGridZ) - 1);
+        for (int k = k0; k <= k1; ++k) m_slices[k].lights.push_back(l);
+    }
+
+    if (m_pool && count >= kParallelLights) m_pool->parallelFor(kGridZ, [this](uint32_t z){ assignSlice(z); });
+    else for (uint32_t z = 0; z < kGridZ; ++z) assignSlice(z);
+
+    m_indices.clear();
+    m_maxPerCluster = 0;
+    for (uint32_t z = 0; z < kGridZ; ++z){
+        const uint32_t base = static_cast<uint32_t>(m_indices.size());
+        for (uint32_t c = clusterIndex(0, 0, z); c < clusterIndex(0, 0, z + 1); ++c){
+            m_clusters[c].offset += base;
+            m_maxPerCluster = std::max(m_maxPerCluster, m_clusters[c].pointCount + m_clusters[c].spotCount);
+        }
+        m_indices.insert(m_indices.end(), m_slices[z].indices.begin(), m_slices[z].indices.end());
+    }
+    m_buildMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+void LightClusters::Lanes::reserve(uint32_t n){
+    const size_t need = size_t(count) + n + kLanePad;
+    if (ids.size() >= need) return;
+    x.resize(need); y.resize(need); s.resize(need); r2.resize(need); ids.resize(need);
+}
+
+void LightClusters::Lanes::set(uint32_t i, float px, float py, float ps, float pr2, uint32_t id){
+    x[i] = px; y[i] = py; s[i] = ps; r2[i] = pr2; ids[i] = id;
+}
+
+void LightClusters::Lanes::pad(){
+    for (uint32_t i = count; i % kLanePad; ++i) set(i, 0.f, 0.f, 0.f, -1.f, 0);
+}
+
+void LightClusters::filterRowScalar(const Lanes& in, float mn, float mx, Lanes& out){
+    out.reserve(in.count);
+    for (uint32_t l = 0; l < in.count; ++l){
+        const float dy = std::max(std::max(mn - in.y[l], in.y[l] - mx), 0.f);
+        const float sum = dy * dy + in.s[l];
+        if (sum <= in.r2[l]) out.set(out.count++, in.x[l], in.y[l], sum, in.r2[l], in.ids[l]);
+    }
+}
+
+// Survivors are compacted without branching: every lane is written to the
+// next free slot and the slot only advances for lanes that passed.
+template<class Ops>
+void LightClusters::filterRow(const Lanes& in, float mn, float mx, Lanes& out){
+    using V = typename Ops::V;
+    const V vmn = Ops::set1(mn), vmx = Ops::set1(mx), zero = Ops::set1(0.f);
+    alignas(32) float sums[8];
+    out.reserve(in.count);
+    uint32_t n = out.count;
+    for (uint32_t base = 0; base < in.count; base += Ops::kWidth){
+        const V vy = Ops::loadu(in.y.data() + base);
+        const V dy = Ops::max_(Ops::max_(Ops::sub(vmn, vy), Ops::sub(vy, vmx)), zero);
+        const V sum = Ops::add(Ops::mul(dy, dy), Ops::loadu(in.s.data() + base));
+        const int bits = Ops::mask(Ops::le(sum, Ops::loadu(in.r2.data() + base)));
+        if (!bits) continue;
+        Ops::storeu(sums, sum);
+        for (int lane = 0; lane < Ops::kWidth; ++lane){
+            const uint32_t l = base + lane;
+            out.set(n, in.x[l], in.y[l], sums[lane], in.r2[l], in.ids[l]);
+            n += (bits >> lane) & 1;
+        }
+    }
+    out.count = n;
+}
+
+void LightClusters::testColumnScalar(const Lanes& in, float mn, float mx, std::vector<uint32_t>& out){
+    for (uint32_t l = 0; l < in.count; ++l){
+        const float dx = std::max(std::max(mn - in.x[l], in.x[l] - mx), 0.f);
+        if (in.s[l] + dx * dx <= in.r2[l]) out.push_back(in.ids[l]);
+    }
+}
+
+template<class Ops>
+void LightClusters::testColumn(const Lanes& in, float mn, float mx, std::vector<uint32_t>& out){
+    using V = typename Ops::V;
+    const V vmn = Ops::set1(mn), vmx = Ops::set1(mx), zero = Ops::set1(0.f);
+    size_t n = out.size();
+    out.resize(n + in.count + Ops::kWidth);
+    for (uint32_t base = 0; base < in.count; base += Ops::kWidth){
+        const V vx = Ops::loadu(in.x.data() + base);
+        const V dx = Ops::max_(Ops::max_(Ops::sub(vmn, vx), Ops::sub(vx, vmx)), zero);
+        const V t = Ops::add(Ops::loadu(in.s.data() + base), Ops::mul(dx, dx));
+        const int bits = Ops::mask(Ops::le(t, Ops::loadu(in.r2.data() + base)));
+        if (!bits) continue;
+        for (int lane = 0; lane < Ops::kWidth; ++lane){
+            out[n] = in.ids[base + lane];
+            n += (bits >> lane) & 1;
+        }
+    }
+    out.resize(n);
+}
+
+// The slice keeps the lights that touch its whole box, with dz^2 stored;
+// each row adds dy^2 and keeps those still in reach; each column adds dx^2.
+// The sums are formed term for term as in touches(), and a cell's box lies
+// inside its row's and slice's, so no step drops a light the full test keeps.
+void LightClusters::assignSlice(uint32_t z){
+    Slice& s = m_slices[z];
+    s.indices.clear();
+    const float d0 = m_sliceDepth[z], d1 = m_sliceDepth[z + 1];
+    const float sxmn = std::min(m_tileX[0] * d0, m_tileX[0] * d1);
+    const float sxmx = std::max(m_tileX[kGridX] * d0, m_tileX[kGridX] * d1);
+    const float symn = std::min(m_tileY[kGridY] * d0, m_tileY[kGridY] * d1);
+    const float symx = std::max(m_tileY[0] * d0, m_tileY[0] * d1);
+
+    s.inSlice.count = 0;
+    s.inSlice.reserve(static_cast<uint32_t>(s.lights.size()));
+    for (uint32_t l : s.lights){
+        const float dx = std::max(std::max(sxmn - m_lx[l], m_lx[l] - sxmx), 0.f);
+        const float dy = std::max(std::max(symn - m_ly[l], m_ly[l] - symx), 0.f);
+        const float dz = std::max(std::max(d0 - m_ld[l], m_ld[l] - d1), 0.f);
+        if (dy * dy + dz * dz + dx * dx <= m_lr2[l]) s.inSlice.set(s.inSlice.count++, m_lx[l], m_ly[l], dz * dz, m_lr2[l], l);
+    }
+    s.inSlice.pad();
+
+    for (uint32_t y = 0; y < kGridY; ++y){
+        const float top = m_tileY[y], bottom = m_tileY[y + 1];
+        const float ymn = std::min(bottom * d0, bottom * d1);
+        const float ymx = std::max(top * d0, top * d1);
+
+        s.inRow.count = 0;
+        switch (m_path){
+            case Path::AVX2: filterRow<AvxOps>(s.inSlice, ymn, ymx, s.inRow); break;
+            case Path::SSE: filterRow<SseOps>(s.inSlice, ymn, ymx, s.inRow); break;
+            default: filterRowScalar(s.inSlice, ymn, ymx, s.inRow); break;
+        }
+        s.inRow.pad();
+
+        for (uint32_t x = 0; x < kGridX; ++x){
+            const float left = m_tileX[x], right = m_tileX[x + 1];
+            const float xmn = std::min(left * d0, left * d1);
+            const float xmx = std::max(right * d0, right * d1);
+
+            const uint32_t first = static_cast<uint32_t>(s.indices.size());
+            switch (m_path){
+                case Path::AVX2: testColumn<AvxOps>(s.inRow, xmn, xmx, s.indices); break;
+                case Path::SSE: testColumn<SseOps>(s.inRow, xmn, xmx, s.indices); break;
+                default: testColumnScalar(s.inRow, xmn, xmx, s.indices); break;
+            }
+
+            // Ids are ascending, so the point lights come first.
+            Cluster& c = m_clusters[clusterIndex(x, y, z)];
+            c.offset = first;
+            c.pointCount = c.spotCount = 0;
+            for (uint32_t i = first; i < static_cast<uint32_t>(s.indices.size()); ++i){
+                uint32_t& l = s.indices[i];
+                if (l < m_pointCount){
+                    ++c.pointCount;
+                } else {
+                    l -= m_pointCount;
+                    ++c.spotCount;
+                }
+            }
+        }
+    }
+    if (m_path == Path::AVX2) AvxOps::end();
+}
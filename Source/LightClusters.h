@@ -0,0 +1,126 @@
+#pragma once
+#include <SimpleMath.h>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+
+using namespace DirectX::SimpleMath;
+
+class WorkerPool;
+
+// Bins point and spot light spheres into a view-space froxel grid: 16x9
+// screen tiles by 24 depth slices spaced exponentially from near to far.
+// A light lands in every cluster whose view-space box its sphere touches.
+// Each cluster gets a run of the compact index list: its point lights
+// first, then its spot lights, both in ascending order.
+class LightClusters {
+public:
+    static constexpr uint32_t kGridX = 16;
+    static constexpr uint32_t kGridY = 9;
+    static constexpr uint32_t kGridZ = 24;
+    static constexpr uint32_t kClusterCount = kGridX * kGridY * kGridZ;
+
+    enum class Path { Scalar, SSE, AVX2 };
+
+    // Matches the shader's StructuredBuffer<uint4>.
+    struct Cluster {
+        uint32_t offset = 0;
+        uint32_t pointCount = 0;
+        uint32_t spotCount = 0;
+        uint32_t pad = 0;
+    };
+
+    LightClusters();
+    ~LightClusters();
+
+    static Path bestPath();
+    static const char* pathName(Path path);
+    void setPath(Path path);
+    Path getPath() const { return m_path; }
+
+    // Slices are assigned in parallel once there are enough lights.
+    void setThreadCount(uint32_t threads);
+
+    // `spheres` holds world-space centers and radii: pointCount point lights
+    // followed by spotCount spot lights. `proj` is a right-handed
+    // perspective projection.
+    void build(const Vector4* spheres, uint32_t pointCount, uint32_t spotCount,
+               const Matrix& view, const Matrix& proj);
+
+    static uint32_t clusterIndex(uint32_t x, uint32_t y, uint32_t z){ return (z * kGridY + y) * kGridX + x; }
+
+    // View-space box of a cluster, with depth measured along -Z as positive.
+    void clusterBounds(uint32_t x, uint32_t y, uint32_t z, Vector3& mn, Vector3& mx) const;
+
+    // The overlap test every path uses, in the same operation order.
+    static bool touches(const Vector3& mn, const Vector3& mx, const Vector3& center, float radiusSq){
+        const float dx = std::max(std::max(mn.x - center.x, center.x - mx.x), 0.f);
+        const float dy = std::max(std::max(mn.y - center.y, center.y - mx.y), 0.f);
+        const float dz = std::max(std::max(mn.z - center.z, center.z - mx.z), 0.f);
+        return dy * dy + dz * dz + dx * dx <= radiusSq;
+    }
+
+    // A light's sphere in the same view space as clusterBounds.
+    Vector3 toView(const Vector4& sphere) const;
+
+    const std::vector<Cluster>& getClusters() const { return m_clusters; }
+    const std::vector<uint32_t>& getIndices() const { return m_indices; }
+    float getNear() const { return m_near; }
+    float getFar() const { return m_far; }
+
+    // Depth slice of view depth d: floor(log(d) * scale + bias).
+    float getSliceScale() const { return m_sliceScale; }
+    float getSliceBias() const { return m_sliceBias; }
+
+    uint32_t getMaxPerCluster() const { return m_maxPerCluster; }
+    float getBuildMs() const { return m_buildMs; }
+
+private:
+    // Lights as SoA. The arrays only grow; `count` lanes are live and pad()
+    // fills the rest of the last vector with lanes that never pass. `s` is
+    // the part of the squared distance summed so far.
+    struct Lanes {
+        std::vector<float> x, y, s, r2;
+        std::vector<uint32_t> ids;
+        uint32_t count = 0;
+
+        // Room for n more lanes plus a whole vector of padding.
+        void reserve(uint32_t n);
+        void set(uint32_t i, float x, float y, float s, float r2, uint32_t id);
+        void pad();
+    };
+
+    // Per depth slice: the lights whose depth range reaches it, those that
+    // touch its box, those left for the current row, and its index run.
+    struct Slice {
+        std::vector<uint32_t> lights;
+        Lanes inSlice, inRow;
+        std::vector<uint32_t> indices;
+    };
+
+    void assignSlice(uint32_t z);
+    template<class Ops> static void filterRow(const Lanes& in, float mn, float mx, Lanes& out);
+    template<class Ops> static void testColumn(const Lanes& in, float mn, float mx, std::vector<uint32_t>& out);
+    static void filterRowScalar(const Lanes& in, float mn, float mx, Lanes& out);
+    static void testColumnScalar(const Lanes& in, float mn, float mx, std::vector<uint32_t>& out);
+
+    Path m_path = Path::SSE;
+    std::unique_ptr<WorkerPool> m_pool;
+
+    Matrix m_view;
+    float m_near = 0.1f, m_far = 100.f;
+    float m_sliceScale = 0.f, m_sliceBias = 0.f;
+    float m_tileX[kGridX + 1] = {};
+    float m_tileY[kGridY + 1] = {};
+    float m_sliceDepth[kGridZ + 1] = {};
+
+    uint32_t m_pointCount = 0;
+    std::vector<float> m_lx, m_ly, m_ld, m_lr2;
+
+    Slice m_slices[kGridZ];
+    std::vector<Cluster> m_clusters;
+    std::vector<uint32_t> m_indices;
+    uint32_t m_maxPerCluster = 0;
+    float m_buildMs = 0.f;
+};
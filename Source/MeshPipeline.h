@@ -12,10 +12,6 @@ class EnvironmentSystem;
 
 class MeshPipeline {
 public:
-	static constexpr UINT MAX_DIR_LIGHTS = 4;
-	static constexpr UINT MAX_POINT_LIGHTS = 32;
-	static constexpr UINT MAX_SPOT_LIGHTS = 16;
-
 	struct CbMVP {
 		Matrix mvp;
 	};
@@ -30,6 +26,11 @@ public:
 		Matrix dirLightViewProj[ShadowMath::kMaxCascades];
 		Vector4 dirShadowParams0;
 		Vector4 dirShadowParams1;
+		uint32_t viewportWidth;
+		uint32_t viewportHeight;
+		uint32_t viewportPad[2];
+		Vector4 viewDepthRow;
+		Vector4 clusterParams;
 	};
 
 	static constexpr uint32_t MAT_FLAG_BASECOLOR_TEX = 0x01;
@@ -94,6 +95,8 @@ public:
 	static constexpr UINT SLOT_MAT_TEXTURES = 9;
 	static constexpr UINT SLOT_SAMPLER = 10;
 	static constexpr UINT SLOT_SHADOW_MAP = 11;
+	static constexpr UINT SLOT_CLUSTERS = 12;
+	static constexpr UINT SLOT_CLUSTER_INDICES = 13;
 
 	bool init(ID3D12Device* device, bool useMSAA = false);
 	void bindIBL(ID3D12GraphicsCommandList* cmd, const EnvironmentSystem* env) const;
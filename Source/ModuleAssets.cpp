@@ -125,7 +125,19 @@ static bool materialCacheNeedsUpgrade(const std::string& sceneName){
 static bool animCacheNeedsUpgrade(const std::string& sceneName){
     SceneImporter::SceneHeader header;
     if (!SceneImporter::LoadSceneMetadata(sceneName, header)) return false;
-    return header.version < 3;
+    if (header.version < 3) return true;
+
+    ModuleFileSystem* fsys = app->getFileSystem();
+    std::string firstAnim = fsys->GetLibraryPath() + "Animations/" + sceneName + "/0.anim";
+    if (!fsys->Exists(firstAnim.c_str())) return false;
+    char* buf = nullptr;
+    uint32_t size = fsys->Load(firstAnim.c_str(), &buf);
+    if (!buf || size < 8){ delete[] buf; return true; }
+    uint32_t magic, version;
+    memcpy(&magic, buf, 4);
+    memcpy(&version, buf + 4, 4);
+    delete[] buf;
+    return magic != 0x414E494D || version < 4;
 }
 
 void ModuleAssets::refreshAssets(){
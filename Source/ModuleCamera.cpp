@@ -6,6 +6,7 @@
 #include "Mouse.h"
 #include "Keyboard.h"
 #include "GamePad.h"
+#include "ImGuiPass.h"
 #include <imgui.h>
 #include <algorithm>
 
@@ -140,7 +141,11 @@ void ModuleCamera::onEditorDebugPanel(){
     ImGui::SameLine();
     if (ImGui::RadioButton("Octree##ca", &ca, 1)) cullAlgorithm = CullAlgorithm::Octree;
     if (cullAlgorithm == CullAlgorithm::Octree)
-        ImGui::Text("Octree Nodes: %d  |  Leaves: %d", octreeNodeCount, octreeLeafCount);
+        ImGui::Text("Octree Nodes: %d  |  Leaves: %d  |  Moved: %d", octreeNodeCount, octreeLeafCount, octreeMovedCount);
+    drawOctreeSection();
+
+    drawOcclusionSection();
+    drawLightClusterSection();
 
     ImGui::Separator();
     ImGui::Text("Force LOD"); ImGui::SameLine();
@@ -172,6 +177,132 @@ void ModuleCamera::onEditorDebugPanel(){
     ImGui::Text("Forward:  %.2f  %.2f  %.2f", fwd.x, fwd.y, fwd.z);
 }
 
+void ModuleCamera::drawOctreeSection(){
+    if (ImGui::Button("Run octree benchmark  (50k boxes, 200 movers)"))
+        m_octreeBench = CullingBenchmark::RunRenderOctree();
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Updates and queries the render octree in place and rebuilt every\n"
+                          "frame, and checks each frame's visible set against brute force.");
+
+    if (m_octreeBench.empty()) return;
+
+    if (ImGui::BeginTable("##octreebench", 6,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("MODE", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("UPDATE MS", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("QUERY MS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("VISIBLE", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("MOVED", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("DIFF", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_octreeBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.mode);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", row.updateMs);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.3f", row.queryMs);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%u", row.visible);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.1f", row.moved);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::TextColored(row.mismatches == 0 ? ImVec4(0.4f, 1.f, 0.4f, 1.f) : ImVec4(1.f, 0.3f, 0.3f, 1.f),
+                               "%u", row.mismatches);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+    ImGui::Text("%u boxes over %u frames", m_octreeBench[0].objects, m_octreeBench[0].frames);
+}
+
+void ModuleCamera::drawOcclusionSection(){
+    ImGui::Separator();
+    ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+    if (occlusionCulling)
+        ImGui::Text("Occluders: %d (%d tris)  |  Tested: %d  |  Occluded: %d  |  %.2f ms",
+                    occluderCount, occluderTriangleCount, occlusionTestedCount, occlusionCulledCount, occlusionRasterMs);
+
+    if (ImGui::Button("Run occlusion benchmark  (8x8 rooms, 2560 props)"))
+        m_occlusionBench = CullingBenchmark::RunOcclusion();
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Rasterizes the walls of a grid of rooms from 8 views on every\n"
+                          "path and counts the frustum-visible props they hide.");
+
+    if (m_occlusionBench.empty()) return;
+
+    if (ImGui::BeginTable("##occbench", 8,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("PATH", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("THR", ImGuiTableColumnFlags_WidthFixed, 32.f);
+        ImGui::TableSetupColumn("FRUSTUM", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("VISIBLE", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("TRIS", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("RASTER MS", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("TEST MS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("DIFF/FALSE", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_occlusionBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.path);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%u", row.threads);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%u", row.frustumVisible);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%u", row.occlusionVisible);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%u", row.occluderTris);
+            ImGui::TableSetColumnIndex(5); ImGui::Text("%.3f", row.rasterMs);
+            ImGui::TableSetColumnIndex(6); ImGui::Text("%.3f", row.testMs);
+            ImGui::TableSetColumnIndex(7);
+            ImGui::TextColored(row.mismatches == 0 ? ImVec4(0.4f, 1.f, 0.4f, 1.f) : ImVec4(1.f, 0.3f, 0.3f, 1.f),
+                               "%u / %u", row.mismatches, row.falseCulls);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+    ImGui::Text("Objects over %u views: %u", m_occlusionBench[0].views, m_occlusionBench[0].objects);
+}
+
+void ModuleCamera::drawLightClusterSection(){
+    ImGui::Separator();
+    ImGui::Text("Light Clusters: %d lights  |  %d refs  |  max %d per cluster  |  %.2f ms",
+                clusterLightCount, clusterReferenceCount, clusterMaxLights, clusterBuildMs);
+
+    if (ImGui::Button("Run light cluster benchmark  (256 - 16384 lights)"))
+        m_lightClusterBench = CullingBenchmark::RunLightClusters();
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Bins scattered point and spot lights into the 16x9x24 froxel grid\n"
+                          "on every path and checks each cluster against brute force.");
+
+    if (m_lightClusterBench.empty()) return;
+
+    if (ImGui::BeginTable("##clusterbench", 7,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("LIGHTS", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("PATH", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("THR", ImGuiTableColumnFlags_WidthFixed, 32.f);
+        ImGui::TableSetupColumn("BUILD MS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("BRUTE MS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("REFS/MAX", ImGuiTableColumnFlags_WidthFixed, 88.f);
+        ImGui::TableSetupColumn("DIFF", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_lightClusterBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::Text("%u", row.lights);
+            ImGui::TableSetColumnIndex(1); ImGui::TextUnformatted(row.path);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%u", row.threads);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.3f", row.buildMs);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.1f", row.bruteMs);
+            ImGui::TableSetColumnIndex(5); ImGui::Text("%u / %u", row.references, row.maxPerCluster);
+            ImGui::TableSetColumnIndex(6);
+            ImGui::TextColored(row.mismatches == 0 ? ImVec4(0.4f, 1.f, 0.4f, 1.f) : ImVec4(1.f, 0.3f, 0.3f, 1.f),
+                               "%u", row.mismatches);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
 void ModuleCamera::updateFlyMode(float, const Vector3& translateLocal, const Vector2& rotateDelta){
     params.polar += rotateDelta.x;
     params.azimuthal = std::clamp(params.azimuthal + rotateDelta.y, -XM_PIDIV2 + 0.01f, XM_PIDIV2 - 0.01f);
@@ -1,6 +1,8 @@
 #pragma once
 #include "Module.h"
 #include "Frustum.h"
+#include "CullingBenchmark.h"
+#include <vector>
 
 class FrustumDebugDraw;
 class GameObject;
@@ -71,6 +73,19 @@ public:
     CullAlgorithm cullAlgorithm = CullAlgorithm::Linear;
     int octreeNodeCount = 0;
     int octreeLeafCount = 0;
+    int octreeMovedCount = 0;
+
+    bool occlusionCulling = true;
+    int occluderCount = 0;
+    int occluderTriangleCount = 0;
+    int occlusionTestedCount = 0;
+    int occlusionCulledCount = 0;
+    float occlusionRasterMs = 0.f;
+
+    int clusterLightCount = 0;
+    int clusterReferenceCount = 0;
+    int clusterMaxLights = 0;
+    float clusterBuildMs = 0.f;
 
     ForceLOD forceLOD = ForceLOD::Auto;
 
@@ -117,8 +132,15 @@ private:
     int m_visibleCount = 0;
     int m_totalCount = 0;
 
+    std::vector<CullingBenchmark::OcclusionResult> m_occlusionBench;
+    std::vector<CullingBenchmark::LightClusterResult> m_lightClusterBench;
+    std::vector<CullingBenchmark::OctreeResult> m_octreeBench;
+
     void rebuildViewMatrix();
     void rebuildFrustum();
     void updateFlyMode(float dt, const Vector3& translate, const Vector2& rotateDelta);
     void updateOrbitMode(const Vector2& rotateDelta);
+    void drawOctreeSection();
+    void drawOcclusionSection();
+    void drawLightClusterSection();
 };
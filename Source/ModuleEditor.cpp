@@ -43,6 +43,8 @@
 #include "ComponentRigidbody.h"
 #include "CollisionSystem.h"
 #include "CollisionResponse.h"
+#include "SimulationIslands.h"
+#include "PhysicsStepper.h"
 #include "EnvironmentMap.h"
 #include "SceneViewPanel.h"
 #include "GameViewPanel.h"
@@ -99,6 +101,8 @@ bool ModuleEditor::init(){
     m_debugDraw = std::make_unique<DebugDrawPass>(device4.Get(), d3d12->getDrawCommandQueue(), false);
     m_collisionSystem = std::make_unique<CollisionSystem>();
     m_collisionResponse = std::make_unique<CollisionResponse>();
+    m_simulationIslands = std::make_unique<SimulationIslands>();
+    m_physicsStepper = std::make_unique<PhysicsStepper>();
     m_sceneManager = std::make_unique<SceneManager>();
     m_meshRenderPass = std::make_unique<ForwardMeshPass>();
     m_hotReload = std::make_unique<HotReloadManager>();
@@ -22,6 +22,7 @@
 #include "ParticlePass.h"
 #include "SkinningPass.h"
 #include "RenderOctree.h"
+#include "OcclusionCuller.h"
 #include "TonemapPass.h"
 #include "BloomPass.h"
 #include "PostProcessChain.h"
@@ -53,6 +54,8 @@ class ImGuiPass;
 class DebugDrawPass;
 class CollisionSystem;
 class CollisionResponse;
+class SimulationIslands;
+class PhysicsStepper;
 class RenderTexture;
 class EditorPanel;
 class SceneViewPanel;
@@ -64,6 +67,53 @@ class ComponentMesh;
 class SceneGraph;
 class FileDialog;
 class EngineDropTarget;
+class ComponentDecal;
+class ComponentBillboard;
+class ComponentParticleSystem;
+class ComponentTrail;
+class ComponentDirectionalLight;
+class ComponentSpotLight;
+class ComponentPointLight;
+struct MeshEntry;
+struct Frustum;
+
+// What the views draw this frame, collected by one walk of the active scene.
+// Each view culls these lists against its own frustum instead of walking the
+// tree again.
+struct SceneFrameData {
+    struct MeshNode { GameObject* node; ComponentMesh* mesh; Matrix world; };
+    struct DecalNode { ComponentDecal* decal; Matrix world; };
+    struct BillboardNode { ComponentBillboard* billboard; Vector3 center; };
+
+    FrameLightData lights;
+    ComponentDirectionalLight* dirCaster = nullptr;
+    ComponentSpotLight* spotCaster = nullptr;
+    Vector3 spotCasterPos;
+    ComponentPointLight* pointCaster = nullptr;
+    Vector3 pointCasterPos;
+
+    std::vector<MeshNode> meshes;
+    std::vector<DecalNode> decals;
+    std::vector<BillboardNode> billboards;
+    std::vector<ComponentParticleSystem*> particleSystems;
+    std::vector<ComponentTrail*> trails;
+    std::vector<ParticleDrawRequest> gpuParticles;
+
+    void clear(){
+        lights.dirLights.clear();
+        lights.pointLights.clear();
+        lights.spotLights.clear();
+        dirCaster = nullptr;
+        spotCaster = nullptr;
+        pointCaster = nullptr;
+        meshes.clear();
+        decals.clear();
+        billboards.clear();
+        particleSystems.clear();
+        trails.clear();
+        gpuParticles.clear();
+    }
+};
 
 class ModuleEditor : public Module {
 public:
@@ -82,6 +132,8 @@ public:
     DebugDrawPass* getDebugDraw() const { return m_debugDraw.get(); }
     CollisionSystem* getCollisionSystem() const { return m_collisionSystem.get(); }
     CollisionResponse* getCollisionResponse() const { return m_collisionResponse.get(); }
+    SimulationIslands* getSimulationIslands() const { return m_simulationIslands.get(); }
+    PhysicsStepper* getPhysicsStepper() const { return m_physicsStepper.get(); }
     EditorSelection& getSelection(){ return m_selection; }
     double getGpuFrameTimeMs() const { return m_gpuFrameTimeMs; }
     bool isGpuTimerReady() const { return m_gpuTimerReady; }
@@ -149,6 +201,8 @@ private:
     std::unique_ptr<DebugDrawPass> m_debugDraw;
     std::unique_ptr<CollisionSystem> m_collisionSystem;
     std::unique_ptr<CollisionResponse> m_collisionResponse;
+    std::unique_ptr<SimulationIslands> m_simulationIslands;
+    std::unique_ptr<PhysicsStepper> m_physicsStepper;
     std::unique_ptr<SceneManager> m_sceneManager;
     std::unique_ptr<ForwardMeshPass> m_meshRenderPass;
     std::unique_ptr<GBufferPass> m_gbufferPass;
@@ -200,9 +254,21 @@ private:
     }
 
     EditorSelection m_selection;
-    FrameLightData m_frameLights;
+    SceneFrameData m_frame;
 
+    // The octree mirrors the first mesh of every active game object and is
+    // patched from the body registry's change log; m_cullVisible holds the
+    // slots the last query showed.
     RenderOctree m_renderOctree;
+    SceneGraph* m_cullScene = nullptr;
+    uint64_t m_cullCursor = 0;
+    std::vector<uint32_t> m_cullSlots;
+    std::vector<uint32_t> m_cullVisible;
+    // Linear culling scratch, parallel to the meshes with an AABB.
+    FrustumCulling::BoxSet m_cullBoxes;
+    std::vector<uint32_t> m_cullBits;
+    std::vector<ComponentMesh*> m_cullMeshes;
+    OcclusionCuller m_occlusionCuller;
     int m_samplerType = 0;
     bool m_firstFrame = true;
 
@@ -229,25 +295,26 @@ private:
     bool m_pendingExitPrefab = false;
 
     ComPtr<ID3D12Resource> createUploadBuffer(ID3D12Device*, SIZE_T, const wchar_t*);
-    void gatherLights(GameObject* node, FrameLightData& out) const;
-    void gatherDecals(GameObject* node, std::vector<DecalInstance>& out,
-                      const Matrix& view, const Matrix& proj,
-                      uint32_t w, uint32_t h) const;
-    void gatherBillboards(GameObject* node, std::vector<BillboardInstance>& out,
-                          const Matrix& view, const Matrix& viewProj,
-                          const Vector3& camPos, const Vector3& camRight, const Vector3& camUp) const;
-    void gatherParticleSystems(GameObject* node, std::vector<BillboardInstance>& out,
-                               const Matrix& viewProj,
-                               const Vector3& camPos, const Vector3& camRight, const Vector3& camUp) const;
-    void gatherTrails(GameObject* node, std::vector<TrailInstance>& out,
-                      const Matrix& viewProj, const Vector3& camPos) const;
-    void gatherGPUParticles(GameObject* node, std::vector<ParticleDrawRequest>& out,
-                            const Vector3& camPos, const Vector3& camRight, const Vector3& camUp,
-                            float elapsedTime) const;
+    void gatherFrame();
+    void gatherNode(GameObject* node, bool active, float elapsedTime);
+    void syncRenderOctree(SceneGraph* scene);
+    void buildDecals(const Frustum& frustum, const Matrix& viewProj,
+                     std::vector<DecalInstance>& out) const;
+    void buildBillboards(const Frustum& frustum, const Matrix& viewProj,
+                         const Vector3& camPos, const Vector3& camRight, const Vector3& camUp,
+                         std::vector<BillboardInstance>& out) const;
+    void buildParticleBillboards(const Frustum& frustum, const Matrix& viewProj,
+                                 const Vector3& camRight, const Vector3& camUp,
+                                 std::vector<BillboardInstance>& out) const;
+    void buildTrails(const Frustum& frustum, const Vector3& camPos,
+                     std::vector<TrailInstance>& out) const;
+    void buildGPUParticles(ComponentParticleSystem* ps, float elapsedTime, ParticleDrawRequest& req) const;
+    void cullOccluded(const Matrix& viewProj, std::vector<MeshEntry*>& opaque,
+                      std::vector<MeshEntry*>& translucent);
     void debugDrawLights(SceneGraph* scene, float lightSize);
     void updateMemory();
     void updateEffectsInEditMode(float dt);
-    void handleNewScenePopup(ID3D12GraphicsCommandList* cmd);
+    void handleNewScenePopup();
     void drawDockspace();
     void drawMenuBar();
     void drawStatusBar();
@@ -1,54 +1,308 @@
 #include "Globals.h"
 #include "NarrowPhase.h"
+#include "WorkerPool.h"
+#include "CapsuleCollision.h"
+#include "SimdOps.h"
 #include <cmath>
 #include <cfloat>
 #include <algorithm>
 
-static bool obbVsOBB(const CollisionBody& ba, const CollisionBody& bb,
-                     ContactPoint& contact){
-    const Vector3 T = bb.obbCenter - ba.obbCenter;
-    const Vector3* uA = ba.obbAxes;
-    const float* eA = ba.obbHalves;
-    const Vector3* uB = bb.obbAxes;
-    const float* eB = bb.obbHalves;
-
-    auto project = [](const Vector3* axes, const float* halves, const Vector3& L) -> float {
-        return halves[0] * fabsf(axes[0].Dot(L))
-             + halves[1] * fabsf(axes[1].Dot(L))
-             + halves[2] * fabsf(axes[2].Dot(L));
-    };
+static inline float dot3(const Vector3& a, const Vector3& b){
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
 
-    float minPen = FLT_MAX;
-    Vector3 bestNrm;
-
-    auto testAxis = [&](Vector3 L) -> bool {
-        float len = L.Length();
-        if (len < 1e-6f) return true;
-        L /= len;
-        float ra = project(uA, eA, L);
-        float rb = project(uB, eB, L);
-        float pen = ra + rb - fabsf(T.Dot(L));
-        if (pen <= 0.f) return false;
-        if (pen < minPen){ minPen = pen; bestNrm = (T.Dot(L) >= 0.f) ? -L : L; }
-        return true;
-    };
+static inline float projectOBB(const Vector3* axes, const float* halves, const Vector3& L){
+    return halves[0] * fabsf(dot3(axes[0], L))
+         + halves[1] * fabsf(dot3(axes[1], L))
+         + halves[2] * fabsf(dot3(axes[2], L));
+}
 
-    for (int i = 0; i < 3; ++i) if (!testAxis(uA[i])) return false;
-    for (int j = 0; j < 3; ++j) if (!testAxis(uB[j])) return false;
-    for (int i = 0; i < 3; ++i)
-        for (int j = 0; j < 3; ++j)
-            if (!testAxis(uA[i].Cross(uB[j]))) return false;
-
-    contact.a = ba.go;
-    contact.b = bb.go;
-    contact.normal = bestNrm;
-    contact.depth = minPen;
-    contact.point = (ba.obbCenter + bb.obbCenter) * 0.5f;
+// Axes 0-2 are A's face normals, 3-5 B's, 6-14 the edge cross products
+// A[i] x B[j] at 6 + i * 3 + j. Written out component-wise so the SIMD lanes
+// below can reproduce it operation for operation.
+static inline Vector3 satAxis(const CollisionBody& ba, const CollisionBody& bb, int k){
+    if (k < 3) return ba.obbAxes[k];
+    if (k < 6) return bb.obbAxes[k - 3];
+    const Vector3& a = ba.obbAxes[(k - 6) / 3];
+    const Vector3& b = bb.obbAxes[(k - 6) % 3];
+    return Vector3(a.y * b.z - a.z * b.y,
+                   a.z * b.x - a.x * b.z,
+                   a.x * b.y - a.y * b.x);
+}
+
+bool NarrowPhase::satScalar(const CollisionBody& ba, const CollisionBody& bb, SatResult& out){
+    const Vector3 T(bb.obbCenter.x - ba.obbCenter.x,
+                    bb.obbCenter.y - ba.obbCenter.y,
+                    bb.obbCenter.z - ba.obbCenter.z);
+    out = {};
+    out.depth = FLT_MAX;
+
+    for (int k = 0; k < 15; ++k){
+        Vector3 L = satAxis(ba, bb, k);
+        const float len = sqrtf(dot3(L, L));
+        if (len < 1e-6f) continue;
+        L = Vector3(L.x / len, L.y / len, L.z / len);
+        const float ra = projectOBB(ba.obbAxes, ba.obbHalves, L);
+        const float rb = projectOBB(bb.obbAxes, bb.obbHalves, L);
+        const float tl = dot3(T, L);
+        const float pen = ra + rb - fabsf(tl);
+        if (pen <= 0.f){ out.separated = true; return false; }
+        if (pen < out.depth){
+            out.depth = pen;
+            out.axis = static_cast<uint8_t>(k);
+            out.flip = tl >= 0.f;
+        }
+    }
     return true;
 }
 
+struct BoxShape {
+    Vector3 c;
+    const Vector3* u;
+    const float* e;
+};
+
+struct ClipVertex {
+    Vector3 p;
+    uint32_t tag;
+};
+
+static inline Vector3 faceNormal(const BoxShape& box, int face){
+    const Vector3& axis = box.u[face >> 1];
+    return (face & 1) ? -axis : axis;
+}
+
+static void faceVertices(const BoxShape& box, int face, ClipVertex out[4]){
+    const int i = face >> 1;
+    const int j = (i + 1) % 3;
+    const int k = (i + 2) % 3;
+    const Vector3 fc = box.c + faceNormal(box, face) * box.e[i];
+    const Vector3 du = box.u[j] * box.e[j];
+    const Vector3 dv = box.u[k] * box.e[k];
+    out[0] = { fc + du + dv, 0 };
+    out[1] = { fc - du + dv, 1 };
+    out[2] = { fc - du - dv, 2 };
+    out[3] = { fc + du - dv, 3 };
+}
+
+// Lets faces of equal size keep their corners instead of producing a cluster
+// of near-duplicate intersection points along the shared edge.
+static constexpr float kClipTolerance = 1e-3f;
+
+// One Sutherland-Hodgman pass against the half-space n.p <= offset. A vertex
+// created on the plane is tagged with the plane and the tags of its edge so
+// the same feature maps to the same tag next frame.
+static int clipPolygon(const ClipVertex* in, int count, const Vector3& n, float offset,
+                       uint32_t plane, ClipVertex* out){
+    int outCount = 0;
+    for (int i = 0; i < count; ++i){
+        const ClipVertex& v0 = in[i];
+        const ClipVertex& v1 = in[(i + 1) % count];
+        const float d0 = n.Dot(v0.p) - offset - kClipTolerance;
+        const float d1 = n.Dot(v1.p) - offset - kClipTolerance;
+        if (d0 <= 0.f) out[outCount++] = v0;
+        if ((d0 <= 0.f) != (d1 <= 0.f)){
+            const float t = d0 / (d0 - d1);
+            const uint32_t tag = 16u + plane * 16u + ((v0.tag & 3u) << 2) + (v1.tag & 3u);
+            out[outCount++] = { v0.p + (v1.p - v0.p) * t, tag };
+        }
+    }
+    return outCount;
+}
+
+static void reduceManifold(ContactPoint* pts, uint32_t& count, const Vector3& n){
+    if (count <= ContactManifold::kMaxPoints) return;
+
+    uint32_t i0 = 0;
+    for (uint32_t i = 1; i < count; ++i)
+        if (pts[i].depth > pts[i0].depth) i0 = i;
+
+    uint32_t i1 = i0;
+    float best = -1.f;
+    for (uint32_t i = 0; i < count; ++i){
+        const float d = (pts[i].point - pts[i0].point).LengthSquared();
+        if (d > best){ best = d; i1 = i; }
+    }
+
+    const Vector3 e = pts[i1].point - pts[i0].point;
+    uint32_t i2 = count;
+    uint32_t i3 = count;
+    float maxArea = 0.f;
+    float minArea = 0.f;
+    for (uint32_t i = 0; i < count; ++i){
+        const float area = e.Cross(pts[i].point - pts[i0].point).Dot(n);
+        if (area > maxArea){ maxArea = area; i2 = i; }
+        if (area < minArea){ minArea = area; i3 = i; }
+    }
+
+    ContactPoint kept[ContactManifold::kMaxPoints];
+    uint32_t keptCount = 0;
+    const uint32_t picks[ContactManifold::kMaxPoints] = { i0, i1, i2, i3 };
+    for (uint32_t p = 0; p < ContactManifold::kMaxPoints; ++p){
+        if (picks[p] >= count || (p == 1 && i1 == i0)) continue;
+        kept[keptCount++] = pts[picks[p]];
+    }
+    for (uint32_t i = 0; i < keptCount; ++i) pts[i] = kept[i];
+    count = keptCount;
+}
+
+// Face contact: the box owning the SAT axis provides the reference face, the
+// other box's most anti-parallel face is clipped against its side planes, and
+// every clipped vertex below the reference face becomes a contact point.
+static bool faceContact(const BoxShape& ref, const BoxShape& inc, int refAxis,
+                        const Vector3& nRef, uint32_t refIsB, ContactManifold& m){
+    const int refFace = refAxis * 2 + (nRef.Dot(ref.u[refAxis]) >= 0.f ? 0 : 1);
+
+    int incFace = 0;
+    float minDot = FLT_MAX;
+    for (int f = 0; f < 6; ++f){
+        const float d = faceNormal(inc, f).Dot(nRef);
+        if (d < minDot){ minDot = d; incFace = f; }
+    }
+
+    ClipVertex bufA[8];
+    ClipVertex bufB[8];
+    faceVertices(inc, incFace, bufA);
+    int count = 4;
+
+    const int j = (refAxis + 1) % 3;
+    const int k = (refAxis + 2) % 3;
+    const Vector3 sideN[4] = { ref.u[j], -ref.u[j], ref.u[k], -ref.u[k] };
+    const float sideE[4] = { ref.e[j], ref.e[j], ref.e[k], ref.e[k] };
+    ClipVertex* src = bufA;
+    ClipVertex* dst = bufB;
+    for (uint32_t p = 0; p < 4 && count > 0; ++p){
+        count = clipPolygon(src, count, sideN[p], sideN[p].Dot(ref.c) + sideE[p], p, dst);
+        std::swap(src, dst);
+    }
+
+    const float refOffset = nRef.Dot(ref.c) + ref.e[refAxis];
+    const uint32_t faceBits = (refIsB << 31) | (static_cast<uint32_t>(refFace) << 16) |
+                              (static_cast<uint32_t>(incFace) << 8);
+    ContactPoint pts[8];
+    uint32_t n = 0;
+    for (int i = 0; i < count; ++i){
+        const float sep = nRef.Dot(src[i].p) - refOffset;
+        if (sep > 0.f) continue;
+        ContactPoint& cp = pts[n++];
+        cp.point = src[i].p - nRef * (sep * 0.5f);
+        cp.depth = -sep;
+        cp.featureId = faceBits | src[i].tag;
+    }
+    if (n == 0) return false;
+
+    reduceManifold(pts, n, nRef);
+    m.pointCount = n;
+    for (uint32_t i = 0; i < n; ++i) m.points[i] = pts[i];
+    return true;
+}
+
+static Vector3 supportEdgeCenter(const BoxShape& box, int edgeAxis, const Vector3& dir){
+    Vector3 p = box.c;
+    for (int a = 0; a < 3; ++a){
+        if (a == edgeAxis) continue;
+        p += box.u[a] * (box.u[a].Dot(dir) >= 0.f ? box.e[a] : -box.e[a]);
+    }
+    return p;
+}
+
+static void edgeContact(const BoxShape& a, const BoxShape& b, int i, int j,
+                        const Vector3& normal, float depth, ContactManifold& m){
+    const Vector3 pa = supportEdgeCenter(a, i, -normal);
+    const Vector3 pb = supportEdgeCenter(b, j, normal);
+    const Vector3& da = a.u[i];
+    const Vector3& db = b.u[j];
+
+    const Vector3 r = pa - pb;
+    const float dab = da.Dot(db);
+    const float denom = 1.f - dab * dab;
+    float s = 0.f;
+    float t = 0.f;
+    if (denom > 1e-6f){
+        s = std::clamp((dab * db.Dot(r) - da.Dot(r)) / denom, -a.e[i], a.e[i]);
+    }
+    t = std::clamp(db.Dot(r) + s * dab, -b.e[j], b.e[j]);
+    s = std::clamp(t * dab - da.Dot(r), -a.e[i], a.e[i]);
+
+    const Vector3 ca = pa + da * s;
+    const Vector3 cb = pb + db * t;
+
+    uint32_t edgeBits = 0;
+    for (int k = 0; k < 3; ++k){
+        if (k != i && a.u[k].Dot(-normal) >= 0.f) edgeBits |= 1u << k;
+        if (k != j && b.u[k].Dot(normal) >= 0.f) edgeBits |= 1u << (k + 3);
+    }
+
+    m.pointCount = 1;
+    m.points[0].point = (ca + cb) * 0.5f;
+    m.points[0].depth = depth;
+    m.points[0].featureId = (1u << 30) | (static_cast<uint32_t>(i * 3 + j) << 8) | edgeBits;
+}
+
+static float facePenetration(const CollisionBody& ba, const CollisionBody& bb, int k, bool& flip){
+    const Vector3& L = satAxis(ba, bb, k);
+    const Vector3 T = bb.obbCenter - ba.obbCenter;
+    const float tl = dot3(T, L);
+    flip = tl >= 0.f;
+    return projectOBB(ba.obbAxes, ba.obbHalves, L) + projectOBB(bb.obbAxes, bb.obbHalves, L) - fabsf(tl);
+}
+
+// The SAT minimum flips between nearly equal axes from frame to frame when
+// boxes rest face to face. Prefer A's faces, then B's, then edges within a
+// tolerance so the reference face and feature ids stay put.
+static SatResult stabilizeAxis(const CollisionBody& ba, const CollisionBody& bb, const SatResult& sat){
+    SatResult bestA = sat;
+    SatResult bestB = sat;
+    bestA.depth = FLT_MAX;
+    bestB.depth = FLT_MAX;
+    for (int k = 0; k < 6; ++k){
+        bool flip;
+        const float pen = facePenetration(ba, bb, k, flip);
+        SatResult& best = k < 3 ? bestA : bestB;
+        if (pen < best.depth){
+            best.depth = pen;
+            best.axis = static_cast<uint8_t>(k);
+            best.flip = flip;
+        }
+    }
+
+    const SatResult& face = bestB.depth < 0.98f * bestA.depth - 0.001f ? bestB : bestA;
+    if (sat.axis >= 6 && face.depth > 1.05f * sat.depth + 0.005f) return sat;
+    return face;
+}
+
+static void makeOBBManifold(const CollisionBody& ba, const CollisionBody& bb,
+                            const SatResult& rawSat, ContactManifold& m){
+    const SatResult sat = stabilizeAxis(ba, bb, rawSat);
+    Vector3 L = satAxis(ba, bb, sat.axis);
+    const float len = sqrtf(dot3(L, L));
+    L = Vector3(L.x / len, L.y / len, L.z / len);
+
+    m.a = ba.go;
+    m.b = bb.go;
+    m.normal = sat.flip ? -L : L;
+
+    const BoxShape a{ ba.obbCenter, ba.obbAxes, ba.obbHalves };
+    const BoxShape b{ bb.obbCenter, bb.obbAxes, bb.obbHalves };
+
+    bool ok;
+    if (sat.axis < 3)      ok = faceContact(a, b, sat.axis, -m.normal, 0u, m);
+    else if (sat.axis < 6) ok = faceContact(b, a, sat.axis - 3, m.normal, 1u, m);
+    else {
+        edgeContact(a, b, (sat.axis - 6) / 3, (sat.axis - 6) % 3, m.normal, sat.depth, m);
+        ok = true;
+    }
+
+    if (!ok){
+        m.pointCount = 1;
+        m.points[0] = {};
+        m.points[0].point = (ba.obbCenter + bb.obbCenter) * 0.5f;
+        m.points[0].depth = sat.depth;
+    }
+}
+
 static bool sphereVsSphere(const CollisionBody& ba, const CollisionBody& bb,
-                            ContactPoint& contact){
+                            ContactManifold& m){
     Vector3 diff = ba.sphereCenter - bb.sphereCenter;
     float distSq = diff.LengthSquared();
     float rSum = ba.sphereRadius + bb.sphereRadius;
@@ -57,23 +311,24 @@ static bool sphereVsSphere(const CollisionBody& ba, const CollisionBody& bb,
 
     float dist = sqrtf(distSq);
 
-    contact.a = ba.go;
-    contact.b = bb.go;
+    m.a = ba.go;
+    m.b = bb.go;
+    m.pointCount = 1;
 
     if (dist < 1e-6f){
-        contact.normal = Vector3(0.f, 1.f, 0.f);
-        contact.depth = rSum;
-        contact.point = ba.sphereCenter;
+        m.normal = Vector3(0.f, 1.f, 0.f);
+        m.points[0].depth = rSum;
+        m.points[0].point = ba.sphereCenter;
     } else {
-        contact.normal = diff / dist;
-        contact.depth = rSum - dist;
-        contact.point = bb.sphereCenter + contact.normal * bb.sphereRadius;
+        m.normal = diff / dist;
+        m.points[0].depth = rSum - dist;
+        m.points[0].point = bb.sphereCenter + m.normal * bb.sphereRadius;
     }
     return true;
 }
 
 static bool sphereVsOBB(const CollisionBody& bSphere, const CollisionBody& bOBB,
-                         ContactPoint& contact){
+                         ContactManifold& m){
     Vector3 d = bSphere.sphereCenter - bOBB.obbCenter;
 
     Vector3 closest = bOBB.obbCenter;
@@ -88,8 +343,9 @@ static bool sphereVsOBB(const CollisionBody& bSphere, const CollisionBody& bOBB,
 
     if (distSq >= bSphere.sphereRadius * bSphere.sphereRadius) return false;
 
-    contact.a = bSphere.go;
-    contact.b = bOBB.go;
+    m.a = bSphere.go;
+    m.b = bOBB.go;
+    m.pointCount = 1;
 
     float dist = sqrtf(distSq);
     if (dist < 1e-6f){
@@ -103,48 +359,284 @@ static bool sphereVsOBB(const CollisionBody& bSphere, const CollisionBody& bOBB,
                 bestNrm = (q >= 0.f) ? bOBB.obbAxes[i] : -bOBB.obbAxes[i];
             }
         }
-        contact.normal = bestNrm;
-        contact.depth = minPen;
-        contact.point = closest;
+        m.normal = bestNrm;
+        m.points[0].depth = minPen;
+        m.points[0].point = closest;
     } else {
-        contact.normal = diff / dist;
-        contact.depth = bSphere.sphereRadius - dist;
-        contact.point = closest;
+        m.normal = diff / dist;
+        m.points[0].depth = bSphere.sphereRadius - dist;
+        m.points[0].point = closest;
     }
     return true;
 }
 
 
-std::vector<ContactPoint> NarrowPhase::test(
-    const std::vector<CollisionPair>& pairs,
-    const std::vector<CollisionBody>& bodies){
-    std::vector<ContactPoint> results;
-    results.reserve(pairs.size());
+namespace {
+
+enum SatField {
+    kTx, kTy, kTz,
+    kA00, kB00 = kA00 + 9,
+    kEA0 = kB00 + 9, kEB0 = kEA0 + 3,
+    kFieldCount = kEB0 + 3
+};
+
+constexpr int kMaxLanes = 8;
+
+struct SatLanes {
+    alignas(32) float f[kFieldCount][kMaxLanes];
+};
+
+alignas(32) constexpr float kLaneIndex[kMaxLanes] = { 0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f };
+
+void gatherLanes(const CollisionPair* pairs, uint32_t count,
+                 const std::vector<CollisionBody>& bodies, SatLanes& g){
+    memset(&g, 0, sizeof(g));
+    for (uint32_t l = 0; l < count; ++l){
+        const CollisionBody& ba = bodies[pairs[l].a];
+        const CollisionBody& bb = bodies[pairs[l].b];
+        g.f[kTx][l] = bb.obbCenter.x - ba.obbCenter.x;
+        g.f[kTy][l] = bb.obbCenter.y - ba.obbCenter.y;
+        g.f[kTz][l] = bb.obbCenter.z - ba.obbCenter.z;
+        for (int i = 0; i < 3; ++i){
+            g.f[kA00 + i * 3 + 0][l] = ba.obbAxes[i].x;
+            g.f[kA00 + i * 3 + 1][l] = ba.obbAxes[i].y;
+            g.f[kA00 + i * 3 + 2][l] = ba.obbAxes[i].z;
+            g.f[kB00 + i * 3 + 0][l] = bb.obbAxes[i].x;
+            g.f[kB00 + i * 3 + 1][l] = bb.obbAxes[i].y;
+            g.f[kB00 + i * 3 + 2][l] = bb.obbAxes[i].z;
+            g.f[kEA0 + i][l] = ba.obbHalves[i];
+            g.f[kEB0 + i][l] = bb.obbHalves[i];
+        }
+    }
+}
+
+// Lane-wise mirror of NarrowPhase::satScalar. Every arithmetic step keeps the
+// scalar operation order (no FMA, explicit divide and sqrt), and the compare
+// predicates match the scalar ones on NaN, which is what makes the separation
+// decision bit-identical.
+template<class Ops>
+void satKernel(const SatLanes& g, uint32_t count, SatResult* out){
+    using V = typename Ops::V;
+    auto ld = [&](int field){ return Ops::load(g.f[field]); };
+
+    const V Tx = ld(kTx), Ty = ld(kTy), Tz = ld(kTz);
+    V A[3][3], B[3][3], eA[3], eB[3];
+    for (int i = 0; i < 3; ++i){
+        for (int c = 0; c < 3; ++c){
+            A[i][c] = ld(kA00 + i * 3 + c);
+            B[i][c] = ld(kB00 + i * 3 + c);
+        }
+        eA[i] = ld(kEA0 + i);
+        eB[i] = ld(kEB0 + i);
+    }
+
+    const V zero = Ops::set1(0.f);
+    const V eps = Ops::set1(1e-6f);
+    V minPen = Ops::set1(FLT_MAX);
+    V bestAxis = zero;
+    V flip = zero;
+    // Lanes past `count` are zero padding; they start out separated so a
+    // partial batch can still stop early.
+    V separated = Ops::nlt(Ops::load(kLaneIndex), Ops::set1(static_cast<float>(count)));
+
+    auto dot = [](V ax, V ay, V az, V bx, V by, V bz){
+        return Ops::add(Ops::add(Ops::mul(ax, bx), Ops::mul(ay, by)), Ops::mul(az, bz));
+    };
+    auto project = [&](V (&axes)[3][3], V (&halves)[3], V Lx, V Ly, V Lz){
+        V p = Ops::mul(halves[0], Ops::abs(dot(axes[0][0], axes[0][1], axes[0][2], Lx, Ly, Lz)));
+        p = Ops::add(p, Ops::mul(halves[1], Ops::abs(dot(axes[1][0], axes[1][1], axes[1][2], Lx, Ly, Lz))));
+        return Ops::add(p, Ops::mul(halves[2], Ops::abs(dot(axes[2][0], axes[2][1], axes[2][2], Lx, Ly, Lz))));
+    };
+    auto testAxis = [&](V Lx, V Ly, V Lz, int k){
+        const V len = Ops::sqrt(dot(Lx, Ly, Lz, Lx, Ly, Lz));
+        const V valid = Ops::nlt(len, eps);
+        Lx = Ops::div(Lx, len);
+        Ly = Ops::div(Ly, len);
+        Lz = Ops::div(Lz, len);
+        const V ra = project(A, eA, Lx, Ly, Lz);
+        const V rb = project(B, eB, Lx, Ly, Lz);
+        const V tl = dot(Tx, Ty, Tz, Lx, Ly, Lz);
+        const V pen = Ops::sub(Ops::add(ra, rb), Ops::abs(tl));
+
+        separated = Ops::or_(separated, Ops::and_(valid, Ops::le(pen, zero)));
+        const V upd = Ops::andnot(separated, Ops::and_(valid, Ops::lt(pen, minPen)));
+        minPen = Ops::select(minPen, pen, upd);
+        bestAxis = Ops::select(bestAxis, Ops::set1(static_cast<float>(k)), upd);
+        flip = Ops::select(flip, Ops::ge(tl, zero), upd);
+        return Ops::mask(separated) != Ops::kAllLanes;
+    };
+
+    bool live = true;
+    for (int i = 0; i < 3 && live; ++i) live = testAxis(A[i][0], A[i][1], A[i][2], i);
+    for (int j = 0; j < 3 && live; ++j) live = testAxis(B[j][0], B[j][1], B[j][2], 3 + j);
+    for (int i = 0; i < 3 && live; ++i){
+        for (int j = 0; j < 3 && live; ++j){
+            const V Lx = Ops::sub(Ops::mul(A[i][1], B[j][2]), Ops::mul(A[i][2], B[j][1]));
+            const V Ly = Ops::sub(Ops::mul(A[i][2], B[j][0]), Ops::mul(A[i][0], B[j][2]));
+            const V Lz = Ops::sub(Ops::mul(A[i][0], B[j][1]), Ops::mul(A[i][1], B[j][0]));
+            live = testAxis(Lx, Ly, Lz, 6 + i * 3 + j);
+        }
+    }
+
+    alignas(32) float depth[kMaxLanes], axis[kMaxLanes];
+    Ops::store(depth, minPen);
+    Ops::store(axis, bestAxis);
+    const int sepBits = Ops::mask(separated);
+    const int flipBits = Ops::mask(flip);
+    Ops::end();
+
+    for (uint32_t l = 0; l < count; ++l){
+        SatResult& r = out[l];
+        r.separated = (sepBits >> l) & 1;
+        r.depth = depth[l];
+        r.axis = static_cast<uint8_t>(axis[l]);
+        r.flip = (flipBits >> l) & 1;
+    }
+}
+
+}
+
+NarrowPhase::NarrowPhase() : m_satPath(bestSatPath()){}
+
+NarrowPhase::~NarrowPhase() = default;
 
-    for (const auto& p : pairs){
+NarrowPhase::SatPath NarrowPhase::bestSatPath(){
+    static const SatPath best = CpuHasAVX2() ? SatPath::AVX2 : SatPath::SSE;
+    return best;
+}
+
+const char* NarrowPhase::satPathName(SatPath path){
+    switch (path){
+        case SatPath::AVX2: return "AVX2 x8";
+        case SatPath::SSE: return "SSE x4";
+        default: return "Scalar";
+    }
+}
+
+void NarrowPhase::setSatPath(SatPath path){
+    if (path == SatPath::AVX2 && bestSatPath() != SatPath::AVX2) path = SatPath::SSE;
+    m_satPath = path;
+}
+
+void NarrowPhase::satBatch(const CollisionPair* pairs, uint32_t count,
+                           const std::vector<CollisionBody>& bodies,
+                           SatResult* out) const{
+    if (m_satPath == SatPath::Scalar){
+        for (uint32_t i = 0; i < count; ++i)
+            satScalar(bodies[pairs[i].a], bodies[pairs[i].b], out[i]);
+        return;
+    }
+
+    const uint32_t width = m_satPath == SatPath::AVX2 ? AvxOps::kWidth : SseOps::kWidth;
+    SatLanes lanes;
+    for (uint32_t base = 0; base < count; base += width){
+        const uint32_t n = std::min(width, count - base);
+        gatherLanes(pairs + base, n, bodies, lanes);
+        if (m_satPath == SatPath::AVX2) satKernel<AvxOps>(lanes, n, out + base);
+        else satKernel<SseOps>(lanes, n, out + base);
+    }
+}
+
+void NarrowPhase::setThreadCount(uint32_t threads){
+    if (threads < 1) threads = 1;
+    if (threads == getThreadCount()) return;
+    if (threads == 1) m_pool.reset();
+    else if (m_pool) m_pool->setThreadCount(threads);
+    else m_pool = std::make_unique<WorkerPool>(threads);
+}
+
+uint32_t NarrowPhase::getThreadCount() const{
+    return m_pool ? m_pool->getThreadCount() : 1;
+}
+
+void NarrowPhase::testChunk(const std::vector<CollisionPair>& pairs,
+                            const std::vector<CollisionBody>& bodies, Chunk& chunk) const{
+    chunk.contacts.clear();
+    chunk.obbPairs.clear();
+    chunk.obbPairIndex.clear();
+    for (uint32_t i = chunk.begin; i < chunk.end; ++i){
+        if (bodies[pairs[i].a].bvType == BVType::AABB &&
+            bodies[pairs[i].b].bvType == BVType::AABB){
+            chunk.obbPairs.push_back(pairs[i]);
+            chunk.obbPairIndex.push_back(i);
+        }
+    }
+    chunk.satResults.resize(chunk.obbPairs.size());
+    satBatch(chunk.obbPairs.data(), static_cast<uint32_t>(chunk.obbPairs.size()), bodies,
+             chunk.satResults.data());
+
+    size_t nextObb = 0;
+    for (uint32_t i = chunk.begin; i < chunk.end; ++i){
+        const CollisionPair& p = pairs[i];
         const CollisionBody& ba = bodies[p.a];
         const CollisionBody& bb = bodies[p.b];
-        ContactPoint cp;
+        ContactManifold m;
+        m.bodyA = p.a;
+        m.bodyB = p.b;
+        // By id, not by slot: gather order decides which body is A.
+        m.key = (static_cast<uint64_t>(std::min(ba.id, bb.id)) << 32) | std::max(ba.id, bb.id);
         bool hit = false;
 
+        if (nextObb < chunk.obbPairIndex.size() && chunk.obbPairIndex[nextObb] == i){
+            const SatResult& sat = chunk.satResults[nextObb++];
+            if (!sat.separated){
+                makeOBBManifold(ba, bb, sat, m);
+                chunk.contacts.push_back(m);
+            }
+            continue;
+        }
+
         const bool aIsSphere = (ba.bvType == BVType::Sphere);
         const bool bIsSphere = (bb.bvType == BVType::Sphere);
 
-        if (!aIsSphere && !bIsSphere){
-            hit = obbVsOBB(ba, bb, cp);
+        if (ba.bvType == BVType::Capsule){
+            hit = CapsuleCollision::Collide(ba, bb, m);
+        } else if (bb.bvType == BVType::Capsule){
+            hit = CapsuleCollision::Collide(bb, ba, m);
+            if (hit) std::swap(m.bodyA, m.bodyB);
         } else if (aIsSphere && bIsSphere){
-            hit = sphereVsSphere(ba, bb, cp);
-        } else if (aIsSphere && !bIsSphere){
-            hit = sphereVsOBB(ba, bb, cp);
+            hit = sphereVsSphere(ba, bb, m);
+        } else if (aIsSphere){
+            hit = sphereVsOBB(ba, bb, m);
         } else {
-            hit = sphereVsOBB(bb, ba, cp);
-            if (hit){
-                std::swap(cp.a, cp.b);
-                cp.normal = -cp.normal;
-            }
+            hit = sphereVsOBB(bb, ba, m);
+            if (hit) std::swap(m.bodyA, m.bodyB);
         }
 
-        if (hit) results.push_back(cp);
+        if (hit) chunk.contacts.push_back(m);
+    }
+}
+
+// Pairs are cut into contiguous chunks, each filling its own contact buffer
+// on whichever thread picks it up. Concatenating the buffers in chunk order
+// gives the same manifolds in the same order as a single-threaded pass.
+std::vector<ContactManifold> NarrowPhase::test(
+    const std::vector<CollisionPair>& pairs,
+    const std::vector<CollisionBody>& bodies){
+    const uint32_t n = static_cast<uint32_t>(pairs.size());
+    const uint32_t threads = getThreadCount();
+    uint32_t chunkCount = 1;
+    if (threads > 1 && n > kMinPairsPerChunk)
+        chunkCount = std::min(threads * kChunksPerThread, (n + kMinPairsPerChunk - 1) / kMinPairsPerChunk);
+    const uint32_t chunkSize = (n + chunkCount - 1) / std::max(chunkCount, 1u);
+
+    if (m_chunks.size() < chunkCount) m_chunks.resize(chunkCount);
+    for (uint32_t c = 0; c < chunkCount; ++c){
+        m_chunks[c].begin = std::min(n, c * chunkSize);
+        m_chunks[c].end = std::min(n, (c + 1) * chunkSize);
     }
+
+    if (chunkCount == 1){
+        testChunk(pairs, bodies, m_chunks[0]);
+    } else {
+        m_pool->parallelFor(chunkCount, [&](uint32_t c){ testChunk(pairs, bodies, m_chunks[c]); });
+    }
+
+    size_t total = 0;
+    for (uint32_t c = 0; c < chunkCount; ++c) total += m_chunks[c].contacts.size();
+    std::vector<ContactManifold> results;
+    results.reserve(total);
+    for (uint32_t c = 0; c < chunkCount; ++c)
+        results.insert(results.end(), m_chunks[c].contacts.begin(), m_chunks[c].contacts.end());
     return results;
 }
@@ -1,10 +1,66 @@
 #pragma once
 #include "CollisionInterfaces.h"
 #include <vector>
+#include <memory>
+
+class WorkerPool;
+
+struct SatResult {
+    float depth = 0.f;
+    uint8_t axis = 0;
+    bool flip = false;
+    bool separated = false;
+};
 
 class NarrowPhase {
 public:
-    std::vector<ContactPoint> test(
+    enum class SatPath { Scalar, SSE, AVX2 };
+
+    NarrowPhase();
+    ~NarrowPhase();
+
+    std::vector<ContactManifold> test(
         const std::vector<CollisionPair>& pairs,
         const std::vector<CollisionBody>& bodies);
+
+    // 15-axis OBB-vs-OBB separating-axis test over many pairs, 4 (SSE) or
+    // 8 (AVX2) lanes at a time. The separation decision is bit-identical to
+    // satScalar() on every path.
+    void satBatch(const CollisionPair* pairs, uint32_t count,
+                  const std::vector<CollisionBody>& bodies,
+                  SatResult* out) const;
+
+    static bool satScalar(const CollisionBody& ba, const CollisionBody& bb, SatResult& out);
+
+    static SatPath bestSatPath();
+    static const char* satPathName(SatPath path);
+
+    SatPath getSatPath() const { return m_satPath; }
+    void setSatPath(SatPath path);
+
+    // Threads used by test(), including the calling one. 1 runs inline.
+    uint32_t getThreadCount() const;
+    void setThreadCount(uint32_t threads);
+    WorkerPool* getWorkerPool() { return m_pool.get(); }
+
+private:
+    static constexpr uint32_t kMinPairsPerChunk = 256;
+    static constexpr uint32_t kChunksPerThread = 4;
+
+    struct Chunk {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        std::vector<CollisionPair> obbPairs;
+        std::vector<uint32_t> obbPairIndex;
+        std::vector<SatResult> satResults;
+        std::vector<ContactManifold> contacts;
+    };
+
+    void testChunk(const std::vector<CollisionPair>& pairs,
+                   const std::vector<CollisionBody>& bodies, Chunk& chunk) const;
+
+    SatPath m_satPath;
+
+    std::vector<Chunk> m_chunks;
+    std::unique_ptr<WorkerPool> m_pool;
 };
@@ -0,0 +1,339 @@
+#include "Globals.h"
+#include "OcclusionCuller.h"
+#include "WorkerPool.h"
+#include "SimdOps.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cfloat>
+
+namespace {
+
+constexpr int kBoxIndices[36] = {
+    0, 1, 3, 0, 3, 2,  4, 6, 7, 4, 7, 5,
+    0, 4, 5, 0, 5, 1,  2, 3, 7, 2, 7, 6,
+    0, 2, 6, 0, 6, 4,  1, 5, 7, 1, 7, 3
+};
+
+// The box test walks at most this many texels per axis.
+constexpr int kMaxTestTexels = 4;
+
+constexpr float kMinArea = 1e-6f;
+
+// Edge functions E(x, y) = a * x + b * y + c, positive inside, and the
+// depth plane z = za * x + zb * y + zc, all in pixel units.
+struct TriSetup {
+    float a[3], b[3], c[3];
+    float za, zb, zc;
+    int x0, x1, y0, y1;
+};
+
+bool setupTriangle(const float* xs, const float* ys, const float* zs,
+                   int tx0, int tx1, int ty0, int ty1, TriSetup& t){
+    float x[3] = { xs[0], xs[1], xs[2] };
+    float y[3] = { ys[0], ys[1], ys[2] };
+    float z[3] = { zs[0], zs[1], zs[2] };
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area < 0.f){
+        std::swap(x[1], x[2]); std::swap(y[1], y[2]); std::swap(z[1], z[2]);
+        area = -area;
+    }
+    if (area < kMinArea) return false;
+
+    // Pixel i is covered when its center i + 0.5 is inside.
+    const float mnx = std::min(x[0], std::min(x[1], x[2]));
+    const float mxx = std::max(x[0], std::max(x[1], x[2]));
+    const float mny = std::min(y[0], std::min(y[1], y[2]));
+    const float mxy = std::max(y[0], std::max(y[1], y[2]));
+    t.x0 = std::max(tx0, static_cast<int>(ceilf(mnx - 0.5f)));
+    t.x1 = std::min(tx1, static_cast<int>(floorf(mxx - 0.5f)));
+    t.y0 = std::max(ty0, static_cast<int>(ceilf(mny - 0.5f)));
+    t.y1 = std::min(ty1, static_cast<int>(floorf(mxy - 0.5f)));
+    if (t.x0 > t.x1 || t.y0 > t.y1) return false;
+
+    for (int i = 0; i < 3; ++i){
+        const int j = (i + 1) % 3;
+        t.a[i] = y[i] - y[j];
+        t.b[i] = x[j] - x[i];
+        t.c[i] = -t.a[i] * x[i] - t.b[i] * y[i];
+    }
+
+    // Edge i is opposite vertex (i + 2) % 3.
+    const float inv = 1.f / area;
+    t.za = (t.a[1] * z[0] + t.a[2] * z[1] + t.a[0] * z[2]) * inv;
+    t.zb = (t.b[1] * z[0] + t.b[2] * z[1] + t.b[0] * z[2]) * inv;
+    t.zc = (t.c[1] * z[0] + t.c[2] * z[1] + t.c[0] * z[2]) * inv;
+    return true;
+}
+
+void rasterScalar(float* depth, const TriSetup& t){
+    for (int y = t.y0; y <= t.y1; ++y){
+        const float py = static_cast<float>(y) + 0.5f;
+        const float r0 = t.b[0] * py + t.c[0];
+        const float r1 = t.b[1] * py + t.c[1];
+        const float r2 = t.b[2] * py + t.c[2];
+        const float rz = t.zb * py + t.zc;
+        float* row = depth + y * OcclusionCuller::kWidth;
+        for (int x = t.x0; x <= t.x1; ++x){
+            const float px = static_cast<float>(x) + 0.5f;
+            if (t.a[0] * px + r0 < 0.f || t.a[1] * px + r1 < 0.f || t.a[2] * px + r2 < 0.f) continue;
+            row[x] = std::min(row[x], t.za * px + rz);
+        }
+    }
+}
+
+// Rows are walked in whole vectors from the last aligned column; the tile
+// width is a multiple of the vector width, so the extra lanes are still
+// pixels of this tile and the edge test decides them like any other.
+template<class Ops>
+void rasterSimd(float* depth, const TriSetup& t){
+    using V = typename Ops::V;
+    constexpr int W = Ops::kWidth;
+    alignas(32) static const float kLaneCenters[8] = { 0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f };
+    const V lanes = Ops::load(kLaneCenters);
+    const V zero = Ops::set1(0.f);
+    const V a0 = Ops::set1(t.a[0]), a1 = Ops::set1(t.a[1]), a2 = Ops::set1(t.a[2]);
+    const V za = Ops::set1(t.za);
+    const int xStart = t.x0 & ~(W - 1);
+
+    for (int y = t.y0; y <= t.y1; ++y){
+        const float py = static_cast<float>(y) + 0.5f;
+        const V r0 = Ops::set1(t.b[0] * py + t.c[0]);
+        const V r1 = Ops::set1(t.b[1] * py + t.c[1]);
+        const V r2 = Ops::set1(t.b[2] * py + t.c[2]);
+        const V rz = Ops::set1(t.zb * py + t.zc);
+        float* row = depth + y * OcclusionCuller::kWidth;
+        for (int x = xStart; x <= t.x1; x += W){
+            const V px = Ops::add(Ops::set1(static_cast<float>(x)), lanes);
+            V inside = Ops::ge(Ops::add(Ops::mul(a0, px), r0), zero);
+            inside = Ops::and_(inside, Ops::ge(Ops::add(Ops::mul(a1, px), r1), zero));
+            inside = Ops::and_(inside, Ops::ge(Ops::add(Ops::mul(a2, px), r2), zero));
+            if (Ops::mask(inside) == 0) continue;
+            const V d = Ops::loadu(row + x);
+            const V z = Ops::add(Ops::mul(za, px), rz);
+            Ops::storeu(row + x, Ops::select(d, Ops::min_(d, z), inside));
+        }
+    }
+}
+
+}
+
+OcclusionCuller::OcclusionCuller() : m_path(bestPath()){
+    int offset = 0;
+    for (int l = 0; l < kMipCount; ++l){
+        m_mipOffset[l] = offset;
+        offset += (kWidth >> l) * (kHeight >> l);
+    }
+    m_depth.assign(offset, 1.f);
+}
+
+OcclusionCuller::~OcclusionCuller() = default;
+
+OcclusionCuller::Path OcclusionCuller::bestPath(){
+    static const Path best = CpuHasAVX2() ? Path::AVX2 : Path::SSE;
+    return best;
+}
+
+const char* OcclusionCuller::pathName(Path path){
+    switch (path){
+        case Path::AVX2: return "AVX2 x8";
+        case Path::SSE: return "SSE x4";
+        default: return "Scalar";
+    }
+}
+
+void OcclusionCuller::setPath(Path path){
+    if (path == Path::AVX2 && bestPath() != Path::AVX2) path = Path::SSE;
+    m_path = path;
+}
+
+void OcclusionCuller::setThreadCount(uint32_t threads){
+    if (threads <= 1) m_pool.reset();
+    else if (m_pool) m_pool->setThreadCount(threads);
+    else m_pool = std::make_unique<WorkerPool>(threads);
+}
+
+void OcclusionCuller::beginFrame(const Matrix& viewProj){
+    m_viewProj = viewProj;
+    m_tris.clear();
+}
+
+void OcclusionCuller::addOccluder(const Vector3* positions, uint32_t stride, const uint32_t* indices,
+                                  uint32_t indexCount, const Matrix& world){
+    const Matrix m = world * m_viewProj;
+    const char* base = reinterpret_cast<const char*>(positions);
+    auto clip = [&](uint32_t i){
+        const Vector3& p = *reinterpret_cast<const Vector3*>(base + static_cast<size_t>(i) * stride);
+        return Vector4::Transform(Vector4(p.x, p.y, p.z, 1.f), m);
+    };
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+        addClipTriangle(clip(indices[i]), clip(indices[i + 1]), clip(indices[i + 2]));
+}
+
+void OcclusionCuller::addOccluderBox(const Vector3& mn, const Vector3& mx){
+    Vector4 v[8];
+    for (int c = 0; c < 8; ++c){
+        const Vector4 p((c & 1) ? mx.x : mn.x, (c & 2) ? mx.y : mn.y, (c & 4) ? mx.z : mn.z, 1.f);
+        v[c] = Vector4::Transform(p, m_viewProj);
+    }
+    for (int i = 0; i < 36; i += 3)
+        addClipTriangle(v[kBoxIndices[i]], v[kBoxIndices[i + 1]], v[kBoxIndices[i + 2]]);
+}
+
+// Rejects triangles outside one clip plane and clips the rest to the near
+// plane (z >= 0), which leaves up to two triangles.
+void OcclusionCuller::addClipTriangle(const Vector4& a, const Vector4& b, const Vector4& c){
+    const Vector4 v[3] = { a, b, c };
+    auto allOut = [&](auto outside){ return outside(v[0]) && outside(v[1]) && outside(v[2]); };
+    if (allOut([](const Vector4& p){ return p.x < -p.w; }) || allOut([](const Vector4& p){ return p.x > p.w; }) ||
+        allOut([](const Vector4& p){ return p.y < -p.w; }) || allOut([](const Vector4& p){ return p.y > p.w; }) ||
+        allOut([](const Vector4& p){ return p.z > p.w; }) || allOut([](const Vector4& p){ return p.z < 0.f; }))
+        return;
+
+    if (v[0].z >= 0.f && v[1].z >= 0.f && v[2].z >= 0.f){
+        addScreenTriangle(v);
+        return;
+    }
+
+    Vector4 poly[4];
+    int n = 0;
+    for (int i = 0; i < 3; ++i){
+        const Vector4& p = v[i];
+        const Vector4& q = v[(i + 1) % 3];
+        if (p.z >= 0.f) poly[n++] = p;
+        if ((p.z >= 0.f) != (q.z >= 0.f)) poly[n++] = p + (q - p) * (p.z / (p.z - q.z));
+    }
+    for (int i = 1; i + 1 < n; ++i){
+        const Vector4 tri[3] = { poly[0], poly[i], poly[i + 1] };
+        addScreenTriangle(tri);
+    }
+}
+
+void OcclusionCuller::addScreenTriangle(const Vector4* v){
+    ScreenTri t;
+    for (int i = 0; i < 3; ++i){
+        const float invW = 1.f / v[i].w;
+        t.x[i] = (v[i].x * invW * 0.5f + 0.5f) * kWidth;
+        t.y[i] = (0.5f - v[i].y * invW * 0.5f) * kHeight;
+        t.z[i] = std::clamp(v[i].z * invW, 0.f, 1.f);
+    }
+    m_tris.push_back(t);
+}
+
+void OcclusionCuller::rasterize(){
+    const auto t0 = std::chrono::high_resolution_clock::now();
+
+    for (Tile& tile : m_tiles) tile.tris.clear();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_tris.size()); ++i){
+        const ScreenTri& t = m_tris[i];
+        const float mnx = std::min(t.x[0], std::min(t.x[1], t.x[2]));
+        const float mxx = std::max(t.x[0], std::max(t.x[1], t.x[2]));
+        const float mny = std::min(t.y[0], std::min(t.y[1], t.y[2]));
+        const float mxy = std::max(t.y[0], std::max(t.y[1], t.y[2]));
+        const int x0 = std::max(0, static_cast<int>(ceilf(mnx - 0.5f)));
+        const int x1 = std::min(kWidth - 1, static_cast<int>(floorf(mxx - 0.5f)));
+        const int y0 = std::max(0, static_cast<int>(ceilf(mny - 0.5f)));
+        const int y1 = std::min(kHeight - 1, static_cast<int>(floorf(mxy - 0.5f)));
+        if (x0 > x1 || y0 > y1) continue;
+        for (int ty = y0 / kTileHeight; ty <= y1 / kTileHeight; ++ty)
+            for (int tx = x0 / kTileWidth; tx <= x1 / kTileWidth; ++tx)
+                m_tiles[ty * kTilesX + tx].tris.push_back(i);
+    }
+
+    if (m_pool) m_pool->parallelFor(kTilesX * kTilesY, [this](uint32_t tile){ rasterizeTile(static_cast<int>(tile)); });
+    else for (int tile = 0; tile < kTilesX * kTilesY; ++tile) rasterizeTile(tile);
+
+    buildMips();
+    m_rasterMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+void OcclusionCuller::rasterizeTile(int tile){
+    const int tx0 = (tile % kTilesX) * kTileWidth;
+    const int ty0 = (tile / kTilesX) * kTileHeight;
+    const int tx1 = tx0 + kTileWidth - 1;
+    const int ty1 = ty0 + kTileHeight - 1;
+    float* depth = m_depth.data();
+    for (int y = ty0; y <= ty1; ++y)
+        std::fill(depth + y * kWidth + tx0, depth + y * kWidth + tx1 + 1, 1.f);
+
+    for (uint32_t i : m_tiles[tile].tris){
+        const ScreenTri& s = m_tris[i];
+        TriSetup t;
+        if (!setupTriangle(s.x, s.y, s.z, tx0, tx1, ty0, ty1, t)) continue;
+        switch (m_path){
+            case Path::AVX2: rasterSimd<AvxOps>(depth, t); break;
+            case Path::SSE: rasterSimd<SseOps>(depth, t); break;
+            default: rasterScalar(depth, t); break;
+        }
+    }
+    if (m_path == Path::AVX2) AvxOps::end();
+}
+
+void OcclusionCuller::buildMips(){
+    for (int l = 1; l < kMipCount; ++l){
+        const int w = kWidth >> l, h = kHeight >> l;
+        const int srcW = w * 2;
+        const float* src = m_depth.data() + m_mipOffset[l - 1];
+        float* dst = m_depth.data() + m_mipOffset[l];
+        for (int y = 0; y < h; ++y){
+            const float* r0 = src + (y * 2) * srcW;
+            const float* r1 = r0 + srcW;
+            for (int x = 0; x < w; ++x)
+                dst[y * w + x] = std::max(std::max(r0[x * 2], r0[x * 2 + 1]), std::max(r1[x * 2], r1[x * 2 + 1]));
+        }
+    }
+}
+
+namespace {
+
+// Projects the box's corners; false when any corner is in front of the near
+// plane, where the screen rectangle is meaningless.
+bool projectBox(const Matrix& viewProj, const Vector3& mn, const Vector3& mx,
+                float& x0, float& x1, float& y0, float& y1, float& zMin){
+    x0 = y0 = zMin = FLT_MAX;
+    x1 = y1 = -FLT_MAX;
+    for (int c = 0; c < 8; ++c){
+        const Vector4 p = Vector4::Transform(
+            Vector4((c & 1) ? mx.x : mn.x, (c & 2) ? mx.y : mn.y, (c & 4) ? mx.z : mn.z, 1.f), viewProj);
+        if (p.z < 0.f || p.w <= 0.f) return false;
+        const float invW = 1.f / p.w;
+        const float sx = (p.x * invW * 0.5f + 0.5f) * OcclusionCuller::kWidth;
+        const float sy = (0.5f - p.y * invW * 0.5f) * OcclusionCuller::kHeight;
+        x0 = std::min(x0, sx); x1 = std::max(x1, sx);
+        y0 = std::min(y0, sy); y1 = std::max(y1, sy);
+        zMin = std::min(zMin, p.z * invW);
+    }
+    return true;
+}
+
+}
+
+bool OcclusionCuller::isVisible(const Vector3& mn, const Vector3& mx) const{
+    float fx0, fx1, fy0, fy1, zMin;
+    if (!projectBox(m_viewProj, mn, mx, fx0, fx1, fy0, fy1, zMin)) return true;
+    if (fx1 < 0.f || fy1 < 0.f || fx0 > kWidth || fy0 > kHeight) return true;
+
+    const int x0 = std::clamp(static_cast<int>(floorf(fx0)), 0, kWidth - 1);
+    const int x1 = std::clamp(static_cast<int>(floorf(fx1)), 0, kWidth - 1);
+    const int y0 = std::clamp(static_cast<int>(floorf(fy0)), 0, kHeight - 1);
+    const int y1 = std::clamp(static_cast<int>(floorf(fy1)), 0, kHeight - 1);
+
+    int l = 0;
+    while (l < kMipCount - 1 &&
+           ((x1 >> l) - (x0 >> l) >= kMaxTestTexels || (y1 >> l) - (y0 >> l) >= kMaxTestTexels)) ++l;
+
+    const int w = kWidth >> l;
+    const float* mip = getDepth(l);
+    for (int y = y0 >> l; y <= (y1 >> l); ++y)
+        for (int x = x0 >> l; x <= (x1 >> l); ++x)
+            if (zMin <= mip[y * w + x]) return true;
+    return false;
+}
+
+float OcclusionCuller::screenCoverage(const Vector3& mn, const Vector3& mx) const{
+    float x0, x1, y0, y1, zMin;
+    if (!projectBox(m_viewProj, mn, mx, x0, x1, y0, y1, zMin)) return 1.f;
+    x0 = std::clamp(x0, 0.f, float(kWidth)); x1 = std::clamp(x1, 0.f, float(kWidth));
+    y0 = std::clamp(y0, 0.f, float(kHeight)); y1 = std::clamp(y1, 0.f, float(kHeight));
+    return (x1 - x0) * (y1 - y0) / float(kWidth * kHeight);
+}
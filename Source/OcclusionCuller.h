@@ -0,0 +1,88 @@
+#pragma once
+#include <SimpleMath.h>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+using namespace DirectX::SimpleMath;
+
+class WorkerPool;
+
+// Software occlusion culling. A few large occluders are rasterized into a
+// small depth buffer on the CPU, a max-depth mip chain is built over it, and
+// boxes are tested against the mip level where their screen rectangle spans
+// a handful of texels. Occluders are drawn double sided at pixel centers, so
+// they only ever hide what is behind their own triangles.
+class OcclusionCuller {
+public:
+    static constexpr int kWidth = 256;
+    static constexpr int kHeight = 128;
+    static constexpr int kTileWidth = 64;
+    static constexpr int kTileHeight = 32;
+    static constexpr int kTilesX = kWidth / kTileWidth;
+    static constexpr int kTilesY = kHeight / kTileHeight;
+    static constexpr int kMipCount = 8;
+
+    enum class Path { Scalar, SSE, AVX2 };
+
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    static Path bestPath();
+    static const char* pathName(Path path);
+    void setPath(Path path);
+    Path getPath() const { return m_path; }
+
+    // Tiles are rasterized in parallel when more than one thread is set.
+    void setThreadCount(uint32_t threads);
+
+    void beginFrame(const Matrix& viewProj);
+
+    // Indexed triangles; `stride` is the byte distance between positions.
+    void addOccluder(const Vector3* positions, uint32_t stride, const uint32_t* indices,
+                     uint32_t indexCount, const Matrix& world);
+    void addOccluderBox(const Vector3& mn, const Vector3& mx);
+
+    // Bins the occluder triangles into tiles, rasterizes them and builds the
+    // mip chain. Call once after the occluders and before any test.
+    void rasterize();
+
+    // False only when the box is certainly behind the occluders. Boxes that
+    // cross the near plane are always visible.
+    bool isVisible(const Vector3& mn, const Vector3& mx) const;
+
+    // Fraction of the screen covered by the box's projected rectangle; 0
+    // when it is off screen and 1 when it crosses the near plane.
+    float screenCoverage(const Vector3& mn, const Vector3& mx) const;
+
+    const float* getDepth(int level = 0) const { return m_depth.data() + m_mipOffset[level]; }
+    uint32_t getTriangleCount() const { return static_cast<uint32_t>(m_tris.size()); }
+    float getRasterMs() const { return m_rasterMs; }
+
+private:
+    struct ScreenTri {
+        float x[3], y[3], z[3];
+    };
+
+    struct Tile {
+        std::vector<uint32_t> tris;
+    };
+
+    void addClipTriangle(const Vector4& a, const Vector4& b, const Vector4& c);
+    void addScreenTriangle(const Vector4* v);
+    void rasterizeTile(int tile);
+    void buildMips();
+
+    Matrix m_viewProj;
+    Path m_path = Path::SSE;
+    std::vector<ScreenTri> m_tris;
+    Tile m_tiles[kTilesX * kTilesY];
+
+    // Every mip level in one buffer: level 0 is kWidth x kHeight and each
+    // further level halves both sides, holding the max of its 2x2 texels.
+    std::vector<float> m_depth;
+    int m_mipOffset[kMipCount] = {};
+
+    std::unique_ptr<WorkerPool> m_pool;
+    float m_rasterMs = 0.f;
+};
@@ -56,7 +56,8 @@ struct OctreeNode {
         }
     }
 
-    void collectPairs(std::unordered_set<uint64_t>& seen,
+    void collectPairs(const std::vector<CollisionBody>& allBodies,
+                      std::unordered_set<uint64_t>& seen,
                       std::vector<CollisionPair>& pairs,
                       std::vector<AABB>& debugLeaves,
                       int& nodeCount, int& leafCount) const{
@@ -70,6 +71,7 @@ struct OctreeNode {
                     uint32_t a = bodyIndices[i];
                     uint32_t b = bodyIndices[j];
                     if (a > b) std::swap(a, b);
+                    if (!reportsPair(allBodies[a], allBodies[b])) continue;
                     uint64_t key = ((uint64_t)a << 32) | b;
                     if (seen.insert(key).second)
                         pairs.push_back({ a, b });
@@ -77,7 +79,7 @@ struct OctreeNode {
             }
         } else {
             for (const auto& c : children)
-                if (c) c->collectPairs(seen, pairs, debugLeaves, nodeCount, leafCount);
+                if (c) c->collectPairs(allBodies, seen, pairs, debugLeaves, nodeCount, leafCount);
         }
     }
 };
@@ -121,7 +123,7 @@ std::vector<CollisionPair> OctreeBroadPhase::query(
 
     std::unordered_set<uint64_t> seen;
     seen.reserve(n * 4);
-    rootNode.collectPairs(seen, pairs, m_debugLeaves, m_lastNodeCount, m_lastLeafCount);
+    rootNode.collectPairs(bodies, seen, pairs, m_debugLeaves, m_lastNodeCount, m_lastLeafCount);
 
     return pairs;
 }
@@ -157,4 +157,95 @@ void PerformancePanel::drawContent(){
     ImGui::PushStyleColor(ImGuiCol_PlotLines, EditorColors::Ok);
     ImGui::PlotLines("##fps", ordered, kHistory, 0, nullptr, 0.f, maxFPS * 1.1f, ImVec2(-1, 60));
     ImGui::PopStyleColor();
+
+    drawAnimationBenchmark();
+    drawCompressionBenchmark();
+}
+
+void PerformancePanel::drawAnimationBenchmark(){
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
+    if (ImGui::Button("Run pose sampling benchmark  (1000 characters x 60 bones)"))
+        m_poseBench = AnimationBenchmark::RunPoseSampling();
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Samples a crowd of characters over 60 frames on every path\n"
+                          "and checks each pose against the name-lookup path. The SSE\n"
+                          "and AVX2 paths are held to the scalar cursor pose on every\n"
+                          "frame; MAX DEG is their worst rotation error.");
+
+    if (m_poseBench.empty()) return;
+
+    if (ImGui::BeginTable("##posebench", 6,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("PATH", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("BIND MS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("MS/FRAME", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("BONES/US", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("MAX DEG", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("DIFF", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_poseBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.path);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", row.bindMs);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%.3f", row.sampleMs);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.2f", row.bonesPerUs);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.1e", row.maxAngleErrDeg);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::TextColored(row.mismatches == 0 ? EditorColors::Ok : EditorColors::Crit, "%u", row.mismatches);
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
+}
+
+void PerformancePanel::drawCompressionBenchmark(){
+    ImGui::Spacing();
+
+    if (ImGui::Button("Run key compression benchmark  (1000 characters x 60 bones)"))
+        m_compressBench = AnimationBenchmark::RunCompression();
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Packs every clip the way the importer does and samples the\n"
+                          "crowd from float and packed keys. MAX DEG and MAX POS are the\n"
+                          "packed pose's worst error against the float pose; MAX POS\n"
+                          "covers translation and scale. TOL fails when either is past\n"
+                          "the importer's tolerance.");
+
+    if (m_compressBench.empty()) return;
+
+    if (ImGui::BeginTable("##compressbench", 9,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)){
+        ImGui::TableSetupColumn("PATH", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("KEYS", ImGuiTableColumnFlags_WidthFixed, 56.f);
+        ImGui::TableSetupColumn("BYTES", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("PACK MS", ImGuiTableColumnFlags_WidthFixed, 64.f);
+        ImGui::TableSetupColumn("MS/FRAME", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("BONES/US", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("MAX DEG", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("MAX POS", ImGuiTableColumnFlags_WidthFixed, 72.f);
+        ImGui::TableSetupColumn("TOL", ImGuiTableColumnFlags_WidthFixed, 40.f);
+        ImGui::TableHeadersRow();
+
+        ImGui::PushFont(g_fontMono);
+        for (const auto& row : m_compressBench){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.path);
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%u", row.keysPerClip);
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%u", row.bytesPerClip);
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%.3f", row.compressMs);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.3f", row.sampleMs);
+            ImGui::TableSetColumnIndex(5); ImGui::Text("%.2f", row.bonesPerUs);
+            ImGui::TableSetColumnIndex(6); ImGui::Text("%.1e", row.maxAngleErrDeg);
+            ImGui::TableSetColumnIndex(7); ImGui::Text("%.1e", row.maxPosErr);
+            ImGui::TableSetColumnIndex(8);
+            if (row.withinTolerance) ImGui::TextColored(EditorColors::Ok, "pass");
+            else ImGui::TextColored(EditorColors::Crit, "FAIL");
+        }
+        ImGui::PopFont();
+        ImGui::EndTable();
+    }
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "EditorPanel.h"
+#include "AnimationBenchmark.h"
 #include <cstdint>
+#include <vector>
 
 class PerformancePanel : public EditorPanel {
 public:
@@ -15,6 +17,9 @@ protected:
     void drawContent() override;
 
 private:
+    void drawAnimationBenchmark();
+    void drawCompressionBenchmark();
+
     static constexpr int kHistory = 200;
     float m_fpsHistory[kHistory] = {};
     int m_fpsIdx = 0;
@@ -22,4 +27,6 @@ private:
     bool m_gpuReady = false;
     uint64_t m_gpuMem = 0;
     uint64_t m_ramMem = 0;
+    std::vector<AnimationBenchmark::PoseSampleResult> m_poseBench;
+    std::vector<AnimationBenchmark::CompressionResult> m_compressBench;
 };
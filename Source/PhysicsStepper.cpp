@@ -0,0 +1,206 @@
+#include "Globals.h"
+#include "PhysicsStepper.h"
+#include "CollisionSystem.h"
+#include "CollisionResponse.h"
+#include "SimulationIslands.h"
+#include "SceneGraph.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "ComponentRigidbody.h"
+#include "ComponentMesh.h"
+#include "CollisionBodyRegistry.h"
+#include <algorithm>
+#include <cmath>
+
+int PhysicsStepper::advance(float frameDt, const std::function<void(float)>& step){
+    m_accumulator += std::max(frameDt, 0.f);
+
+    int steps = 0;
+    while (m_accumulator >= m_fixedDt && steps < m_maxSubsteps){
+        step(m_fixedDt);
+        m_accumulator -= m_fixedDt;
+        ++steps;
+        ++m_stepCount;
+    }
+    if (m_accumulator >= m_fixedDt){
+        m_droppedSteps += static_cast<uint32_t>(m_accumulator / m_fixedDt);
+        m_accumulator = fmodf(m_accumulator, m_fixedDt);
+    }
+    m_lastSubsteps = steps;
+    return steps;
+}
+
+void PhysicsStepper::reset(){
+    m_accumulator = 0.f;
+    m_lastSubsteps = 0;
+    m_poses.clear();
+    m_poseOfSlot.clear();
+    m_poseScene = nullptr;
+}
+
+static bool isActiveUnder(const GameObject* go, const GameObject* root){
+    for (const GameObject* node = go; node; node = node->getParent()){
+        if (!node->isActive()) return false;
+        if (node == root) return true;
+    }
+    return false;
+}
+
+void PhysicsStepper::removePose(uint32_t index){
+    m_poseOfSlot[m_poses[index].slot] = kNoPose;
+    const uint32_t last = static_cast<uint32_t>(m_poses.size() - 1);
+    if (index != last){
+        m_poses[index] = m_poses[last];
+        m_poseOfSlot[m_poses[index].slot] = index;
+    }
+    m_poses.pop_back();
+}
+
+// A game object with several meshes gets one pose, from its first mesh.
+static bool findPoseTarget(const CollisionBodyRegistry::Entry& e, const GameObject* root,
+                           ComponentRigidbody*& rb, ComponentTransform*& t){
+    if (!e.mesh || e.owner->getComponent<ComponentMesh>() != e.mesh || !isActiveUnder(e.owner, root))
+        return false;
+    rb = e.owner->getComponent<ComponentRigidbody>();
+    t = e.owner->getTransform();
+    return rb && t && !rb->isStatic;
+}
+
+// A transform that no longer matches what was last shown was moved from
+// outside physics (script, gizmo), so it becomes both poses instead of being
+// overwritten.
+void PhysicsStepper::syncSlot(uint32_t slot, const GameObject* root){
+    const CollisionBodyRegistry::Entry& e = CollisionBodyRegistry::GetEntries()[slot];
+    ComponentRigidbody* rb = nullptr;
+    ComponentTransform* t = nullptr;
+    if (!findPoseTarget(e, root, rb, t)) return;
+
+    uint32_t index = m_poseOfSlot[slot];
+    if (index == kNoPose){
+        index = static_cast<uint32_t>(m_poses.size());
+        m_poseOfSlot[slot] = index;
+        BodyPose& added = m_poses.emplace_back();
+        for (const BodyPose& released : m_releasedPoses){
+            if (released.owner != e.owner || released.rb != rb || released.transform != t) continue;
+            added = released;
+            added.generation = e.generation;
+            break;
+        }
+        added.slot = slot;
+    }
+    BodyPose& pose = m_poses[index];
+    const bool moved = pose.owner != e.owner || pose.rb != rb || pose.transform != t ||
+                       pose.generation != e.generation ||
+                       t->position != pose.shownPosition || t->rotation != pose.shownRotation;
+    pose.owner = e.owner;
+    pose.rb = rb;
+    pose.transform = t;
+    pose.generation = e.generation;
+    if (moved){
+        pose.prevPosition = pose.currPosition = pose.shownPosition = t->position;
+        pose.prevRotation = pose.currRotation = pose.shownRotation = t->rotation;
+    }
+}
+
+// Refreshes the poses of the slots logged since the last step, then puts
+// every body back on its current step pose before stepping.
+void PhysicsStepper::syncPoses(SceneGraph* scene){
+    const std::vector<CollisionBodyRegistry::Entry>& entries = CollisionBodyRegistry::GetEntries();
+    m_changedSlots.clear();
+    if (scene != m_poseScene || !CollisionBodyRegistry::ReadChanges(m_changeCursor, m_changedSlots)){
+        m_poseScene = scene;
+        m_poses.clear();
+        m_poseOfSlot.assign(entries.size(), kNoPose);
+        m_changeCursor = CollisionBodyRegistry::GetLogEnd();
+        m_changedSlots.clear();
+        for (uint32_t slot = 0; slot < static_cast<uint32_t>(entries.size()); ++slot)
+            m_changedSlots.push_back(slot);
+    }
+    m_poseOfSlot.resize(entries.size(), kNoPose);
+
+    // Drop poses before adding any, so a pose moving to another mesh of the
+    // same game object is found whatever the slot order.
+    const GameObject* root = scene->getRoot();
+    m_releasedPoses.clear();
+    for (uint32_t slot : m_changedSlots){
+        const uint32_t index = m_poseOfSlot[slot];
+        if (index == kNoPose) continue;
+        ComponentRigidbody* rb = nullptr;
+        ComponentTransform* t = nullptr;
+        if (findPoseTarget(entries[slot], root, rb, t) && m_poses[index].generation == entries[slot].generation)
+            continue;
+        m_releasedPoses.push_back(m_poses[index]);
+        removePose(index);
+    }
+    for (uint32_t slot : m_changedSlots) syncSlot(slot, root);
+
+    for (BodyPose& pose : m_poses){
+        ComponentTransform* t = pose.transform;
+        if (t->position == pose.currPosition && t->rotation == pose.currRotation) continue;
+        t->position = pose.currPosition;
+        t->rotation = pose.currRotation;
+        t->markDirty();
+    }
+}
+
+void PhysicsStepper::writeInterpolated(){
+    const float alpha = std::min(getAlpha(), 1.f);
+    for (BodyPose& pose : m_poses){
+        if (!m_interpolate || pose.rb->isSleeping()){
+            pose.shownPosition = pose.currPosition;
+            pose.shownRotation = pose.currRotation;
+        } else {
+            pose.shownPosition = Vector3::Lerp(pose.prevPosition, pose.currPosition, alpha);
+            pose.shownRotation = Quaternion::Slerp(pose.prevRotation, pose.currRotation, alpha);
+        }
+        ComponentTransform* t = pose.transform;
+        if (t->position == pose.shownPosition && t->rotation == pose.shownRotation) continue;
+        t->position = pose.shownPosition;
+        t->rotation = pose.shownRotation;
+        t->markDirty();
+    }
+}
+
+void PhysicsStepper::stepScene(SceneGraph* scene, float frameDt, float gravityY,
+                               CollisionSystem& collision, CollisionResponse& response,
+                               SimulationIslands* islands){
+    if (!scene) return;
+    syncPoses(scene);
+
+    advance(frameDt, [&](float h){
+        for (BodyPose& pose : m_poses){
+            pose.prevPosition = pose.currPosition;
+            pose.prevRotation = pose.currRotation;
+            pose.rb->integrateVelocity(h, gravityY);
+        }
+
+        collision.run(scene, h);
+        response.solve(collision.getManifolds(), collision.getBodies(), h);
+        collision.recordSolve(response.getLastSolveMs(), response.getLastConstraintCount());
+
+        // Fast movers stop at their first time of impact; the contact there
+        // is picked up by the discrete pass on the next step.
+        const std::vector<CcdClamp>& clamps = collision.runContinuous(h);
+        for (BodyPose& pose : m_poses){
+            float fraction = 1.f;
+            if (!clamps.empty() && pose.rb->isFastMoving){
+                auto it = std::lower_bound(clamps.begin(), clamps.end(), pose.rb,
+                    [](const CcdClamp& c, const ComponentRigidbody* rb){ return c.rb < rb; });
+                if (it != clamps.end() && it->rb == pose.rb) fraction = it->fraction;
+            }
+            pose.rb->integratePosition(h * fraction);
+        }
+
+        if (islands) islands->update(collision.getManifolds(), collision.getBodies(), h);
+
+        for (BodyPose& pose : m_poses){
+            pose.currPosition = pose.transform->position;
+            pose.currRotation = pose.transform->rotation;
+        }
+        if (m_stepObserver) m_stepObserver();
+    });
+
+    writeInterpolated();
+    // Everything logged since syncPoses was written by the steps above.
+    m_changeCursor = CollisionBodyRegistry::GetLogEnd();
+}
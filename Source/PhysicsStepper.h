@@ -0,0 +1,96 @@
+#pragma once
+#include "Globals.h"
+#include <vector>
+#include <functional>
+
+class SceneGraph;
+class GameObject;
+class CollisionSystem;
+class CollisionResponse;
+class SimulationIslands;
+class ComponentRigidbody;
+class ComponentTransform;
+
+// Fixed-timestep physics driver. Frame time is accumulated and consumed in
+// fixedDt steps, at most maxSubsteps per frame; time beyond that is dropped
+// so a slow frame cannot make the next one slower. Each rigidbody keeps the
+// pose of the previous and the current step, and rendering sees the blend of
+// the two by the fraction of a step left in the accumulator. Poses mirror the
+// body registry: one per non-static rigidbody that has a mesh, patched from
+// the registry's change log rather than by walking the scene.
+class PhysicsStepper {
+public:
+    // Runs step(fixedDt) as many times as the accumulated time allows and
+    // returns how many steps ran. The step never sees the frame delta, so the
+    // simulation is identical at any render rate.
+    int advance(float frameDt, const std::function<void(float)>& step);
+
+    // One render frame of scene physics. Each step integrates velocities,
+    // collides, solves, sweeps fast movers, integrates positions and updates
+    // islands; interpolated transforms are written afterwards.
+    void stepScene(SceneGraph* scene, float frameDt, float gravityY,
+                   CollisionSystem& collision, CollisionResponse& response,
+                   SimulationIslands* islands);
+
+    // Forgets the accumulator and stored poses, e.g. when play mode restarts.
+    void reset();
+
+    float getFixedDt() const { return m_fixedDt; }
+    void setFixedDt(float dt){ m_fixedDt = dt < 1e-4f ? 1e-4f : dt; m_accumulator = 0.f; }
+
+    int getMaxSubsteps() const { return m_maxSubsteps; }
+    void setMaxSubsteps(int n){ m_maxSubsteps = n < 1 ? 1 : n; }
+
+    bool isInterpolating() const { return m_interpolate; }
+    void setInterpolating(bool on){ m_interpolate = on; }
+
+    float getAlpha() const { return m_accumulator / m_fixedDt; }
+    int getLastSubsteps() const { return m_lastSubsteps; }
+    uint32_t getDroppedSteps() const { return m_droppedSteps; }
+    uint64_t getStepCount() const { return m_stepCount; }
+
+    // Called by stepScene after every fixed step, once the step's poses are
+    // final and before interpolation; lets tests record each step's state.
+    void setStepObserver(std::function<void()> observer){ m_stepObserver = std::move(observer); }
+
+private:
+    struct BodyPose {
+        const GameObject* owner = nullptr;
+        ComponentRigidbody* rb = nullptr;
+        ComponentTransform* transform = nullptr;
+        Vector3 prevPosition;
+        Vector3 currPosition;
+        Vector3 shownPosition;
+        Quaternion prevRotation;
+        Quaternion currRotation;
+        Quaternion shownRotation;
+        uint32_t slot = 0;
+        uint32_t generation = 0;
+    };
+
+    void syncPoses(SceneGraph* scene);
+    void syncSlot(uint32_t slot, const GameObject* root);
+    void removePose(uint32_t index);
+    void writeInterpolated();
+
+    float m_fixedDt = 1.f / 60.f;
+    int m_maxSubsteps = 5;
+    bool m_interpolate = true;
+    float m_accumulator = 0.f;
+
+    int m_lastSubsteps = 0;
+    uint32_t m_droppedSteps = 0;
+    uint64_t m_stepCount = 0;
+    std::function<void()> m_stepObserver;
+
+    static constexpr uint32_t kNoPose = 0xFFFFFFFFu;
+    std::vector<BodyPose> m_poses;
+    // Registry slot -> index into m_poses, or kNoPose.
+    std::vector<uint32_t> m_poseOfSlot;
+    std::vector<uint32_t> m_changedSlots;
+    // Poses dropped by this sync, so one that moves to another slot of the
+    // same game object keeps its step poses.
+    std::vector<BodyPose> m_releasedPoses;
+    SceneGraph* m_poseScene = nullptr;
+    uint64_t m_changeCursor = 0;
+};
@@ -1,99 +1,344 @@
 #include "Globals.h"
 #include "RenderOctree.h"
 #include <cfloat>
+#include <cmath>
+#include <algorithm>
 
-bool RenderOctree::s_dirty = true;
-
-AABB RenderOctree::octant(const AABB& parent, int idx){
-    const Vector3 mid = (parent.min + parent.max) * 0.5f;
-    Vector3 lo, hi;
-    lo.x = (idx & 1) ? mid.x : parent.min.x;
-    hi.x = (idx & 1) ? parent.max.x : mid.x;
-    lo.y = (idx & 2) ? mid.y : parent.min.y;
-    hi.y = (idx & 2) ? parent.max.y : mid.y;
-    lo.z = (idx & 4) ? mid.z : parent.min.z;
-    hi.z = (idx & 4) ? parent.max.z : mid.z;
-    return { lo, hi };
-}
-
-void RenderOctree::Node::subdivide(const std::vector<Entry>& entries, int capacity, int maxDepth){
-    for (int i = 0; i < 8; ++i){
-        children[i] = std::make_unique<Node>();
-        children[i]->region = octant(region, i);
-        children[i]->depth = depth + 1;
+namespace {
+
+inline Vector3 boxCenter(const AABB& b){ return (b.min + b.max) * 0.5f; }
+
+inline float boxHalfExtent(const AABB& b){
+    const Vector3 e = (b.max - b.min) * 0.5f;
+    return std::max(e.x, std::max(e.y, e.z));
+}
+
+inline bool sameBox(const AABB& a, const AABB& b){
+    return a.min == b.min && a.max == b.max;
+}
+
+enum class Overlap { Outside, Partial, Inside };
+
+// A cube against the frustum. Inside needs a margin: an entry's own test
+// rounds differently, and one lying on a plane must not be handed over
+// untested.
+Overlap classify(const Frustum& frustum, const Vector3& c, float e, uint8_t& lastPlane){
+    auto test = [&](int p, bool& inside){
+        const FrustumPlane& pl = frustum.planes[p];
+        const float s = pl.normal.Dot(c);
+        const float r = (fabsf(pl.normal.x) + fabsf(pl.normal.y) + fabsf(pl.normal.z)) * e;
+        inside = s - r > pl.d + 1e-4f * (fabsf(s) + r + fabsf(pl.d));
+        return s + r < pl.d;
+    };
+    bool inside = false;
+    if (lastPlane < Frustum::COUNT && test(lastPlane, inside)) return Overlap::Outside;
+    bool allInside = true;
+    for (int p = 0; p < Frustum::COUNT; ++p){
+        if (test(p, inside)){
+            lastPlane = static_cast<uint8_t>(p);
+            return Overlap::Outside;
+        }
+        allInside = allInside && inside;
     }
-    for (uint32_t idx : entryIndices)
-        for (auto& c : children)
-            c->insert(idx, entries[idx].worldAABB, entries, capacity, maxDepth);
-    entryIndices.clear();
-}
-
-void RenderOctree::Node::insert(uint32_t idx, const AABB& bounds, const std::vector<Entry>& entries, int capacity, int maxDepth){
-    if (!region.intersects(bounds)) return;
-    if (isLeaf()){
-        entryIndices.push_back(idx);
-        if (static_cast<int>(entryIndices.size()) > capacity && depth < maxDepth)
-            subdivide(entries, capacity, maxDepth);
+    return allInside ? Overlap::Inside : Overlap::Partial;
+}
+
+}
+
+uint32_t RenderOctree::allocNode(uint32_t parent, int octant){
+    uint32_t idx;
+    if (!m_freeNodes.empty()){
+        idx = m_freeNodes.back();
+        m_freeNodes.pop_back();
     } else {
-        for (auto& c : children)
-            c->insert(idx, bounds, entries, capacity, maxDepth);
+        idx = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    // Freed nodes keep their entry arrays' capacity.
+    Node& n = m_nodes[idx];
+    n.center = Vector3::Zero;
+    n.halfSize = 0.f;
+    n.childMask = 0;
+    n.depth = 0;
+    n.lastPlane = FrustumCulling::kNoPlane;
+    n.live = true;
+    n.split = false;
+    std::fill(std::begin(n.children), std::end(n.children), kNone);
+    n.parent = parent;
+    if (parent != kNone){
+        Node& p = m_nodes[parent];
+        const float q = p.halfSize * 0.5f;
+        n.center = p.center + Vector3((octant & 1) ? q : -q, (octant & 2) ? q : -q, (octant & 4) ? q : -q);
+        n.halfSize = q;
+        n.depth = static_cast<uint8_t>(p.depth + 1);
+        if (p.childMask == 0) --m_leafCount;
+        p.children[octant] = idx;
+        p.childMask |= static_cast<uint8_t>(1u << octant);
     }
+    ++m_nodeCount;
+    ++m_leafCount;
+    return idx;
 }
 
-void RenderOctree::Node::queryFrustum(const Frustum& frustum, const std::vector<Entry>& entries, std::vector<GameObject*>& out) const{
-    if (!frustum.intersectsAABB(region.min, region.max)) return;
-    if (isLeaf()){
-        for (uint32_t idx : entryIndices) out.push_back(entries[idx].go);
-    } else {
-        for (const auto& c : children)
-            if (c) c->queryFrustum(frustum, entries, out);
+void RenderOctree::freeNode(uint32_t node){
+    Node& n = m_nodes[node];
+    if (n.parent != kNone){
+        Node& p = m_nodes[n.parent];
+        for (int i = 0; i < 8; ++i){
+            if (p.children[i] != node) continue;
+            p.children[i] = kNone;
+            p.childMask &= static_cast<uint8_t>(~(1u << i));
+        }
+        if (p.childMask == 0) ++m_leafCount;
     }
+    n.live = false;
+    n.boxes.clear();
+    n.planes.clear();
+    n.ids.clear();
+    m_freeNodes.push_back(node);
+    --m_nodeCount;
+    --m_leafCount;
 }
 
-void RenderOctree::Node::countStats(int& nodeCount, int& leafCount) const{
-    ++nodeCount;
-    if (isLeaf()) ++leafCount;
-    else for (const auto& c : children) if (c) c->countStats(nodeCount, leafCount);
+// Descends from the root through split nodes while a child's cell still
+// covers the box; its loose bounds then contain the whole box.
+uint32_t RenderOctree::findNode(const AABB& box, bool& overflow){
+    const Vector3 c = boxCenter(box);
+    const float e = boxHalfExtent(box);
+    uint32_t node = m_root;
+    const Node& root = m_nodes[m_root];
+    const Vector3 d = c - root.center;
+    overflow = e > root.halfSize ||
+               fabsf(d.x) > root.halfSize || fabsf(d.y) > root.halfSize || fabsf(d.z) > root.halfSize;
+    if (overflow) return node;
+
+    while (m_nodes[node].split && m_nodes[node].depth < kMaxDepth && e <= m_nodes[node].halfSize * 0.5f){
+        const Node& n = m_nodes[node];
+        const int octant = (c.x >= n.center.x ? 1 : 0) | (c.y >= n.center.y ? 2 : 0) | (c.z >= n.center.z ? 4 : 0);
+        node = n.children[octant] != kNone ? n.children[octant] : allocNode(node, octant);
+    }
+    return node;
 }
 
-void RenderOctree::clear(){
-    m_pending.clear();
+// Whether findNode would still pick this node for the box.
+bool RenderOctree::fits(uint32_t node, const AABB& box) const{
+    const Node& n = m_nodes[node];
+    const Vector3 d = boxCenter(box) - n.center;
+    const float e = boxHalfExtent(box);
+    if (fabsf(d.x) > n.halfSize || fabsf(d.y) > n.halfSize || fabsf(d.z) > n.halfSize) return false;
+    return e <= n.halfSize && (!n.split || n.depth == kMaxDepth || e > n.halfSize * 0.5f);
+}
+
+void RenderOctree::link(uint32_t id, uint32_t node){
+    Slot& s = m_slots[id];
+    Node& n = m_nodes[node];
+    s.node = node;
+    s.index = static_cast<uint32_t>(n.ids.size());
+    n.boxes.push(s.worldAABB.min, s.worldAABB.max);
+    n.planes.push_back(FrustumCulling::kNoPlane);
+    n.ids.push_back(id);
+}
+
+// Moves the node's last entry into the hole.
+void RenderOctree::unlink(uint32_t id){
+    Slot& s = m_slots[id];
+    if (s.node == kNone) return;
+    Node& n = m_nodes[s.node];
+    FrustumCulling::BoxSet& b = n.boxes;
+    const uint32_t i = s.index;
+    const uint32_t last = static_cast<uint32_t>(n.ids.size() - 1);
+    if (i != last){
+        b.cx[i] = b.cx[last]; b.cy[i] = b.cy[last]; b.cz[i] = b.cz[last];
+        b.ex[i] = b.ex[last]; b.ey[i] = b.ey[last]; b.ez[i] = b.ez[last];
+        n.planes[i] = n.planes[last];
+        n.ids[i] = n.ids[last];
+        m_slots[n.ids[i]].index = i;
+    }
+    b.cx.pop_back(); b.cy.pop_back(); b.cz.pop_back();
+    b.ex.pop_back(); b.ey.pop_back(); b.ez.pop_back();
+    n.planes.pop_back();
+    n.ids.pop_back();
+    if (s.overflow) --m_overflow;
+    s.node = kNone;
+    s.overflow = false;
+}
+
+void RenderOctree::place(uint32_t id){
+    if (m_root == kNone){
+        m_needsRegrow = true;
+        return;
+    }
+    bool overflow;
+    const uint32_t node = findNode(m_slots[id].worldAABB, overflow);
+    link(id, node);
+    m_slots[id].overflow = overflow;
+    if (overflow) ++m_overflow;
+    const Node& n = m_nodes[node];
+    if (!n.split && n.depth < kMaxDepth && n.ids.size() > kSplitCount) splitNode(node);
+}
+
+// Entries outside the root cell and those too large for a child stay.
+void RenderOctree::splitNode(uint32_t node){
+    m_nodes[node].split = true;
+    for (uint32_t i = static_cast<uint32_t>(m_nodes[node].ids.size()); i-- > 0;){
+        const uint32_t id = m_nodes[node].ids[i];
+        const Slot& s = m_slots[id];
+        if (s.overflow || fits(node, s.worldAABB)) continue;
+        unlink(id);
+        place(id);
+    }
 }
 
-void RenderOctree::add(GameObject* go, const AABB& worldAABB){
-    m_pending.push_back({ go, worldAABB });
+void RenderOctree::pruneFrom(uint32_t node){
+    while (node != kNone && node != m_root){
+        const Node& n = m_nodes[node];
+        if (!n.ids.empty() || n.childMask != 0) return;
+        const uint32_t parent = n.parent;
+        freeNode(node);
+        node = parent;
+    }
 }
 
-void RenderOctree::build(){
-    if (!s_dirty && m_pending.size() == m_lastBuiltCount) return;
-    s_dirty = false;
-    m_lastBuiltCount = m_pending.size();
+// Fits a fresh root around every entry with room to move, then relinks
+// them all. Only runs for the first frame and when too many entries have
+// drifted outside the root.
+void RenderOctree::regrow(){
+    m_needsRegrow = false;
+    for (Node& n : m_nodes){
+        n.live = false;
+        n.boxes.clear();
+        n.planes.clear();
+        n.ids.clear();
+    }
+    m_freeNodes.clear();
+    for (uint32_t i = static_cast<uint32_t>(m_nodes.size()); i-- > 0;) m_freeNodes.push_back(i);
     m_nodeCount = 0;
     m_leafCount = 0;
-    m_root.reset();
+    m_overflow = 0;
+    m_root = kNone;
+
+    AABB bounds;
+    for (const Slot& s : m_slots){
+        if (!s.live) continue;
+        bounds.min = Vector3::Min(bounds.min, s.worldAABB.min);
+        bounds.max = Vector3::Max(bounds.max, s.worldAABB.max);
+    }
+    if (!bounds.isValid()) return;
+
+    const Vector3 size = bounds.max - bounds.min;
+    m_root = allocNode(kNone, 0);
+    m_nodes[m_root].center = boxCenter(bounds);
+    m_nodes[m_root].halfSize = std::max(size.x, std::max(size.y, size.z)) * 0.5f * 1.25f + 0.01f;
+    ++m_rebuilds;
 
-    if (m_pending.empty()) return;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_slots.size()); ++i){
+        Slot& s = m_slots[i];
+        if (!s.live) continue;
+        s.node = kNone;
+        s.overflow = false;
+        place(i);
+    }
+}
+
+void RenderOctree::beginUpdate(){
+    m_moved = 0;
+}
+
+void RenderOctree::update(uint32_t id, const AABB& worldAABB){
+    if (id >= m_slots.size()) m_slots.resize(id + 1);
+    Slot& s = m_slots[id];
+    if (!s.live){
+        s = Slot{};
+        s.worldAABB = worldAABB;
+        s.live = true;
+        ++m_entryCount;
+        place(id);
+        ++m_moved;
+        return;
+    }
+    if (sameBox(s.worldAABB, worldAABB)) return;
 
-    AABB root;
-    root.min = Vector3( FLT_MAX, FLT_MAX, FLT_MAX);
-    root.max = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
-    for (const auto& e : m_pending){
-        root.min = Vector3::Min(root.min, e.worldAABB.min);
-        root.max = Vector3::Max(root.max, e.worldAABB.max);
+    s.worldAABB = worldAABB;
+    if (s.node == kNone){
+        place(id);
+    } else if (s.overflow || !fits(s.node, worldAABB)){
+        const uint32_t oldNode = s.node;
+        unlink(id);
+        place(id);
+        pruneFrom(oldNode);
+        ++m_moved;
+    } else {
+        FrustumCulling::BoxSet& b = m_nodes[s.node].boxes;
+        const Vector3 c = boxCenter(worldAABB), e = (worldAABB.max - worldAABB.min) * 0.5f;
+        b.cx[s.index] = c.x; b.cy[s.index] = c.y; b.cz[s.index] = c.z;
+        b.ex[s.index] = e.x; b.ey[s.index] = e.y; b.ez[s.index] = e.z;
     }
-    const Vector3 kEps(0.01f, 0.01f, 0.01f);
-    root.min -= kEps;
-    root.max += kEps;
+}
 
-    m_root = std::make_unique<Node>();
-    m_root->region = root;
-    m_root->depth = 0;
-    for (uint32_t i = 0; i < (uint32_t)m_pending.size(); ++i)
-        m_root->insert(i, m_pending[i].worldAABB, m_pending, NODE_CAPACITY, MAX_DEPTH);
+void RenderOctree::remove(uint32_t id){
+    if (!contains(id)) return;
+    Slot& s = m_slots[id];
+    const uint32_t node = s.node;
+    unlink(id);
+    pruneFrom(node);
+    s.live = false;
+    --m_entryCount;
+}
 
-    m_root->countStats(m_nodeCount, m_leafCount);
+void RenderOctree::endUpdate(){
+    const uint32_t regrowAt = std::max(kMinOverflowForRegrow, m_entryCount / kOverflowFractionForRegrow);
+    if (m_needsRegrow || m_overflow > regrowAt || (m_root == kNone && m_entryCount > 0)) regrow();
+    m_lastMoved = m_moved;
 }
 
-void RenderOctree::query(const Frustum& frustum, std::vector<GameObject*>& outVisible) const{
-    if (m_root) m_root->queryFrustum(frustum, m_pending, outVisible);
+void RenderOctree::clear(){
+    m_slots.clear();
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_root = kNone;
+    m_overflow = 0;
+    m_entryCount = 0;
+    m_needsRegrow = false;
+    m_nodeCount = 0;
+    m_leafCount = 0;
+}
+
+void RenderOctree::appendSubtree(uint32_t node, std::vector<uint32_t>& out) const{
+    const Node& n = m_nodes[node];
+    out.insert(out.end(), n.ids.begin(), n.ids.end());
+    for (int i = 0; i < 8; ++i)
+        if (n.childMask & (1u << i)) appendSubtree(n.children[i], out);
+}
+
+// The root's own entries are always tested: it also holds the ones outside
+// its cell.
+void RenderOctree::query(const Frustum& frustum, std::vector<uint32_t>& outVisible) const{
+    if (m_root == kNone) return;
+    m_stack.clear();
+    m_stack.push_back(m_root);
+
+    while (!m_stack.empty()){
+        const uint32_t id = m_stack.back();
+        m_stack.pop_back();
+        const Node& n = m_nodes[id];
+        if (id != m_root){
+            const Overlap o = classify(frustum, n.center, n.halfSize * 2.f, n.lastPlane);
+            if (o == Overlap::Outside) continue;
+            if (o == Overlap::Inside){
+                appendSubtree(id, outVisible);
+                continue;
+            }
+        }
+
+        const uint32_t count = static_cast<uint32_t>(n.ids.size());
+        if (count != 0){
+            m_bits.resize(FrustumCulling::MaskWords(count));
+            FrustumCulling::Cull(frustum, n.boxes.view(n.planes.data()), m_bits.data());
+            for (uint32_t i = 0; i < count; ++i)
+                if (FrustumCulling::IsVisible(m_bits.data(), i)) outVisible.push_back(n.ids[i]);
+        }
+        for (int i = 0; i < 8; ++i)
+            if (n.childMask & (1u << i)) m_stack.push_back(n.children[i]);
+    }
 }
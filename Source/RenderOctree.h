@@ -1,54 +1,106 @@
 #pragma once
 #include "BoundingVolume.h"
 #include "Frustum.h"
+#include "FrustumCulling.h"
 #include <vector>
-#include <memory>
-
-class GameObject;
+#include <cstdint>
 
+// Loose octree over the renderable meshes. Each node's bounds are twice its
+// cell, so an entry lives in a cell that holds its center and is at least as
+// large as the entry; it never straddles. A node keeps its entries until it
+// holds more than kSplitCount, then passes down the ones small enough for a
+// child, so leaves hold a batch worth culling. Entries are keyed by a
+// caller id (the body registry slot) and persist until removed, so a frame
+// only relinks the entries it is told about. Each node keeps its entries'
+// boxes contiguous, ready for a batched cull.
 class RenderOctree {
 public:
-    struct Entry {
-        GameObject* go;
-        AABB worldAABB;
-    };
-
-    static void notifyTransformChanged(){ s_dirty = true; }
+    // Between beginUpdate() and endUpdate(), update() the entries that were
+    // added or moved and remove() the ones that are gone; the rest keep their
+    // boxes.
+    void beginUpdate();
+    void update(uint32_t id, const AABB& worldAABB);
+    void remove(uint32_t id);
+    void endUpdate();
 
     void clear();
-    void add(GameObject* go, const AABB& worldAABB);
 
-    void build();
+    // Ids of the entries whose own AABB touches the frustum. A node wholly
+    // inside the frustum hands over its subtree untested; the entries of the
+    // nodes on its boundary are culled in SIMD batches.
+    void query(const Frustum& frustum, std::vector<uint32_t>& outVisible) const;
 
-    void query(const Frustum& frustum, std::vector<GameObject*>& outVisible) const;
+    bool contains(uint32_t id) const { return id < m_slots.size() && m_slots[id].live; }
 
     int getNodeCount() const { return m_nodeCount; }
     int getLeafCount() const { return m_leafCount; }
+    uint32_t getEntryCount() const { return m_entryCount; }
+    uint32_t getLastMovedCount() const { return m_lastMoved; }
+    uint32_t getRebuildCount() const { return m_rebuilds; }
 
 private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+    static constexpr int kMaxDepth = 8;
+    static constexpr uint32_t kSplitCount = 256;
+
+    // Entries outside the root cell wait in the root; past this many the
+    // root is regrown around everything.
+    static constexpr uint32_t kMinOverflowForRegrow = 32;
+    static constexpr uint32_t kOverflowFractionForRegrow = 16;
+
+    struct Slot {
+        AABB worldAABB{};
+        uint32_t node = kNone;
+        uint32_t index = 0;
+        bool live = false;
+        bool overflow = false;
+    };
+
     struct Node {
-        AABB region;
-        int depth = 0;
-        std::vector<uint32_t> entryIndices;
-        std::unique_ptr<Node> children[8];
-
-        bool isLeaf() const { return !children[0]; }
-        void subdivide(const std::vector<Entry>& entries, int capacity, int maxDepth);
-        void insert(uint32_t idx, const AABB& bounds, const std::vector<Entry>& entries, int capacity, int maxDepth);
-        void queryFrustum(const Frustum& frustum, const std::vector<Entry>& entries, std::vector<GameObject*>& out) const;
-        void countStats(int& nodeCount, int& leafCount) const;
+        Vector3 center;
+        float halfSize = 0.f;
+        uint32_t parent = kNone;
+        uint32_t children[8];
+        uint8_t childMask = 0;
+        uint8_t depth = 0;
+        bool live = false;
+        bool split = false;
+        mutable uint8_t lastPlane = FrustumCulling::kNoPlane;
+
+        // The node's entries, in parallel.
+        FrustumCulling::BoxSet boxes;
+        mutable std::vector<uint8_t> planes;
+        std::vector<uint32_t> ids;
     };
 
-    static AABB octant(const AABB& parent, int idx);
+    uint32_t allocNode(uint32_t parent, int octant);
+    void freeNode(uint32_t node);
+    uint32_t findNode(const AABB& box, bool& overflow);
+    bool fits(uint32_t node, const AABB& box) const;
+    void link(uint32_t id, uint32_t node);
+    void unlink(uint32_t id);
+    void place(uint32_t id);
+    void splitNode(uint32_t node);
+    void pruneFrom(uint32_t node);
+    void regrow();
+    void appendSubtree(uint32_t node, std::vector<uint32_t>& out) const;
 
-    std::vector<Entry> m_pending;
-    std::unique_ptr<Node> m_root;
-    size_t m_lastBuiltCount = SIZE_MAX;
-    int m_nodeCount = 0;
-    int m_leafCount = 0;
+    // Indexed by id.
+    std::vector<Slot> m_slots;
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_freeNodes;
 
-    static constexpr int NODE_CAPACITY = 8;
-    static constexpr int MAX_DEPTH = 6;
+    // Query scratch.
+    mutable std::vector<uint32_t> m_stack;
+    mutable std::vector<uint32_t> m_bits;
 
-    static bool s_dirty;
+    uint32_t m_root = kNone;
+    uint32_t m_overflow = 0;
+    uint32_t m_entryCount = 0;
+    uint32_t m_moved = 0;
+    uint32_t m_lastMoved = 0;
+    uint32_t m_rebuilds = 0;
+    bool m_needsRegrow = false;
+    int m_nodeCount = 0;
+    int m_leafCount = 0;
 };
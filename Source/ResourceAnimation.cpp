@@ -1,12 +1,14 @@
 #include "Globals.h"
 #include "ResourceAnimation.h"
 #include "ImporterUtils.h"
+#include "AnimationCompression.h"
 #include <cstring>
+#include <algorithm>
 
 namespace {
 struct AnimFileHeader {
     uint32_t magic = 0x414E494D;
-    uint32_t version = 2;
+    uint32_t version = 4;
     uint32_t animNameLen = 0;
     uint32_t channelCount = 0;
     float duration = 0.f;
@@ -15,16 +17,94 @@ struct AnimFileHeader {
 
 ResourceAnimation::ResourceAnimation(UID uid) : ResourceBase(uid, Type::Animation){}
 
+int ResourceAnimation::findChannel(const std::string& nodeName) const{
+    auto it = m_channelIndex.find(nodeName);
+    return (it != m_channelIndex.end()) ? (int)it->second : -1;
+}
+
+// Reserves room for the channel's keys at the end of the flat arrays, float
+// or packed to match the clip. A repeated node name keeps its first
+// channel, as the name map always did.
+ResourceAnimation::Channel* ResourceAnimation::appendChannel(const std::string& nodeName,
+                                                             const uint32_t (&counts)[TrackCount]){
+    if (!m_channelIndex.emplace(nodeName, (uint32_t)m_channels.size()).second) return nullptr;
+
+    Channel ch;
+    for (uint32_t t = 0; t < TrackCount; ++t){
+        TrackRange& track = ch.tracks[t];
+        track.first = (uint32_t)m_times[t].size();
+        track.count = counts[t];
+        const uint32_t end = track.first + track.count;
+        m_times[t].resize(end);
+        if (m_packed) m_packedKeys[t].resize((size_t)end * 3);
+        else if (t == Rotation) m_rotations.resize(end);
+        else m_vectors[t].resize(end);
+    }
+
+    m_channels.push_back(ch);
+    m_channelNames.push_back(nodeName);
+    return &m_channels.back();
+}
+
+void ResourceAnimation::addChannel(const std::string& nodeName,
+                                   const float* posTimes, const Vector3* positions, uint32_t posCount,
+                                   const float* rotTimes, const Quaternion* rotations, uint32_t rotCount,
+                                   const float* scaleTimes, const Vector3* scales, uint32_t scaleCount){
+    if (m_packed) return;
+    Channel* ch = appendChannel(nodeName, { posCount, rotCount, scaleCount });
+    if (!ch) return;
+
+    const TrackRange& pos = ch->tracks[Translation];
+    std::copy(posTimes, posTimes + posCount, m_times[Translation].begin() + pos.first);
+    std::copy(positions, positions + posCount, m_vectors[Translation].begin() + pos.first);
+
+    const TrackRange& rot = ch->tracks[Rotation];
+    std::copy(rotTimes, rotTimes + rotCount, m_times[Rotation].begin() + rot.first);
+    std::copy(rotations, rotations + rotCount, m_rotations.begin() + rot.first);
+
+    const TrackRange& scale = ch->tracks[Scale];
+    std::copy(scaleTimes, scaleTimes + scaleCount, m_times[Scale].begin() + scale.first);
+    std::copy(scales, scales + scaleCount, m_vectors[Scale].begin() + scale.first);
+}
+
+void ResourceAnimation::addPackedChannel(const std::string& nodeName,
+                                         const AnimationCompression::PackedVectors& positions,
+                                         const AnimationCompression::PackedRotations& rotations,
+                                         const AnimationCompression::PackedVectors& scales){
+    if (!m_packed && !m_channels.empty()) return;
+    m_packed = true;
+    Channel* ch = appendChannel(nodeName, { (uint32_t)positions.times.size(), (uint32_t)rotations.times.size(),
+                                            (uint32_t)scales.times.size() });
+    if (!ch) return;
+
+    const std::vector<float>* times[TrackCount] = { &positions.times, &rotations.times, &scales.times };
+    const std::vector<uint16_t>* keys[TrackCount] = { &positions.keys, &rotations.keys, &scales.keys };
+    for (uint32_t t = 0; t < TrackCount; ++t){
+        const TrackRange& track = ch->tracks[t];
+        std::copy(times[t]->begin(), times[t]->end(), m_times[t].begin() + track.first);
+        std::copy(keys[t]->begin(), keys[t]->end(), m_packedKeys[t].begin() + (size_t)track.first * 3);
+    }
+    ch->tracks[Translation].origin = positions.origin;
+    ch->tracks[Translation].step = positions.step;
+    ch->tracks[Scale].origin = scales.origin;
+    ch->tracks[Scale].step = scales.step;
+}
+
+size_t ResourceAnimation::getKeyBytes() const{
+    size_t bytes = m_channels.size() * sizeof(Channel) + m_rotations.size() * sizeof(Quaternion);
+    for (uint32_t t = 0; t < TrackCount; ++t)
+        bytes += m_times[t].size() * sizeof(float) + m_vectors[t].size() * sizeof(Vector3)
+               + m_packedKeys[t].size() * sizeof(uint16_t);
+    return bytes;
+}
+
 const ResourceAnimation::MorphChannel* ResourceAnimation::getMorphChannel(const std::string& nodeName) const{
     auto it = m_morphChannels.find(nodeName);
     return (it != m_morphChannels.end()) ? &it->second : nullptr;
 }
 
 bool ResourceAnimation::LoadInMemory(){
-    m_channels.clear();
-    m_morphChannels.clear();
-    m_name.clear();
-    m_duration = 0.f;
+    UnloadFromMemory();
 
     AnimFileHeader header;
     std::vector<char> raw;
@@ -38,51 +118,67 @@ bool ResourceAnimation::LoadInMemory(){
     m_name.assign(cur, header.animNameLen);
     cur += header.animNameLen;
     m_duration = header.duration;
+    // Versions 3 and 4 pack their keys; version 5 keeps float keys for a
+    // clip whose range was too wide to pack within tolerance.
+    m_packed = header.version == 3 || header.version == 4;
 
     m_channels.reserve(header.channelCount);
+    m_channelNames.reserve(header.channelCount);
+
+    // Scale tracks arrived with version 4; older files stop at rotation.
+    const uint32_t fileTracks = header.version >= 4 ? TrackCount : Scale;
+    auto trackBytes = [&](uint32_t t, uint32_t count) -> size_t {
+        if (count == 0) return 0;
+        if (m_packed) return count * (sizeof(float) + 3 * sizeof(uint16_t)) + (t != Rotation ? 2 * sizeof(Vector3) : 0);
+        return count * (sizeof(float) + (t == Rotation ? sizeof(Quaternion) : sizeof(Vector3)));
+    };
 
     for (uint32_t i = 0; i < header.channelCount; ++i){
-        if (cur + 3 * sizeof(uint32_t) > end) return false;
+        if (cur + (1 + fileTracks) * sizeof(uint32_t) > end) return false;
 
-        uint32_t nameLen, posCount, rotCount;
+        uint32_t nameLen;
+        uint32_t counts[TrackCount] = {};
         memcpy(&nameLen, cur, sizeof(uint32_t));
-        memcpy(&posCount, cur + sizeof(uint32_t), sizeof(uint32_t));
-        memcpy(&rotCount, cur + 2 * sizeof(uint32_t), sizeof(uint32_t));
-        cur += 3 * sizeof(uint32_t);
+        memcpy(counts, cur + sizeof(uint32_t), fileTracks * sizeof(uint32_t));
+        cur += (1 + fileTracks) * sizeof(uint32_t);
 
         if (cur + nameLen > end) return false;
         std::string nodeName(cur, nameLen);
         cur += nameLen;
 
-        Channel ch;
-
-        if (posCount > 0){
-            size_t timeBytes = posCount * sizeof(float);
-            size_t posBytes = posCount * sizeof(Vector3);
-            if (cur + timeBytes + posBytes > end) return false;
+        size_t channelBytes = 0;
+        for (uint32_t t = 0; t < fileTracks; ++t) channelBytes += trackBytes(t, counts[t]);
+        if (cur + channelBytes > end) return false;
 
-            ch.posCount = posCount;
-            ch.posTimeStamps = std::make_unique<float[]>(posCount);
-            ch.positions = std::make_unique<Vector3[]>(posCount);
-            memcpy(ch.posTimeStamps.get(), cur, timeBytes);
-            memcpy(ch.positions.get(), cur + timeBytes, posBytes);
-            cur += timeBytes + posBytes;
+        Channel* ch = appendChannel(nodeName, counts);
+        if (!ch){
+            cur += channelBytes;
+            continue;
         }
 
-        if (rotCount > 0){
-            size_t timeBytes = rotCount * sizeof(float);
-            size_t rotBytes = rotCount * sizeof(Quaternion);
-            if (cur + timeBytes + rotBytes > end) return false;
-
-            ch.rotCount = rotCount;
-            ch.rotTimeStamps = std::make_unique<float[]>(rotCount);
-            ch.rotations = std::make_unique<Quaternion[]>(rotCount);
-            memcpy(ch.rotTimeStamps.get(), cur, timeBytes);
-            memcpy(ch.rotations.get(), cur + timeBytes, rotBytes);
-            cur += timeBytes + rotBytes;
+        // Per track: times, then the packed range and keys or the float keys.
+        for (uint32_t t = 0; t < fileTracks; ++t){
+            TrackRange& track = ch->tracks[t];
+            if (track.count == 0) continue;
+            memcpy(m_times[t].data() + track.first, cur, track.count * sizeof(float));
+            cur += track.count * sizeof(float);
+
+            if (m_packed){
+                if (t != Rotation){
+                    memcpy(&track.origin, cur, sizeof(Vector3));
+                    memcpy(&track.step, cur + sizeof(Vector3), sizeof(Vector3));
+                    cur += 2 * sizeof(Vector3);
+                }
+                memcpy(m_packedKeys[t].data() + (size_t)track.first * 3, cur, track.count * 3 * sizeof(uint16_t));
+                cur += track.count * 3 * sizeof(uint16_t);
+            } else if (t == Rotation){
+                memcpy(m_rotations.data() + track.first, cur, track.count * sizeof(Quaternion));
+                cur += track.count * sizeof(Quaternion);
+            } else {
+                memcpy(m_vectors[t].data() + track.first, cur, track.count * sizeof(Vector3));
+                cur += track.count * sizeof(Vector3);
+            }
         }
-
-        m_channels.emplace(std::move(nodeName), std::move(ch));
     }
 
     if (header.version >= 2 && cur + sizeof(uint32_t) <= end){
@@ -143,6 +239,15 @@ bool ResourceAnimation::LoadInMemory(){
 
 void ResourceAnimation::UnloadFromMemory(){
     m_channels.clear();
+    m_channelNames.clear();
+    m_channelIndex.clear();
+    for (uint32_t t = 0; t < TrackCount; ++t){
+        m_times[t].clear();
+        m_vectors[t].clear();
+        m_packedKeys[t].clear();
+    }
+    m_rotations.clear();
+    m_packed = false;
     m_morphChannels.clear();
     m_name.clear();
     m_duration = 0.f;
@@ -2,19 +2,32 @@
 #include "ResourceCommon.h"
 #include <unordered_map>
 #include <string>
+#include <vector>
 #include <memory>
 #include <cstdint>
 
+namespace AnimationCompression { struct PackedVectors; struct PackedRotations; }
+
 class ResourceAnimation : public ResourceBase {
 public:
-    struct Channel {
-        std::unique_ptr<Vector3[]> positions;
-        std::unique_ptr<float[]> posTimeStamps;
-        uint32_t posCount = 0;
+    // A channel's transform tracks, all sampled the same way: translation
+    // and scale keys are Vector3, rotation keys are Quaternion.
+    enum Track : uint32_t { Translation, Rotation, Scale, TrackCount };
 
-        std::unique_ptr<Quaternion[]> rotations;
-        std::unique_ptr<float[]> rotTimeStamps;
-        uint32_t rotCount = 0;
+    // A track's keys inside the clip's flat arrays for that track. The
+    // origin and step place a packed clip's 16-bit translation or scale keys
+    // in the track's range.
+    struct TrackRange {
+        uint32_t first = 0;
+        uint32_t count = 0;
+        Vector3 origin;
+        Vector3 step;
+    };
+
+    // Channels are stored in file order and names are only used to bind them
+    // to bones.
+    struct Channel {
+        TrackRange tracks[TrackCount];
     };
 
     struct MorphChannel {
@@ -31,14 +44,50 @@ public:
 
     const std::string& getAnimName() const { return m_name; }
     float getDuration() const { return m_duration; }
-    const std::unordered_map<std::string, Channel>& getChannels() const { return m_channels; }
+    const std::vector<Channel>& getChannels() const { return m_channels; }
+    const std::string& getChannelName(uint32_t channel) const { return m_channelNames[channel]; }
     const std::unordered_map<std::string, MorphChannel>& getMorphChannels() const { return m_morphChannels; }
 
+    // Index of the node's channel, or -1.
+    int findChannel(const std::string& nodeName) const;
+
+    // A clip holds either float keys or packed ones (version 3 and 4 files),
+    // which the sampler decodes per key; see AnimationCompression.
+    // Times are float either way.
+    bool isPacked() const { return m_packed; }
+    const float* getTimes(Track track) const { return m_times[track].data(); }
+    const Vector3* getVectors(Track track) const { return m_vectors[track].data(); }
+    const Quaternion* getRotations() const { return m_rotations.data(); }
+    const uint16_t* getPackedKeys(Track track) const { return m_packedKeys[track].data(); }
+
+    // Bytes held by the channel table and the key arrays.
+    size_t getKeyBytes() const;
+
     const MorphChannel* getMorphChannel(const std::string& nodeName) const;
 
+    // Builds a clip in memory, for tools and benchmarks.
+    void setDuration(float seconds){ m_duration = seconds; }
+    void addChannel(const std::string& nodeName,
+                    const float* posTimes, const Vector3* positions, uint32_t posCount,
+                    const float* rotTimes, const Quaternion* rotations, uint32_t rotCount,
+                    const float* scaleTimes = nullptr, const Vector3* scales = nullptr, uint32_t scaleCount = 0);
+    void addPackedChannel(const std::string& nodeName,
+                          const AnimationCompression::PackedVectors& positions,
+                          const AnimationCompression::PackedRotations& rotations,
+                          const AnimationCompression::PackedVectors& scales);
+
 private:
+    Channel* appendChannel(const std::string& nodeName, const uint32_t (&counts)[TrackCount]);
+
     std::string m_name;
     float m_duration = 0.f;
-    std::unordered_map<std::string, Channel> m_channels;
+    std::vector<Channel> m_channels;
+    std::vector<std::string> m_channelNames;
+    std::unordered_map<std::string, uint32_t> m_channelIndex;
+    std::vector<float> m_times[TrackCount];
+    std::vector<Vector3> m_vectors[TrackCount];     // the rotation slot stays empty
+    std::vector<Quaternion> m_rotations;
+    bool m_packed = false;
+    std::vector<uint16_t> m_packedKeys[TrackCount];
     std::unordered_map<std::string, MorphChannel> m_morphChannels;
 };
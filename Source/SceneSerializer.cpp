@@ -93,6 +93,17 @@ bool SceneSerializer::SaveScene(const SceneGraph* scene, const std::string& file
 
             set.AddMember("GravityY", settings->gravityY, a);
 
+            Value layersObj(kObjectType);
+            Value layerNames(kArrayType);
+            Value layerMasks(kArrayType);
+            for (uint32_t i = 0; i < CollisionLayers::kLayerCount; ++i){
+                layerNames.PushBack(Value(settings->collisionLayers.names[i].c_str(), a), a);
+                layerMasks.PushBack(settings->collisionLayers.masks[i], a);
+            }
+            layersObj.AddMember("names", layerNames, a);
+            layersObj.AddMember("masks", layerMasks, a);
+            set.AddMember("CollisionLayers", layersObj, a);
+
             Value ppObj(kObjectType);
             ppObj.AddMember("exposure", settings->postProcess.exposure, a);
             ppObj.AddMember("bloomEnabled", settings->postProcess.bloomEnabled, a);
@@ -194,6 +205,7 @@ bool SceneSerializer::LoadScene(const std::string& filePath, SceneGraph* scene,
         settings->skybox = defaults.skybox;
         settings->ambient = defaults.ambient;
         settings->gravityY = defaults.gravityY;
+        settings->collisionLayers = defaults.collisionLayers;
         settings->postProcess = defaults.postProcess;
 
         if (doc["Scene"].HasMember("Settings")){
@@ -212,6 +224,19 @@ bool SceneSerializer::LoadScene(const std::string& filePath, SceneGraph* scene,
                 if (amb.HasMember("intensity")) settings->ambient.intensity = amb["intensity"].GetFloat();
             }
             if (set.HasMember("GravityY")) settings->gravityY = set["GravityY"].GetFloat();
+            if (set.HasMember("CollisionLayers")){
+                const Value& cl = set["CollisionLayers"];
+                if (cl.HasMember("names")){
+                    const Value& names = cl["names"];
+                    for (SizeType i = 0; i < names.Size() && i < CollisionLayers::kLayerCount; ++i)
+                        settings->collisionLayers.names[i] = names[i].GetString();
+                }
+                if (cl.HasMember("masks")){
+                    const Value& masks = cl["masks"];
+                    for (SizeType i = 0; i < masks.Size() && i < CollisionLayers::kLayerCount; ++i)
+                        settings->collisionLayers.masks[i] = masks[i].GetUint();
+                }
+            }
             if (set.HasMember("PostProcess")){
                 const Value& pp = set["PostProcess"];
                 if (pp.HasMember("exposure")) settings->postProcess.exposure = pp["exposure"].GetFloat();
@@ -17,6 +17,7 @@ void SceneSettingsPanel::drawContent(){
     drawEnvironmentSection();
     drawLightingSection();
     drawPhysicsSection();
+    drawCollisionLayersSection();
     drawBroadphaseSection();
     if (ModuleCamera* cam = app->getCamera()) cam->onEditorDebugPanel();
 }
@@ -103,7 +104,60 @@ void SceneSettingsPanel::drawPhysicsSection(){
     ImGui::SetNextItemWidth(-1.f);
     ImGui::DragFloat("##gravity_y", &s.gravityY, 0.1f, -50.f, 0.f, "%.2f m/s²");
     if (ImGui::IsItemHovered())
-        ImGui::SetTooltip("World-space Y gravity (m/s²).\nApplied by ComponentRigidbody each frame.");
+        ImGui::SetTooltip("World-space Y gravity (m/s²).\nApplied by ComponentRigidbody each physics step.");
+}
+
+void SceneSettingsPanel::drawCollisionLayersSection(){
+    if (!ImGui::CollapsingHeader("Collision Layers")) return;
+    CollisionLayers& layers = m_editor->getSceneManager()->getSettings().collisionLayers;
+
+    // Only named layers get a row and column; naming a layer brings it in.
+    std::vector<uint32_t> used;
+    for (uint32_t i = 0; i < CollisionLayers::kLayerCount; ++i)
+        if (!layers.names[i].empty()) used.push_back(i);
+
+    if (ImGui::TreeNode("Names##cl")){
+        for (uint32_t i = 0; i < CollisionLayers::kLayerCount; ++i){
+            ImGui::PushID(static_cast<int>(i));
+            char nameBuf[64] = {};
+            strncpy_s(nameBuf, layers.names[i].c_str(), sizeof(nameBuf) - 1);
+            ImGui::Text("%2u", i);
+            ImGui::SameLine(40.f);
+            ImGui::SetNextItemWidth(-1.f);
+            if (ImGui::InputText("##n", nameBuf, sizeof(nameBuf))) layers.names[i] = nameBuf;
+            ImGui::PopID();
+        }
+        ImGui::TreePop();
+    }
+
+    if (used.empty()){ textMuted("Name a layer to edit its interactions."); return; }
+
+    const int cols = static_cast<int>(used.size()) + 1;
+    if (ImGui::BeginTable("##layermatrix", cols,
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit |
+            ImGuiTableFlags_ScrollX)){
+        ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 90.f);
+        for (uint32_t l : used) ImGui::TableSetupColumn(layers.names[l].c_str(), ImGuiTableColumnFlags_WidthFixed, 24.f);
+        ImGui::TableHeadersRow();
+
+        for (size_t r = 0; r < used.size(); ++r){
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(layers.names[used[r]].c_str());
+            for (size_t c = 0; c <= r; ++c){
+                ImGui::TableSetColumnIndex(static_cast<int>(c) + 1);
+                ImGui::PushID(static_cast<int>(used[r] * CollisionLayers::kLayerCount + used[c]));
+                bool on = layers.canCollide(used[r], used[c]);
+                if (ImGui::Checkbox("##c", &on)) layers.set(used[r], used[c], on);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("%s  x  %s", layers.names[used[r]].c_str(), layers.names[used[c]].c_str());
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::SmallButton("Reset##cl")) layers.reset();
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Every layer collides with every layer.");
 }
 
 void SceneSettingsPanel::drawBroadphaseSection(){
@@ -113,7 +167,9 @@ void SceneSettingsPanel::drawBroadphaseSection(){
 
     const bool isGrid = cs->isUsingGrid();
     const bool isOctree = cs->isUsingOctree();
-    const bool isBrute = !isGrid && !isOctree;
+    const bool isTree = cs->isUsingDynamicTree();
+    const bool isSap = cs->isUsingSweepAndPrune();
+    const bool isBrute = !isGrid && !isOctree && !isTree && !isSap;
 
     auto styleActive = [](bool on){
         if (on) ImGui::PushStyleColor(ImGuiCol_Button, EditorColors::Active);
@@ -127,8 +183,12 @@ void SceneSettingsPanel::drawBroadphaseSection(){
     styleActive(isGrid); if (ImGui::Button("Uniform Grid")){ cs->useGridBroadPhase(); } styleEnd(isGrid);
     ImGui::SameLine();
     styleActive(isOctree); if (ImGui::Button("Octree")){ cs->useOctreeBroadPhase(); } styleEnd(isOctree);
+    ImGui::SameLine();
+    styleActive(isTree); if (ImGui::Button("AABB Tree")){ cs->useDynamicTreeBroadPhase(); } styleEnd(isTree);
+    ImGui::SameLine();
+    styleActive(isSap); if (ImGui::Button("Sweep & Prune")){ cs->useSweepAndPruneBroadPhase(); } styleEnd(isSap);
 
-    const char* complexity = isBrute ? "O(n\xC2\xB2)" : isGrid ? "O(n log n)" : "adaptive";
+    const char* complexity = isBrute ? "O(n\xC2\xB2)" : isGrid ? "O(n log n)" : isTree ? "O(moved log n)" : isSap ? "O(n + swaps)" : "adaptive";
     ImGui::SameLine(0, 10);
     textMuted("%s", complexity);
 }
@@ -15,6 +15,7 @@ private:
     void drawEnvironmentSection();
     void drawLightingSection();
     void drawPhysicsSection();
+    void drawCollisionLayersSection();
     void drawBroadphaseSection();
 
     std::vector<std::string> m_skyboxFiles;
@@ -10,11 +10,13 @@
 #include "ResourceMesh.h"
 #include "Mesh.h"
 #include "Frustum.h"
+#include "FrustumCulling.h"
 #include "ReadData.h"
 #include <d3dx12.h>
 
 namespace {
     constexpr UINT cbAlign(UINT b){ return (b + 255u) & ~255u; }
+    constexpr float kUnboundedExtent = 1e30f;
 
     struct CubeMVP {
         Matrix worldLightViewProj;
@@ -500,6 +502,8 @@ void ShadowMapPass::render(ID3D12GraphicsCommandList* cmd,
         }
     }
 
+    cullCascades(meshes, viewProjs, cascadeCount, skip);
+
     BEGIN_EVENT(cmd, L"Shadow Map Pass");
     if (mode == 0){
         renderDepth(cmd, meshes, viewProjs, cascadeCount, skip);
@@ -512,6 +516,28 @@ void ShadowMapPass::render(ID3D12GraphicsCommandList* cmd,
     END_EVENT(cmd);
 }
 
+// Boxes are gathered once and shared by every cascade; each cascade keeps
+// its own last-rejecting plane per mesh. Meshes without a world AABB get an
+// unbounded box so they are never culled.
+void ShadowMapPass::cullCascades(const std::vector<MeshEntry*>& meshes,
+                                 const Matrix* viewProjs, int cascadeCount, const bool* skip){
+    const uint32_t count = static_cast<uint32_t>(meshes.size());
+    m_cullBoxes.clear();
+    m_cullBoxes.reserve(count);
+    for (const MeshEntry* e : meshes){
+        if (e && e->hasWorldAABB) m_cullBoxes.push(e->aabbMin, e->aabbMax);
+        else m_cullBoxes.pushCenterExtent(Vector3::Zero, Vector3(kUnboundedExtent, kUnboundedExtent, kUnboundedExtent));
+    }
+
+    for (int c = 0; c < cascadeCount; ++c){
+        if (skip && skip[c]) continue;
+        if (m_cullPlanes[c].size() != count) m_cullPlanes[c].assign(count, FrustumCulling::kNoPlane);
+        m_cascadeVisible[c].resize(FrustumCulling::MaskWords(count));
+        FrustumCulling::Cull(Frustum::fromViewProj(viewProjs[c]),
+                             m_cullBoxes.view(m_cullPlanes[c].data()), m_cascadeVisible[c].data());
+    }
+}
+
 void ShadowMapPass::renderDepth(ID3D12GraphicsCommandList* cmd,
                                 const std::vector<MeshEntry*>& meshes,
                                 const Matrix* viewProjs, int cascadeCount,
@@ -541,12 +567,13 @@ void ShadowMapPass::renderDepth(ID3D12GraphicsCommandList* cmd,
         cmd->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
         const Matrix& lightViewProj = viewProjs[c];
-        const Frustum lightFr = Frustum::fromViewProj(lightViewProj);
-        for (MeshEntry* entry : meshes){
+        const uint32_t* visible = m_cascadeVisible[c].data();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(meshes.size()); ++i){
+            if (!FrustumCulling::IsVisible(visible, i)) continue;
+            MeshEntry* entry = meshes[i];
             if (!entry) continue;
             Mesh* mesh = entry->meshRes ? entry->meshRes->getMesh() : entry->mesh;
             if (!mesh) continue;
-            if (!entryVisible(entry, lightFr)) continue;
             if (m_ringCursor >= MAX_DRAWS) m_ringCursor = 0;
             const UINT slot = m_ringCursor++;
 
@@ -680,12 +707,13 @@ void ShadowMapPass::renderMoments(ID3D12GraphicsCommandList* cmd,
         cmd->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
         const Matrix& lightViewProj = viewProjs[c];
-        const Frustum lightFr = Frustum::fromViewProj(lightViewProj);
-        for (MeshEntry* entry : meshes){
+        const uint32_t* visible = m_cascadeVisible[c].data();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(meshes.size()); ++i){
+            if (!FrustumCulling::IsVisible(visible, i)) continue;
+            MeshEntry* entry = meshes[i];
             if (!entry) continue;
             Mesh* mesh = entry->meshRes ? entry->meshRes->getMesh() : entry->mesh;
             if (!mesh) continue;
-            if (!entryVisible(entry, lightFr)) continue;
             if (m_ringCursor >= MAX_DRAWS) m_ringCursor = 0;
             const UINT slot = m_ringCursor++;
 
@@ -5,6 +5,7 @@
 #include "DepthStencilDesc.h"
 #include "RenderTargetDesc.h"
 #include "ShadowMath.h"
+#include "FrustumCulling.h"
 #include <SimpleMath.h>
 #include <vector>
 #include <d3d12.h>
@@ -203,6 +204,8 @@ private:
     bool ensureSpotResources(uint32_t resolution);
     bool ensurePointResources(uint32_t resolution);
     bool ensureReduceResources(uint32_t depthW, uint32_t depthH);
+    void cullCascades(const std::vector<MeshEntry*>& meshes, const Matrix* viewProjs,
+                      int cascadeCount, const bool* skip);
     void renderDepth(ID3D12GraphicsCommandList* cmd, const std::vector<MeshEntry*>& meshes,
                      const Matrix* viewProjs, int cascadeCount, const bool* skip);
     void renderMoments(ID3D12GraphicsCommandList* cmd, const std::vector<MeshEntry*>& meshes,
@@ -272,6 +275,10 @@ private:
     Matrix m_cachedVP[ShadowMath::kMaxCascades];
     bool m_cacheValid[ShadowMath::kMaxCascades] = {};
 
+    FrustumCulling::BoxSet m_cullBoxes;
+    std::vector<uint8_t> m_cullPlanes[ShadowMath::kMaxCascades];
+    std::vector<uint32_t> m_cascadeVisible[ShadowMath::kMaxCascades];
+
     ComPtr<ID3D12Resource> m_previewTex;
     ShaderTableDesc m_previewSrv;
     uint32_t m_previewRes = 0;
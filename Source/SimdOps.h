@@ -0,0 +1,77 @@
+#pragma once
+#include <intrin.h>
+#include <immintrin.h>
+
+// Lane-wise float ops for kernels written once as templates and
+// instantiated for SSE (4 lanes) and AVX2 (8 lanes). end() runs after an
+// AVX kernel so following SSE code pays no transition penalty.
+struct SseOps {
+    using V = __m128;
+    static constexpr int kWidth = 4;
+    static constexpr int kAllLanes = 0xF;
+    static V load(const float* p){ return _mm_load_ps(p); }
+    static V loadu(const float* p){ return _mm_loadu_ps(p); }
+    static void store(float* p, V a){ _mm_store_ps(p, a); }
+    static void storeu(float* p, V a){ _mm_storeu_ps(p, a); }
+    static V set1(float f){ return _mm_set1_ps(f); }
+    static V add(V a, V b){ return _mm_add_ps(a, b); }
+    static V sub(V a, V b){ return _mm_sub_ps(a, b); }
+    static V mul(V a, V b){ return _mm_mul_ps(a, b); }
+    static V div(V a, V b){ return _mm_div_ps(a, b); }
+    static V sqrt(V a){ return _mm_sqrt_ps(a); }
+    static V abs(V a){ return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    static V min_(V a, V b){ return _mm_min_ps(a, b); }
+    static V max_(V a, V b){ return _mm_max_ps(a, b); }
+    static V lt(V a, V b){ return _mm_cmplt_ps(a, b); }
+    static V le(V a, V b){ return _mm_cmple_ps(a, b); }
+    static V ge(V a, V b){ return _mm_cmpge_ps(a, b); }
+    static V nlt(V a, V b){ return _mm_cmpnlt_ps(a, b); }
+    static V and_(V a, V b){ return _mm_and_ps(a, b); }
+    static V andnot(V a, V b){ return _mm_andnot_ps(a, b); }
+    static V or_(V a, V b){ return _mm_or_ps(a, b); }
+    static V select(V a, V b, V m){ return _mm_or_ps(_mm_andnot_ps(m, a), _mm_and_ps(m, b)); }
+    static int mask(V a){ return _mm_movemask_ps(a); }
+    static void end(){}
+};
+
+struct AvxOps {
+    using V = __m256;
+    static constexpr int kWidth = 8;
+    static constexpr int kAllLanes = 0xFF;
+    static V load(const float* p){ return _mm256_load_ps(p); }
+    static V loadu(const float* p){ return _mm256_loadu_ps(p); }
+    static void store(float* p, V a){ _mm256_store_ps(p, a); }
+    static void storeu(float* p, V a){ _mm256_storeu_ps(p, a); }
+    static V set1(float f){ return _mm256_set1_ps(f); }
+    static V add(V a, V b){ return _mm256_add_ps(a, b); }
+    static V sub(V a, V b){ return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b){ return _mm256_mul_ps(a, b); }
+    static V div(V a, V b){ return _mm256_div_ps(a, b); }
+    static V sqrt(V a){ return _mm256_sqrt_ps(a); }
+    static V abs(V a){ return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+    static V min_(V a, V b){ return _mm256_min_ps(a, b); }
+    static V max_(V a, V b){ return _mm256_max_ps(a, b); }
+    static V lt(V a, V b){ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static V le(V a, V b){ return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static V ge(V a, V b){ return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static V nlt(V a, V b){ return _mm256_cmp_ps(a, b, _CMP_NLT_UQ); }
+    static V and_(V a, V b){ return _mm256_and_ps(a, b); }
+    static V andnot(V a, V b){ return _mm256_andnot_ps(a, b); }
+    static V or_(V a, V b){ return _mm256_or_ps(a, b); }
+    static V select(V a, V b, V m){ return _mm256_blendv_ps(a, b, m); }
+    static int mask(V a){ return _mm256_movemask_ps(a); }
+    static void end(){ _mm256_zeroupper(); }
+};
+
+inline bool CpuHasAVX2(){
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
@@ -0,0 +1,110 @@
+#include "Globals.h"
+#include "SimulationIslands.h"
+#include "ComponentRigidbody.h"
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <numeric>
+
+static constexpr uint32_t kNoIsland = UINT32_MAX;
+
+static inline bool isDynamic(const CollisionBody& body){
+    return body.rb && !body.rb->isStatic && body.rb->getInvMass() > 0.f;
+}
+
+uint32_t SimulationIslands::find(uint32_t i){
+    while (m_parent[i] != i){
+        m_parent[i] = m_parent[m_parent[i]];
+        i = m_parent[i];
+    }
+    return i;
+}
+
+void SimulationIslands::unite(uint32_t a, uint32_t b){
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (a < b) m_parent[b] = a;
+    else m_parent[a] = b;
+}
+
+void SimulationIslands::update(const std::vector<ContactManifold>& manifolds,
+                               const std::vector<CollisionBody>& bodies, float dt){
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    const uint32_t n = static_cast<uint32_t>(bodies.size());
+    m_parent.resize(n);
+    std::iota(m_parent.begin(), m_parent.end(), 0u);
+    m_islandOf.assign(n, kNoIsland);
+    m_islands.clear();
+    m_wakeIslands.clear();
+
+    const float lin2 = m_linearThreshold * m_linearThreshold;
+    const float ang2 = m_angularThreshold * m_angularThreshold;
+    for (const CollisionBody& body : bodies){
+        if (!isDynamic(body) || body.rb->isSleeping()) continue;
+        ComponentRigidbody* rb = body.rb;
+        const bool still = rb->velocity.LengthSquared() < lin2 &&
+                           rb->angularVelocity.LengthSquared() < ang2;
+        rb->setSleepTimer(still && rb->canSleep ? rb->getSleepTimer() + dt : 0.f);
+    }
+
+    for (const ContactManifold& m : manifolds){
+        if (isDynamic(bodies[m.bodyA]) && isDynamic(bodies[m.bodyB]))
+            unite(m.bodyA, m.bodyB);
+    }
+
+    for (uint32_t i = 0; i < n; ++i){
+        if (!isDynamic(bodies[i])) continue;
+        const uint32_t root = find(i);
+        if (m_islandOf[root] == kNoIsland){
+            m_islandOf[root] = static_cast<uint32_t>(m_islands.size());
+            m_islands.push_back({ FLT_MAX, false, true });
+        }
+        m_islandOf[i] = m_islandOf[root];
+
+        const ComponentRigidbody* rb = bodies[i].rb;
+        if (rb->isSleeping()) continue;
+        IslandState& island = m_islands[m_islandOf[i]];
+        island.hasAwake = true;
+        island.minTimer = std::min(island.minTimer, rb->getSleepTimer());
+        island.canSleep = island.canSleep && rb->canSleep;
+    }
+
+    // An island sleeps only if every awake member is ready; otherwise each
+    // sleeping group it touches is woken in full.
+    std::vector<uint32_t> sleepId(m_islands.size(), 0);
+    for (uint32_t k = 0; k < static_cast<uint32_t>(m_islands.size()); ++k){
+        const IslandState& island = m_islands[k];
+        if (!island.hasAwake) continue;
+        if (m_sleepingEnabled && island.canSleep && island.minTimer >= m_sleepTime)
+            sleepId[k] = m_nextSleepIsland++;
+    }
+    for (uint32_t i = 0; i < n; ++i){
+        const uint32_t k = m_islandOf[i];
+        if (k == kNoIsland || !bodies[i].rb->isSleeping()) continue;
+        if (!m_sleepingEnabled || (m_islands[k].hasAwake && sleepId[k] == 0))
+            m_wakeIslands.push_back(bodies[i].rb->getSleepIsland());
+    }
+    std::sort(m_wakeIslands.begin(), m_wakeIslands.end());
+
+    m_islandCount = static_cast<uint32_t>(m_islands.size());
+    m_sleepingBodies = 0;
+    m_awakeBodies = 0;
+    for (uint32_t i = 0; i < n; ++i){
+        const uint32_t k = m_islandOf[i];
+        if (k == kNoIsland) continue;
+        ComponentRigidbody* rb = bodies[i].rb;
+        if (sleepId[k] != 0){
+            rb->sleep(sleepId[k]);
+        } else if (rb->isSleeping() &&
+                   std::binary_search(m_wakeIslands.begin(), m_wakeIslands.end(), rb->getSleepIsland())){
+            rb->wakeUp();
+        }
+        if (rb->isSleeping()) ++m_sleepingBodies;
+        else ++m_awakeBodies;
+    }
+
+    m_lastMs = std::chrono::duration<float, std::milli>(
+        std::chrono::high_resolution_clock::now() - t0).count();
+}
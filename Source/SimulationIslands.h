@@ -0,0 +1,57 @@
+#pragma once
+#include "CollisionInterfaces.h"
+#include <vector>
+
+// Groups dynamic bodies into islands over this frame's contact graph
+// (union-find) and puts an island to sleep once every body in it has stayed
+// below the velocity thresholds for sleepTime seconds. An island that touches
+// an awake, moving body wakes as a whole, including members that fell asleep
+// together with it but are not in contact this frame.
+class SimulationIslands {
+public:
+    void update(const std::vector<ContactManifold>& manifolds,
+                const std::vector<CollisionBody>& bodies, float dt);
+
+    bool isSleepingEnabled() const { return m_sleepingEnabled; }
+    void setSleepingEnabled(bool on){ m_sleepingEnabled = on; }
+
+    float getLinearSleepThreshold() const { return m_linearThreshold; }
+    void setLinearSleepThreshold(float v){ m_linearThreshold = v < 0.f ? 0.f : v; }
+
+    float getAngularSleepThreshold() const { return m_angularThreshold; }
+    void setAngularSleepThreshold(float v){ m_angularThreshold = v < 0.f ? 0.f : v; }
+
+    float getSleepTime() const { return m_sleepTime; }
+    void setSleepTime(float t){ m_sleepTime = t < 0.f ? 0.f : t; }
+
+    uint32_t getLastIslandCount() const { return m_islandCount; }
+    uint32_t getLastSleepingBodyCount() const { return m_sleepingBodies; }
+    uint32_t getLastAwakeBodyCount() const { return m_awakeBodies; }
+    float getLastUpdateMs() const { return m_lastMs; }
+
+private:
+    uint32_t find(uint32_t i);
+    void unite(uint32_t a, uint32_t b);
+
+    struct IslandState {
+        float minTimer;
+        bool hasAwake;
+        bool canSleep;
+    };
+
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_islandOf;
+    std::vector<IslandState> m_islands;
+    std::vector<uint32_t> m_wakeIslands;
+
+    bool m_sleepingEnabled = true;
+    float m_linearThreshold = 0.05f;
+    float m_angularThreshold = 0.05f;
+    float m_sleepTime = 0.5f;
+    uint32_t m_nextSleepIsland = 1;
+
+    uint32_t m_islandCount = 0;
+    uint32_t m_sleepingBodies = 0;
+    uint32_t m_awakeBodies = 0;
+    float m_lastMs = 0.f;
+};
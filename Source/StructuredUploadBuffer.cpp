@@ -0,0 +1,59 @@
+#include "Globals.h"
+#include "StructuredUploadBuffer.h"
+#include "Application.h"
+#include "ModuleD3D12.h"
+#include "ModuleGPUResources.h"
+#include "ModuleShaderDescriptors.h"
+#include <d3dx12.h>
+#include <algorithm>
+
+bool StructuredUploadBuffer::init(ID3D12Device* device, UINT stride, UINT capacity, const wchar_t* name){
+    m_stride = stride;
+    m_name = name;
+    return allocate(device, std::max(capacity, 1u));
+}
+
+bool StructuredUploadBuffer::allocate(ID3D12Device* device, UINT capacity){
+    auto hp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto bd = CD3DX12_RESOURCE_DESC::Buffer(UINT64(m_stride) * capacity);
+    ComPtr<ID3D12Resource> buf;
+    HRESULT hr = device->CreateCommittedResource(&hp, D3D12_HEAP_FLAG_NONE, &bd,
+                                                  D3D12_RESOURCE_STATE_GENERIC_READ,
+                                                  nullptr, IID_PPV_ARGS(&buf));
+    if (FAILED(hr)){
+        LOG("StructuredUploadBuffer: %u x %u bytes failed 0x%08X", capacity, m_stride, hr);
+        return false;
+    }
+    ShaderTableDesc srv = app->getShaderDescriptors()->allocTable("StructuredUploadSRV");
+    if (!srv.isValid()){
+        LOG("StructuredUploadBuffer: SRV alloc failed");
+        return false;
+    }
+    buf->SetName(m_name);
+    void* mapped = nullptr;
+    buf->Map(0, nullptr, &mapped);
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC sv = {};
+    sv.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    sv.Format = DXGI_FORMAT_UNKNOWN;
+    sv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    sv.Buffer.NumElements = capacity;
+    sv.Buffer.StructureByteStride = m_stride;
+    srv.createSRV(buf.Get(), 0, &sv);
+
+    if (m_buf) app->getGPUResources()->deferRelease(m_buf);
+    m_buf = buf;
+    m_mapped = mapped;
+    m_srv = srv;
+    m_capacity = capacity;
+    return true;
+}
+
+bool StructuredUploadBuffer::upload(const void* data, size_t count){
+    if (count > m_capacity){
+        const UINT grown = static_cast<UINT>(std::max(count, size_t(m_capacity) * 2));
+        if (!allocate(app->getD3D12()->getDevice(), grown)) return false;
+    }
+    if (count > 0) memcpy(m_mapped, data, count * m_stride);
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "ShaderTableDesc.h"
+#include <d3d12.h>
+#include <wrl.h>
+using Microsoft::WRL::ComPtr;
+
+// A persistently mapped upload buffer behind a one-slot structured SRV table,
+// for per-frame arrays with no fixed upper bound. It only grows: an upload
+// that does not fit retires the old buffer through deferRelease and takes a
+// new buffer and table at least twice the size.
+class StructuredUploadBuffer {
+public:
+    bool init(ID3D12Device* device, UINT stride, UINT capacity, const wchar_t* name);
+
+    // Copies `count` elements, growing first if needed. Returns false if a
+    // grow failed, in which case the old contents and view are kept.
+    bool upload(const void* data, size_t count);
+
+    D3D12_GPU_DESCRIPTOR_HANDLE getSRV() const { return m_srv.getGPUHandle(0); }
+    UINT getCapacity() const { return m_capacity; }
+
+private:
+    bool allocate(ID3D12Device* device, UINT capacity);
+
+    ComPtr<ID3D12Resource> m_buf;
+    void* m_mapped = nullptr;
+    ShaderTableDesc m_srv;
+    UINT m_stride = 0;
+    UINT m_capacity = 0;
+    const wchar_t* m_name = L"";
+};
@@ -0,0 +1,473 @@
+#include "Globals.h"
+#include "SweepAndPruneBroadPhase.h"
+
+#include <algorithm>
+
+static inline float axisValue(const Vector3& v, int axis){
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static inline BroadPhasePairEvent makeEvent(BroadPhasePairEvent::Type type, uint32_t a, uint32_t b){
+    return { type, std::min(a, b), std::max(a, b) };
+}
+
+// Orders endpoints by value, placing mins ahead of maxes on ties so touching
+// boxes count as overlapping, matching AABB::intersects.
+static inline bool endpointLess(float av, bool aMax, float bv, bool bMax){
+    return av < bv || (av == bv && !aMax && bMax);
+}
+
+static inline void eraseOverlap(std::vector<uint32_t>& list, uint32_t value){
+    auto it = std::find(list.begin(), list.end(), value);
+    if (it == list.end()) return;
+    *it = list.back();
+    list.pop_back();
+}
+
+
+bool SweepAndPruneBroadPhase::overlaps2D(const Proxy& a, const Proxy& b, int skipAxis) const{
+    const int axis1 = (skipAxis + 1) % 3;
+    const int axis2 = (skipAxis + 2) % 3;
+    return overlapsOnAxis(a, b, axis1) && overlapsOnAxis(a, b, axis2);
+}
+
+void SweepAndPruneBroadPhase::addPair(uint32_t a, uint32_t b, std::vector<BroadPhasePairEvent>& events){
+    m_proxies[a].overlaps.push_back(b);
+    m_proxies[b].overlaps.push_back(a);
+    if (reported(m_proxies[a], m_proxies[b]))
+        events.push_back(makeEvent(BroadPhasePairEvent::Type::Added, a, b));
+    ++m_activePairs;
+}
+
+void SweepAndPruneBroadPhase::removePair(uint32_t a, uint32_t b, std::vector<BroadPhasePairEvent>& events){
+    eraseOverlap(m_proxies[a].overlaps, b);
+    eraseOverlap(m_proxies[b].overlaps, a);
+    if (reported(m_proxies[a], m_proxies[b]))
+        events.push_back(makeEvent(BroadPhasePairEvent::Type::Removed, a, b));
+    --m_activePairs;
+}
+
+// A layer, mask or sleep change turns existing overlaps on or off without
+// any endpoint moving, so the difference is reported here.
+void SweepAndPruneBroadPhase::setFilter(uint32_t p, const CollisionBody& body,
+                                        std::vector<BroadPhasePairEvent>& events){
+    Proxy& P = m_proxies[p];
+    if (P.layerBits == body.layerBits && P.maskBits == body.maskBits &&
+        P.sleeping == body.sleeping && P.resting == body.resting) return;
+
+    Proxy old;
+    old.layerBits = P.layerBits;
+    old.maskBits = P.maskBits;
+    old.sleeping = P.sleeping;
+    old.resting = P.resting;
+    P.layerBits = body.layerBits;
+    P.maskBits = body.maskBits;
+    P.sleeping = body.sleeping;
+    P.resting = body.resting;
+    for (uint32_t q : P.overlaps){
+        const Proxy& Q = m_proxies[q];
+        const bool was = reported(old, Q);
+        const bool is = reported(P, Q);
+        if (was != is)
+            events.push_back(makeEvent(is ? BroadPhasePairEvent::Type::Added
+                                          : BroadPhasePairEvent::Type::Removed, p, q));
+    }
+}
+
+void SweepAndPruneBroadPhase::sortMinDown(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events){
+    std::vector<Endpoint>& ep = m_axes[axis];
+    const Endpoint cur = ep[i];
+    const uint32_t self = cur.proxy();
+
+    while (i > 0 && endpointLess(cur.value, cur.isMax(), ep[i - 1].value, ep[i - 1].isMax())){
+        const Endpoint prev = ep[i - 1];
+        Proxy& other = m_proxies[prev.proxy()];
+        if (prev.isMax()){
+            if (events && overlaps2D(m_proxies[self], other, axis))
+                addPair(self, prev.proxy(), *events);
+            other.maxIdx[axis] = i;
+        } else {
+            other.minIdx[axis] = i;
+        }
+        ep[i] = prev;
+        --i;
+        ++m_swapCount;
+    }
+    ep[i] = cur;
+    m_proxies[self].minIdx[axis] = i;
+}
+
+void SweepAndPruneBroadPhase::sortMinUp(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events){
+    std::vector<Endpoint>& ep = m_axes[axis];
+    const Endpoint cur = ep[i];
+    const uint32_t self = cur.proxy();
+    const uint32_t n = static_cast<uint32_t>(ep.size());
+
+    while (i + 1 < n && endpointLess(ep[i + 1].value, ep[i + 1].isMax(), cur.value, cur.isMax())){
+        const Endpoint next = ep[i + 1];
+        Proxy& other = m_proxies[next.proxy()];
+        if (next.isMax()){
+            if (events && overlaps2D(m_proxies[self], other, axis))
+                removePair(self, next.proxy(), *events);
+            other.maxIdx[axis] = i;
+        } else {
+            other.minIdx[axis] = i;
+        }
+        ep[i] = next;
+        ++i;
+        ++m_swapCount;
+    }
+    ep[i] = cur;
+    m_proxies[self].minIdx[axis] = i;
+}
+
+void SweepAndPruneBroadPhase::sortMaxDown(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events){
+    std::vector<Endpoint>& ep = m_axes[axis];
+    const Endpoint cur = ep[i];
+    const uint32_t self = cur.proxy();
+
+    while (i > 0 && endpointLess(cur.value, cur.isMax(), ep[i - 1].value, ep[i - 1].isMax())){
+        const Endpoint prev = ep[i - 1];
+        Proxy& other = m_proxies[prev.proxy()];
+        if (!prev.isMax()){
+            if (events && overlaps2D(m_proxies[self], other, axis))
+                removePair(self, prev.proxy(), *events);
+            other.minIdx[axis] = i;
+        } else {
+            other.maxIdx[axis] = i;
+        }
+        ep[i] = prev;
+        --i;
+        ++m_swapCount;
+    }
+    ep[i] = cur;
+    m_proxies[self].maxIdx[axis] = i;
+}
+
+void SweepAndPruneBroadPhase::sortMaxUp(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events){
+    std::vector<Endpoint>& ep = m_axes[axis];
+    const Endpoint cur = ep[i];
+    const uint32_t self = cur.proxy();
+    const uint32_t n = static_cast<uint32_t>(ep.size());
+
+    while (i + 1 < n && endpointLess(ep[i + 1].value, ep[i + 1].isMax(), cur.value, cur.isMax())){
+        const Endpoint next = ep[i + 1];
+        Proxy& other = m_proxies[next.proxy()];
+        if (!next.isMax()){
+            if (events && overlaps2D(m_proxies[self], other, axis))
+                addPair(self, next.proxy(), *events);
+            other.minIdx[axis] = i;
+        } else {
+            other.maxIdx[axis] = i;
+        }
+        ep[i] = next;
+        ++i;
+        ++m_swapCount;
+    }
+    ep[i] = cur;
+    m_proxies[self].maxIdx[axis] = i;
+}
+
+void SweepAndPruneBroadPhase::moveProxy(uint32_t p, const AABB& box, std::vector<BroadPhasePairEvent>& events){
+    Proxy& P = m_proxies[p];
+    for (int axis = 0; axis < 3; ++axis){
+        const float newMin = axisValue(box.min, axis);
+        const float newMax = std::max(axisValue(box.max, axis), newMin);
+        Endpoint& eMin = m_axes[axis][P.minIdx[axis]];
+        Endpoint& eMax = m_axes[axis][P.maxIdx[axis]];
+        const float oldMin = eMin.value;
+        const float oldMax = eMax.value;
+        if (newMin == oldMin && newMax == oldMax) continue;
+
+        eMin.value = newMin;
+        eMax.value = newMax;
+
+        // Grow first, then shrink, so the min never crosses its own max.
+        if (newMin < oldMin) sortMinDown(axis, P.minIdx[axis], &events);
+        if (newMax > oldMax) sortMaxUp(axis, P.maxIdx[axis], &events);
+        if (newMin > oldMin) sortMinUp(axis, P.minIdx[axis], &events);
+        if (newMax < oldMax) sortMaxDown(axis, P.maxIdx[axis], &events);
+    }
+    P.box = box;
+}
+
+void SweepAndPruneBroadPhase::insertProxy(uint32_t p, std::vector<BroadPhasePairEvent>& events){
+    Proxy& P = m_proxies[p];
+    P.alive = true;
+    for (int axis = 0; axis < 3; ++axis){
+        std::vector<Endpoint>& ep = m_axes[axis];
+        const float mn = axisValue(P.box.min, axis);
+        const float mx = std::max(axisValue(P.box.max, axis), mn);
+        ep.push_back({ mn, p << 1 });
+        ep.push_back({ mx, (p << 1) | kMaxFlag });
+        P.minIdx[axis] = static_cast<uint32_t>(ep.size() - 2);
+        P.maxIdx[axis] = static_cast<uint32_t>(ep.size() - 1);
+        sortMinDown(axis, P.minIdx[axis], nullptr);
+        sortMaxDown(axis, P.maxIdx[axis], nullptr);
+    }
+
+    const uint32_t count = static_cast<uint32_t>(m_proxies.size());
+    for (uint32_t q = 0; q < count; ++q){
+        if (q == p || !m_proxies[q].alive) continue;
+        const Proxy& Q = m_proxies[q];
+        if (overlapsOnAxis(P, Q, 0) && overlaps2D(P, Q, 0))
+            addPair(p, q, events);
+    }
+}
+
+void SweepAndPruneBroadPhase::removeDeadEndpoints(){
+    for (int axis = 0; axis < 3; ++axis){
+        std::vector<Endpoint>& ep = m_axes[axis];
+        uint32_t w = 0;
+        for (uint32_t r = 0; r < ep.size(); ++r){
+            Proxy& P = m_proxies[ep[r].proxy()];
+            if (!P.alive) continue;
+            if (ep[r].isMax()) P.maxIdx[axis] = w;
+            else P.minIdx[axis] = w;
+            ep[w++] = ep[r];
+        }
+        ep.resize(w);
+    }
+}
+
+void SweepAndPruneBroadPhase::rebuild(std::vector<BroadPhasePairEvent>& events){
+    const uint32_t count = static_cast<uint32_t>(m_proxies.size());
+
+    for (int axis = 0; axis < 3; ++axis){
+        std::vector<Endpoint>& ep = m_axes[axis];
+        ep.clear();
+        for (uint32_t p = 0; p < count; ++p){
+            const Proxy& P = m_proxies[p];
+            if (!P.alive) continue;
+            const float mn = axisValue(P.box.min, axis);
+            ep.push_back({ mn, p << 1 });
+            ep.push_back({ std::max(axisValue(P.box.max, axis), mn), (p << 1) | kMaxFlag });
+        }
+        std::sort(ep.begin(), ep.end(), [](const Endpoint& a, const Endpoint& b){
+            return endpointLess(a.value, a.isMax(), b.value, b.isMax());
+        });
+        for (uint32_t i = 0; i < ep.size(); ++i){
+            Proxy& P = m_proxies[ep[i].proxy()];
+            if (ep[i].isMax()) P.maxIdx[axis] = i;
+            else P.minIdx[axis] = i;
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> fresh(count);
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> activePos(count, 0);
+    for (const Endpoint& e : m_axes[0]){
+        const uint32_t p = e.proxy();
+        if (!e.isMax()){
+            for (uint32_t q : active){
+                if (overlaps2D(m_proxies[p], m_proxies[q], 0)){
+                    fresh[p].push_back(q);
+                    fresh[q].push_back(p);
+                }
+            }
+            activePos[p] = static_cast<uint32_t>(active.size());
+            active.push_back(p);
+        } else {
+            const uint32_t last = active.back();
+            active[activePos[p]] = last;
+            activePos[last] = activePos[p];
+            active.pop_back();
+        }
+    }
+
+    int pairs = 0;
+    for (uint32_t p = 0; p < count; ++p){
+        Proxy& P = m_proxies[p];
+        if (!P.alive) continue;
+        std::vector<uint32_t>& now = fresh[p];
+        std::sort(P.overlaps.begin(), P.overlaps.end());
+        std::sort(now.begin(), now.end());
+
+        size_t i = 0, j = 0;
+        while (i < P.overlaps.size() || j < now.size()){
+            const uint32_t was = i < P.overlaps.size() ? P.overlaps[i] : UINT32_MAX;
+            const uint32_t is = j < now.size() ? now[j] : UINT32_MAX;
+            if (was == is){ ++i; ++j; continue; }
+            if (was < is){
+                if (was > p && reported(P, m_proxies[was]))
+                    events.push_back(makeEvent(BroadPhasePairEvent::Type::Removed, p, was));
+                ++i;
+            } else {
+                if (is > p && reported(P, m_proxies[is]))
+                    events.push_back(makeEvent(BroadPhasePairEvent::Type::Added, p, is));
+                ++j;
+            }
+        }
+        pairs += static_cast<int>(now.size());
+        P.overlaps.swap(now);
+    }
+    m_activePairs = pairs / 2;
+}
+
+uint32_t SweepAndPruneBroadPhase::allocateProxy(){
+    if (!m_freeProxies.empty()){
+        const uint32_t p = m_freeProxies.back();
+        m_freeProxies.pop_back();
+        m_proxies[p] = Proxy{};
+        return p;
+    }
+    m_proxies.emplace_back();
+    return static_cast<uint32_t>(m_proxies.size() - 1);
+}
+
+void SweepAndPruneBroadPhase::update(const std::vector<CollisionBody>& bodies,
+                                     std::vector<BroadPhasePairEvent>& outEvents){
+    ++m_stamp;
+    m_swapCount = 0;
+
+    // Slots freed last frame become reusable only now, so an event stream
+    // never sees one proxy index stand for two different bodies.
+    m_freeProxies.insert(m_freeProxies.end(), m_pendingFree.begin(), m_pendingFree.end());
+    m_pendingFree.clear();
+
+    const uint32_t n = static_cast<uint32_t>(bodies.size());
+    m_bodyProxy.assign(n, UINT32_MAX);
+    std::vector<uint32_t> added;
+    uint32_t seen = 0;
+
+    for (uint32_t i = 0; i < n; ++i){
+        auto it = m_proxyById.find(bodies[i].id);
+        if (it == m_proxyById.end()){
+            added.push_back(i);
+            continue;
+        }
+        Proxy& P = m_proxies[it->second];
+        P.bodyIndex = i;
+        P.stamp = m_stamp;
+        m_bodyProxy[i] = it->second;
+        ++seen;
+    }
+
+    if (seen != m_proxyById.size()){
+        for (auto it = m_proxyById.begin(); it != m_proxyById.end();){
+            const uint32_t p = it->second;
+            Proxy& P = m_proxies[p];
+            if (P.stamp == m_stamp){ ++it; continue; }
+            while (!P.overlaps.empty()) removePair(p, P.overlaps.back(), outEvents);
+            P.alive = false;
+            m_pendingFree.push_back(p);
+            it = m_proxyById.erase(it);
+        }
+        removeDeadEndpoints();
+    }
+
+    for (uint32_t i = 0; i < n; ++i){
+        if (m_bodyProxy[i] == UINT32_MAX) continue;
+        setFilter(m_bodyProxy[i], bodies[i], outEvents);
+        if (!bodies[i].sleeping)
+            moveProxy(m_bodyProxy[i], bodies[i].worldAABB, outEvents);
+    }
+
+    if (!added.empty()){
+        std::vector<uint32_t> created;
+        created.reserve(added.size());
+        for (uint32_t i : added){
+            const uint32_t p = allocateProxy();
+            Proxy& P = m_proxies[p];
+            P.box = bodies[i].worldAABB;
+            P.id = bodies[i].id;
+            P.bodyIndex = i;
+            P.stamp = m_stamp;
+            P.layerBits = bodies[i].layerBits;
+            P.maskBits = bodies[i].maskBits;
+            P.sleeping = bodies[i].sleeping;
+            P.resting = bodies[i].resting;
+            m_proxyById[P.id] = p;
+            created.push_back(p);
+        }
+
+        if (created.size() > kRebuildThreshold){
+            for (uint32_t p : created) m_proxies[p].alive = true;
+            rebuild(outEvents);
+        } else {
+            for (uint32_t p : created) insertProxy(p, outEvents);
+        }
+    }
+
+    m_lastSwapCount = m_swapCount;
+}
+
+std::vector<CollisionPair> SweepAndPruneBroadPhase::query(
+    const std::vector<CollisionBody>& bodies){
+    m_queryEvents.clear();
+    update(bodies, m_queryEvents);
+
+    std::vector<CollisionPair> pairs;
+    pairs.reserve(m_activePairs);
+    const uint32_t count = static_cast<uint32_t>(m_proxies.size());
+    for (uint32_t p = 0; p < count; ++p){
+        const Proxy& P = m_proxies[p];
+        if (!P.alive) continue;
+        for (uint32_t q : P.overlaps){
+            if (q < p || !reported(P, m_proxies[q])) continue;
+            const uint32_t a = P.bodyIndex;
+            const uint32_t b = m_proxies[q].bodyIndex;
+            pairs.push_back({ std::min(a, b), std::max(a, b) });
+        }
+    }
+    return pairs;
+}
+
+// Candidates overlap the box on x, so either their min endpoint is at or
+// below box.max.x or their max endpoint is at or above box.min.x; the
+// shorter of the two runs of the sorted x axis is scanned.
+void SweepAndPruneBroadPhase::queryOverlap(const AABB& box, const std::vector<CollisionBody>& bodies,
+                                           std::vector<uint32_t>& outBodies) const{
+    const std::vector<Endpoint>& ep = m_axes[0];
+    const auto upper = std::upper_bound(ep.begin(), ep.end(), box.max.x,
+        [](float v, const Endpoint& e){ return v < e.value; });
+    const auto lower = std::lower_bound(ep.begin(), ep.end(), box.min.x,
+        [](const Endpoint& e, float v){ return e.value < v; });
+    const bool scanMins = (upper - ep.begin()) <= (ep.end() - lower);
+
+    auto first = scanMins ? ep.begin() : lower;
+    auto last = scanMins ? upper : ep.end();
+    for (auto it = first; it != last; ++it){
+        if (it->isMax() != !scanMins) continue;
+        const Proxy& P = m_proxies[it->proxy()];
+        if (P.alive && P.bodyIndex < bodies.size() && P.box.intersects(box))
+            outBodies.push_back(P.bodyIndex);
+    }
+}
+
+// Bounded rays become an overlap query on the segment's box; candidates are
+// visited nearest entry first so a closest-hit callback can stop early.
+void SweepAndPruneBroadPhase::queryRay(const Vector3& origin, const Vector3& dir, float maxT, float radius,
+                                       const std::vector<CollisionBody>& bodies, const RayHitFn& hit) const{
+    if (!(maxT < kMaxSegment)){
+        IBroadPhase::queryRay(origin, dir, maxT, radius, bodies, hit);
+        return;
+    }
+    const Vector3 end = origin + dir * maxT;
+    const Vector3 grow(radius, radius, radius);
+    const AABB segment{ Vector3::Min(origin, end) - grow, Vector3::Max(origin, end) + grow };
+
+    std::vector<uint32_t> candidates;
+    queryOverlap(segment, bodies, candidates);
+
+    const Vector3 invDir(1.f / dir.x, 1.f / dir.y, 1.f / dir.z);
+    std::vector<std::pair<float, uint32_t>> order;
+    order.reserve(candidates.size());
+    for (uint32_t i : candidates){
+        const AABB box{ bodies[i].worldAABB.min - grow, bodies[i].worldAABB.max + grow };
+        float t;
+        if (box.intersectsRay(origin, invDir, maxT, t)) order.push_back({ t, i });
+    }
+    std::sort(order.begin(), order.end());
+    for (const auto& [t, i] : order){
+        if (t > maxT) break;
+        maxT = hit(i, maxT);
+    }
+}
+
+void SweepAndPruneBroadPhase::drawDebug(){
+    for (const Proxy& P : m_proxies){
+        if (!P.alive || P.overlaps.empty()) continue;
+        dd::aabb(ddConvert(P.box.min), ddConvert(P.box.max), dd::colors::Yellow);
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "CollisionInterfaces.h"
+#include "BoundingVolume.h"
+#include <vector>
+#include <unordered_map>
+
+// Three-axis incremental sweep and prune. Endpoint arrays stay sorted between
+// frames and are repaired with insertion sort; every endpoint swap that starts
+// or ends an overlap emits a pair event, so frame coherence keeps updates
+// close to linear and no pair set is needed for deduplication. Overlap lists
+// track every box overlap; only pairs whose layers collide and that are not
+// sleeping pairs produce events.
+class SweepAndPruneBroadPhase : public IBroadPhase {
+public:
+    SweepAndPruneBroadPhase() = default;
+
+    std::vector<CollisionPair> query(
+        const std::vector<CollisionBody>& bodies) override;
+
+    bool emitsPairEvents() const override { return true; }
+    void update(const std::vector<CollisionBody>& bodies,
+                std::vector<BroadPhasePairEvent>& outEvents) override;
+    uint32_t getProxyBody(uint32_t proxy) const override { return m_proxies[proxy].bodyIndex; }
+
+    void queryOverlap(const AABB& box, const std::vector<CollisionBody>& bodies,
+                      std::vector<uint32_t>& outBodies) const override;
+    void queryRay(const Vector3& origin, const Vector3& dir, float maxT, float radius,
+                  const std::vector<CollisionBody>& bodies, const RayHitFn& hit) const override;
+
+    void drawDebug() override;
+
+    const char* getName() const override { return "Sweep and Prune"; }
+
+    int getProxyCount() const { return static_cast<int>(m_proxyById.size()); }
+    int getLastSwapCount() const { return m_lastSwapCount; }
+    int getActivePairCount() const { return m_activePairs; }
+
+private:
+    static constexpr uint32_t kMaxFlag = 1u;
+    static constexpr uint32_t kRebuildThreshold = 32;
+    // Longer rays walk every body instead of the segment's box.
+    static constexpr float kMaxSegment = 1e6f;
+
+    struct Endpoint {
+        float value;
+        uint32_t data;
+
+        uint32_t proxy() const { return data >> 1; }
+        bool isMax() const { return (data & kMaxFlag) != 0; }
+    };
+
+    struct Proxy {
+        AABB box;
+        uint32_t id = 0;
+        uint32_t bodyIndex = 0;
+        uint32_t stamp = 0;
+        uint32_t layerBits = 1u;
+        uint32_t maskBits = 0xFFFFFFFFu;
+        bool sleeping = false;
+        bool resting = true;
+        uint32_t minIdx[3] = {};
+        uint32_t maxIdx[3] = {};
+        std::vector<uint32_t> overlaps;
+        bool alive = false;
+    };
+
+    bool overlapsOnAxis(const Proxy& a, const Proxy& b, int axis) const{
+        return a.minIdx[axis] < b.maxIdx[axis] && b.minIdx[axis] < a.maxIdx[axis];
+    }
+    bool overlaps2D(const Proxy& a, const Proxy& b, int skipAxis) const;
+    static bool reported(const Proxy& a, const Proxy& b){
+        return layersCollide(a.layerBits, a.maskBits, b.layerBits, b.maskBits) &&
+               !isSleepingPair(a.sleeping, a.resting, b.sleeping, b.resting);
+    }
+    void setFilter(uint32_t p, const CollisionBody& body, std::vector<BroadPhasePairEvent>& events);
+
+    void addPair(uint32_t a, uint32_t b, std::vector<BroadPhasePairEvent>& events);
+    void removePair(uint32_t a, uint32_t b, std::vector<BroadPhasePairEvent>& events);
+
+    void sortMinDown(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events);
+    void sortMinUp(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events);
+    void sortMaxDown(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events);
+    void sortMaxUp(int axis, uint32_t i, std::vector<BroadPhasePairEvent>* events);
+
+    void moveProxy(uint32_t p, const AABB& box, std::vector<BroadPhasePairEvent>& events);
+    void insertProxy(uint32_t p, std::vector<BroadPhasePairEvent>& events);
+    void removeDeadEndpoints();
+    void rebuild(std::vector<BroadPhasePairEvent>& events);
+
+    uint32_t allocateProxy();
+
+    std::vector<Endpoint> m_axes[3];
+    std::vector<Proxy> m_proxies;
+    std::vector<uint32_t> m_freeProxies;
+    std::vector<uint32_t> m_pendingFree;
+    std::unordered_map<uint32_t, uint32_t> m_proxyById;
+
+    std::vector<uint32_t> m_bodyProxy;
+    std::vector<BroadPhasePairEvent> m_queryEvents;
+
+    uint32_t m_stamp = 0;
+    int m_swapCount = 0;
+    int m_lastSwapCount = 0;
+    int m_activePairs = 0;
+};
@@ -73,6 +73,7 @@ std::vector<CollisionPair> UniformGridBroadPhase::query(
                 uint32_t a = flat[p].idx;
                 uint32_t b = flat[q].idx;
                 if (a > b) std::swap(a, b);
+                if (!reportsPair(bodies[a], bodies[b])) continue;
                 uint64_t pairKey = ((uint64_t)a << 32) | b;
                 if (seen.insert(pairKey).second)
                     pairs.push_back({ a, b });
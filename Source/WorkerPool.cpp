@@ -0,0 +1,88 @@
+#include "Globals.h"
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(uint32_t threadCount){
+    start(threadCount > 1 ? threadCount - 1 : 0);
+}
+
+WorkerPool::~WorkerPool(){
+    stop();
+}
+
+uint32_t WorkerPool::hardwareThreads(){
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void WorkerPool::setThreadCount(uint32_t threadCount){
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount == getThreadCount()) return;
+    stop();
+    start(threadCount - 1);
+}
+
+void WorkerPool::start(uint32_t workerCount){
+    m_quit = false;
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i)
+        m_workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+void WorkerPool::stop(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_workers) t.join();
+    m_workers.clear();
+}
+
+void WorkerPool::runTasks(const std::function<void(uint32_t)>& task, uint32_t count){
+    for (uint32_t i = m_next.fetch_add(1); i < count; i = m_next.fetch_add(1))
+        task(i);
+}
+
+void WorkerPool::workerLoop(){
+    // A restarted pool keeps its generation; starting from it stops a new
+    // worker from picking up the last loop's finished task.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t seen = m_generation;
+    for (;;){
+        m_wake.wait(lock, [&]{ return m_quit || m_generation != seen; });
+        if (m_quit) return;
+        seen = m_generation;
+        const std::function<void(uint32_t)>* task = m_task;
+        const uint32_t count = m_count;
+
+        lock.unlock();
+        runTasks(*task, count);
+        lock.lock();
+
+        if (--m_busy == 0) m_done.notify_one();
+    }
+}
+
+void WorkerPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& task){
+    if (count == 0) return;
+    if (m_workers.empty() || count == 1){
+        for (uint32_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next.store(0);
+        m_busy = static_cast<uint32_t>(m_workers.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    runTasks(task, count);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&]{ return m_busy == 0; });
+    m_task = nullptr;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+// Persistent worker threads for blocking parallel-for loops. The calling
+// thread takes part in every loop, so a pool of N threads starts N - 1
+// workers and a pool of 1 runs everything inline.
+class WorkerPool {
+public:
+    explicit WorkerPool(uint32_t threadCount = 1);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+    void setThreadCount(uint32_t threadCount);
+
+    // Calls task(i) once for every i in [0, count) and returns when all calls
+    // have finished. Indices are handed out dynamically, so tasks must not
+    // depend on which thread runs them.
+    void parallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+
+    static uint32_t hardwareThreads();
+
+private:
+    void start(uint32_t workerCount);
+    void stop();
+    void workerLoop();
+    void runTasks(const std::function<void(uint32_t)>& task, uint32_t count);
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const std::function<void(uint32_t)>* m_task = nullptr;
+    uint32_t m_count = 0;
+    std::atomic<uint32_t> m_next{ 0 };
+    uint32_t m_busy = 0;
+    uint64_t m_generation = 0;
+    bool m_quit = false;
+};
@@ -0,0 +1,22 @@
+#ifndef _CLUSTERS_HLSLI_
+#define _CLUSTERS_HLSLI_
+
+// Must match LightClusters::kGridX/Y/Z.
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+
+// Froxel of a pixel: its screen tile and the exponential slice of its view
+// depth. viewDepthRow turns a world position into view depth; clusterParams.xy
+// are LightClusters' slice scale and bias.
+uint getClusterIndex(float2 pixelPos, float3 worldPos, uint2 viewportSize,
+                     float4 viewDepthRow, float4 clusterParams){
+    uint x = min(uint(pixelPos.x * CLUSTER_X / viewportSize.x), CLUSTER_X - 1);
+    uint y = min(uint(pixelPos.y * CLUSTER_Y / viewportSize.y), CLUSTER_Y - 1);
+    float viewDepth = max(dot(float4(worldPos, 1.0f), viewDepthRow), 1e-4f);
+    float slice = floor(log(viewDepth) * clusterParams.x + clusterParams.y);
+    uint z = uint(clamp(slice, 0.0f, CLUSTER_Z - 1.0f));
+    return (z * CLUSTER_Y + y) * CLUSTER_X + x;
+}
+
+#endif
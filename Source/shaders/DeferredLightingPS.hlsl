@@ -4,9 +4,7 @@
 #include "ImageBasedLighting.hlsli"
 #include "Samplers.hlsli"
 #include "Shadows.hlsli"
-
-#define TILE_SIZE        16
-#define MAX_LIGHTS_PER_TILE 64
+#include "Clusters.hlsli"
 
 cbuffer CbPerFrame : register(b0){
     uint DirLightCount;
@@ -18,7 +16,7 @@ cbuffer CbPerFrame : register(b0){
     float4x4 InvViewProj;
     uint ViewportWidth;
     uint ViewportHeight;
-    uint2 LightCullingPad;
+    uint2 ViewportPad;
     float4x4 LightViewProj[MAX_CASCADES];
     float4 ShadowParams0;
     float4 ShadowParams1;
@@ -30,14 +28,17 @@ cbuffer CbPerFrame : register(b0){
     float4 SpotShadowPos;
     float4 PointShadowParams;
     float4 PointShadowPos;
+    float4 ViewDepthRow;
+    float4 ClusterParams;
 };
 
 StructuredBuffer<DirectionalLight> DirLights : register(t0);
 StructuredBuffer<PointLight> PointLights : register(t1);
 StructuredBuffer<SpotLight> SpotLights : register(t2);
 
-StructuredBuffer<int> PointLightIndices : register(t10);
-StructuredBuffer<int> SpotLightIndices : register(t11);
+// x = offset into ClusterLightIndices, y = point count, z = spot count.
+StructuredBuffer<uint4> Clusters : register(t10);
+StructuredBuffer<uint> ClusterLightIndices : register(t11);
 
 Texture2DArray ShadowMap : register(t12);
 Texture2DArray ShadowMoments : register(t13);
@@ -64,11 +65,6 @@ float3 ReconstructWorldPos(float2 uv, float depth){
     return worldH.xyz / worldH.w;
 }
 
-uint getTileIndex(uint2 pixelPos){
-    uint numTilesX = (ViewportWidth + TILE_SIZE - 1) / TILE_SIZE;
-    return (pixelPos.y / TILE_SIZE) * numTilesX + (pixelPos.x / TILE_SIZE);
-}
-
 float4 main(float4 svPos : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET {
     float4 albedoSample = GBufferAlbedo.Sample(PointClamp, uv);
     float4 normalMRSample = GBufferNormalMR.Sample(PointClamp, uv);
@@ -121,11 +117,11 @@ float4 main(float4 svPos : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET {
         color += dirContribution;
     }
 
-    uint tileIdx = getTileIndex(uint2(svPos.xy));
+    uint4 cluster = Clusters[getClusterIndex(svPos.xy, worldPos, uint2(ViewportWidth, ViewportHeight),
+                                             ViewDepthRow, ClusterParams)];
 
-    for (uint j = 0; j < MAX_LIGHTS_PER_TILE; ++j){
-        int pIdx = PointLightIndices[tileIdx * MAX_LIGHTS_PER_TILE + j];
-        if (pIdx < 0) break;
+    for (uint j = 0; j < cluster.y; ++j){
+        uint pIdx = ClusterLightIndices[cluster.x + j];
         float3 pc = EvaluatePointLight(V, N, PointLights[pIdx], worldPos, albedo, roughness, metallic);
         if (PointShadowParams.x > 0.5f &&
             distance(PointLights[pIdx].Position, PointShadowPos.xyz) < 0.05f)
@@ -134,9 +130,8 @@ float4 main(float4 svPos : SV_POSITION, float2 uv : TEXCOORD0) : SV_TARGET {
         color += pc;
     }
 
-    for (uint k = 0; k < MAX_LIGHTS_PER_TILE; ++k){
-        int sIdx = SpotLightIndices[tileIdx * MAX_LIGHTS_PER_TILE + k];
-        if (sIdx < 0) break;
+    for (uint k = 0; k < cluster.z; ++k){
+        uint sIdx = ClusterLightIndices[cluster.x + cluster.y + k];
         float3 spc = EvaluateSpotLight(V, N, SpotLights[sIdx], worldPos, albedo, roughness, metallic);
         if (SpotShadowParams.x > 0.5f &&
             distance(SpotLights[sIdx].Position, SpotShadowPos.xyz) < 0.05f)
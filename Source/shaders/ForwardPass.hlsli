@@ -3,9 +3,11 @@
 
 #include "Common.hlsli"
 #include "Lights.hlsli"
+#include "Lighting.hlsli"
 #include "Material.hlsli"
 #include "Samplers.hlsli"
 #include "Shadows.hlsli"
+#include "Clusters.hlsli"
 
 cbuffer CbMVP : register(b0){
     float4x4 MVP;
@@ -21,6 +23,11 @@ cbuffer CbPerFrame : register(b1){
     float4x4 DirLightViewProj[MAX_CASCADES];
     float4 DirShadowParams0;
     float4 DirShadowParams1;
+    uint ViewportWidth;
+    uint ViewportHeight;
+    uint2 ViewportPad;
+    float4 ViewDepthRow;
+    float4 ClusterParams;
 };
 
 cbuffer CbPerInstance : register(b2){
@@ -44,6 +51,10 @@ Texture2D OcclusionTex : register(t9);
 Texture2D EmissiveTex : register(t10);
 Texture2DArray DirShadowMap : register(t11);
 
+// x = offset into ClusterLightIndices, y = point count, z = spot count.
+StructuredBuffer<uint4> Clusters : register(t12);
+StructuredBuffer<uint> ClusterLightIndices : register(t13);
+
 float ComputeForwardDirShadow(float3 worldPos){
     if (DirShadowParams1.x < 0.5f) return 1.0f;
     int cascade;
@@ -52,6 +63,21 @@ float ComputeForwardDirShadow(float3 worldPos){
                                 DirShadowParams0.z, DirShadowParams0.w, cascade);
 }
 
+// Point and spot lights of the pixel's cluster, as in the deferred pass.
+float3 EvaluateClusterLights(float2 pixelPos, float3 worldPos, float3 V, float3 N,
+                             float3 baseColour, float alphaRoughness, float metallic){
+    uint4 cluster = Clusters[getClusterIndex(pixelPos, worldPos, uint2(ViewportWidth, ViewportHeight),
+                                             ViewDepthRow, ClusterParams)];
+    float3 colour = float3(0.0f, 0.0f, 0.0f);
+    for (uint j = 0; j < cluster.y; ++j)
+        colour += EvaluatePointLight(V, N, PointLights[ClusterLightIndices[cluster.x + j]], worldPos,
+                                     baseColour, alphaRoughness, metallic);
+    for (uint k = 0; k < cluster.z; ++k)
+        colour += EvaluateSpotLight(V, N, SpotLights[ClusterLightIndices[cluster.x + cluster.y + k]], worldPos,
+                                    baseColour, alphaRoughness, metallic);
+    return colour;
+}
+
 #define VARIANCE  0.3
 #define THRESHOLD 0.2
 
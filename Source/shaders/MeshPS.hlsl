@@ -1,7 +1,3 @@
-#define MAX_DIR_LIGHTS   4
-#define MAX_POINT_LIGHTS 32
-#define MAX_SPOT_LIGHTS  16
-
 #define PI 3.14159265359f
 
 struct DirectionalLight {
@@ -44,10 +40,6 @@ cbuffer LightCB : register(b2){
 
     float numRoughnessLevels;
     float3 pad1;
-
-    DirectionalLight dirLights[MAX_DIR_LIGHTS];
-    PointLight pointLights[MAX_POINT_LIGHTS];
-    SpotLight spotLights[MAX_SPOT_LIGHTS];
 };
 
 cbuffer MaterialCB : register(b3){
@@ -77,6 +69,9 @@ Texture2D normalMapTex : register(t4);
 Texture2D aoTex : register(t5);
 Texture2D emissiveTex : register(t6);
 Texture2D metalRoughTex : register(t7);
+StructuredBuffer<DirectionalLight> dirLights : register(t8);
+StructuredBuffer<PointLight> pointLights : register(t9);
+StructuredBuffer<SpotLight> spotLights : register(t10);
 
 SamplerState samplers[4] : register(s0);
 
@@ -6,7 +6,8 @@ float4 main(
     float3 worldPos : POSITION,
     float2 texCoord : TEXCOORD,
     float3 normal : NORMAL0,
-    float4 tangent : TANGENT) : SV_TARGET {
+    float4 tangent : TANGENT,
+    float4 svPos : SV_POSITION) : SV_TARGET {
     float3 V = normalize(CameraPosition - worldPos);
     float3 N = normalize(normal);
 
@@ -49,13 +50,7 @@ float4 main(
         colour += dirC;
     }
 
-    for (uint i = 0; i < PointLightCount; i++)
-        colour += EvaluatePointLight(V, N, PointLights[i], worldPos,
-                                     baseColour, alphaRoughness, metallic);
-
-    for (uint i = 0; i < SpotLightCount; i++)
-        colour += EvaluateSpotLight(V, N, SpotLights[i], worldPos,
-                                    baseColour, alphaRoughness, metallic);
+    colour += EvaluateClusterLights(svPos.xy, worldPos, V, N, baseColour, alphaRoughness, metallic);
 
     colour += SampleEmissive(InstanceMaterial, EmissiveTex, texCoord);
 